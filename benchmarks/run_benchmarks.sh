@@ -0,0 +1,83 @@
+#!/bin/bash
+#
+# Runs the benchmarks in benchmarks/ with pytest-benchmark, saving the results as JSON and, optionally, comparing them
+# against a stored baseline.
+#
+# Results are saved in .benchmarks/ (the pytest-benchmark default) in a directory named after the machine and Python
+# version, for example .benchmarks/Linux-CPython-3.13-64bit/0001_baseline.json
+#
+# Typical use:
+#
+#   benchmarks/run_benchmarks.sh -s baseline        # Save a baseline from the current build.
+#   ... change and rebuild ...
+#   benchmarks/run_benchmarks.sh -c baseline        # Compare against the baseline, fail on regression.
+
+set -o errexit  # abort on nonzero exitstatus
+set -o nounset  # abort on unbound variable
+set -o pipefail # don't hide errors within pipes
+
+BENCHMARK_DIRECTORY="benchmarks"
+# Fail the comparison if the mean time of any benchmark is this much slower than the baseline.
+COMPARE_FAIL_THRESHOLD="mean:10%"
+
+usage()
+{
+    echo "usage: run_benchmarks.sh [-s NAME] [-c NAME] [-t THRESHOLD] [-k EXPRESSION] [-j FILE] [-h, --help]"
+    echo "options:"
+    echo " -h, --help     Print help and exit."
+    echo " -s NAME        Save the results as a baseline called NAME."
+    echo " -c NAME        Compare the results with the saved baseline NAME, this fails on a regression."
+    echo " -t THRESHOLD   Regression threshold for -c, default: ${COMPARE_FAIL_THRESHOLD}"
+    echo " -k EXPRESSION  Only run the benchmarks matching the pytest -k EXPRESSION."
+    echo " -j FILE        Also write the results as JSON to FILE."
+}
+
+# If -h or --help print help.
+for arg in "$@"
+do
+    if [ "$arg" == "--help" ] || [ "$arg" == "-h" ]
+    then
+        usage
+        exit
+    fi
+done
+
+OPT_SAVE=""
+OPT_COMPARE=""
+OPT_KEYWORD=""
+OPT_JSON=""
+
+while getopts "s:c:t:k:j:" opt; do
+    case "$opt" in
+    s)  OPT_SAVE="$OPTARG" ;;
+    c)  OPT_COMPARE="$OPTARG" ;;
+    t)  COMPARE_FAIL_THRESHOLD="$OPTARG" ;;
+    k)  OPT_KEYWORD="$OPTARG" ;;
+    j)  OPT_JSON="$OPTARG" ;;
+    *)  usage
+        exit 1 ;;
+    esac
+done
+
+PYTEST_ARGS=("${BENCHMARK_DIRECTORY}" "--benchmark-only" "--benchmark-sort=name")
+if [ -n "${OPT_SAVE}" ]; then
+    PYTEST_ARGS+=("--benchmark-save=${OPT_SAVE}")
+else
+    # Always keep the JSON of a run so it can be compared later.
+    PYTEST_ARGS+=("--benchmark-autosave")
+fi
+if [ -n "${OPT_COMPARE}" ]; then
+    # pytest-benchmark matches the saved run by its name suffix, for example 0001_baseline.json
+    PYTEST_ARGS+=("--benchmark-compare=*${OPT_COMPARE}" "--benchmark-compare-fail=${COMPARE_FAIL_THRESHOLD}")
+fi
+if [ -n "${OPT_KEYWORD}" ]; then
+    PYTEST_ARGS+=("-k" "${OPT_KEYWORD}")
+fi
+if [ -n "${OPT_JSON}" ]; then
+    PYTEST_ARGS+=("--benchmark-json=${OPT_JSON}")
+fi
+
+echo "---> Python version:"
+python -VV
+echo "---> pytest ${PYTEST_ARGS[*]}"
+pytest "${PYTEST_ARGS[@]}"
@@ -0,0 +1,82 @@
+"""
+Benchmarks of the call overhead of METH_VARARGS/METH_KEYWORDS functions and tp_new/tp_init construction against
+their METH_FASTCALL and vectorcall equivalents.
+The work done in each call is tiny so the difference is the argument passing.
+
+Run with:
+
+    pytest benchmarks --benchmark-sort=name
+"""
+import io
+
+import pytest
+
+from cPyExtPatt import cParseArgs
+from cPyExtPatt import cSeqObject
+from cPyExtPatt import cFile
+from cPyExtPatt.Iterators import cIterator
+from cPyExtPatt.Logging import cLogging
+from cPyExtPatt.SimpleExample import cFibA
+
+
+class SequenceLongObjectSubclass(cSeqObject.SequenceLongObject):
+    """tp_vectorcall is not inherited so this is constructed with tp_new and tp_init."""
+    pass
+
+
+class SequenceOfLongSubclass(cIterator.SequenceOfLong):
+    """tp_vectorcall is not inherited so this is constructed with tp_new and tp_init."""
+    pass
+
+
+@pytest.mark.parametrize('function', (cFibA.fibonacci, cFibA.fibonacci_fastcall))
+def test_fibonacci(benchmark, function):
+    benchmark.group = 'call_fibonacci'
+    result = benchmark(function, 1)
+    assert result == 1
+
+
+@pytest.mark.parametrize('function', (cParseArgs.parse_args, cParseArgs.parse_args_fastcall))
+def test_parse_args(benchmark, function):
+    benchmark.group = 'call_parse_args'
+    result = benchmark(function, b'bytes', 123, 'str')
+    assert result == (b'bytes', 123, 'str')
+
+
+def test_parse_args_fastcall_keywords(benchmark):
+    benchmark.group = 'call_parse_args'
+    result = benchmark(lambda: cParseArgs.parse_args_fastcall(b'bytes', 123, c='str'))
+    assert result == (b'bytes', 123, 'str')
+
+
+@pytest.mark.parametrize('function', (cLogging.log, cLogging.log_fastcall))
+def test_log(benchmark, function):
+    # Below the log level so this measures the call, not the logging.
+    cLogging.py_log_set_level(cLogging.CRITICAL)
+    benchmark.group = 'call_log'
+    result = benchmark(function, cLogging.DEBUG, 'Message')
+    assert result is None
+
+
+@pytest.mark.parametrize('function', (cFile.read_python_file_to_c, cFile.read_python_file_to_c_fastcall))
+def test_read_python_file_to_c(benchmark, function):
+    file_object = io.BytesIO(b'')
+    benchmark.group = 'call_read_python_file_to_c'
+    result = benchmark(function, file_object, 0)
+    assert result == b''
+
+
+@pytest.mark.parametrize('cls', (cSeqObject.SequenceLongObject, SequenceLongObjectSubclass))
+def test_construct_sequence_long_object(benchmark, cls):
+    values = [1, 2, 3]
+    benchmark.group = 'construct_SequenceLongObject'
+    result = benchmark(cls, values)
+    assert len(result) == 3
+
+
+@pytest.mark.parametrize('cls', (cIterator.SequenceOfLong, SequenceOfLongSubclass))
+def test_construct_sequence_of_long(benchmark, cls):
+    values = [1, 2, 3]
+    benchmark.group = 'construct_SequenceOfLong'
+    result = benchmark(cls, values)
+    assert len(result) == 3
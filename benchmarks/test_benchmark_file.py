@@ -0,0 +1,178 @@
+"""
+Benchmarks of cFile reading from and writing to Python file objects from C and C++.
+
+Run with:
+
+    pytest benchmarks --benchmark-sort=name
+"""
+import io
+import os
+
+import pytest
+
+from cPyExtPatt import cFile
+
+SIZES = (1_024, 1_024 * 1_024)
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_read_python(benchmark, size):
+    """The baseline, reading the whole file from Python."""
+    file_object = io.BytesIO(b' ' * size)
+    benchmark.group = f'read_{size}'
+    result = benchmark(lambda: file_object.seek(0) or file_object.read())
+    assert len(result) == size
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_read_python_file_to_c(benchmark, size):
+    file_object = io.BytesIO(b' ' * size)
+    benchmark.group = f'read_{size}'
+    result = benchmark(lambda: file_object.seek(0) or cFile.read_python_file_to_c(file_object))
+    assert len(result) == size
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_write_python(benchmark, size):
+    """The baseline, writing to the file from Python."""
+    data = b' ' * size
+    file_object = io.StringIO()
+    benchmark.group = f'write_{size}'
+    result = benchmark(lambda: file_object.seek(0) or file_object.write(data.decode('ascii')))
+    assert result == size
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_write_bytes_to_python_file(benchmark, size):
+    data = b' ' * size
+    file_object = io.StringIO()
+    benchmark.group = f'write_{size}'
+    result = benchmark(lambda: file_object.seek(0) or cFile.write_bytes_to_python_file(data, file_object))
+    assert result == size
+
+
+@pytest.mark.parametrize('use_readinto', (True, False))
+@pytest.mark.parametrize('chunk_size', (4_096, 64 * 1_024))
+@pytest.mark.parametrize('method', ('buffer', 'vector', 'iostream'))
+def test_read_python_file_via_wrapper(benchmark, method, chunk_size, use_readinto):
+    """Reading a file in chunks through the C++ wrapper, with readinto() or with read()."""
+    size = 4 * 1_024 * 1_024
+    file_object = io.BytesIO(b' ' * size)
+    benchmark.group = f'read_wrapper_{method}_{chunk_size}'
+    result = benchmark(
+        lambda: file_object.seek(0) or cFile.read_python_file_via_wrapper(
+            file_object, chunk_size=chunk_size, method=method, use_readinto=use_readinto
+        )
+    )
+    assert len(result) == size
+
+
+@pytest.mark.parametrize('use_readinto', (True, False))
+@pytest.mark.parametrize('chunk_size', (16, 64))
+def test_read_python_file_via_wrapper_per_call(benchmark, chunk_size, use_readinto):
+    """Small chunks so that the time is dominated by the cost of each call to the Python file's read() or readinto().
+    extra_info has the number of calls and, when available, the mean time per call in nanoseconds."""
+    size = 1_024 * 1_024
+    file_object = io.BytesIO(b' ' * size)
+    # About one call per chunk, plus those that find EOF.
+    calls = size // chunk_size + 1
+    benchmark.group = f'read_wrapper_per_call_{chunk_size}'
+    result = benchmark(
+        lambda: file_object.seek(0) or cFile.read_python_file_via_wrapper(
+            file_object, chunk_size=chunk_size, method='vector', use_readinto=use_readinto
+        )
+    )
+    assert len(result) == size
+    benchmark.extra_info['python_calls'] = calls
+    stats = getattr(benchmark, 'stats', None)
+    if stats is not None:
+        benchmark.extra_info['ns_per_call'] = stats.stats.mean * 1e9 / calls
+
+
+@pytest.fixture(scope='module')
+def data_path(tmp_path_factory):
+    path = tmp_path_factory.mktemp('data') / 'data.bin'
+    path.write_bytes(b' ' * (4 * 1_024 * 1_024))
+    return path
+
+
+@pytest.mark.parametrize('use_fd', (True, False))
+def test_read_file_io_via_wrapper(benchmark, data_path, use_fd):
+    """Reading an io.FileIO through the C++ wrapper with read(2) and the GIL released or with readinto()."""
+    with io.FileIO(data_path, 'r') as file_object:
+        benchmark.group = 'read_wrapper_file_io'
+        result = benchmark(
+            lambda: file_object.seek(0) or cFile.read_python_file_via_wrapper(
+                file_object, chunk_size=64 * 1_024, use_fd=use_fd
+            )
+        )
+    assert len(result) == data_path.stat().st_size
+
+
+@pytest.mark.parametrize('size', (64, 4_096))
+def test_pread_os(benchmark, data_path, size):
+    """The baseline, os.pread()."""
+    with io.FileIO(data_path, 'r') as file_object:
+        benchmark.group = f'pread_{size}'
+        result = benchmark(os.pread, file_object.fileno(), size, 1_000)
+    assert len(result) == size
+
+
+@pytest.mark.parametrize('size', (64, 4_096))
+def test_pread_python_file(benchmark, data_path, size):
+    with io.FileIO(data_path, 'r') as file_object:
+        benchmark.group = f'pread_{size}'
+        result = benchmark(cFile.pread_python_file, file_object, size, 1_000)
+    assert len(result) == size
+
+
+def test_preadv_python_file(benchmark, data_path):
+    """One preadv() for 64 blocks of 4096 bytes."""
+    sizes = [4_096] * 64
+    with io.FileIO(data_path, 'r') as file_object:
+        benchmark.group = 'preadv'
+        result = benchmark(cFile.preadv_python_file, file_object, sizes, 1_000)
+    assert len(result) == len(sizes)
+
+
+RANDOM_OFFSETS = [(i * 7_919 * 4_096) % (4 * 1_024 * 1_024 - 4_096) for i in range(256)]
+
+
+def test_random_access_seek_read(benchmark, data_path):
+    """The baseline, seek() and read() for 256 random blocks."""
+    with open(data_path, 'rb') as file_object:
+        benchmark.group = 'random_access'
+        result = benchmark(lambda: [file_object.seek(offset) or file_object.read(64) for offset in RANDOM_OFFSETS])
+    assert len(result) == len(RANDOM_OFFSETS)
+
+
+def test_random_access_mapped_file(benchmark, data_path):
+    """Slices of a MappedFile, each is a memoryview with no copy."""
+    with cFile.MappedFile(data_path) as mapped:
+        mapped.madvise(cFile.MADV_RANDOM)
+        benchmark.group = 'random_access'
+        result = benchmark(lambda: [mapped[offset:offset + 64] for offset in RANDOM_OFFSETS])
+        assert len(result) == len(RANDOM_OFFSETS)
+        del result
+
+
+INTEGERS_DATA = b' '.join(b'%d' % i for i in range(200_000))
+
+
+def test_sum_integers_python(benchmark):
+    """The baseline, parsing in Python."""
+    file_object = io.BytesIO(INTEGERS_DATA)
+    benchmark.group = 'sum_integers'
+    result = benchmark(lambda: file_object.seek(0) or sum(map(int, file_object.read().split())))
+    assert result == sum(range(200_000))
+
+
+@pytest.mark.parametrize('buffer_size', (64, 64 * 1_024, 4 * 1_024 * 1_024))
+def test_sum_integers_via_streambuf(benchmark, buffer_size):
+    """Parsing with std::istream, the buffer size sets how often Python read() is called."""
+    file_object = io.BytesIO(INTEGERS_DATA)
+    benchmark.group = 'sum_integers'
+    result = benchmark(
+        lambda: file_object.seek(0) or cFile.sum_integers_via_streambuf(file_object, buffer_size=buffer_size)
+    )
+    assert result == sum(range(200_000))
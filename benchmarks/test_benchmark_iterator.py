@@ -0,0 +1,91 @@
+"""
+Benchmarks of cIterator.SequenceOfLong iteration with and without interning of the boxed values.
+
+Run with:
+
+    pytest benchmarks --benchmark-sort=name
+
+The allocation benchmarks use tracemalloc to count the memory blocks that are still allocated after materialising
+the sequence as a list. These are recorded in the benchmark ``extra_info`` as ``blocks`` and ``bytes``.
+"""
+import random
+import tracemalloc
+
+import pytest
+
+from cPyExtPatt.Iterators import cIterator
+
+SIZES = (1_000, 1_000_000)
+
+# Number of distinct values, this is categorical style data. These are outside CPython's small int cache.
+CARDINALITY = 100
+
+
+def make_categorical_values(size, cardinality=CARDINALITY):
+    rng = random.Random(1234)
+    categories = [1_000 + i * 7_919 for i in range(cardinality)]
+    return [rng.choice(categories) for _i in range(size)]
+
+
+def allocations(function):
+    """Return the (blocks, bytes) still allocated by the result of function()."""
+    tracemalloc.start()
+    try:
+        before = tracemalloc.take_snapshot()
+        result = function()
+        after = tracemalloc.take_snapshot()
+    finally:
+        tracemalloc.stop()
+    stats = after.compare_to(before, 'filename')
+    blocks = sum(stat.count_diff for stat in stats)
+    size = sum(stat.size_diff for stat in stats)
+    del result
+    return blocks, size
+
+
+@pytest.mark.parametrize('size', SIZES)
+@pytest.mark.parametrize('intern', (False, True))
+def test_iterate(benchmark, size, intern):
+    sequence = cIterator.SequenceOfLong(make_categorical_values(size), intern=intern)
+    benchmark.group = f'iterate_{size}'
+    result = benchmark(list, sequence)
+    assert len(result) == size
+
+
+@pytest.mark.parametrize('size', SIZES)
+@pytest.mark.parametrize('intern', (False, True))
+def test_getitem(benchmark, size, intern):
+    sequence = cIterator.SequenceOfLong(make_categorical_values(size), intern=intern)
+    benchmark.group = f'getitem_{size}'
+    result = benchmark(lambda: [sequence[i] for i in range(size)])
+    assert len(result) == size
+
+
+@pytest.mark.parametrize('size', SIZES)
+@pytest.mark.parametrize('intern', (False, True))
+def test_iterate_allocations(benchmark, size, intern):
+    """Benchmark the time and record the allocations of materialising the sequence as a list."""
+    values = make_categorical_values(size)
+    sequence = cIterator.SequenceOfLong(values, intern=intern)
+    # Warm the cache so that this only measures the steady state.
+    list(sequence)
+    blocks, size_bytes = allocations(lambda: list(sequence))
+    benchmark.group = f'iterate_allocations_{size}'
+    benchmark.extra_info['blocks'] = blocks
+    benchmark.extra_info['bytes'] = size_bytes
+    benchmark(list, sequence)
+    if intern:
+        # Only the list itself is allocated.
+        assert blocks < size // 10
+    else:
+        # One int for every value.
+        assert blocks >= size
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_chunks(benchmark, size):
+    """For comparison, iteration over raw memoryview chunks."""
+    sequence = cIterator.SequenceOfLong(make_categorical_values(size))
+    benchmark.group = f'iterate_{size}'
+    result = benchmark(lambda: sum(len(chunk) for chunk in iter(sequence).chunks(4096)))
+    assert result == size
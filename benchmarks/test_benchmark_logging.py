@@ -0,0 +1,60 @@
+"""
+Benchmarks of cLogging, calling the Python logging module from C, compared with calling it from Python.
+
+Run with:
+
+    pytest benchmarks --benchmark-sort=name
+
+Messages are sent to a ``logging.NullHandler`` so this measures the cost of the call and the logging machinery, not
+the I/O.
+"""
+import logging
+
+import pytest
+
+from cPyExtPatt.Logging import cLogging
+
+
+@pytest.fixture(params=('enabled', 'disabled'))
+def logger(request):
+    """The Python logger used by cLogging with the level set so that ERROR messages are, or are not, emitted."""
+    logger = logging.getLogger('cLogging')
+    previous = (logger.level, logger.propagate, logger.handlers[:])
+    logger.handlers = [logging.NullHandler()]
+    logger.propagate = False
+    if request.param == 'enabled':
+        logger.setLevel(logging.DEBUG)
+    else:
+        logger.setLevel(logging.CRITICAL)
+    yield logger
+    logger.level, logger.propagate, logger.handlers = previous
+
+
+def test_log_python(benchmark, logger):
+    benchmark.group = f'log_{logger.level}'
+    result = benchmark(logger.error, 'Message')
+    assert result is None
+
+
+def test_log_c(benchmark, logger):
+    benchmark.group = f'log_{logger.level}'
+    result = benchmark(cLogging.log, cLogging.ERROR, 'Message')
+    assert result is None
+
+
+def test_log_c_fastcall(benchmark, logger):
+    benchmark.group = f'log_{logger.level}'
+    result = benchmark(cLogging.log_fastcall, cLogging.ERROR, 'Message')
+    assert result is None
+
+
+def test_py_file_line_function(benchmark):
+    benchmark.group = 'file_line_function'
+    result = benchmark(cLogging.py_file_line_function)
+    assert len(result) == 3
+
+
+def test_c_file_line_function(benchmark):
+    benchmark.group = 'file_line_function'
+    result = benchmark(cLogging.c_file_line_function)
+    assert len(result) == 3
@@ -0,0 +1,48 @@
+"""
+Benchmarks of pickling cPickle.Custom, that implements ``__getstate__`` and ``__setstate__`` in C, compared with an
+equivalent pure Python class.
+
+Run with:
+
+    pytest benchmarks --benchmark-sort=name
+"""
+import pickle
+
+import pytest
+
+from cPyExtPatt import cPickle
+
+ARGS = ('FIRST', 'LAST', 11)
+
+
+class PythonCustom:
+    """The pure Python equivalent of cPickle.Custom."""
+
+    def __init__(self, first, last, number):
+        self.first = first
+        self.last = last
+        self.number = number
+
+
+@pytest.mark.parametrize('cls', (cPickle.Custom, PythonCustom))
+def test_dumps(benchmark, cls):
+    obj = cls(*ARGS)
+    benchmark.group = 'pickle_dumps'
+    result = benchmark(pickle.dumps, obj)
+    assert len(result) > 0
+
+
+@pytest.mark.parametrize('cls', (cPickle.Custom, PythonCustom))
+def test_loads(benchmark, cls):
+    pickled_value = pickle.dumps(cls(*ARGS))
+    benchmark.group = 'pickle_loads'
+    result = benchmark(pickle.loads, pickled_value)
+    assert result.number == 11
+
+
+@pytest.mark.parametrize('cls', (cPickle.Custom, PythonCustom))
+def test_round_trip(benchmark, cls):
+    obj = cls(*ARGS)
+    benchmark.group = 'pickle_round_trip'
+    result = benchmark(lambda: pickle.loads(pickle.dumps(obj)))
+    assert result.first == 'FIRST'
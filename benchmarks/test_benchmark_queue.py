@@ -0,0 +1,116 @@
+"""
+Benchmarks of the lock-free Threads.cppqueue.cppQueue compared with queue.Queue.
+
+Run with:
+
+    pytest benchmarks --benchmark-sort=name
+
+The handoff benchmarks measure the wall clock time for producer threads to pass a fixed number of items to consumer
+threads.
+"""
+import queue
+import threading
+
+import pytest
+
+from cPyExtPatt.Threads import cppqueue
+
+QUEUE_TYPES = {
+    'queue.Queue': queue.Queue,
+    'cppQueue': cppqueue.cppQueue,
+}
+MAXSIZE = 1024
+HANDOFF_ITEMS = 20_000
+BATCH_SIZE = 64
+
+
+@pytest.mark.parametrize('queue_type', QUEUE_TYPES)
+def test_put_get(benchmark, queue_type):
+    """An uncontended put() then get()."""
+    obj = QUEUE_TYPES[queue_type](MAXSIZE)
+
+    def put_get():
+        obj.put(1)
+        return obj.get()
+
+    benchmark.group = 'queue_put_get'
+    assert benchmark(put_get) == 1
+
+
+@pytest.mark.parametrize('queue_type', QUEUE_TYPES)
+def test_put_get_nowait(benchmark, queue_type):
+    obj = QUEUE_TYPES[queue_type](MAXSIZE)
+
+    def put_get_nowait():
+        obj.put_nowait(1)
+        return obj.get_nowait()
+
+    benchmark.group = 'queue_put_get_nowait'
+    assert benchmark(put_get_nowait) == 1
+
+
+def test_put_get_many(benchmark):
+    """A batch of put_many() then get_many(), compare with BATCH_SIZE times test_put_get."""
+    obj = cppqueue.cppQueue(MAXSIZE)
+    items = list(range(BATCH_SIZE))
+
+    def put_get_many():
+        obj.put_many(items)
+        return obj.get_many(BATCH_SIZE)
+
+    benchmark.group = 'queue_put_get_many'
+    assert benchmark(put_get_many) == items
+
+
+def _handoff(obj, producers, consumers, batch):
+    items_per_producer = HANDOFF_ITEMS // producers
+    sentinel = None
+
+    def produce():
+        if batch:
+            values = list(range(items_per_producer))
+            for i in range(0, items_per_producer, BATCH_SIZE):
+                obj.put_many(values[i:i + BATCH_SIZE])
+        else:
+            for i in range(items_per_producer):
+                obj.put(i)
+
+    def consume():
+        while True:
+            if batch:
+                items = obj.get_many(BATCH_SIZE)
+            else:
+                items = [obj.get()]
+            if sentinel in items:
+                # Pass on any other consumer's sentinels.
+                for _i in range(items.count(sentinel) - 1):
+                    obj.put(sentinel)
+                return
+
+    consumer_threads = [threading.Thread(target=consume) for _i in range(consumers)]
+    producer_threads = [threading.Thread(target=produce) for _i in range(producers)]
+    for thread in consumer_threads + producer_threads:
+        thread.start()
+    for thread in producer_threads:
+        thread.join()
+    for _i in range(consumers):
+        obj.put(sentinel)
+    for thread in consumer_threads:
+        thread.join()
+
+
+@pytest.mark.parametrize('queue_type', QUEUE_TYPES)
+@pytest.mark.parametrize('producers, consumers', ((1, 1), (4, 4)))
+def test_handoff(benchmark, queue_type, producers, consumers):
+    obj = QUEUE_TYPES[queue_type](MAXSIZE)
+    benchmark.group = f'queue_handoff_{producers}_{consumers}'
+    benchmark.pedantic(_handoff, args=(obj, producers, consumers, False), rounds=5, iterations=1)
+    assert obj.empty()
+
+
+@pytest.mark.parametrize('producers, consumers', ((1, 1), (4, 4)))
+def test_handoff_batch(benchmark, producers, consumers):
+    obj = cppqueue.cppQueue(MAXSIZE)
+    benchmark.group = f'queue_handoff_{producers}_{consumers}'
+    benchmark.pedantic(_handoff, args=(obj, producers, consumers, True), rounds=5, iterations=1)
+    assert obj.empty()
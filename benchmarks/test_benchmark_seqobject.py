@@ -0,0 +1,322 @@
+"""
+Benchmarks of the cSeqObject.SequenceLongObject reductions against pure Python and numpy.
+
+Run with:
+
+    pytest benchmarks --benchmark-sort=name
+
+numpy is optional, those benchmarks are skipped if it is not installed.
+"""
+import random
+
+import pytest
+
+from cPyExtPatt import cSeqObject
+
+SIZES = (1_000, 1_000_000)
+# SequenceLongObject_sq_ass_item() writes diagnostics to stdout so keep this small.
+SETITEM_SIZES = (1_000,)
+
+SIMD_LEVELS = [level for level in ('scalar', 'avx2') if level == 'scalar' or cSeqObject.simd_level() == level]
+
+
+def make_values(size, limit=2 ** 31):
+    rng = random.Random(1234)
+    return [rng.randint(-limit, limit) for _i in range(size)]
+
+
+@pytest.fixture(params=SIMD_LEVELS)
+def simd_level(request):
+    previous = cSeqObject.set_simd_level(request.param)
+    yield request.param
+    cSeqObject.set_simd_level(previous)
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_getitem_list(benchmark, size):
+    values = make_values(size)
+    benchmark.group = f'getitem_{size}'
+    result = benchmark(lambda: [values[i] for i in range(size)])
+    assert len(result) == size
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_getitem_sequence(benchmark, size):
+    obj = cSeqObject.SequenceLongObject(make_values(size))
+    benchmark.group = f'getitem_{size}'
+    result = benchmark(lambda: [obj[i] for i in range(size)])
+    assert len(result) == size
+
+
+@pytest.mark.parametrize('size', SETITEM_SIZES)
+def test_setitem_list(benchmark, size):
+    values = make_values(size)
+
+    def setitem():
+        for i in range(size):
+            values[i] = i
+
+    benchmark.group = f'setitem_{size}'
+    benchmark(setitem)
+    assert values[-1] == size - 1
+
+
+@pytest.mark.parametrize('size', SETITEM_SIZES)
+def test_setitem_sequence(benchmark, size):
+    obj = cSeqObject.SequenceLongObject(make_values(size))
+
+    def setitem():
+        for i in range(size):
+            obj[i] = i
+
+    benchmark.group = f'setitem_{size}'
+    benchmark(setitem)
+    assert obj[-1] == size - 1
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_sum_list(benchmark, size):
+    values = make_values(size)
+    benchmark.group = f'sum_{size}'
+    result = benchmark(sum, values)
+    assert result == sum(values)
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_sum_sequence_via_sq_item(benchmark, size):
+    """This is the baseline that the native methods replace, each value is boxed via sq_item."""
+    values = make_values(size)
+    obj = cSeqObject.SequenceLongObject(values)
+    benchmark.group = f'sum_{size}'
+    result = benchmark(sum, obj)
+    assert result == sum(values)
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_sum_sequence(benchmark, size, simd_level):
+    values = make_values(size)
+    obj = cSeqObject.SequenceLongObject(values)
+    benchmark.group = f'sum_{size}'
+    result = benchmark(obj.sum)
+    assert result == sum(values)
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_sum_numpy(benchmark, size):
+    np = pytest.importorskip('numpy')
+    values = make_values(size)
+    arr = np.array(values, dtype=np.int64)
+    benchmark.group = f'sum_{size}'
+    result = benchmark(arr.sum)
+    assert result == sum(values)
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_max_list(benchmark, size):
+    values = make_values(size)
+    benchmark.group = f'max_{size}'
+    result = benchmark(max, values)
+    assert result == max(values)
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_max_sequence(benchmark, size, simd_level):
+    values = make_values(size)
+    obj = cSeqObject.SequenceLongObject(values)
+    benchmark.group = f'max_{size}'
+    result = benchmark(obj.max)
+    assert result == max(values)
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_max_numpy(benchmark, size):
+    np = pytest.importorskip('numpy')
+    values = make_values(size)
+    arr = np.array(values, dtype=np.int64)
+    benchmark.group = f'max_{size}'
+    result = benchmark(arr.max)
+    assert result == max(values)
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_argmin_list(benchmark, size):
+    values = make_values(size)
+    benchmark.group = f'argmin_{size}'
+    result = benchmark(lambda: values.index(min(values)))
+    assert values[result] == min(values)
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_argmin_sequence(benchmark, size, simd_level):
+    values = make_values(size)
+    obj = cSeqObject.SequenceLongObject(values)
+    benchmark.group = f'argmin_{size}'
+    result = benchmark(obj.argmin)
+    assert values[result] == min(values)
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_argmin_numpy(benchmark, size):
+    np = pytest.importorskip('numpy')
+    values = make_values(size)
+    arr = np.array(values, dtype=np.int64)
+    benchmark.group = f'argmin_{size}'
+    result = benchmark(arr.argmin)
+    assert values[result] == min(values)
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_count_list(benchmark, size):
+    values = make_values(size)
+    benchmark.group = f'count_{size}'
+    result = benchmark(values.count, values[0])
+    assert result >= 1
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_count_sequence(benchmark, size, simd_level):
+    values = make_values(size)
+    obj = cSeqObject.SequenceLongObject(values)
+    benchmark.group = f'count_{size}'
+    result = benchmark(obj.count, values[0])
+    assert result == values.count(values[0])
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_dot_list(benchmark, size):
+    # Small enough that the dot product does not overflow a C long.
+    values = make_values(size, 2 ** 16)
+    benchmark.group = f'dot_{size}'
+    result = benchmark(lambda: sum(a * b for a, b in zip(values, values)))
+    assert result > 0
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_dot_sequence(benchmark, size):
+    # Small enough that the dot product does not overflow a C long.
+    values = make_values(size, 2 ** 16)
+    obj = cSeqObject.SequenceLongObject(values)
+    benchmark.group = f'dot_{size}'
+    result = benchmark(obj.dot, obj)
+    assert result == sum(a * b for a, b in zip(values, values))
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_dot_numpy(benchmark, size):
+    np = pytest.importorskip('numpy')
+    # Small enough that the dot product does not overflow a C long.
+    values = make_values(size, 2 ** 16)
+    arr = np.array(values, dtype=np.int64)
+    benchmark.group = f'dot_{size}'
+    result = benchmark(arr.dot, arr)
+    assert result == sum(a * b for a, b in zip(values, values))
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_slice_list(benchmark, size):
+    values = make_values(size)
+    benchmark.group = f'slice_{size}'
+    result = benchmark(lambda: values[1:-1])
+    assert len(result) == size - 2
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_slice_sequence_view(benchmark, size):
+    obj = cSeqObject.SequenceLongObject(make_values(size))
+    benchmark.group = f'slice_{size}'
+    result = benchmark(lambda: obj[1:-1])
+    assert len(result) == size - 2
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_slice_sequence_copy(benchmark, size):
+    obj = cSeqObject.SequenceLongObject(make_values(size))
+    benchmark.group = f'slice_{size}'
+    result = benchmark(lambda: obj[1:-1].copy())
+    assert len(result) == size - 2
+
+
+def _append_all(obj, count):
+    append = obj.append
+    for i in range(count):
+        append(i)
+    return obj
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_append_list(benchmark, size):
+    benchmark.group = f'append_{size}'
+    result = benchmark(lambda: _append_all([], size))
+    assert len(result) == size
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_append_sequence(benchmark, size):
+    benchmark.group = f'append_{size}'
+    result = benchmark(lambda: _append_all(cSeqObject.SequenceLongObject([]), size))
+    assert len(result) == size
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_contains_list(benchmark, size):
+    values = make_values(size)
+    benchmark.group = f'contains_{size}'
+    result = benchmark(lambda: 2 ** 40 in values)
+    assert not result
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_contains_sequence(benchmark, size, simd_level):
+    obj = cSeqObject.SequenceLongObject(make_values(size))
+    benchmark.group = f'contains_{size}'
+    result = benchmark(lambda: 2 ** 40 in obj)
+    assert not result
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_contains_sequence_sorted(benchmark, size):
+    obj = cSeqObject.SequenceLongObject(make_values(size))
+    obj.sort()
+    benchmark.group = f'contains_{size}'
+    result = benchmark(lambda: 2 ** 40 in obj)
+    assert not result
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_sort_list(benchmark, size):
+    values = make_values(size)
+    benchmark.group = f'sort_{size}'
+    result = benchmark(lambda: sorted(values))
+    assert len(result) == size
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_sort_sequence(benchmark, size):
+    values = make_values(size)
+    benchmark.group = f'sort_{size}'
+    # sort() is in-place so each round sorts a new, unsorted, object. This includes the cost of construction.
+    result = benchmark(lambda: cSeqObject.SequenceLongObject(values).sort())
+    assert result is None
+
+
+def _contains_many_set(values, needles):
+    lookup = set(values)
+    return [needle in lookup for needle in needles]
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_contains_many_set(benchmark, size):
+    values = make_values(size)
+    needles = make_values(1000, 2 ** 32)
+    benchmark.group = f'contains_many_{size}'
+    result = benchmark(_contains_many_set, values, needles)
+    assert len(result) == len(needles)
+
+
+@pytest.mark.parametrize('size', SIZES)
+def test_contains_many_sequence(benchmark, size):
+    obj = cSeqObject.SequenceLongObject(make_values(size))
+    needles = make_values(1000, 2 ** 32)
+    benchmark.group = f'contains_many_{size}'
+    result = benchmark(obj.contains_many, needles)
+    assert len(result) == len(needles)
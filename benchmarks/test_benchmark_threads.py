@@ -0,0 +1,169 @@
+"""
+Benchmarks of the thread safe list subclasses csublist.cSubList and cppsublist.cppSubList.
+
+Run with:
+
+    pytest benchmarks --benchmark-sort=name
+
+By default ``append()`` and ``max()`` do no simulated work so these measure the cost of the locking itself.
+The contended benchmarks measure the wall clock time for 1..N threads to use the same list with a cost model, see
+``src/cpy/Threads/cCostModel.h``, of no work, a short busy loop with the GIL released and a short sleep.
+The lock counters and the lock hold time histogram are saved in the ``extra_info`` of the results.
+"""
+import threading
+
+import pytest
+
+from cPyExtPatt.Threads import cppsublist
+from cPyExtPatt.Threads import csublist
+
+SUBLIST_TYPES = (csublist.cSubList, cppsublist.cppSubList)
+THREAD_COUNTS = (1, 2, 4, 8)
+APPENDS_PER_THREAD = 100
+ROUNDS = 3
+# {name: (cost_mode, cost in microseconds), ...}
+COST_MODELS = {
+    'no_work': ('sleep', 0),
+    'busy_20us': ('busy', 20),
+    'sleep_100us': ('sleep', 100),
+}
+
+
+def _set_cost_model(obj, cost_model, cost_attribute):
+    """Set the cost model and turn on the lock hold time histogram."""
+    obj.cost_mode, cost_us = COST_MODELS[cost_model]
+    setattr(obj, cost_attribute, cost_us)
+    obj.trace_lock_hold = True
+
+
+def _save_lock_counters(benchmark, obj):
+    for name in ('lock_shared_acquired', 'lock_shared_contended', 'lock_shared_wait_ns',
+                 'lock_exclusive_acquired', 'lock_exclusive_contended', 'lock_exclusive_wait_ns'):
+        benchmark.extra_info[name] = getattr(obj, name)
+    benchmark.extra_info['lock_hold_histogram'] = {str(k): v for k, v in obj.lock_hold_histogram().items()}
+
+
+def _run_in_threads(target, args, thread_count):
+    threads = [threading.Thread(target=target, args=args) for _i in range(thread_count)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+
+
+def _append(obj, count):
+    for _i in range(count):
+        obj.append(len(obj))
+
+
+@pytest.mark.parametrize('cls', SUBLIST_TYPES)
+def test_append(benchmark, cls):
+    obj = cls()
+    benchmark.group = 'sublist_append'
+    benchmark(obj.append, 42)
+
+
+@pytest.mark.parametrize('cls', SUBLIST_TYPES)
+@pytest.mark.parametrize('thread_count', THREAD_COUNTS)
+@pytest.mark.parametrize('cost_model', COST_MODELS)
+def test_append_contended(benchmark, cls, thread_count, cost_model):
+    obj = cls()
+    _set_cost_model(obj, cost_model, 'append_cost_us')
+    benchmark.group = f'sublist_append_contended_{cost_model}'
+    benchmark.pedantic(_run_in_threads, args=(_append, (obj, APPENDS_PER_THREAD), thread_count),
+                       rounds=ROUNDS, iterations=1)
+    _save_lock_counters(benchmark, obj)
+    assert len(obj) == ROUNDS * thread_count * APPENDS_PER_THREAD
+
+
+@pytest.mark.parametrize('cls', SUBLIST_TYPES)
+def test_max(benchmark, cls):
+    obj = cls(range(16))
+    benchmark.group = 'sublist_max'
+    result = benchmark(obj.max)
+    assert result == 15
+
+
+def _max(obj, count):
+    for _i in range(count):
+        obj.max()
+
+
+MAX_PER_THREAD = 20
+
+
+@pytest.mark.parametrize('cls', SUBLIST_TYPES)
+@pytest.mark.parametrize('thread_count', THREAD_COUNTS)
+@pytest.mark.parametrize('rwlock', (False, True))
+@pytest.mark.parametrize('cost_model', COST_MODELS)
+def test_max_contended(benchmark, cls, thread_count, rwlock, cost_model):
+    """With rwlock=True the readers hold a shared lock and run concurrently."""
+    obj = cls(range(16), rwlock=rwlock)
+    _set_cost_model(obj, cost_model, 'compare_cost_us')
+    benchmark.group = f'sublist_max_contended_{cost_model}'
+    benchmark.pedantic(_run_in_threads, args=(_max, (obj, MAX_PER_THREAD), thread_count),
+                       rounds=ROUNDS, iterations=1)
+    _save_lock_counters(benchmark, obj)
+    if rwlock:
+        assert obj.lock_shared_contended == 0
+
+
+PARALLEL_MAX_SIZE = 1_000_000
+
+
+@pytest.mark.parametrize('thread_count', (1, 2, 4))
+@pytest.mark.parametrize('value_type', (int, float))
+def test_max_parallel(benchmark, thread_count, value_type):
+    """cppSubList.max() of a long homogeneous list uses the native path with the GIL released."""
+    obj = cppsublist.cppSubList(value_type(v) for v in range(PARALLEL_MAX_SIZE))
+    previous = cppsublist.set_parallel_max_threads(thread_count)
+    try:
+        benchmark.group = f'sublist_max_parallel_{value_type.__name__}'
+        result = benchmark(obj.max)
+    finally:
+        cppsublist.set_parallel_max_threads(previous)
+    assert result == PARALLEL_MAX_SIZE - 1
+
+
+def test_max_parallel_builtin(benchmark):
+    """The builtin max() of a list of the same length for comparison."""
+    values = list(range(PARALLEL_MAX_SIZE))
+    benchmark.group = 'sublist_max_parallel_int'
+    result = benchmark(max, values)
+    assert result == PARALLEL_MAX_SIZE - 1
+
+
+GETITEM_PER_THREAD = 10_000
+# One append() for this many reads.
+READS_PER_APPEND = 64
+
+
+def _getitem(obj, count):
+    for i in range(count):
+        obj[i & 15]
+        if i % READS_PER_APPEND == 0:
+            obj.append(i)
+
+
+@pytest.mark.parametrize('max_spins', (0, 100))
+@pytest.mark.parametrize('thread_count', THREAD_COUNTS)
+def test_getitem_contended(benchmark, thread_count, max_spins):
+    """Short critical sections where spinning, rather than releasing the GIL, can win.
+    __getitem__ only takes the lock, a shared one, with rwlock=True and the occasional append() takes it exclusively.
+    With the GIL there is little contention, this is most useful on a free-threaded build.
+    The lock counters are saved in the extra_info of the results."""
+    obj = cppsublist.cppSubList(range(16), rwlock=True)
+    previous = cppsublist.set_lock_max_spins(max_spins)
+    try:
+        benchmark.group = f'sublist_getitem_contended_{thread_count}'
+        benchmark.pedantic(_run_in_threads, args=(_getitem, (obj, GETITEM_PER_THREAD), thread_count),
+                           rounds=ROUNDS, iterations=1)
+    finally:
+        cppsublist.set_lock_max_spins(previous)
+    for name in ('lock_shared_acquired', 'lock_shared_contended', 'lock_shared_wait_ns',
+                 'lock_exclusive_acquired', 'lock_exclusive_contended', 'lock_exclusive_wait_ns',
+                 'lock_spin_acquired'):
+        benchmark.extra_info[name] = getattr(obj, name)
+    assert obj.lock_shared_acquired == ROUNDS * thread_count * GETITEM_PER_THREAD
+    appends_per_thread = (GETITEM_PER_THREAD + READS_PER_APPEND - 1) // READS_PER_APPEND
+    assert obj.lock_exclusive_acquired == ROUNDS * thread_count * appends_per_thread
@@ -154,6 +154,7 @@ create_and_test_bdist_wheel() {
     pytest tests -x
     # Run all tests (slow).
 #    pytest tests --runslow --benchmark-sort=name
+#    pytest benchmarks --benchmark-sort=name
 #    pytest tests -v
     echo "---> Running setup for bdist_wheel:"
     # Need wheel otherwise bdist_wheel "error: invalid command 'bdist_wheel'"
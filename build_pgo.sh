@@ -0,0 +1,67 @@
+#!/bin/bash
+#
+# Builds the extensions with profile guided optimisation (PGO) and link time optimisation in the current environment.
+#
+# 1. Build with PYEXTPATT_BUILD_PROFILE=pgo-instrument.
+# 2. Train by running the benchmarks once each, this writes the profile to PYEXTPATT_PGO_DIR.
+# 3. With clang merge the raw profiles into default.profdata.
+# 4. Rebuild with PYEXTPATT_BUILD_PROFILE=pgo-use.
+# 5. Run the tests.
+#
+# The build directory must be the same for steps 1 and 4 as gcc matches profiles by object file path.
+
+set -o errexit  # abort on nonzero exitstatus
+set -o nounset  # abort on unbound variable
+set -o pipefail # don't hide errors within pipes
+
+PGO_DIRECTORY="${PYEXTPATT_PGO_DIR:-${PWD}/build/pgo}"
+export PYEXTPATT_PGO_DIR="${PGO_DIRECTORY}"
+
+usage()
+{
+    echo "usage: build_pgo.sh [-h, --help]"
+    echo "options:"
+    echo " -h, --help  Print help and exit."
+    echo "The profile is written to PYEXTPATT_PGO_DIR, currently: ${PGO_DIRECTORY}"
+}
+
+# If -h or --help print help.
+for arg in "$@"
+do
+    if [ "$arg" == "--help" ] || [ "$arg" == "-h" ]
+    then
+        usage
+        exit
+    fi
+done
+
+echo "---> Python version:"
+python -VV
+echo "---> Removing profile data in ${PGO_DIRECTORY}"
+rm -rf -- "${PGO_DIRECTORY}"
+mkdir -p "${PGO_DIRECTORY}"
+
+echo "---> Building instrumented extensions:"
+PYEXTPATT_BUILD_PROFILE=pgo-instrument python setup.py build_ext --inplace --force
+
+echo "---> Training with the benchmarks:"
+# --benchmark-disable runs each benchmark once, that is enough to reach the hot paths.
+pytest benchmarks --benchmark-disable -q
+
+CC_NAME="${CC:-$(python -c "import sysconfig; print(sysconfig.get_config_var('CC'))")}"
+if [[ "${CC_NAME}" == *clang* ]]; then
+    echo "---> Merging clang profiles:"
+    # On Mac OS X llvm-profdata is run with xcrun.
+    if command -v llvm-profdata &>/dev/null; then
+        LLVM_PROFDATA="llvm-profdata"
+    else
+        LLVM_PROFDATA="xcrun llvm-profdata"
+    fi
+    ${LLVM_PROFDATA} merge -output="${PGO_DIRECTORY}/default.profdata" "${PGO_DIRECTORY}"/*.profraw
+fi
+
+echo "---> Building optimised extensions:"
+PYEXTPATT_BUILD_PROFILE=pgo-use python setup.py build_ext --inplace --force
+
+echo "---> Running tests:"
+pytest tests -x
@@ -25,7 +25,30 @@ long_description = (
 
 licence = (here / 'LICENSE.txt').read_text(encoding='utf-8')
 
-DEBUG = True
+# The build profile is selected with the environment variable PYEXTPATT_BUILD_PROFILE, one of:
+#
+# - "debug" (the default) -O0 -g3 with asserts enabled.
+# - "release" -O3 with NDEBUG.
+# - "release-lto" As "release" with link time optimisation.
+# - "pgo-instrument" As "release-lto" and instrumented to write a profile into PYEXTPATT_PGO_DIR when run.
+# - "pgo-use" As "release-lto" and optimised with the profile in PYEXTPATT_PGO_DIR.
+#
+# For example:
+#   PYEXTPATT_BUILD_PROFILE=release python setup.py develop
+#
+# The profile guided optimisation (PGO) steps are run, in order, by build_pgo.sh
+BUILD_PROFILES = ('debug', 'release', 'release-lto', 'pgo-instrument', 'pgo-use')
+BUILD_PROFILE = os.environ.get('PYEXTPATT_BUILD_PROFILE', 'debug')
+if BUILD_PROFILE not in BUILD_PROFILES:
+    raise ValueError(
+        f'PYEXTPATT_BUILD_PROFILE must be one of {", ".join(BUILD_PROFILES)} not "{BUILD_PROFILE}"'
+    )
+# Profile data is written to, and read from, here. This must be an absolute path.
+PGO_DIRECTORY = os.path.abspath(os.environ.get('PYEXTPATT_PGO_DIR', os.path.join('build', 'pgo')))
+# The PGO flags and warnings differ between clang and gcc.
+COMPILER_IS_CLANG = 'clang' in os.environ.get('CC', sysconfig.get_config_var('CC') or '')
+
+DEBUG = BUILD_PROFILE == 'debug'
 # Generally I write code so that if DEBUG is defined as 0 then all optimisations
 # are off and asserts are enabled. Typically run times of these builds are x2 to x10
 # release builds.
@@ -55,6 +78,25 @@ if DEBUG:
 else:
     extra_compile_args_cpp += ["-DNDEBUG", "-O3"]
 
+# Flags for the build profile that are added to every extension, both compile and link.
+extra_compile_args_profile = []
+extra_link_args_profile = []
+if BUILD_PROFILE in ('release-lto', 'pgo-instrument', 'pgo-use'):
+    extra_compile_args_profile += ["-flto"]
+    extra_link_args_profile += ["-flto"]
+if BUILD_PROFILE == 'pgo-instrument':
+    extra_compile_args_profile += ["-fprofile-generate=%s" % PGO_DIRECTORY]
+    extra_link_args_profile += ["-fprofile-generate=%s" % PGO_DIRECTORY]
+elif BUILD_PROFILE == 'pgo-use':
+    extra_compile_args_profile += ["-fprofile-use=%s" % PGO_DIRECTORY]
+    extra_link_args_profile += ["-fprofile-use=%s" % PGO_DIRECTORY]
+    # Code that the training run never reached, and files without a profile, are not worth a warning.
+    if COMPILER_IS_CLANG:
+        extra_compile_args_profile += ["-Wno-profile-instr-unprofiled", "-Wno-profile-instr-out-of-date"]
+    else:
+        # Counters are updated without locks by the threaded benchmarks.
+        extra_compile_args_profile += ["-fprofile-correction", "-Wno-missing-profile"]
+
 PYTHON_INCLUDE_DIRECTORIES = [
     sysconfig.get_paths()['include'],
 ]
@@ -98,14 +140,21 @@ ext_modules = [
               extra_compile_args=extra_compile_args_c,
               language='c',
               ),
-    Extension(f"{PACKAGE_NAME}.cSeqObject", sources=['src/cpy/Object/cSeqObject.c', ],
-              include_dirs=['/usr/local/include', ],
+    Extension(f"{PACKAGE_NAME}.cSeqObject",
+              sources=[
+                  'src/cpy/Object/cSeqObject.c',
+                  'src/cpy/Object/LongArrayKernels.c',
+                  'src/cpy/Util/py_long_array.c',
+                  'src/cpy/Util/py_fastcall_args.c',
+              ],
+              include_dirs=['/usr/local/include', 'src/cpy/Util', ],
               library_dirs=[os.getcwd(), ],  # path to .a or .so file(s)
               extra_compile_args=extra_compile_args_c,
               language='c',
               ),
-    Extension(f"{PACKAGE_NAME}.cParseArgs", sources=['src/cpy/ParseArgs/cParseArgs.c', ],
-              include_dirs=['/usr/local/include', ],  # os.path.join(os.getcwd(), 'include'),],
+    Extension(f"{PACKAGE_NAME}.cParseArgs",
+              sources=['src/cpy/ParseArgs/cParseArgs.c', 'src/cpy/Util/py_fastcall_args.c', ],
+              include_dirs=['/usr/local/include', 'src/cpy/Util', ],  # os.path.join(os.getcwd(), 'include'),],
               library_dirs=[os.getcwd(), ],  # path to .a or .so file(s)
               extra_compile_args=extra_compile_args_c,
               language='c',
@@ -133,8 +182,10 @@ ext_modules = [
     Extension(f"{PACKAGE_NAME}.cFile", sources=[
         'src/cpy/File/cFile.cpp',
         'src/cpy/File/PythonFileWrapper.cpp',
+        'src/cpy/File/PythonFileStreamBuf.cpp',
+        'src/cpy/Util/py_fastcall_args.c',
     ],
-              include_dirs=['/usr/local/include', 'src/cpy/File', ],  # os.path.join(os.getcwd(), 'include'),],
+              include_dirs=['/usr/local/include', 'src/cpy/File', 'src/cpy/Util', ],  # os.path.join(os.getcwd(), 'include'),],
               library_dirs=[os.getcwd(), ],  # path to .a or .so file(s)
               extra_compile_args=extra_compile_args_cpp,
               language='c++11',
@@ -186,9 +237,20 @@ ext_modules = [
               language='c++11',
               # undef_macros=undef_macros,
               ),
+    Extension(f"{PACKAGE_NAME}.cpp.cTypedSequence",
+              sources=['src/cpy/cpp/cTypedSequence.cpp', ],
+              include_dirs=['/usr/local/include', ],
+              library_dirs=[os.getcwd(), ],
+              extra_compile_args=extra_compile_args_cpp,
+              language='c++11',
+              ),
     Extension(f"{PACKAGE_NAME}.SimpleExample.cFibA",
-              sources=['src/cpy/SimpleExample/cFibA.c', ],
-              include_dirs=[],
+              sources=[
+                  'src/cpy/SimpleExample/cFibA.c',
+                  'src/cpy/SimpleExample/cFibFast.c',
+                  'src/cpy/Util/py_fastcall_args.c',
+              ],
+              include_dirs=['src/cpy/Util', ],
               library_dirs=[],
               libraries=[],
               # For best performance.
@@ -201,7 +263,7 @@ ext_modules = [
               language='c',
               ),
     Extension(f"{PACKAGE_NAME}.SimpleExample.cFibB",
-              sources=['src/cpy/SimpleExample/cFibB.c', ],
+              sources=['src/cpy/SimpleExample/cFibB.c', 'src/cpy/SimpleExample/cFibFast.c', ],
               include_dirs=[],
               library_dirs=[],
               libraries=[],
@@ -221,8 +283,14 @@ ext_modules = [
     #           language='c++11',
     #           ),
     Extension(name=f"{PACKAGE_NAME}.Iterators.cIterator",
-              include_dirs=[],
-              sources=["src/cpy/Iterators/cIterator.c", ],
+              include_dirs=[
+                  'src/cpy/Util',
+              ],
+              sources=[
+                  "src/cpy/Iterators/cIterator.c",
+                  'src/cpy/Util/py_long_array.c',
+                  'src/cpy/Util/py_fastcall_args.c',
+              ],
               extra_compile_args=extra_compile_args_c,
               language='c',
               ),
@@ -264,9 +332,22 @@ ext_modules = [
               extra_compile_args=extra_compile_args_cpp,
               language='c++11',
               ),
+    Extension(name=f"{PACKAGE_NAME}.Threads.cppqueue",
+              include_dirs=[
+                  '/usr/local/include',
+                  'src/cpy/Util',
+                  "src/cpy/Threads",
+              ],
+              sources=[
+                  "src/cpy/Threads/cppqueue.cpp",
+                  'src/cpy/Util/py_fastcall_args.c',
+              ],
+              extra_compile_args=extra_compile_args_cpp,
+              language='c++11',
+              ),
     Extension(name=f"{PACKAGE_NAME}.Logging.cLogging",
-              include_dirs=[],
-              sources=["src/cpy/Logging/cLogging.c", ],
+              include_dirs=['src/cpy/Util', ],
+              sources=["src/cpy/Logging/cLogging.c", 'src/cpy/Util/py_fastcall_args.c', ],
               extra_compile_args=extra_compile_args_c,
               language='c',
               ),
@@ -305,6 +386,7 @@ if sys.version_info.major >= 3 and sys.version_info.minor >= 12:
                   include_dirs=[
                       'src/cpy',
                       'src/cpy/Watchers',
+                      'src/cpy/Util',
                   ],
                   sources=[
                       "src/cpy/Watchers/DictWatcher.c",
@@ -316,6 +398,11 @@ if sys.version_info.major >= 3 and sys.version_info.minor >= 12:
                   ),
     )
 
+# Add the build profile flags to every extension, including those with their own flags.
+for extension in ext_modules:
+    extension.extra_compile_args = extension.extra_compile_args + extra_compile_args_profile
+    extension.extra_link_args = extension.extra_link_args + extra_link_args_profile
+
 # For keywords see: https://setuptools.pypa.io/en/latest/references/keywords.html
 setup(
     name=PACKAGE_NAME,
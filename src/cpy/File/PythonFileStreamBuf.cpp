@@ -0,0 +1,227 @@
+//
+// PythonFileStreamBuf.cpp
+// A std::streambuf that reads from and writes to a Python file.
+//
+
+#include "PythonFileStreamBuf.h"
+
+#include <algorithm>
+#include <cstring>
+
+PythonFileStreamBuf::PythonFileStreamBuf(PyObject *python_file_object, size_t buffer_size)
+        : m_file(python_file_object), m_buffer_size(buffer_size) {
+    if (buffer_size == 0) {
+        throw ExceptionPythonFileObjectWrapper("PythonFileStreamBuf: the buffer size must be > 0.");
+    }
+    /* The buffers are allocated on first use so a stream that only reads does not have a put buffer. */
+    setg(nullptr, nullptr, nullptr);
+    setp(nullptr, nullptr);
+}
+
+PythonFileStreamBuf::~PythonFileStreamBuf() {
+    if (m_has_error) {
+        return;
+    }
+    /* Keep any exception that is already set. */
+    PyObject *type, *value, *traceback;
+    PyErr_Fetch(&type, &value, &traceback);
+    if (flush_put_area()) {
+        PyErr_WriteUnraisable(NULL);
+    }
+    /* Giving back the read ahead data is only possible if the file can seek relative to the current position. */
+    if (discard_get_area()) {
+        PyErr_Clear();
+    }
+    PyErr_Restore(type, value, traceback);
+}
+
+int PythonFileStreamBuf::flush_put_area() {
+    Py_ssize_t count = pptr() - pbase();
+    setp(nullptr, nullptr);
+    if (count > 0) {
+        if (m_has_error) {
+            return -1;
+        }
+        ++m_write_calls;
+        if (m_file.write(m_put_buffer.data(), count)) {
+            if (!PyErr_Occurred()) {
+                PyErr_Format(PyExc_IOError, "Wrote fewer than %zd bytes to the Python file.", count);
+            }
+            m_has_error = true;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int PythonFileStreamBuf::discard_get_area() {
+    Py_ssize_t unread = egptr() - gptr();
+    setg(nullptr, nullptr, nullptr);
+    if (unread > 0) {
+        if (m_has_error) {
+            return -1;
+        }
+        m_file.seek(-unread, 1);
+        if (PyErr_Occurred()) {
+            m_has_error = true;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+PythonFileStreamBuf::int_type PythonFileStreamBuf::underflow() {
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+    if (m_has_error || flush_put_area()) {
+        return traits_type::eof();
+    }
+    ++m_read_calls;
+    int result = m_file.read((Py_ssize_t) m_buffer_size, m_get_buffer);
+    if (result == -3) {
+        PyErr_SetString(PyExc_TypeError, "read() must return bytes or str.");
+    }
+    if (result != 0 && result != -2) {
+        assert(PyErr_Occurred());
+        m_has_error = true;
+    }
+    if (m_has_error || m_get_buffer.empty()) {
+        setg(nullptr, nullptr, nullptr);
+        return traits_type::eof();
+    }
+    char *begin = m_get_buffer.data();
+    setg(begin, begin, begin + m_get_buffer.size());
+    return traits_type::to_int_type(*gptr());
+}
+
+PythonFileStreamBuf::int_type PythonFileStreamBuf::overflow(int_type ch) {
+    if (m_has_error) {
+        return traits_type::eof();
+    }
+    if (pbase()) {
+        if (flush_put_area()) {
+            return traits_type::eof();
+        }
+    } else if (discard_get_area()) {
+        /* Switching from reading to writing, the Python file must be at the stream position. */
+        return traits_type::eof();
+    }
+    m_put_buffer.resize(m_buffer_size);
+    setp(m_put_buffer.data(), m_put_buffer.data() + m_put_buffer.size());
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+int PythonFileStreamBuf::sync() {
+    if (m_has_error || flush_put_area() || discard_get_area()) {
+        return -1;
+    }
+    return 0;
+}
+
+std::streamsize PythonFileStreamBuf::xsgetn(char_type *s, std::streamsize count) {
+    std::streamsize done = 0;
+    while (done < count) {
+        std::streamsize available = egptr() - gptr();
+        if (available > 0) {
+            std::streamsize size = std::min(available, count - done);
+            memcpy(s + done, gptr(), (size_t) size);
+            gbump((int) size);
+            done += size;
+            continue;
+        }
+        if (m_has_error) {
+            break;
+        }
+        if (count - done >= (std::streamsize) m_buffer_size && (m_file.uses_readinto() || m_file.uses_fd())) {
+            /* A large read goes directly into the caller's memory. */
+            if (flush_put_area()) {
+                break;
+            }
+            ++m_read_calls;
+            Py_ssize_t size = m_file.readinto(s + done, (Py_ssize_t) (count - done));
+            if (size < 0) {
+                m_has_error = true;
+                break;
+            }
+            /* This is only short at EOF. */
+            done += size;
+            break;
+        }
+        if (traits_type::eq_int_type(underflow(), traits_type::eof())) {
+            break;
+        }
+    }
+    return done;
+}
+
+std::streamsize PythonFileStreamBuf::xsputn(const char_type *s, std::streamsize count) {
+    if (m_has_error) {
+        return 0;
+    }
+    if (count >= (std::streamsize) m_buffer_size) {
+        /* A large write goes directly from the caller's memory, after anything already buffered. */
+        if (pbase() ? flush_put_area() : discard_get_area()) {
+            return 0;
+        }
+        ++m_write_calls;
+        if (m_file.write(s, (Py_ssize_t) count)) {
+            if (!PyErr_Occurred()) {
+                PyErr_Format(PyExc_IOError, "Wrote fewer than %zd bytes to the Python file.", (Py_ssize_t) count);
+            }
+            m_has_error = true;
+            return 0;
+        }
+        return count;
+    }
+    std::streamsize done = 0;
+    while (done < count) {
+        std::streamsize available = epptr() - pptr();
+        if (available == 0) {
+            if (traits_type::eq_int_type(overflow(traits_type::eof()), traits_type::eof())) {
+                break;
+            }
+            continue;
+        }
+        std::streamsize size = std::min(available, count - done);
+        memcpy(pptr(), s + done, (size_t) size);
+        pbump((int) size);
+        done += size;
+    }
+    return done;
+}
+
+PythonFileStreamBuf::pos_type
+PythonFileStreamBuf::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) {
+    (void) which;
+    if (m_has_error) {
+        return pos_type(off_type(-1));
+    }
+    if (dir == std::ios_base::cur && off == 0) {
+        /* tellg() or tellp(), this does not disturb the buffers. */
+        long position = m_file.tell();
+        if (PyErr_Occurred()) {
+            m_has_error = true;
+            return pos_type(off_type(-1));
+        }
+        return pos_type(off_type(position - (egptr() - gptr()) + (pptr() - pbase())));
+    }
+    if (sync()) {
+        return pos_type(off_type(-1));
+    }
+    int whence = dir == std::ios_base::beg ? 0 : (dir == std::ios_base::cur ? 1 : 2);
+    long position = m_file.seek((Py_ssize_t) off, whence);
+    if (PyErr_Occurred()) {
+        m_has_error = true;
+        return pos_type(off_type(-1));
+    }
+    return pos_type(off_type(position));
+}
+
+PythonFileStreamBuf::pos_type PythonFileStreamBuf::seekpos(pos_type pos, std::ios_base::openmode which) {
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+}
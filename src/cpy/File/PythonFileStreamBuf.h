@@ -0,0 +1,74 @@
+//
+// PythonFileStreamBuf.h
+// A std::streambuf that reads from and writes to a Python file so that C++ can use std::istream and std::ostream.
+//
+
+#ifndef PYTHONEXTENSIONSBASIC_PYTHONFILESTREAMBUF_H
+#define PYTHONEXTENSIONSBASIC_PYTHONFILESTREAMBUF_H
+
+#include "PythonFileWrapper.h"
+
+#include <streambuf>
+#include <vector>
+
+/// A buffered std::streambuf over a Python file, for example:
+///
+///     PythonFileStreamBuf stream_buf(py_file_object, 1024 * 1024);
+///     std::istream is(&stream_buf);
+///     long value;
+///     while (is >> value) { ... }
+///
+/// The Python file's read() or readinto() is called once for each fill of the buffer and write() once for each time
+/// the buffer is full or flushed. Reads or writes at least as large as the buffer go directly to or from the Python
+/// file.
+///
+/// The GIL must be held whilst this is used. If a Python call fails then the stream sees EOF, or a failed write,
+/// the Python exception is left set and has_error() is true. No more Python calls are made after that.
+///
+/// sync(), which std::ostream::flush() calls, writes any buffered data and seeks the Python file back over any read
+/// ahead data that has not been consumed so that the Python file position matches the stream position.
+/// The destructor does the same but can only report a failed write as unraisable, so flush the stream first.
+/// Positions, from tellg() etc., are only meaningful for binary files.
+class PythonFileStreamBuf : public std::streambuf {
+public:
+    static const size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+    /// Throws an ExceptionPythonFileObjectWrapper if python_file_object does not look like a file or buffer_size is 0.
+    explicit PythonFileStreamBuf(PyObject *python_file_object, size_t buffer_size = DEFAULT_BUFFER_SIZE);
+
+    /// True if a Python call has failed, the Python exception is set.
+    bool has_error() const { return m_has_error; }
+
+    size_t buffer_size() const { return m_buffer_size; }
+
+    /// The number of calls to the Python file to read and to write.
+    Py_ssize_t read_calls() const { return m_read_calls; }
+    Py_ssize_t write_calls() const { return m_write_calls; }
+
+    ~PythonFileStreamBuf() override;
+
+protected:
+    int_type underflow() override;
+    int_type overflow(int_type ch) override;
+    int sync() override;
+    std::streamsize xsgetn(char_type *s, std::streamsize count) override;
+    std::streamsize xsputn(const char_type *s, std::streamsize count) override;
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+
+private:
+    /// Write the put area to the Python file, returns non-zero on failure.
+    int flush_put_area();
+    /// Seek the Python file back over the unread get area and empty it, returns non-zero on failure.
+    int discard_get_area();
+
+    PythonFileObjectWrapper m_file;
+    size_t m_buffer_size;
+    std::vector<char> m_get_buffer;
+    std::vector<char> m_put_buffer;
+    bool m_has_error = false;
+    Py_ssize_t m_read_calls = 0;
+    Py_ssize_t m_write_calls = 0;
+};
+
+#endif //PYTHONEXTENSIONSBASIC_PYTHONFILESTREAMBUF_H
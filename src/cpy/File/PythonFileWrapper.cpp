@@ -4,7 +4,44 @@
 
 #include "PythonFileWrapper.h"
 
+#include <algorithm>
+#include <cstring>
+#include <new>
 #include <sstream>
+#include <stdexcept>
+
+#if PYTHON_FILE_WRAPPER_HAS_PREAD
+#include <cerrno>
+#include <climits>
+#include <unistd.h>
+#ifdef HAVE_PREADV
+#include <sys/uio.h>
+#endif
+#endif
+
+#ifndef IOV_MAX
+#define IOV_MAX 16
+#endif
+
+/* The most that a single read(2), pread(2) or pwrite(2) is asked for, Linux does not transfer more than this. */
+static const Py_ssize_t FD_IO_MAX = 0x7ffff000;
+
+/**
+ * Call a cached bound method with vectorcall, the arguments are on the stack so there is no argument tuple.
+ * PY_VECTORCALL_ARGUMENTS_OFFSET allows a bound method to use args[-1] for self rather than copying the arguments.
+ * These return a new reference or NULL with an exception set.
+ */
+static inline PyObject *
+vectorcall_one(PyObject *callable, PyObject *arg) {
+    PyObject *args[2] = {NULL, arg};
+    return PyObject_Vectorcall(callable, args + 1, 1 | PY_VECTORCALL_ARGUMENTS_OFFSET, NULL);
+}
+
+static inline PyObject *
+vectorcall_two(PyObject *callable, PyObject *arg_0, PyObject *arg_1) {
+    PyObject *args[3] = {NULL, arg_0, arg_1};
+    return PyObject_Vectorcall(callable, args + 1, 2 | PY_VECTORCALL_ARGUMENTS_OFFSET, NULL);
+}
 
 /**
  * Macro that gets the given method and checks that it is callable.
@@ -38,7 +75,8 @@ PythonFileObjectWrapper::PythonFileObjectWrapper(PyObject *python_file_object) :
                                                                                  m_python_read_method(NULL),
                                                                                  m_python_write_method(NULL),
                                                                                  m_python_seek_method(NULL),
-                                                                                 m_python_tell_method(NULL) {
+                                                                                 m_python_tell_method(NULL),
+                                                                                 m_python_readinto_method(NULL) {
     assert(python_file_object);
     Py_INCREF(m_python_file_object);
     /* Get the read and write methods of the passed object */
@@ -46,6 +84,252 @@ PythonFileObjectWrapper::PythonFileObjectWrapper(PyObject *python_file_object) :
     EXTRACT_METHOD_AND_CHECK(write);
     EXTRACT_METHOD_AND_CHECK(seek);
     EXTRACT_METHOD_AND_CHECK(tell);
+    /* readinto() is optional, text files do not have it. */
+    m_python_readinto_method = PyObject_GetAttrString(python_file_object, "readinto"); /* New ref. */
+    if (!m_python_readinto_method) {
+        PyErr_Clear();
+    } else if (!PyCallable_Check(m_python_readinto_method)) {
+        Py_CLEAR(m_python_readinto_method);
+    }
+#if PYTHON_FILE_WRAPPER_HAS_PREAD
+    /* fileno() is optional, io.BytesIO has one that raises. */
+    if (PyObject_AsFileDescriptor(python_file_object) >= 0) {
+        m_has_fd = true;
+        /* Exactly a FileIO, a subclass might override read(). */
+        m_fd_is_raw = strcmp(Py_TYPE(python_file_object)->tp_name, "_io.FileIO") == 0;
+    } else {
+        PyErr_Clear();
+    }
+#endif
+}
+
+/**
+ * If anything other than the caller has a reference to the memoryview then release it so that it can no longer access
+ * the C++ buffer. This preserves any current exception.
+ * Returns non-zero with an exception set if the memoryview can not be released.
+ */
+static int
+release_memoryview(PyObject *memory_view) {
+    if (Py_REFCNT(memory_view) == 1) {
+        return 0;
+    }
+    PyObject *type, *value, *traceback;
+    PyErr_Fetch(&type, &value, &traceback);
+    PyObject *result = PyObject_CallMethod(memory_view, "release", NULL);
+    if (!result) {
+        /* Probably a BufferError as the memoryview has been exported. */
+        Py_XDECREF(type);
+        Py_XDECREF(value);
+        Py_XDECREF(traceback);
+        return -1;
+    }
+    Py_DECREF(result);
+    PyErr_Restore(type, value, traceback);
+    return 0;
+}
+
+PyObject *PythonFileObjectWrapper::py_size(Py_ssize_t value) {
+    for (int i = 0; i < SIZE_CACHE_LENGTH; ++i) {
+        if (m_size_cache[i] && m_size_cache_values[i] == value) {
+            Py_INCREF(m_size_cache[i]);
+            return m_size_cache[i];
+        }
+    }
+    PyObject *ret = PyLong_FromSsize_t(value);
+    if (ret) {
+        /* Replace the oldest entry. */
+        Py_XDECREF(m_size_cache[m_size_cache_next]);
+        Py_INCREF(ret);
+        m_size_cache[m_size_cache_next] = ret;
+        m_size_cache_values[m_size_cache_next] = value;
+        m_size_cache_next = (m_size_cache_next + 1) % SIZE_CACHE_LENGTH;
+    }
+    return ret;
+}
+
+Py_ssize_t PythonFileObjectWrapper::readinto_with_memoryview(char *buffer, Py_ssize_t number_of_bytes) {
+    assert(!PyErr_Occurred());
+    assert(m_python_readinto_method);
+    Py_ssize_t ret = 0;
+    PyObject *memory_view = NULL;
+    PyObject *read_result = NULL;
+
+    /* readinto() can read fewer bytes than asked for, a raw file does, so repeat until EOF or the buffer is full. */
+    while (ret < number_of_bytes) {
+        memory_view = PyMemoryView_FromMemory(buffer + ret, number_of_bytes - ret, PyBUF_WRITE);
+        if (!memory_view) {
+            goto except;
+        }
+        read_result = vectorcall_one(m_python_readinto_method, memory_view);
+        if (release_memoryview(memory_view)) {
+            goto except;
+        }
+        Py_CLEAR(memory_view);
+        if (!read_result) {
+            goto except;
+        }
+        if (read_result == Py_None) {
+            /* A non-blocking file with no data available. */
+            break;
+        }
+        Py_ssize_t count = PyLong_AsSsize_t(read_result);
+        if (count == -1 && PyErr_Occurred()) {
+            goto except;
+        }
+        if (count < 0 || count > number_of_bytes - ret) {
+            PyErr_Format(PyExc_ValueError, "readinto() returned %zd, expected 0 to %zd.", count, number_of_bytes - ret);
+            goto except;
+        }
+        Py_CLEAR(read_result);
+        if (count == 0) {
+            /* EOF */
+            break;
+        }
+        ret += count;
+    }
+    assert(!PyErr_Occurred());
+    goto finally;
+except:
+    assert(PyErr_Occurred());
+    ret = -1;
+finally:
+    Py_XDECREF(memory_view);
+    Py_XDECREF(read_result);
+    return ret;
+}
+
+Py_ssize_t PythonFileObjectWrapper::readinto_with_read(char *buffer, Py_ssize_t number_of_bytes) {
+    assert(!PyErr_Occurred());
+    assert(m_python_read_method);
+    Py_ssize_t ret = 0;
+    PyObject *read_size = NULL;
+    PyObject *read_value = NULL;
+    Py_buffer view;
+
+    while (ret < number_of_bytes) {
+        read_size = py_size(number_of_bytes - ret);
+        if (!read_size) {
+            goto except;
+        }
+        read_value = vectorcall_one(m_python_read_method, read_size);
+        Py_CLEAR(read_size);
+        if (!read_value) {
+            goto except;
+        }
+        if (read_value == Py_None) {
+            /* A non-blocking file with no data available. */
+            break;
+        }
+        if (PyUnicode_Check(read_value)) {
+            PyErr_SetString(PyExc_TypeError, "Reading into a buffer needs a file opened in binary mode.");
+            goto except;
+        }
+        if (PyObject_GetBuffer(read_value, &view, PyBUF_SIMPLE)) {
+            goto except;
+        }
+        Py_ssize_t count = view.len;
+        if (count > number_of_bytes - ret) {
+            PyBuffer_Release(&view);
+            PyErr_Format(PyExc_ValueError, "read() returned %zd bytes, expected 0 to %zd.", count, number_of_bytes - ret);
+            goto except;
+        }
+        memcpy(buffer + ret, view.buf, count);
+        PyBuffer_Release(&view);
+        Py_CLEAR(read_value);
+        if (count == 0) {
+            /* EOF */
+            break;
+        }
+        ret += count;
+    }
+    assert(!PyErr_Occurred());
+    goto finally;
+except:
+    assert(PyErr_Occurred());
+    ret = -1;
+finally:
+    Py_XDECREF(read_value);
+    return ret;
+}
+
+int PythonFileObjectWrapper::file_descriptor() {
+    /* This calls fileno() every time rather than keeping the file descriptor as the file might have been closed and
+     * the file descriptor reused. */
+    return PyObject_AsFileDescriptor(m_python_file_object);
+}
+
+#if PYTHON_FILE_WRAPPER_HAS_PREAD
+/**
+ * Repeat a read(2), pread(2) or pwrite(2) like system call with the GIL released until number_of_bytes have been
+ * transferred or it returns 0.
+ * io_call(offset_from_start, size) returns the result of the system call.
+ * Returns the number of bytes transferred or -1 with a Python exception set.
+ */
+template<typename IOCall>
+static Py_ssize_t
+fd_io_loop(Py_ssize_t number_of_bytes, IOCall io_call) {
+    Py_ssize_t ret = 0;
+    while (ret < number_of_bytes) {
+        ssize_t count;
+        int error_number;
+        Py_BEGIN_ALLOW_THREADS
+            count = io_call(ret, std::min(number_of_bytes - ret, FD_IO_MAX));
+            error_number = errno;
+        Py_END_ALLOW_THREADS
+        if (count < 0) {
+            if (error_number == EINTR) {
+                if (PyErr_CheckSignals()) {
+                    return -1;
+                }
+                continue;
+            }
+            if (error_number == EAGAIN || error_number == EWOULDBLOCK) {
+                /* A non-blocking file with no data available, as readinto() returning None. */
+                break;
+            }
+            errno = error_number;
+            PyErr_SetFromErrno(PyExc_OSError);
+            return -1;
+        }
+        if (count == 0) {
+            /* EOF */
+            break;
+        }
+        ret += count;
+    }
+    return ret;
+}
+#endif
+
+Py_ssize_t PythonFileObjectWrapper::readinto_with_fd(char *buffer, Py_ssize_t number_of_bytes) {
+    assert(!PyErr_Occurred());
+#if PYTHON_FILE_WRAPPER_HAS_PREAD
+    int fd = file_descriptor();
+    if (fd < 0) {
+        return -1;
+    }
+    return fd_io_loop(number_of_bytes, [fd, buffer](Py_ssize_t done, Py_ssize_t size) {
+        return ::read(fd, buffer + done, size);
+    });
+#else
+    (void) buffer;
+    (void) number_of_bytes;
+    PyErr_SetString(PyExc_OSError, "Reading from a file descriptor is not supported on this platform.");
+    return -1;
+#endif
+}
+
+Py_ssize_t PythonFileObjectWrapper::readinto(char *buffer, Py_ssize_t number_of_bytes) {
+    assert(!PyErr_Occurred());
+    assert(buffer || number_of_bytes == 0);
+    assert(number_of_bytes >= 0);
+    if (uses_fd()) {
+        return readinto_with_fd(buffer, number_of_bytes);
+    }
+    if (uses_readinto()) {
+        return readinto_with_memoryview(buffer, number_of_bytes);
+    }
+    return readinto_with_read(buffer, number_of_bytes);
 }
 
 int PythonFileObjectWrapper::read_py_write_cpp(Py_ssize_t number_of_bytes, std::iostream &ios) {
@@ -57,17 +341,32 @@ int PythonFileObjectWrapper::read_py_write_cpp(Py_ssize_t number_of_bytes, std::
 #if DEBUG_PYEXT_COMMON
     fprintf(stdout, "%s(): %s#%d number_of_bytes=%ld\n", __FUNCTION__, __FILE__, __LINE__, number_of_bytes);
 #endif
-    PyObject * read_args = Py_BuildValue("(i)", number_of_bytes);
-    PyObject * read_value = PyObject_Call(m_python_read_method, read_args, NULL);
+    if (number_of_bytes >= 0 && (uses_fd() || uses_readinto())) {
+        /* Read directly into the reusable buffer. */
+        if ((Py_ssize_t) m_read_buffer.size() < number_of_bytes) {
+            try {
+                m_read_buffer.resize(number_of_bytes);
+            } catch (const std::bad_alloc &) {
+                PyErr_NoMemory();
+                return -1;
+            } catch (const std::length_error &) {
+                PyErr_NoMemory();
+                return -1;
+            }
+        }
+        Py_ssize_t count = readinto(m_read_buffer.data(), number_of_bytes);
+        if (count < 0) {
+            return -1;
+        }
+        ios.write(m_read_buffer.data(), count);
+        return count == number_of_bytes ? 0 : -2;
+    }
+    PyObject * read_size = py_size(number_of_bytes);
+    PyObject * read_value = read_size ? vectorcall_one(m_python_read_method, read_size) : NULL;
     if (read_value == NULL) {
         ret = -1;
         goto except;
     } else {
-        /* Check for EOF */
-        if (number_of_bytes >= 0 && PySequence_Length(read_value) != number_of_bytes) {
-            ret = -2; /* Signal EOF. */
-            goto except;
-        }
         if (PyBytes_Check(read_value)) {
             ios.write(PyBytes_AsString(read_value), PyBytes_Size(read_value));
         } else if (PyUnicode_Check(read_value)) {
@@ -78,6 +377,11 @@ int PythonFileObjectWrapper::read_py_write_cpp(Py_ssize_t number_of_bytes, std::
             ret = -3;
             goto except;
         }
+        /* Check for EOF */
+        if (number_of_bytes >= 0 && PySequence_Length(read_value) != number_of_bytes) {
+            ret = -2; /* Signal EOF. */
+            goto except;
+        }
     }
     goto finally;
     except:
@@ -85,7 +389,7 @@ int PythonFileObjectWrapper::read_py_write_cpp(Py_ssize_t number_of_bytes, std::
     assert(ret);
     finally:
     /* Clean up under normal conditions and return an appropriate value. */
-    Py_XDECREF(read_args);
+    Py_XDECREF(read_size);
     Py_XDECREF(read_value);
 #if DEBUG_PYEXT_COMMON
     fprintf(stdout, "%s(): %s#%d ret=%d\n", __FUNCTION__, __FILE__, __LINE__, ret);
@@ -100,8 +404,8 @@ int PythonFileObjectWrapper::read_cpp_write_py(std::iostream &ios, Py_ssize_t nu
     assert(m_python_write_method);
     int ret = 0;
     PyObject *py_bytes = NULL;
-    PyObject *write_args = NULL;
     PyObject *write_result = NULL;
+    Py_ssize_t write_count;
 #if DEBUG_PYEXT_COMMON
     fprintf(stdout, "%s(): %s#%d number_of_bytes=%ld\n", __FUNCTION__, __FILE__, __LINE__, number_of_bytes);
 #endif
@@ -117,13 +421,17 @@ int PythonFileObjectWrapper::read_cpp_write_py(std::iostream &ios, Py_ssize_t nu
         PyErr_SetString(PyExc_ValueError, "Can not read from C++ stream.");
         goto except;
     }
-    write_args = Py_BuildValue("(O)", py_bytes);
-    write_result = PyObject_Call(m_python_write_method, write_args, NULL);
+    write_result = vectorcall_one(m_python_write_method, py_bytes);
     if (write_result == NULL) {
         ret = -1;
         goto except;
     }
-    if (PyLong_AsLong(write_result) != number_of_bytes) {
+    write_count = PyLong_AsSsize_t(write_result);
+    if (write_count == -1 && PyErr_Occurred()) {
+        ret = -1;
+        goto except;
+    }
+    if (write_count != number_of_bytes) {
         ret = -2;
         goto except;
     }
@@ -134,7 +442,6 @@ int PythonFileObjectWrapper::read_cpp_write_py(std::iostream &ios, Py_ssize_t nu
     finally:
     /* Clean up under normal conditions and return an appropriate value. */
     Py_XDECREF(py_bytes);
-    Py_XDECREF(write_args);
     Py_XDECREF(write_result);
 #if DEBUG_PYEXT_COMMON
     fprintf(stdout, "%s(): %s#%d ret=%d\n", __FUNCTION__, __FILE__, __LINE__, ret);
@@ -152,18 +459,34 @@ int PythonFileObjectWrapper::read(Py_ssize_t number_of_bytes, std::vector<char>
 #if DEBUG_PYEXT_COMMON
     fprintf(stdout, "%s(): %s#%d number_of_bytes=%ld\n", __FUNCTION__, __FILE__, __LINE__, number_of_bytes);
 #endif
+    if (number_of_bytes >= 0 && (uses_fd() || uses_readinto())) {
+        /* Read directly into the result, if that is being reused it is not re-allocated. */
+        try {
+            result.resize(number_of_bytes);
+        } catch (const std::bad_alloc &) {
+            result.clear();
+            PyErr_NoMemory();
+            return -1;
+        } catch (const std::length_error &) {
+            result.clear();
+            PyErr_NoMemory();
+            return -1;
+        }
+        Py_ssize_t count = readinto(result.data(), number_of_bytes);
+        if (count < 0) {
+            result.clear();
+            return -1;
+        }
+        result.resize(count);
+        return count == number_of_bytes ? 0 : -2;
+    }
     result.clear();
-    PyObject * read_args = Py_BuildValue("(i)", number_of_bytes);
-    PyObject * read_value = PyObject_Call(m_python_read_method, read_args, NULL);
+    PyObject * read_size = py_size(number_of_bytes);
+    PyObject * read_value = read_size ? vectorcall_one(m_python_read_method, read_size) : NULL;
     if (read_value == NULL) {
         ret = -1;
         goto except;
     } else {
-        /* Check for EOF */
-        if (number_of_bytes >= 0 && PySequence_Length(read_value) != number_of_bytes) {
-            ret = -2; /* Signal EOF. */
-            goto except;
-        }
         const char *buffer;
         Py_ssize_t size;
         if (PyBytes_Check(read_value)) {
@@ -175,8 +498,11 @@ int PythonFileObjectWrapper::read(Py_ssize_t number_of_bytes, std::vector<char>
             ret = -3;
             goto except;
         }
-        for (Py_ssize_t i = 0; i < size; ++i) {
-            result.push_back(buffer[i]);
+        result.assign(buffer, buffer + size);
+        /* Check for EOF */
+        if (number_of_bytes >= 0 && PySequence_Length(read_value) != number_of_bytes) {
+            ret = -2; /* Signal EOF. */
+            goto except;
         }
     }
     goto finally;
@@ -185,7 +511,7 @@ int PythonFileObjectWrapper::read(Py_ssize_t number_of_bytes, std::vector<char>
     assert(ret);
     finally:
     /* Clean up under normal conditions and return an appropriate value. */
-    Py_XDECREF(read_args);
+    Py_XDECREF(read_size);
     Py_XDECREF(read_value);
 #if DEBUG_PYEXT_COMMON
     fprintf(stdout, "%s(): %s#%d ret=%d\n", __FUNCTION__, __FILE__, __LINE__, ret);
@@ -200,20 +526,28 @@ int PythonFileObjectWrapper::write(const char *buffer, Py_ssize_t number_of_byte
     assert(m_python_write_method);
     int ret = 0;
     PyObject * py_bytes = NULL;
-    PyObject * write_args = NULL;
     PyObject * write_result = NULL;
+    Py_ssize_t write_count;
 #if DEBUG_PYEXT_COMMON
     fprintf(stdout, "%s(): %s#%d number_of_bytes=%ld\n", __FUNCTION__, __FILE__, __LINE__, number_of_bytes);
 #endif
     // Create a Python bytes object, read into it.
     py_bytes = PyBytes_FromStringAndSize(buffer, number_of_bytes);
-    write_args = Py_BuildValue("(O)", py_bytes);
-    write_result = PyObject_Call(m_python_write_method, write_args, NULL);
+    if (!py_bytes) {
+        ret = -1;
+        goto except;
+    }
+    write_result = vectorcall_one(m_python_write_method, py_bytes);
     if (write_result == NULL) {
         ret = -1;
         goto except;
     }
-    if (PyLong_AsLong(write_result) != number_of_bytes) {
+    write_count = PyLong_AsSsize_t(write_result);
+    if (write_count == -1 && PyErr_Occurred()) {
+        ret = -1;
+        goto except;
+    }
+    if (write_count != number_of_bytes) {
         ret = -2;
         goto except;
     }
@@ -224,7 +558,6 @@ except:
 finally:
     /* Clean up under normal conditions and return an appropriate value. */
     Py_XDECREF(py_bytes);
-    Py_XDECREF(write_args);
     Py_XDECREF(write_result);
 #if DEBUG_PYEXT_COMMON
     fprintf(stdout, "%s(): %s#%d ret=%d\n", __FUNCTION__, __FILE__, __LINE__, ret);
@@ -237,9 +570,20 @@ long PythonFileObjectWrapper::seek(Py_ssize_t pos, int whence) {
     assert(m_python_file_object);
     assert(m_python_seek_method);
 
-    PyObject * arguments = Py_BuildValue("ni", pos, whence);
-    PyObject * result = PyObject_Call(m_python_seek_method, arguments, NULL);
-    return PyLong_AsLong(result);
+    PyObject * py_pos = PyLong_FromSsize_t(pos);
+    PyObject * py_whence = PyLong_FromLong(whence);
+    PyObject * result = NULL;
+    if (py_pos && py_whence) {
+        result = vectorcall_two(m_python_seek_method, py_pos, py_whence);
+    }
+    Py_XDECREF(py_pos);
+    Py_XDECREF(py_whence);
+    if (!result) {
+        return -1;
+    }
+    long ret = PyLong_AsLong(result);
+    Py_DECREF(result);
+    return ret;
 }
 
 long PythonFileObjectWrapper::tell() {
@@ -248,7 +592,188 @@ long PythonFileObjectWrapper::tell() {
     assert(m_python_tell_method);
 
     PyObject * result = PyObject_CallNoArgs(m_python_tell_method);
-    return PyLong_AsLong(result);
+    if (!result) {
+        return -1;
+    }
+    long ret = PyLong_AsLong(result);
+    Py_DECREF(result);
+    return ret;
+}
+
+/**
+ * Check the size and offset of positional I/O.
+ * Returns non-zero with a ValueError set if either is negative.
+ */
+static int
+check_positional_arguments(Py_ssize_t number_of_bytes, Py_ssize_t offset) {
+    if (number_of_bytes < 0) {
+        PyErr_Format(PyExc_ValueError, "The number of bytes must be >= 0 not %zd.", number_of_bytes);
+        return -1;
+    }
+    if (offset < 0) {
+        PyErr_Format(PyExc_ValueError, "The offset must be >= 0 not %zd.", offset);
+        return -2;
+    }
+    return 0;
+}
+
+/**
+ * For a file without a file descriptor this seeks to offset, calls operation() and then seeks back to the original
+ * position, even if operation() fails.
+ * operation() returns the number of bytes transferred or -1 with a Python exception set, as does this.
+ */
+template<typename Operation>
+static Py_ssize_t
+at_position(PyObject *seek_method, PyObject *tell_method, Py_ssize_t offset, Operation operation) {
+    Py_ssize_t ret = -1;
+    PyObject *position = PyObject_CallNoArgs(tell_method);
+    if (!position) {
+        return -1;
+    }
+    PyObject *py_offset = PyLong_FromSsize_t(offset);
+    PyObject *seek_result = py_offset ? vectorcall_one(seek_method, py_offset) : NULL;
+    Py_XDECREF(py_offset);
+    if (seek_result) {
+        Py_DECREF(seek_result);
+        ret = operation();
+    }
+    /* Restore the position, keeping any exception. */
+    PyObject *type, *value, *traceback;
+    PyErr_Fetch(&type, &value, &traceback);
+    seek_result = vectorcall_one(seek_method, position);
+    Py_DECREF(position);
+    if (!seek_result) {
+        if (type) {
+            PyErr_Clear();
+            PyErr_Restore(type, value, traceback);
+        }
+        return -1;
+    }
+    Py_DECREF(seek_result);
+    PyErr_Restore(type, value, traceback);
+    return type ? -1 : ret;
+}
+
+Py_ssize_t PythonFileObjectWrapper::pread_with_seek(char *buffer, Py_ssize_t number_of_bytes, Py_ssize_t offset) {
+    return at_position(m_python_seek_method, m_python_tell_method, offset, [this, buffer, number_of_bytes]() {
+        return readinto(buffer, number_of_bytes);
+    });
+}
+
+Py_ssize_t
+PythonFileObjectWrapper::pwrite_with_seek(const char *buffer, Py_ssize_t number_of_bytes, Py_ssize_t offset) {
+    return at_position(m_python_seek_method, m_python_tell_method, offset, [this, buffer, number_of_bytes]() {
+        PyObject *py_bytes = PyBytes_FromStringAndSize(buffer, number_of_bytes);
+        if (!py_bytes) {
+            return (Py_ssize_t) -1;
+        }
+        PyObject *write_result = vectorcall_one(m_python_write_method, py_bytes);
+        Py_DECREF(py_bytes);
+        if (!write_result) {
+            return (Py_ssize_t) -1;
+        }
+        Py_ssize_t count = PyLong_AsSsize_t(write_result);
+        Py_DECREF(write_result);
+        return count;
+    });
+}
+
+Py_ssize_t PythonFileObjectWrapper::pread(char *buffer, Py_ssize_t number_of_bytes, Py_ssize_t offset) {
+    assert(!PyErr_Occurred());
+    assert(buffer || number_of_bytes == 0);
+    if (check_positional_arguments(number_of_bytes, offset)) {
+        return -1;
+    }
+#if PYTHON_FILE_WRAPPER_HAS_PREAD
+    if (m_has_fd) {
+        int fd = file_descriptor();
+        if (fd < 0) {
+            return -1;
+        }
+        return fd_io_loop(number_of_bytes, [fd, buffer, offset](Py_ssize_t done, Py_ssize_t size) {
+            return ::pread(fd, buffer + done, size, (off_t) (offset + done));
+        });
+    }
+#endif
+    return pread_with_seek(buffer, number_of_bytes, offset);
+}
+
+Py_ssize_t
+PythonFileObjectWrapper::preadv(const std::vector<std::pair<char *, Py_ssize_t>> &buffers, Py_ssize_t offset) {
+    assert(!PyErr_Occurred());
+    Py_ssize_t number_of_bytes = 0;
+    for (const auto &buffer: buffers) {
+        if (check_positional_arguments(buffer.second, offset)) {
+            return -1;
+        }
+        number_of_bytes += buffer.second;
+    }
+#if PYTHON_FILE_WRAPPER_HAS_PREAD && defined(HAVE_PREADV)
+    if (m_has_fd) {
+        int fd = file_descriptor();
+        if (fd < 0) {
+            return -1;
+        }
+        std::vector<struct iovec> iov;
+        iov.reserve(buffers.size());
+        for (const auto &buffer: buffers) {
+            if (buffer.second) {
+                iov.push_back({buffer.first, (size_t) buffer.second});
+            }
+        }
+        /* The index of the first buffer that is not full. */
+        size_t index = 0;
+        return fd_io_loop(number_of_bytes, [fd, &iov, &index, offset](Py_ssize_t done, Py_ssize_t) {
+            ssize_t count = ::preadv(fd, &iov[index], (int) std::min(iov.size() - index, (size_t) IOV_MAX),
+                                     (off_t) (offset + done));
+            /* Move past the buffers that have been filled for the next call. */
+            for (ssize_t remaining = count; remaining > 0;) {
+                if ((size_t) remaining >= iov[index].iov_len) {
+                    remaining -= iov[index].iov_len;
+                    ++index;
+                } else {
+                    iov[index].iov_base = (char *) iov[index].iov_base + remaining;
+                    iov[index].iov_len -= remaining;
+                    remaining = 0;
+                }
+            }
+            return count;
+        });
+    }
+#endif
+    /* Read each buffer in turn until one is short. */
+    Py_ssize_t ret = 0;
+    for (const auto &buffer: buffers) {
+        Py_ssize_t count = pread(buffer.first, buffer.second, offset + ret);
+        if (count < 0) {
+            return -1;
+        }
+        ret += count;
+        if (count < buffer.second) {
+            break;
+        }
+    }
+    return ret;
+}
+
+Py_ssize_t PythonFileObjectWrapper::pwrite(const char *buffer, Py_ssize_t number_of_bytes, Py_ssize_t offset) {
+    assert(!PyErr_Occurred());
+    assert(buffer || number_of_bytes == 0);
+    if (check_positional_arguments(number_of_bytes, offset)) {
+        return -1;
+    }
+#if PYTHON_FILE_WRAPPER_HAS_PREAD
+    if (m_has_fd) {
+        int fd = file_descriptor();
+        if (fd < 0) {
+            return -1;
+        }
+        return fd_io_loop(number_of_bytes, [fd, buffer, offset](Py_ssize_t done, Py_ssize_t size) {
+            return ::pwrite(fd, buffer + done, size, (off_t) (offset + done));
+        });
+    }
+#endif
+    return pwrite_with_seek(buffer, number_of_bytes, offset);
 }
 
 std::string PythonFileObjectWrapper::str_pointers() const {
@@ -269,6 +794,11 @@ std::string PythonFileObjectWrapper::str_pointers() const {
     oss << "m_python_tell_method  " << std::hex << m_python_tell_method << " type: "
         << Py_TYPE(m_python_tell_method)->tp_name << " ref count=" << std::dec << m_python_tell_method->ob_refcnt
         << std::endl;
+    if (m_python_readinto_method) {
+        oss << "m_python_readinto_method " << std::hex << m_python_readinto_method << " type: "
+            << Py_TYPE(m_python_readinto_method)->tp_name << " ref count=" << std::dec
+            << m_python_readinto_method->ob_refcnt << std::endl;
+    }
     return {oss.str()};
 }
 
@@ -282,5 +812,9 @@ PythonFileObjectWrapper::~PythonFileObjectWrapper() {
     Py_XDECREF(m_python_write_method);
     Py_XDECREF(m_python_seek_method);
     Py_XDECREF(m_python_tell_method);
+    Py_XDECREF(m_python_readinto_method);
+    for (int i = 0; i < SIZE_CACHE_LENGTH; ++i) {
+        Py_XDECREF(m_size_cache[i]);
+    }
     Py_XDECREF(m_python_file_object);
 }
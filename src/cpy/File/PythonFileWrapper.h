@@ -13,7 +13,14 @@
 #include <exception>
 #include <string>
 #include <utility>
-//#include <utility>
+#include <vector>
+
+/* Positional I/O on the file descriptor needs pread() and pwrite(), preadv() is used if available. */
+#if defined(HAVE_PREAD) && defined(HAVE_PWRITE)
+#define PYTHON_FILE_WRAPPER_HAS_PREAD 1
+#else
+#define PYTHON_FILE_WRAPPER_HAS_PREAD 0
+#endif
 
 class ExceptionPythonFileObjectWrapper : public std::exception {
 public:
@@ -32,12 +39,21 @@ protected:
 /// Class that is created with a PyObject* that looks like a Python File.
 /// This can then read from that file object ans write to a user provided C++ stream or read from a user provided C++
 /// stream and write to the give Python file like object.
+///
+/// If the file has a readinto() method, binary files do, then reads of a known size go directly into a C++ buffer
+/// through a memoryview. This avoids creating a bytes object and copying it for every read.
+/// Otherwise, or if set_use_readinto(false), the file's read() method is used.
+///
+/// If the file has a fileno() then pread(), preadv() and pwrite() use the file descriptor with the GIL released.
+/// These do not change the file position. Otherwise they seek, read or write, and seek back.
+/// If the file is exactly an io.FileIO, an unbuffered file, then the file position is that of the file descriptor so
+/// sequential reads also use the file descriptor with the GIL released, unless set_use_fd(false).
 class PythonFileObjectWrapper {
 public:
     explicit PythonFileObjectWrapper(PyObject *python_file_object);
 
     /// Read from a Python file and write to the C++ stream.
-    /// Return zero on success, non-zero on failure.
+    /// Return zero on success, non-zero on failure, -2 is EOF and then the bytes that were read have been written.
     int read_py_write_cpp(Py_ssize_t number_of_bytes, std::iostream &ios);
 
     /// Read from a C++ stream and write to a Python file.
@@ -45,9 +61,42 @@ public:
     int read_cpp_write_py(std::iostream &ios, Py_ssize_t number_of_bytes);
 
     /// Read a number of bytes from a Python file and load them into the result.
-    /// Return zero on success, non-zero on failure.
+    /// Return zero on success, non-zero on failure, -2 is EOF and then the result has the bytes that were read.
     int read(Py_ssize_t number_of_bytes, std::vector<char> &result);
 
+    /// Read up to number_of_bytes from a Python file into the caller's buffer, fewer only at EOF.
+    /// The buffer can be reused for every read.
+    /// Returns the number of bytes read or -1 with a Python exception set.
+    Py_ssize_t readinto(char *buffer, Py_ssize_t number_of_bytes);
+
+    /// True if the file has a readinto() method and it is being used.
+    bool uses_readinto() const { return m_python_readinto_method && m_use_readinto; }
+
+    /// Choose whether to use readinto(), if the file has one, or always read(). The default is true.
+    void set_use_readinto(bool use_readinto) { m_use_readinto = use_readinto; }
+
+    /// True if the file had a file descriptor when this was constructed.
+    bool has_fd() const { return m_has_fd; }
+
+    /// True if sequential reads use the file descriptor directly, only for an io.FileIO.
+    bool uses_fd() const { return m_fd_is_raw && m_use_fd; }
+
+    /// Choose whether sequential reads of an io.FileIO use the file descriptor. The default is true.
+    void set_use_fd(bool use_fd) { m_use_fd = use_fd; }
+
+    /// Read up to number_of_bytes at offset into the caller's buffer without changing the file position.
+    /// This bypasses any Python buffering, flush() the file first if it has been written to.
+    /// Returns the number of bytes read, fewer only at EOF, or -1 with a Python exception set.
+    Py_ssize_t pread(char *buffer, Py_ssize_t number_of_bytes, Py_ssize_t offset);
+
+    /// As pread() but scatters the data across the buffers in order, each is a pointer and a size.
+    Py_ssize_t preadv(const std::vector<std::pair<char *, Py_ssize_t>> &buffers, Py_ssize_t offset);
+
+    /// Write number_of_bytes at offset without changing the file position.
+    /// This bypasses any Python buffering so a buffered reader may already have a stale copy of that data.
+    /// Returns the number of bytes written or -1 with a Python exception set.
+    Py_ssize_t pwrite(const char *buffer, Py_ssize_t number_of_bytes, Py_ssize_t offset);
+
     /// Write a number of bytes to a Python file.
     /// Return zero on success, non-zero on failure.
     int write(const char *buffer, Py_ssize_t number_of_bytes);
@@ -57,10 +106,10 @@ public:
     /// 0 – start of the stream (the default); offset should be zero or positive.
     /// 1 – current stream position; offset may be negative.
     /// 2 – end of the stream; offset is usually negative.
-    /// Returns the new absolute position.
+    /// Returns the new absolute position or -1 with a Python exception set.
     long seek(Py_ssize_t pos, int whence = 0);
 
-    /// Returns the current absolute position.
+    /// Returns the current absolute position or -1 with a Python exception set.
     long tell();
     /// Returns a multi-line string that describes the class state.
     std::string str_pointers() const;
@@ -75,6 +124,35 @@ protected:
     PyObject *m_python_write_method = NULL;
     PyObject *m_python_seek_method = NULL;
     PyObject *m_python_tell_method = NULL;
+    /// This is optional, NULL if the file has no readinto().
+    PyObject *m_python_readinto_method = NULL;
+    bool m_use_readinto = true;
+    /// Reused by read_py_write_cpp().
+    std::vector<char> m_read_buffer;
+    bool m_has_fd = false;
+    bool m_fd_is_raw = false;
+    bool m_use_fd = true;
+    /// A few Python ints for the sizes passed to read(), programs usually read the same few sizes over and over.
+    static const int SIZE_CACHE_LENGTH = 4;
+    PyObject *m_size_cache[SIZE_CACHE_LENGTH] = {NULL, NULL, NULL, NULL};
+    Py_ssize_t m_size_cache_values[SIZE_CACHE_LENGTH] = {0, 0, 0, 0};
+    int m_size_cache_next = 0;
+
+    /// Returns a new reference to a Python int of value, from the cache if possible, or NULL with an exception set.
+    PyObject *py_size(Py_ssize_t value);
+
+    /// Fill the buffer using readinto(), returns the number of bytes read or -1 with a Python exception set.
+    Py_ssize_t readinto_with_memoryview(char *buffer, Py_ssize_t number_of_bytes);
+    /// Fill the buffer using read(), returns the number of bytes read or -1 with a Python exception set.
+    Py_ssize_t readinto_with_read(char *buffer, Py_ssize_t number_of_bytes);
+    /// Fill the buffer using read(2) on the file descriptor, returns the number of bytes read or -1 with a Python
+    /// exception set.
+    Py_ssize_t readinto_with_fd(char *buffer, Py_ssize_t number_of_bytes);
+    /// Returns the current file descriptor or -1 with a Python exception set, for example if the file is closed.
+    int file_descriptor();
+    /// pread() and pwrite() for files without a file descriptor.
+    Py_ssize_t pread_with_seek(char *buffer, Py_ssize_t number_of_bytes, Py_ssize_t offset);
+    Py_ssize_t pwrite_with_seek(const char *buffer, Py_ssize_t number_of_bytes, Py_ssize_t offset);
 };
 
 #endif //PYTHONEXTENSIONSBASIC_PYTHONFILEWRAPPER_H
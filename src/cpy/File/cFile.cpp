@@ -10,8 +10,31 @@
 
 #include "Python.h"
 #include "PythonFileWrapper.h"
+#include "PythonFileStreamBuf.h"
+#include "py_fastcall_args.h"
 #include "time.h"
 
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <new>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/* MappedFile needs POSIX mmap(). */
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+#define CFILE_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define CFILE_HAS_MMAP 0
+#endif
+
 #define FPRINTF_DEBUG 0
 
 /** Example of changing a Python string representing a file path to a C string and back again.
@@ -69,29 +92,19 @@ parse_filesystem_argument(PyObject *Py_UNUSED(module), PyObject *args, PyObject
 
 
 /**
- * Take a Python file object and and an integer and read that number of bytes and access this data in C.
- * This returns the bytes read as a bytes object.
- *
- * Python signature:
- *
- * def read_python_file_to_c(file_object: typing.IO, size: int = -1) -> bytes:
+ * Read bytes_to_read bytes from the Python file object and access this data in C.
+ * This is the implementation of read_python_file_to_c() and read_python_file_to_c_fastcall().
  */
 static PyObject *
-read_python_file_to_c(PyObject *Py_UNUSED(module), PyObject *args, PyObject *kwds) {
+read_python_file_to_c_impl(PyObject *py_file_object, Py_ssize_t bytes_to_read) {
     assert(!PyErr_Occurred());
-    static const char *kwlist[] = {"file_object", "size", NULL};
-    PyObject *py_file_object = NULL;
-    Py_ssize_t bytes_to_read = -1;
     PyObject *py_read_meth = NULL;
-    PyObject *py_read_args = NULL;
+    PyObject *py_read_size = NULL;
+    PyObject *py_read_argv[2] = {NULL, NULL};
     PyObject *py_read_data = NULL;
     char *c_bytes_data = NULL;
     PyObject *ret = NULL;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|n", (char **) (kwlist),
-                                     &py_file_object, &bytes_to_read)) {
-        return NULL;
-    }
 #if FPRINTF_DEBUG
     fprintf(stdout, "Got a file object of type \"%s\" and bytes to read of %ld\n", Py_TYPE(py_file_object)->tp_name,
             bytes_to_read);
@@ -118,12 +131,15 @@ read_python_file_to_c(PyObject *Py_UNUSED(module), PyObject *args, PyObject *kwd
     fprintf(stdout, "Read attribute is callable.\n");
 #endif
     // Call read(VisibleRecord::NUMBER_OF_HEADER_BYTES) to get a Python bytes object.
-    py_read_args = Py_BuildValue("(i)", bytes_to_read);
-    if (!py_read_args) {
+    py_read_size = PyLong_FromSsize_t(bytes_to_read);
+    if (!py_read_size) {
         goto except;
     }
     // This should advance that readable file pointer.
-    py_read_data = PyObject_Call(py_read_meth, py_read_args, NULL);
+    // The argument is on the stack rather than in a tuple.
+    // PY_VECTORCALL_ARGUMENTS_OFFSET lets a bound method put self in py_read_argv[0] rather than copying.
+    py_read_argv[1] = py_read_size;
+    py_read_data = PyObject_Vectorcall(py_read_meth, py_read_argv + 1, 1 | PY_VECTORCALL_ARGUMENTS_OFFSET, NULL);
     if (py_read_data == NULL) {
         goto except;
     }
@@ -132,9 +148,9 @@ read_python_file_to_c(PyObject *Py_UNUSED(module), PyObject *args, PyObject *kwd
 #endif
     /* Check for EOF */
     if (bytes_to_read >= 0 && PySequence_Length(py_read_data) != bytes_to_read) {
-        assert(PyErr_Occurred());
+        assert(!PyErr_Occurred());
         PyErr_Format(PyExc_IOError,
-                     "Reading file object gives EOF. Requested bytes %ld, got %ld.",
+                     "Reading file object gives EOF. Requested bytes %zd, got %zd.",
                      bytes_to_read, PySequence_Length(py_read_data));
         goto except;
     }
@@ -154,14 +170,66 @@ read_python_file_to_c(PyObject *Py_UNUSED(module), PyObject *args, PyObject *kwd
 except:
     /* Handle every abnormal condition and clean up. */
     assert(PyErr_Occurred());
+    Py_XDECREF(py_read_data);
     ret = NULL;
 finally:
     /* Clean up under normal conditions and return an appropriate value. */
     Py_XDECREF(py_read_meth);
-    Py_XDECREF(py_read_args);
+    Py_XDECREF(py_read_size);
     return ret;
 }
 
+/**
+ * Take a Python file object and and an integer and read that number of bytes and access this data in C.
+ * This returns the bytes read as a bytes object.
+ *
+ * Python signature:
+ *
+ * def read_python_file_to_c(file_object: typing.IO, size: int = -1) -> bytes:
+ */
+static PyObject *
+read_python_file_to_c(PyObject *Py_UNUSED(module), PyObject *args, PyObject *kwds) {
+    static const char *kwlist[] = {"file_object", "size", NULL};
+    PyObject *py_file_object = NULL;
+    Py_ssize_t bytes_to_read = -1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|n", (char **) (kwlist),
+                                     &py_file_object, &bytes_to_read)) {
+        return NULL;
+    }
+    return read_python_file_to_c_impl(py_file_object, bytes_to_read);
+}
+
+static const char *const read_python_file_to_c_fastcall_keywords[] = {"file_object", "size", NULL};
+static PyFastcallParser read_python_file_to_c_fastcall_parser = {
+        "read_python_file_to_c_fastcall", read_python_file_to_c_fastcall_keywords, 1, NULL, 0
+};
+
+/**
+ * As read_python_file_to_c() but with METH_FASTCALL | METH_KEYWORDS.
+ *
+ * Python signature:
+ *
+ * def read_python_file_to_c_fastcall(file_object: typing.IO, size: int = -1) -> bytes:
+ */
+static PyObject *
+read_python_file_to_c_fastcall(PyObject *Py_UNUSED(module), PyObject *const *args, Py_ssize_t nargs,
+                               PyObject *kwnames) {
+    PyObject *argv[2];
+    Py_ssize_t bytes_to_read = -1;
+
+    if (py_fastcall_unpack(&read_python_file_to_c_fastcall_parser, args, nargs, kwnames, argv)) {
+        return NULL;
+    }
+    if (argv[1]) {
+        bytes_to_read = PyLong_AsSsize_t(argv[1]);
+        if (bytes_to_read == -1 && PyErr_Occurred()) {
+            return NULL;
+        }
+    }
+    return read_python_file_to_c_impl(argv[0], bytes_to_read);
+}
+
 
 /**
  * Take a Python bytes object, extract the bytes as a C char* and write to the python file object.
@@ -222,6 +290,431 @@ wrap_python_file(PyObject *Py_UNUSED(module), PyObject *args, PyObject *kwds) {
     return py_file_wrapper.py_str_pointers();
 }
 
+/**
+ * Reads the whole of a Python file through a PythonFileObjectWrapper in chunks and returns the bytes.
+ * method selects the wrapper API:
+ *
+ * - "buffer": PythonFileObjectWrapper::readinto() into a single reused buffer.
+ * - "vector": PythonFileObjectWrapper::read() into a reused std::vector<char>.
+ * - "iostream": PythonFileObjectWrapper::read_py_write_cpp() into a std::stringstream.
+ *
+ * If use_readinto is False the file's read() method is used.
+ * If use_fd is True, and the file is an io.FileIO, the file descriptor is read with the GIL released.
+ *
+ * Python signature:
+ *
+ * def read_python_file_via_wrapper(file_object: typing.IO, chunk_size: int = 65536, method: str = 'buffer',
+ *                                  use_readinto: bool = True, use_fd: bool = True) -> bytes:
+ */
+static PyObject *
+read_python_file_via_wrapper(PyObject *Py_UNUSED(module), PyObject *args, PyObject *kwds) {
+    assert(!PyErr_Occurred());
+    static const char *kwlist[] = {"file_object", "chunk_size", "method", "use_readinto", "use_fd", NULL};
+    PyObject *py_file_object = NULL;
+    Py_ssize_t chunk_size = 65536;
+    const char *method = "buffer";
+    int use_readinto = 1;
+    int use_fd = 1;
+    std::string result;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|nspp", (char **) (kwlist),
+                                     &py_file_object, &chunk_size, &method, &use_readinto, &use_fd)) {
+        return NULL;
+    }
+    if (chunk_size <= 0) {
+        PyErr_Format(PyExc_ValueError, "chunk_size must be > 0 not %zd.", chunk_size);
+        return NULL;
+    }
+    try {
+        PythonFileObjectWrapper py_file_wrapper(py_file_object);
+        py_file_wrapper.set_use_readinto(use_readinto != 0);
+        py_file_wrapper.set_use_fd(use_fd != 0);
+        int err = 0;
+        if (strcmp(method, "buffer") == 0) {
+            std::vector<char> buffer(chunk_size);
+            Py_ssize_t count;
+            do {
+                count = py_file_wrapper.readinto(buffer.data(), chunk_size);
+                if (count < 0) {
+                    return NULL;
+                }
+                result.append(buffer.data(), count);
+            } while (count == chunk_size);
+        } else if (strcmp(method, "vector") == 0) {
+            std::vector<char> chunk;
+            do {
+                err = py_file_wrapper.read(chunk_size, chunk);
+                if (err == 0 || err == -2) {
+                    result.append(chunk.data(), chunk.size());
+                }
+            } while (err == 0);
+        } else if (strcmp(method, "iostream") == 0) {
+            std::stringstream ios;
+            do {
+                err = py_file_wrapper.read_py_write_cpp(chunk_size, ios);
+            } while (err == 0);
+            result = ios.str();
+        } else {
+            PyErr_Format(PyExc_ValueError, "method must be 'buffer', 'vector' or 'iostream' not '%s'.", method);
+            return NULL;
+        }
+        if (err == -3) {
+            PyErr_SetString(PyExc_TypeError, "read() must return bytes or str.");
+            return NULL;
+        }
+        if (err != 0 && err != -2) {
+            assert(PyErr_Occurred());
+            return NULL;
+        }
+    } catch (ExceptionPythonFileObjectWrapper &err) {
+        if (!PyErr_Occurred()) {
+            PyErr_SetString(PyExc_ValueError, err.what());
+        }
+        return NULL;
+    } catch (const std::bad_alloc &) {
+        return PyErr_NoMemory();
+    } catch (const std::length_error &) {
+        return PyErr_NoMemory();
+    }
+    return PyBytes_FromStringAndSize(result.data(), result.size());
+}
+
+/**
+ * Reads size bytes at offset from a Python file without changing its position.
+ * This uses pread() with the GIL released if the file has a file descriptor.
+ * The result is shorter than size at EOF.
+ *
+ * Python signature:
+ *
+ * def pread_python_file(file_object: typing.IO, size: int, offset: int) -> bytes:
+ */
+static PyObject *
+pread_python_file(PyObject *Py_UNUSED(module), PyObject *args, PyObject *kwds) {
+    assert(!PyErr_Occurred());
+    static const char *kwlist[] = {"file_object", "size", "offset", NULL};
+    PyObject *py_file_object = NULL;
+    Py_ssize_t size = 0;
+    Py_ssize_t offset = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "Onn", (char **) (kwlist),
+                                     &py_file_object, &size, &offset)) {
+        return NULL;
+    }
+    if (size < 0) {
+        PyErr_Format(PyExc_ValueError, "size must be >= 0 not %zd.", size);
+        return NULL;
+    }
+    try {
+        PythonFileObjectWrapper py_file_wrapper(py_file_object);
+        std::vector<char> buffer(size);
+        Py_ssize_t count = py_file_wrapper.pread(buffer.data(), size, offset);
+        if (count < 0) {
+            return NULL;
+        }
+        return PyBytes_FromStringAndSize(buffer.data(), count);
+    } catch (ExceptionPythonFileObjectWrapper &err) {
+        if (!PyErr_Occurred()) {
+            PyErr_SetString(PyExc_ValueError, err.what());
+        }
+        return NULL;
+    } catch (const std::bad_alloc &) {
+        return PyErr_NoMemory();
+    } catch (const std::length_error &) {
+        return PyErr_NoMemory();
+    }
+}
+
+/**
+ * Reads consecutive blocks of the given sizes starting at offset from a Python file without changing its position.
+ * This uses a single preadv() with the GIL released if the file has a file descriptor.
+ * At EOF the last block is short and any after that are empty.
+ *
+ * Python signature:
+ *
+ * def preadv_python_file(file_object: typing.IO, sizes: typing.Sequence[int], offset: int) -> typing.List[bytes]:
+ */
+static PyObject *
+preadv_python_file(PyObject *Py_UNUSED(module), PyObject *args, PyObject *kwds) {
+    assert(!PyErr_Occurred());
+    static const char *kwlist[] = {"file_object", "sizes", "offset", NULL};
+    PyObject *py_file_object = NULL;
+    PyObject *py_sizes = NULL;
+    Py_ssize_t offset = 0;
+    std::vector<Py_ssize_t> sizes;
+    PyObject *ret = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOn", (char **) (kwlist),
+                                     &py_file_object, &py_sizes, &offset)) {
+        return NULL;
+    }
+    PyObject *py_sizes_fast = PySequence_Fast(py_sizes, "sizes must be a sequence of integers.");
+    if (!py_sizes_fast) {
+        return NULL;
+    }
+    Py_ssize_t total = 0;
+    for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(py_sizes_fast); ++i) {
+        Py_ssize_t size = PyLong_AsSsize_t(PySequence_Fast_GET_ITEM(py_sizes_fast, i));
+        if (size == -1 && PyErr_Occurred()) {
+            Py_DECREF(py_sizes_fast);
+            return NULL;
+        }
+        if (size < 0) {
+            PyErr_Format(PyExc_ValueError, "sizes must be >= 0 not %zd.", size);
+            Py_DECREF(py_sizes_fast);
+            return NULL;
+        }
+        if (size > PY_SSIZE_T_MAX - total) {
+            PyErr_SetString(PyExc_OverflowError, "The total of sizes is too large.");
+            Py_DECREF(py_sizes_fast);
+            return NULL;
+        }
+        sizes.push_back(size);
+        total += size;
+    }
+    Py_DECREF(py_sizes_fast);
+    try {
+        PythonFileObjectWrapper py_file_wrapper(py_file_object);
+        /* One allocation divided into the blocks. */
+        std::vector<char> data(total);
+        std::vector<std::pair<char *, Py_ssize_t>> buffers;
+        Py_ssize_t start = 0;
+        for (Py_ssize_t size: sizes) {
+            buffers.emplace_back(data.data() + start, size);
+            start += size;
+        }
+        Py_ssize_t count = py_file_wrapper.preadv(buffers, offset);
+        if (count < 0) {
+            return NULL;
+        }
+        ret = PyList_New(sizes.size());
+        if (!ret) {
+            return NULL;
+        }
+        start = 0;
+        for (size_t i = 0; i < sizes.size(); ++i) {
+            Py_ssize_t size = std::max((Py_ssize_t) 0, std::min(sizes[i], count - start));
+            PyObject *block = PyBytes_FromStringAndSize(data.data() + start, size);
+            if (!block) {
+                Py_DECREF(ret);
+                return NULL;
+            }
+            PyList_SET_ITEM(ret, i, block);
+            start += sizes[i];
+        }
+    } catch (ExceptionPythonFileObjectWrapper &err) {
+        if (!PyErr_Occurred()) {
+            PyErr_SetString(PyExc_ValueError, err.what());
+        }
+        return NULL;
+    } catch (const std::bad_alloc &) {
+        return PyErr_NoMemory();
+    } catch (const std::length_error &) {
+        return PyErr_NoMemory();
+    }
+    return ret;
+}
+
+/**
+ * Writes bytes at offset to a Python file without changing its position.
+ * This uses pwrite() with the GIL released if the file has a file descriptor.
+ * This returns the number of bytes written.
+ *
+ * Python signature:
+ *
+ * def pwrite_python_file(file_object: typing.IO, data: bytes, offset: int) -> int:
+ */
+static PyObject *
+pwrite_python_file(PyObject *Py_UNUSED(module), PyObject *args, PyObject *kwds) {
+    assert(!PyErr_Occurred());
+    static const char *kwlist[] = {"file_object", "data", "offset", NULL};
+    PyObject *py_file_object = NULL;
+    Py_buffer c_buffer;
+    Py_ssize_t offset = 0;
+    PyObject *ret = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "Oy*n", (char **) (kwlist),
+                                     &py_file_object, &c_buffer, &offset)) {
+        return NULL;
+    }
+    try {
+        PythonFileObjectWrapper py_file_wrapper(py_file_object);
+        Py_ssize_t count = py_file_wrapper.pwrite((const char *) c_buffer.buf, c_buffer.len, offset);
+        if (count >= 0) {
+            ret = PyLong_FromSsize_t(count);
+        }
+    } catch (ExceptionPythonFileObjectWrapper &err) {
+        if (!PyErr_Occurred()) {
+            PyErr_SetString(PyExc_ValueError, err.what());
+        }
+    }
+    PyBuffer_Release(&c_buffer);
+    return ret;
+}
+
+/**
+ * Reads the lines of a Python file with std::getline() on a std::istream over a PythonFileStreamBuf.
+ * The lines do not include the trailing newline.
+ *
+ * Python signature:
+ *
+ * def read_lines_via_streambuf(file_object: typing.IO, buffer_size: int = 65536) -> typing.List[bytes]:
+ */
+static PyObject *
+read_lines_via_streambuf(PyObject *Py_UNUSED(module), PyObject *args, PyObject *kwds) {
+    assert(!PyErr_Occurred());
+    static const char *kwlist[] = {"file_object", "buffer_size", NULL};
+    PyObject *py_file_object = NULL;
+    Py_ssize_t buffer_size = PythonFileStreamBuf::DEFAULT_BUFFER_SIZE;
+    PyObject *ret = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|n", (char **) (kwlist), &py_file_object, &buffer_size)) {
+        return NULL;
+    }
+    if (buffer_size <= 0) {
+        PyErr_Format(PyExc_ValueError, "buffer_size must be > 0 not %zd.", buffer_size);
+        return NULL;
+    }
+    ret = PyList_New(0);
+    if (!ret) {
+        return NULL;
+    }
+    try {
+        PythonFileStreamBuf stream_buf(py_file_object, (size_t) buffer_size);
+        std::istream is(&stream_buf);
+        std::string line;
+        while (std::getline(is, line)) {
+            PyObject *py_line = PyBytes_FromStringAndSize(line.data(), line.size());
+            if (!py_line || PyList_Append(ret, py_line)) {
+                Py_XDECREF(py_line);
+                Py_DECREF(ret);
+                return NULL;
+            }
+            Py_DECREF(py_line);
+        }
+        if (stream_buf.has_error()) {
+            Py_DECREF(ret);
+            return NULL;
+        }
+    } catch (ExceptionPythonFileObjectWrapper &err) {
+        Py_DECREF(ret);
+        if (!PyErr_Occurred()) {
+            PyErr_SetString(PyExc_ValueError, err.what());
+        }
+        return NULL;
+    }
+    return ret;
+}
+
+/**
+ * Parses a Python file of whitespace separated integers with operator>>() on a std::istream over a
+ * PythonFileStreamBuf and returns their sum.
+ * This is typical C++ parsing code that makes many small reads from the stream.
+ *
+ * Python signature:
+ *
+ * def sum_integers_via_streambuf(file_object: typing.IO, buffer_size: int = 65536) -> int:
+ */
+static PyObject *
+sum_integers_via_streambuf(PyObject *Py_UNUSED(module), PyObject *args, PyObject *kwds) {
+    assert(!PyErr_Occurred());
+    static const char *kwlist[] = {"file_object", "buffer_size", NULL};
+    PyObject *py_file_object = NULL;
+    Py_ssize_t buffer_size = PythonFileStreamBuf::DEFAULT_BUFFER_SIZE;
+    long long total = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|n", (char **) (kwlist), &py_file_object, &buffer_size)) {
+        return NULL;
+    }
+    if (buffer_size <= 0) {
+        PyErr_Format(PyExc_ValueError, "buffer_size must be > 0 not %zd.", buffer_size);
+        return NULL;
+    }
+    try {
+        PythonFileStreamBuf stream_buf(py_file_object, (size_t) buffer_size);
+        std::istream is(&stream_buf);
+        long long value;
+        while (is >> value) {
+            total += value;
+        }
+        if (stream_buf.has_error()) {
+            return NULL;
+        }
+        if (!is.eof()) {
+            PyErr_SetString(PyExc_ValueError, "Can not parse an integer from the file.");
+            return NULL;
+        }
+    } catch (ExceptionPythonFileObjectWrapper &err) {
+        if (!PyErr_Occurred()) {
+            PyErr_SetString(PyExc_ValueError, err.what());
+        }
+        return NULL;
+    }
+    return PyLong_FromLongLong(total);
+}
+
+/**
+ * Writes each bytes object followed by a newline to a Python file with a std::ostream over a PythonFileStreamBuf.
+ * This returns the number of bytes written.
+ *
+ * Python signature:
+ *
+ * def write_lines_via_streambuf(file_object: typing.IO, lines: typing.Sequence[bytes],
+ *                               buffer_size: int = 65536) -> int:
+ */
+static PyObject *
+write_lines_via_streambuf(PyObject *Py_UNUSED(module), PyObject *args, PyObject *kwds) {
+    assert(!PyErr_Occurred());
+    static const char *kwlist[] = {"file_object", "lines", "buffer_size", NULL};
+    PyObject *py_file_object = NULL;
+    PyObject *py_lines = NULL;
+    Py_ssize_t buffer_size = PythonFileStreamBuf::DEFAULT_BUFFER_SIZE;
+    PyObject *py_lines_fast = NULL;
+    Py_ssize_t total = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO|n", (char **) (kwlist),
+                                     &py_file_object, &py_lines, &buffer_size)) {
+        return NULL;
+    }
+    if (buffer_size <= 0) {
+        PyErr_Format(PyExc_ValueError, "buffer_size must be > 0 not %zd.", buffer_size);
+        return NULL;
+    }
+    py_lines_fast = PySequence_Fast(py_lines, "lines must be a sequence of bytes.");
+    if (!py_lines_fast) {
+        return NULL;
+    }
+    try {
+        PythonFileStreamBuf stream_buf(py_file_object, (size_t) buffer_size);
+        std::ostream os(&stream_buf);
+        for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(py_lines_fast); ++i) {
+            char *line;
+            Py_ssize_t size;
+            if (PyBytes_AsStringAndSize(PySequence_Fast_GET_ITEM(py_lines_fast, i), &line, &size)) {
+                Py_DECREF(py_lines_fast);
+                return NULL;
+            }
+            os.write(line, size) << '\n';
+            total += size + 1;
+        }
+        os.flush();
+        if (stream_buf.has_error() || !os) {
+            if (!PyErr_Occurred()) {
+                PyErr_SetString(PyExc_IOError, "Can not write to the file.");
+            }
+            Py_DECREF(py_lines_fast);
+            return NULL;
+        }
+    } catch (ExceptionPythonFileObjectWrapper &err) {
+        Py_DECREF(py_lines_fast);
+        if (!PyErr_Occurred()) {
+            PyErr_SetString(PyExc_ValueError, err.what());
+        }
+        return NULL;
+    }
+    Py_DECREF(py_lines_fast);
+    return PyLong_FromSsize_t(total);
+}
+
 #if 0
 /**
  * Returns an integer file descriptor from a Python file object.
@@ -252,6 +745,459 @@ PyObject *c_file_path_as_python_file(const char *filename, const char *mode) {
 }
 #endif
 
+#if CFILE_HAS_MMAP
+/****************** MappedFile: a memory mapped file. ****************/
+
+/**
+ * A file, or part of a file, mapped into memory and exposed through the buffer protocol.
+ * Slicing returns a memoryview of the mapping so does not copy.
+ */
+typedef struct {
+    PyObject_HEAD
+    /* The start of the mapping, page aligned, NULL if there is no mapping. */
+    char *map_base;
+    /* The size of the whole mapping. */
+    size_t map_size;
+    /* The start of the requested data within the mapping, the offset may not be page aligned. */
+    char *data;
+    Py_ssize_t size;
+    /* The offset in the file of data. */
+    Py_ssize_t offset;
+    char readonly;
+    /* Non-zero if huge pages have been requested successfully. */
+    char huge_pages;
+    char closed;
+    /* Number of outstanding buffer exports, while this is non-zero the file can not be closed. */
+    Py_ssize_t exports;
+} MappedFileObject;
+
+/* The data of a mapping of zero bytes, mmap() can not map zero bytes. */
+static char g_mapped_file_empty[1];
+
+static Py_ssize_t
+mapped_file_page_size(void) {
+    static Py_ssize_t page_size = 0;
+    if (!page_size) {
+        page_size = (Py_ssize_t) sysconf(_SC_PAGESIZE);
+    }
+    return page_size;
+}
+
+/* Returns non-zero with a ValueError set if the file is closed. */
+static int
+MappedFile_check_open(MappedFileObject *self) {
+    if (self->closed) {
+        PyErr_SetString(PyExc_ValueError, "I/O operation on a closed MappedFile.");
+        return -1;
+    }
+    return 0;
+}
+
+/* Unmap any mapping, the caller must check that there are no exports. */
+static void
+MappedFile_unmap(MappedFileObject *self) {
+    assert(self->exports == 0);
+    if (self->map_base) {
+        munmap(self->map_base, self->map_size);
+    }
+    self->map_base = NULL;
+    self->map_size = 0;
+    self->data = g_mapped_file_empty;
+    self->size = 0;
+    self->closed = 1;
+}
+
+static PyObject *
+MappedFile_new(PyTypeObject *type, PyObject *Py_UNUSED(args), PyObject *Py_UNUSED(kwds)) {
+    MappedFileObject *self = (MappedFileObject *) type->tp_alloc(type, 0);
+    if (self) {
+        self->map_base = NULL;
+        self->map_size = 0;
+        self->data = g_mapped_file_empty;
+        self->size = 0;
+        self->offset = 0;
+        self->readonly = 1;
+        self->huge_pages = 0;
+        self->closed = 1;
+        self->exports = 0;
+    }
+    return (PyObject *) self;
+}
+
+/**
+ * Python signature:
+ *
+ * MappedFile(path: typing.Union[str, bytes, pathlib.Path], writable: bool = False, offset: int = 0, length: int = -1,
+ *            huge_pages: bool = False)
+ */
+static int
+MappedFile_init(MappedFileObject *self, PyObject *args, PyObject *kwds) {
+    static const char *kwlist[] = {"path", "writable", "offset", "length", "huge_pages", NULL};
+    PyObject *py_path = NULL;
+    int writable = 0;
+    Py_ssize_t offset = 0;
+    Py_ssize_t length = -1;
+    int huge_pages = 0;
+    const char *c_path;
+    int fd = -1;
+    int error_number = 0;
+    struct stat file_stat;
+    Py_ssize_t file_size;
+    Py_ssize_t aligned_offset;
+    size_t map_size;
+    void *map_base = NULL;
+    int ret = -1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&|pnnp", const_cast<char **>(kwlist), PyUnicode_FSConverter,
+                                     &py_path, &writable, &offset, &length, &huge_pages)) {
+        goto except;
+    }
+    if (self->exports) {
+        PyErr_SetString(PyExc_BufferError, "Can not re-initialise a MappedFile whilst a buffer is exported.");
+        goto except;
+    }
+    MappedFile_unmap(self);
+    if (offset < 0) {
+        PyErr_Format(PyExc_ValueError, "offset must be >= 0 not %zd.", offset);
+        goto except;
+    }
+    c_path = PyBytes_AsString(py_path);
+    Py_BEGIN_ALLOW_THREADS
+        fd = open(c_path, (writable ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+        if (fd < 0 || fstat(fd, &file_stat)) {
+            error_number = errno;
+        }
+    Py_END_ALLOW_THREADS
+    if (error_number) {
+        errno = error_number;
+        PyErr_SetFromErrnoWithFilename(PyExc_OSError, c_path);
+        goto except;
+    }
+    file_size = (Py_ssize_t) file_stat.st_size;
+    if (offset > file_size) {
+        PyErr_Format(PyExc_ValueError, "offset %zd is beyond the end of the file of %zd bytes.", offset, file_size);
+        goto except;
+    }
+    if (length < 0) {
+        length = file_size - offset;
+    } else if (length > file_size - offset) {
+        PyErr_Format(PyExc_ValueError, "length %zd from offset %zd is beyond the end of the file of %zd bytes.",
+                     length, offset, file_size);
+        goto except;
+    }
+    self->readonly = writable ? 0 : 1;
+    self->offset = offset;
+    self->huge_pages = 0;
+    if (length > 0) {
+        /* mmap() needs a page aligned offset. */
+        aligned_offset = offset - offset % mapped_file_page_size();
+        map_size = (size_t) (length + offset - aligned_offset);
+        Py_BEGIN_ALLOW_THREADS
+            map_base = mmap(NULL, map_size, PROT_READ | (writable ? PROT_WRITE : 0), MAP_SHARED, fd,
+                            (off_t) aligned_offset);
+            error_number = errno;
+        Py_END_ALLOW_THREADS
+        if (map_base == MAP_FAILED) {
+            errno = error_number;
+            PyErr_SetFromErrnoWithFilename(PyExc_OSError, c_path);
+            goto except;
+        }
+        self->map_base = (char *) map_base;
+        self->map_size = map_size;
+        self->data = self->map_base + (offset - aligned_offset);
+        self->size = length;
+        if (huge_pages) {
+#ifdef MADV_HUGEPAGE
+            /* Transparent huge pages, this is a hint that the kernel may ignore.
+             * Files on a hugetlbfs mount always use huge pages. */
+            self->huge_pages = madvise(self->map_base, self->map_size, MADV_HUGEPAGE) == 0;
+#endif
+        }
+    }
+    self->closed = 0;
+    ret = 0;
+    goto finally;
+except:
+    assert(PyErr_Occurred());
+    ret = -1;
+finally:
+    /* The mapping does not need the file to be open. */
+    if (fd >= 0) {
+        close(fd);
+    }
+    Py_XDECREF(py_path);
+    return ret;
+}
+
+static void
+MappedFile_dealloc(MappedFileObject *self) {
+    MappedFile_unmap(self);
+    Py_TYPE(self)->tp_free((PyObject *) self);
+}
+
+static PyObject *
+MappedFile_close(MappedFileObject *self, PyObject *Py_UNUSED(ignored)) {
+    if (self->exports) {
+        PyErr_SetString(PyExc_BufferError, "Can not close a MappedFile whilst a buffer is exported.");
+        return NULL;
+    }
+    MappedFile_unmap(self);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+MappedFile_enter(MappedFileObject *self, PyObject *Py_UNUSED(ignored)) {
+    if (MappedFile_check_open(self)) {
+        return NULL;
+    }
+    Py_INCREF(self);
+    return (PyObject *) self;
+}
+
+static PyObject *
+MappedFile_exit(MappedFileObject *self, PyObject *Py_UNUSED(args)) {
+    PyObject *result = MappedFile_close(self, NULL);
+    if (!result) {
+        return NULL;
+    }
+    Py_DECREF(result);
+    Py_RETURN_FALSE;
+}
+
+/**
+ * Converts start and length, relative to the data, to a page aligned address and length for madvise() and msync().
+ * The length is zero if there is nothing to do, for example an empty file where there is no mapping and the data is
+ * not in any page that we own.
+ * Returns non-zero with a ValueError set if they are out of range.
+ */
+static int
+MappedFile_page_range(MappedFileObject *self, Py_ssize_t start, Py_ssize_t length, char **p_address,
+                      size_t *p_length) {
+    if (start < 0 || start > self->size) {
+        PyErr_Format(PyExc_ValueError, "start must be 0 to %zd not %zd.", self->size, start);
+        return -1;
+    }
+    if (length < 0) {
+        length = self->size - start;
+    } else if (length > self->size - start) {
+        PyErr_Format(PyExc_ValueError, "length must be 0 to %zd not %zd.", self->size - start, length);
+        return -2;
+    }
+    if (self->map_base == NULL || length == 0) {
+        *p_address = self->map_base;
+        *p_length = 0;
+        return 0;
+    }
+    char *address = self->data + start;
+    char *aligned = self->map_base + (address - self->map_base) / mapped_file_page_size() * mapped_file_page_size();
+    *p_address = aligned;
+    *p_length = (size_t) (length + (address - aligned));
+    return 0;
+}
+
+/**
+ * Give the kernel a hint about how the mapping will be accessed, advice is one of cFile.MADV_NORMAL,
+ * cFile.MADV_SEQUENTIAL, cFile.MADV_RANDOM, cFile.MADV_WILLNEED or cFile.MADV_DONTNEED.
+ *
+ * Python signature:
+ *
+ * def madvise(self, advice: int, start: int = 0, length: int = -1) -> None:
+ */
+static PyObject *
+MappedFile_madvise(MappedFileObject *self, PyObject *args, PyObject *kwds) {
+    static const char *kwlist[] = {"advice", "start", "length", NULL};
+    int advice;
+    Py_ssize_t start = 0;
+    Py_ssize_t length = -1;
+    char *address;
+    size_t page_length;
+    int result = 0;
+    int error_number = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "i|nn", const_cast<char **>(kwlist), &advice, &start, &length)) {
+        return NULL;
+    }
+    if (MappedFile_check_open(self) || MappedFile_page_range(self, start, length, &address, &page_length)) {
+        return NULL;
+    }
+    if (page_length == 0) {
+        Py_RETURN_NONE;
+    }
+    Py_BEGIN_ALLOW_THREADS
+        result = madvise(address, page_length, advice);
+        error_number = errno;
+    Py_END_ALLOW_THREADS
+    if (result) {
+        errno = error_number;
+        return PyErr_SetFromErrno(PyExc_OSError);
+    }
+    Py_RETURN_NONE;
+}
+
+/**
+ * Write any changes to a writable mapping back to the file.
+ *
+ * Python signature:
+ *
+ * def flush(self, start: int = 0, length: int = -1) -> None:
+ */
+static PyObject *
+MappedFile_flush(MappedFileObject *self, PyObject *args, PyObject *kwds) {
+    static const char *kwlist[] = {"start", "length", NULL};
+    Py_ssize_t start = 0;
+    Py_ssize_t length = -1;
+    char *address;
+    size_t page_length;
+    int result = 0;
+    int error_number = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|nn", const_cast<char **>(kwlist), &start, &length)) {
+        return NULL;
+    }
+    if (MappedFile_check_open(self) || MappedFile_page_range(self, start, length, &address, &page_length)) {
+        return NULL;
+    }
+    if (self->readonly || page_length == 0) {
+        Py_RETURN_NONE;
+    }
+    Py_BEGIN_ALLOW_THREADS
+        result = msync(address, page_length, MS_SYNC);
+        error_number = errno;
+    Py_END_ALLOW_THREADS
+    if (result) {
+        errno = error_number;
+        return PyErr_SetFromErrno(PyExc_OSError);
+    }
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef MappedFile_methods[] = {
+        {
+                "close",
+                (PyCFunction) MappedFile_close,
+                METH_NOARGS,
+                "Unmap the file. This raises a BufferError if a buffer, such as a slice, is still exported."
+        },
+        {
+                "madvise",
+                (PyCFunction) MappedFile_madvise,
+                METH_VARARGS | METH_KEYWORDS,
+                "madvise(advice, start=0, length=-1) gives the kernel a hint about how the mapping will be accessed."
+        },
+        {
+                "flush",
+                (PyCFunction) MappedFile_flush,
+                METH_VARARGS | METH_KEYWORDS,
+                "flush(start=0, length=-1) writes changes to a writable mapping back to the file."
+        },
+        {"__enter__", (PyCFunction) MappedFile_enter, METH_NOARGS, "Enter the context manager."},
+        {"__exit__", (PyCFunction) MappedFile_exit, METH_VARARGS, "Exit the context manager, this closes the file."},
+        {NULL, NULL, 0, NULL}  /* Sentinel */
+};
+
+static PyMemberDef MappedFile_members[] = {
+        {"offset", T_PYSSIZET, offsetof(MappedFileObject, offset), READONLY, "The offset of the mapping in the file."},
+        {"readonly", T_BOOL, offsetof(MappedFileObject, readonly), READONLY, "True if the mapping is read only."},
+        {"huge_pages", T_BOOL, offsetof(MappedFileObject, huge_pages), READONLY,
+         "True if huge pages were requested and accepted."},
+        {"closed", T_BOOL, offsetof(MappedFileObject, closed), READONLY, "True if the file is closed."},
+        {NULL, 0, 0, 0, NULL}  /* Sentinel */
+};
+
+static Py_ssize_t
+MappedFile_mp_length(MappedFileObject *self) {
+    if (MappedFile_check_open(self)) {
+        return -1;
+    }
+    return self->size;
+}
+
+/* An integer index returns an int, a slice returns a memoryview of the mapping. */
+static PyObject *
+MappedFile_mp_subscript(MappedFileObject *self, PyObject *key) {
+    if (MappedFile_check_open(self)) {
+        return NULL;
+    }
+    if (PyIndex_Check(key)) {
+        Py_ssize_t index = PyNumber_AsSsize_t(key, PyExc_IndexError);
+        if (index == -1 && PyErr_Occurred()) {
+            return NULL;
+        }
+        if (index < 0) {
+            index += self->size;
+        }
+        if (index < 0 || index >= self->size) {
+            PyErr_SetString(PyExc_IndexError, "MappedFile index out of range.");
+            return NULL;
+        }
+        return PyLong_FromLong((unsigned char) self->data[index]);
+    }
+    if (PySlice_Check(key)) {
+        /* The memoryview has a buffer export so the file can not be closed while the slice exists. */
+        PyObject *memory_view = PyMemoryView_FromObject((PyObject *) self);
+        if (!memory_view) {
+            return NULL;
+        }
+        PyObject *ret = PyObject_GetItem(memory_view, key);
+        Py_DECREF(memory_view);
+        return ret;
+    }
+    PyErr_Format(PyExc_TypeError, "MappedFile indices must be integers or slices, not %s.", Py_TYPE(key)->tp_name);
+    return NULL;
+}
+
+static PyMappingMethods MappedFile_mapping_methods = {
+        .mp_length = (lenfunc) MappedFile_mp_length,
+        .mp_subscript = (binaryfunc) MappedFile_mp_subscript,
+        .mp_ass_subscript = NULL,
+};
+
+static int
+MappedFile_bf_getbuffer(MappedFileObject *self, Py_buffer *view, int flags) {
+    if (MappedFile_check_open(self)) {
+        view->obj = NULL;
+        return -1;
+    }
+    if (PyBuffer_FillInfo(view, (PyObject *) self, self->data, self->size, self->readonly, flags)) {
+        return -1;
+    }
+    self->exports++;
+    return 0;
+}
+
+static void
+MappedFile_bf_releasebuffer(MappedFileObject *self, Py_buffer *Py_UNUSED(view)) {
+    assert(self->exports > 0);
+    self->exports--;
+}
+
+static PyBufferProcs MappedFile_buffer_procs = {
+        .bf_getbuffer = (getbufferproc) MappedFile_bf_getbuffer,
+        .bf_releasebuffer = (releasebufferproc) MappedFile_bf_releasebuffer,
+};
+
+static PyTypeObject MappedFileType = {
+        PyVarObject_HEAD_INIT(NULL, 0)
+        .tp_name = "cPyExtPatt.cFile.MappedFile",
+        .tp_basicsize = sizeof(MappedFileObject),
+        .tp_itemsize = 0,
+        .tp_dealloc = (destructor) MappedFile_dealloc,
+        .tp_as_mapping = &MappedFile_mapping_methods,
+        .tp_as_buffer = &MappedFile_buffer_procs,
+        .tp_flags = Py_TPFLAGS_DEFAULT,
+        .tp_doc = PyDoc_STR(
+                "MappedFile(path, writable=False, offset=0, length=-1, huge_pages=False) maps a file into memory.\n"
+                "The mapping supports the buffer protocol and slicing returns a memoryview without copying."
+        ),
+        .tp_methods = MappedFile_methods,
+        .tp_members = MappedFile_members,
+        .tp_init = (initproc) MappedFile_init,
+        .tp_new = MappedFile_new,
+};
+
+/****************** END: MappedFile. ****************/
+#endif // CFILE_HAS_MMAP
+
 static PyMethodDef cFile_methods[] = {
         {
                 "parse_filesystem_argument",
@@ -265,6 +1211,12 @@ static PyMethodDef cFile_methods[] = {
                 METH_VARARGS | METH_KEYWORDS,
                 "Read n bytes from a Python file."
         },
+        {
+                "read_python_file_to_c_fastcall",
+                (PyCFunction) (void (*)(void)) read_python_file_to_c_fastcall,
+                METH_FASTCALL | METH_KEYWORDS,
+                "Read n bytes from a Python file, this uses METH_FASTCALL."
+        },
         {
                 "write_bytes_to_python_file",
                 (PyCFunction) write_bytes_to_python_file,
@@ -277,6 +1229,48 @@ static PyMethodDef cFile_methods[] = {
                 METH_VARARGS | METH_KEYWORDS,
                 "Wrap a Python file."
         },
+        {
+                "read_python_file_via_wrapper",
+                (PyCFunction) read_python_file_via_wrapper,
+                METH_VARARGS | METH_KEYWORDS,
+                "Read the whole of a Python file in chunks through the C++ wrapper."
+        },
+        {
+                "pread_python_file",
+                (PyCFunction) pread_python_file,
+                METH_VARARGS | METH_KEYWORDS,
+                "Read bytes at an offset from a Python file without changing its position."
+        },
+        {
+                "preadv_python_file",
+                (PyCFunction) preadv_python_file,
+                METH_VARARGS | METH_KEYWORDS,
+                "Read consecutive blocks at an offset from a Python file without changing its position."
+        },
+        {
+                "pwrite_python_file",
+                (PyCFunction) pwrite_python_file,
+                METH_VARARGS | METH_KEYWORDS,
+                "Write bytes at an offset to a Python file without changing its position."
+        },
+        {
+                "read_lines_via_streambuf",
+                (PyCFunction) read_lines_via_streambuf,
+                METH_VARARGS | METH_KEYWORDS,
+                "Read the lines of a Python file with a C++ std::istream."
+        },
+        {
+                "sum_integers_via_streambuf",
+                (PyCFunction) sum_integers_via_streambuf,
+                METH_VARARGS | METH_KEYWORDS,
+                "Sum the integers in a Python file parsed with a C++ std::istream."
+        },
+        {
+                "write_lines_via_streambuf",
+                (PyCFunction) write_lines_via_streambuf,
+                METH_VARARGS | METH_KEYWORDS,
+                "Write lines to a Python file with a C++ std::ostream."
+        },
         {
                 NULL,
                 NULL,
@@ -298,6 +1292,37 @@ static PyModuleDef cFile_module = {
 };
 
 PyMODINIT_FUNC PyInit_cFile(void) {
-    return PyModule_Create(&cFile_module);
+    PyObject *m = NULL;
+
+    if (py_fastcall_parser_init(&read_python_file_to_c_fastcall_parser)) {
+        return NULL;
+    }
+    m = PyModule_Create(&cFile_module);
+    if (!m) {
+        return NULL;
+    }
+#if CFILE_HAS_MMAP
+    if (PyType_Ready(&MappedFileType) < 0) {
+        goto except;
+    }
+    Py_INCREF(&MappedFileType);
+    if (PyModule_AddObject(m, "MappedFile", (PyObject *) &MappedFileType) < 0) {
+        Py_DECREF(&MappedFileType);
+        goto except;
+    }
+    if (PyModule_AddIntConstant(m, "MADV_NORMAL", MADV_NORMAL)
+        || PyModule_AddIntConstant(m, "MADV_SEQUENTIAL", MADV_SEQUENTIAL)
+        || PyModule_AddIntConstant(m, "MADV_RANDOM", MADV_RANDOM)
+        || PyModule_AddIntConstant(m, "MADV_WILLNEED", MADV_WILLNEED)
+        || PyModule_AddIntConstant(m, "MADV_DONTNEED", MADV_DONTNEED)) {
+        goto except;
+    }
+#endif
+    return m;
+#if CFILE_HAS_MMAP
+except:
+    Py_DECREF(m);
+    return NULL;
+#endif
 }
 /****************** END: Parsing arguments. ****************/
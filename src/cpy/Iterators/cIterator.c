@@ -8,12 +8,122 @@
 #include <Python.h>
 #include "structmember.h"
 
+#include "py_long_array.h"
+#include "py_fastcall_args.h"
+
+/* The maximum number of distinct values that the interning cache will hold. */
+#define LONG_INTERN_CACHE_MAX_SIZE (1 << 16)
+
+/**
+ * An open addressing hash table of C long to boxed Python int.
+ * This allows low cardinality data to be boxed without allocating a new PyLong for every value.
+ * The table holds a strong reference to each value.
+ */
+typedef struct {
+    long *keys;
+    /* NULL for an empty slot. */
+    PyObject **values;
+    /* Zero or a power of two. */
+    Py_ssize_t capacity;
+    Py_ssize_t size;
+    Py_ssize_t hits;
+    Py_ssize_t misses;
+} LongInternCache;
+
 typedef struct {
     PyObject_HEAD
     long *array_long;
     ssize_t size;
+    /* If non-zero values are boxed through the cache. */
+    int intern;
+    LongInternCache cache;
 } SequenceOfLong;
 
+static void
+long_intern_cache_clear(LongInternCache *cache) {
+    for (Py_ssize_t i = 0; i < cache->capacity; ++i) {
+        Py_XDECREF(cache->values[i]);
+    }
+    PyMem_Free(cache->keys);
+    PyMem_Free(cache->values);
+    memset(cache, 0, sizeof(LongInternCache));
+}
+
+static size_t
+long_intern_cache_slot(const LongInternCache *cache, long key) {
+    /* Fibonacci hashing, the mask then takes the well mixed high bits. */
+    unsigned long long hash = (unsigned long long) key * 0x9E3779B97F4A7C15ULL;
+    size_t mask = (size_t) cache->capacity - 1;
+    size_t slot = (size_t) (hash >> 32) & mask;
+    while (cache->values[slot] && cache->keys[slot] != key) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/* Double the capacity. Returns 0 on success, -1 if the memory can not be allocated (no exception is set). */
+static int
+long_intern_cache_grow(LongInternCache *cache) {
+    LongInternCache new_cache = *cache;
+    new_cache.capacity = cache->capacity ? cache->capacity * 2 : 16;
+    new_cache.keys = PyMem_Malloc(new_cache.capacity * sizeof(long));
+    new_cache.values = PyMem_Calloc(new_cache.capacity, sizeof(PyObject *));
+    if (!new_cache.keys || !new_cache.values) {
+        PyMem_Free(new_cache.keys);
+        PyMem_Free(new_cache.values);
+        return -1;
+    }
+    for (Py_ssize_t i = 0; i < cache->capacity; ++i) {
+        if (cache->values[i]) {
+            size_t slot = long_intern_cache_slot(&new_cache, cache->keys[i]);
+            new_cache.keys[slot] = cache->keys[i];
+            new_cache.values[slot] = cache->values[i];
+        }
+    }
+    PyMem_Free(cache->keys);
+    PyMem_Free(cache->values);
+    *cache = new_cache;
+    return 0;
+}
+
+/**
+ * Return a new reference to a Python int for the value, from the cache if possible.
+ * On a miss the new int is added to the cache unless it is full.
+ */
+static PyObject *
+long_intern_cache_box(LongInternCache *cache, long value) {
+    if (cache->capacity) {
+        size_t slot = long_intern_cache_slot(cache, value);
+        if (cache->values[slot]) {
+            cache->hits++;
+            Py_INCREF(cache->values[slot]);
+            return cache->values[slot];
+        }
+    }
+    cache->misses++;
+    PyObject *ret = PyLong_FromLong(value);
+    if (ret && cache->size < LONG_INTERN_CACHE_MAX_SIZE) {
+        /* Keep the load factor <= 0.5. A failure to grow just means that this value is not cached. */
+        if ((cache->size + 1) * 2 <= cache->capacity || long_intern_cache_grow(cache) == 0) {
+            size_t slot = long_intern_cache_slot(cache, value);
+            cache->keys[slot] = value;
+            Py_INCREF(ret);
+            cache->values[slot] = ret;
+            cache->size++;
+        }
+    }
+    return ret;
+}
+
+/* Box a value from the sequence, interned if the sequence has interning enabled. */
+static PyObject *
+SequenceOfLong_box(SequenceOfLong *self, long value) {
+    if (self->intern) {
+        return long_intern_cache_box(&self->cache, value);
+    }
+    return PyLong_FromLong(value);
+}
+
 typedef struct {
     PyObject_HEAD
     PyObject *sequence;
@@ -64,11 +174,27 @@ SequenceOfLongIterator_dealloc(SequenceOfLongIterator *self) {
     Py_TYPE(self)->tp_free((PyObject *) self);
 }
 
+/* An iterator created with SequenceOfLongIterator.__new__() and not initialised has no sequence.
+ * Returns non-zero and sets a ValueError if so. */
+static int
+SequenceOfLongIterator_check_sequence(SequenceOfLongIterator *self) {
+    if (!self->sequence) {
+        PyErr_SetString(PyExc_ValueError, "SequenceOfLongIterator has no sequence, it has not been initialised.");
+        return -1;
+    }
+    return 0;
+}
+
 static PyObject *
 SequenceOfLongIterator_next(SequenceOfLongIterator *self) {
+    if (SequenceOfLongIterator_check_sequence(self)) {
+        return NULL;
+    }
     size_t size = ((SequenceOfLong *) self->sequence)->size;
     if (self->index < size) {
-        PyObject *ret = PyLong_FromLong(((SequenceOfLong *) self->sequence)->array_long[self->index]);
+        PyObject *ret = SequenceOfLong_box(
+                (SequenceOfLong *) self->sequence, ((SequenceOfLong *) self->sequence)->array_long[self->index]
+        );
         self->index += 1;
         return ret;
     }
@@ -92,9 +218,194 @@ SequenceOfLongIterator___str__(SequenceOfLongIterator *self, PyObject *Py_UNUSED
     }
 }
 
+/**
+ * Create a read only memoryview of format 'l' of up to count values from the current position and advance the
+ * position past them. This is a copy so it remains valid if the sequence is re-initialised.
+ * At the end of the sequence this returns an empty memoryview.
+ */
+static PyObject *
+SequenceOfLongIterator_chunk(SequenceOfLongIterator *self, Py_ssize_t count) {
+    SequenceOfLong *sequence = (SequenceOfLong *) self->sequence;
+    PyObject *bytes = NULL;
+    PyObject *view = NULL;
+    PyObject *ret = NULL;
+    Py_ssize_t remaining = 0;
+
+    if (SequenceOfLongIterator_check_sequence(self)) {
+        goto except;
+    }
+    if (self->index < (size_t) sequence->size) {
+        remaining = sequence->size - (Py_ssize_t) self->index;
+    }
+    if (count > remaining) {
+        count = remaining;
+    }
+    bytes = PyBytes_FromStringAndSize(NULL, count * (Py_ssize_t) sizeof(long));
+    if (!bytes) {
+        goto except;
+    }
+    if (count) {
+        memcpy(PyBytes_AS_STRING(bytes), sequence->array_long + self->index, count * sizeof(long));
+    }
+    view = PyMemoryView_FromObject(bytes);
+    if (!view) {
+        goto except;
+    }
+    ret = PyObject_CallMethod(view, "cast", "s", "l");
+    if (!ret) {
+        goto except;
+    }
+    self->index += count;
+    goto finally;
+except:
+    assert(PyErr_Occurred());
+    Py_XDECREF(ret);
+    ret = NULL;
+finally:
+    Py_XDECREF(view);
+    Py_XDECREF(bytes);
+    return ret;
+}
+
+static PyObject *
+SequenceOfLongIterator_next_chunk(SequenceOfLongIterator *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"n", NULL};
+    Py_ssize_t count = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "n", kwlist, &count)) {
+        return NULL;
+    }
+    if (count <= 0) {
+        PyErr_Format(PyExc_ValueError, "Chunk size must be > 0 not %zd", count);
+        return NULL;
+    }
+    return SequenceOfLongIterator_chunk(self, count);
+}
+
+/**
+ * An iterator that yields chunks from a SequenceOfLongIterator.
+ * This shares the position of the underlying iterator.
+ */
+typedef struct {
+    PyObject_HEAD
+    SequenceOfLongIterator *iterator;
+    Py_ssize_t chunk_size;
+} SequenceOfLongChunks;
+
+static void
+SequenceOfLongChunks_dealloc(SequenceOfLongChunks *self) {
+    Py_XDECREF(self->iterator);
+    Py_TYPE(self)->tp_free((PyObject *) self);
+}
+
+static PyObject *
+SequenceOfLongChunks_next(SequenceOfLongChunks *self) {
+    PyObject *ret = SequenceOfLongIterator_chunk(self->iterator, self->chunk_size);
+    if (ret && PyObject_Length(ret) == 0) {
+        /* End iteration. */
+        Py_DECREF(ret);
+        ret = NULL;
+    }
+    return ret;
+}
+
+static PyTypeObject SequenceOfLongChunksType = {
+        PyVarObject_HEAD_INIT(NULL, 0)
+        .tp_name = "cPyExtPatt.Iterators.cIterator.SequenceOfLongChunks",
+        .tp_basicsize = sizeof(SequenceOfLongChunks),
+        .tp_itemsize = 0,
+        .tp_dealloc = (destructor) SequenceOfLongChunks_dealloc,
+        .tp_flags = Py_TPFLAGS_DEFAULT,
+        .tp_doc = "Iterator of chunks from a SequenceOfLongIterator.",
+        .tp_iter = PyObject_SelfIter,
+        .tp_iternext = (iternextfunc) SequenceOfLongChunks_next,
+};
+
+static PyObject *
+SequenceOfLongIterator_chunks(SequenceOfLongIterator *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"size", NULL};
+    Py_ssize_t chunk_size = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "n", kwlist, &chunk_size)) {
+        return NULL;
+    }
+    if (chunk_size <= 0) {
+        PyErr_Format(PyExc_ValueError, "Chunk size must be > 0 not %zd", chunk_size);
+        return NULL;
+    }
+    SequenceOfLongChunks *ret = PyObject_New(SequenceOfLongChunks, &SequenceOfLongChunksType);
+    if (ret) {
+        Py_INCREF(self);
+        ret->iterator = self;
+        ret->chunk_size = chunk_size;
+    }
+    return (PyObject *) ret;
+}
+
+static PyObject *
+SequenceOfLongIterator___length_hint__(SequenceOfLongIterator *self, PyObject *Py_UNUSED(ignored)) {
+    if (!self->sequence) {
+        return PyLong_FromLong(0);
+    }
+    Py_ssize_t size = ((SequenceOfLong *) self->sequence)->size;
+    if (self->index < (size_t) size) {
+        return PyLong_FromSsize_t(size - (Py_ssize_t) self->index);
+    }
+    return PyLong_FromLong(0);
+}
+
+/* Pickling support, this is (type, (sequence,), index) so that an iterator can be checkpointed mid-stream. */
+static PyObject *
+SequenceOfLongIterator___reduce__(SequenceOfLongIterator *self, PyObject *Py_UNUSED(ignored)) {
+    if (SequenceOfLongIterator_check_sequence(self)) {
+        return NULL;
+    }
+    return Py_BuildValue("O(O)n", Py_TYPE(self), self->sequence, (Py_ssize_t) self->index);
+}
+
+/* Set the position from the pickled index. As with list iterators this is clamped to the size of the sequence. */
+static PyObject *
+SequenceOfLongIterator___setstate__(SequenceOfLongIterator *self, PyObject *state) {
+    if (SequenceOfLongIterator_check_sequence(self)) {
+        return NULL;
+    }
+    if (!PyLong_Check(state)) {
+        PyErr_Format(PyExc_TypeError, "State must be an int, not type %s", Py_TYPE(state)->tp_name);
+        return NULL;
+    }
+    Py_ssize_t index = PyLong_AsSsize_t(state);
+    if (index == -1 && PyErr_Occurred()) {
+        return NULL;
+    }
+    if (index < 0) {
+        index = 0;
+    }
+    if (index > ((SequenceOfLong *) self->sequence)->size) {
+        index = ((SequenceOfLong *) self->sequence)->size;
+    }
+    self->index = index;
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef SequenceOfLongIterator_methods[] = {
+        {"next_chunk", (PyCFunction) SequenceOfLongIterator_next_chunk, METH_VARARGS | METH_KEYWORDS,
+                "Return a memoryview of format 'l' of up to n values and advance the iterator past them."
+                " At the end of the sequence this is empty."},
+        {"chunks", (PyCFunction) SequenceOfLongIterator_chunks, METH_VARARGS | METH_KEYWORDS,
+                "Return an iterator of memoryviews of format 'l' of up to size values."
+                " This advances this iterator."},
+        {"__length_hint__", (PyCFunction) SequenceOfLongIterator___length_hint__, METH_NOARGS,
+                "Return the number of remaining values."},
+        {"__reduce__", (PyCFunction) SequenceOfLongIterator___reduce__, METH_NOARGS,
+                "Return state information for pickling."},
+        {"__setstate__", (PyCFunction) SequenceOfLongIterator___setstate__, METH_O,
+                "Set the position of the iterator from the pickled state."},
+        {NULL, NULL, 0, NULL}  /* Sentinel */
+};
+
 static PyTypeObject SequenceOfLongIteratorType = {
         PyVarObject_HEAD_INIT(NULL, 0)
-        .tp_name = "SequenceOfLongIterator",
+        .tp_name = "cPyExtPatt.Iterators.cIterator.SequenceOfLongIterator",
         .tp_basicsize = sizeof(SequenceOfLongIterator),
         .tp_itemsize = 0,
         .tp_dealloc = (destructor) SequenceOfLongIterator_dealloc,
@@ -103,10 +414,162 @@ static PyTypeObject SequenceOfLongIteratorType = {
         .tp_doc = "SequenceOfLongIterator object.",
         .tp_iter = PyObject_SelfIter,
         .tp_iternext = (iternextfunc) SequenceOfLongIterator_next,
+        .tp_methods = SequenceOfLongIterator_methods,
         .tp_init = (initproc) SequenceOfLongIterator_init,
         .tp_new = SequenceOfLongIterator_new,
 };
 
+/**
+ * An iterator over a range of a SequenceOfLong with any step, for example reversed, strided or a part of the
+ * sequence for a worker thread.
+ * This is constructed with slice semantics SequenceOfLongRangeIterator(sequence, start=None, stop=None, step=None).
+ */
+typedef struct {
+    PyObject_HEAD
+    PyObject *sequence;
+    Py_ssize_t index;
+    Py_ssize_t step;
+    /* Number of values remaining. */
+    Py_ssize_t remaining;
+} SequenceOfLongRangeIterator;
+
+static PyTypeObject SequenceOfLongRangeIteratorType;
+
+/* Create a range iterator, this does not check the arguments. */
+static PyObject *
+SequenceOfLongRangeIterator_create(PyObject *sequence, Py_ssize_t start, Py_ssize_t step, Py_ssize_t length) {
+    SequenceOfLongRangeIterator *ret = (SequenceOfLongRangeIterator *) SequenceOfLongRangeIteratorType.tp_alloc(
+            &SequenceOfLongRangeIteratorType, 0
+    );
+    if (ret) {
+        Py_INCREF(sequence);
+        ret->sequence = sequence;
+        ret->index = start;
+        ret->step = step;
+        ret->remaining = length;
+    }
+    return (PyObject *) ret;
+}
+
+/* Create a range iterator with slice semantics, any of start, stop, step can be None. */
+static PyObject *
+SequenceOfLongRangeIterator_from_slice(PyObject *sequence, PyObject *start, PyObject *stop, PyObject *step) {
+    Py_ssize_t c_start, c_stop, c_step, length;
+    PyObject *slice = PySlice_New(start, stop, step);
+    if (!slice) {
+        return NULL;
+    }
+    if (PySlice_Unpack(slice, &c_start, &c_stop, &c_step) < 0) {
+        Py_DECREF(slice);
+        return NULL;
+    }
+    Py_DECREF(slice);
+    length = PySlice_AdjustIndices(((SequenceOfLong *) sequence)->size, &c_start, &c_stop, c_step);
+    return SequenceOfLongRangeIterator_create(sequence, c_start, c_step, length);
+}
+
+static PyObject *
+SequenceOfLongRangeIterator_new(PyTypeObject *Py_UNUSED(type), PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"sequence", "start", "stop", "step", NULL};
+    PyObject *sequence = NULL;
+    PyObject *start = Py_None;
+    PyObject *stop = Py_None;
+    PyObject *step = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|OOO", kwlist, &sequence, &start, &stop, &step)) {
+        return NULL;
+    }
+    if (!is_sequence_of_long_type(sequence)) {
+        PyErr_Format(
+                PyExc_ValueError,
+                "Argument must be a SequenceOfLongType, not type %s",
+                Py_TYPE(sequence)->tp_name
+        );
+        return NULL;
+    }
+    return SequenceOfLongRangeIterator_from_slice(sequence, start, stop, step);
+}
+
+static void
+SequenceOfLongRangeIterator_dealloc(SequenceOfLongRangeIterator *self) {
+    Py_XDECREF(self->sequence);
+    Py_TYPE(self)->tp_free((PyObject *) self);
+}
+
+static PyObject *
+SequenceOfLongRangeIterator_next(SequenceOfLongRangeIterator *self) {
+    SequenceOfLong *sequence = (SequenceOfLong *) self->sequence;
+    /* The sequence might have been re-initialised to a smaller size. */
+    if (self->remaining > 0 && self->index >= 0 && self->index < sequence->size) {
+        PyObject *ret = SequenceOfLong_box(sequence, sequence->array_long[self->index]);
+        self->remaining -= 1;
+        /* Stepping past the last value could overflow with a large step. */
+        if (self->remaining > 0) {
+            self->index += self->step;
+        }
+        return ret;
+    }
+    // End iteration.
+    self->remaining = 0;
+    return NULL;
+}
+
+static PyObject *
+SequenceOfLongRangeIterator___length_hint__(SequenceOfLongRangeIterator *self, PyObject *Py_UNUSED(ignored)) {
+    return PyLong_FromSsize_t(self->remaining);
+}
+
+/* Pickling support, this is (type, (sequence, start, stop, step)) from the current position.
+ * stop is one past the last index rather than index + remaining * step which can overflow with a large step.
+ * The last index is within the sequence as it was when the iterator was created so that can not overflow. */
+static PyObject *
+SequenceOfLongRangeIterator___reduce__(SequenceOfLongRangeIterator *self, PyObject *Py_UNUSED(ignored)) {
+    if (self->remaining <= 0) {
+        /* Exhausted, an empty range. */
+        return Py_BuildValue(
+                "O(Onnn)", Py_TYPE(self), self->sequence, (Py_ssize_t) 0, (Py_ssize_t) 0, (Py_ssize_t) 1
+        );
+    }
+    Py_ssize_t last = self->index + (self->remaining - 1) * self->step;
+    Py_ssize_t stop = self->step > 0 ? last + 1 : last - 1;
+    if (stop < 0) {
+        /* Reversed to the start, a negative stop would be relative to the end. */
+        return Py_BuildValue("O(OnOn)", Py_TYPE(self), self->sequence, self->index, Py_None, self->step);
+    }
+    return Py_BuildValue("O(Onnn)", Py_TYPE(self), self->sequence, self->index, stop, self->step);
+}
+
+static PyObject *
+SequenceOfLongRangeIterator___str__(SequenceOfLongRangeIterator *self) {
+    return PyUnicode_FromFormat(
+            "<SequenceOfLong range iterator index: %zd step: %zd remaining: %zd>",
+            self->index, self->step, self->remaining
+    );
+}
+
+static PyMethodDef SequenceOfLongRangeIterator_methods[] = {
+        {"__length_hint__", (PyCFunction) SequenceOfLongRangeIterator___length_hint__, METH_NOARGS,
+                "Return the number of remaining values."},
+        {"__reduce__", (PyCFunction) SequenceOfLongRangeIterator___reduce__, METH_NOARGS,
+                "Return state information for pickling."},
+        {NULL, NULL, 0, NULL}  /* Sentinel */
+};
+
+static PyTypeObject SequenceOfLongRangeIteratorType = {
+        PyVarObject_HEAD_INIT(NULL, 0)
+        .tp_name = "cPyExtPatt.Iterators.cIterator.SequenceOfLongRangeIterator",
+        .tp_basicsize = sizeof(SequenceOfLongRangeIterator),
+        .tp_itemsize = 0,
+        .tp_dealloc = (destructor) SequenceOfLongRangeIterator_dealloc,
+        .tp_str = (reprfunc) SequenceOfLongRangeIterator___str__,
+        .tp_flags = Py_TPFLAGS_DEFAULT,
+        .tp_doc = "Iterator over a range of a SequenceOfLong with slice semantics.",
+        .tp_iter = PyObject_SelfIter,
+        .tp_iternext = (iternextfunc) SequenceOfLongRangeIterator_next,
+        .tp_methods = SequenceOfLongRangeIterator_methods,
+        .tp_new = SequenceOfLongRangeIterator_new,
+};
+
 static PyObject *
 SequenceOfLong_new(PyTypeObject *type, PyObject *Py_UNUSED(args), PyObject *Py_UNUSED(kwds)) {
     SequenceOfLong *self;
@@ -115,52 +578,80 @@ SequenceOfLong_new(PyTypeObject *type, PyObject *Py_UNUSED(args), PyObject *Py_U
         assert(!PyErr_Occurred());
         self->size = 0;
         self->array_long = NULL;
+        self->intern = 0;
+        memset(&self->cache, 0, sizeof(LongInternCache));
     }
     return (PyObject *) self;
 }
 
+/**
+ * Initialise from a sequence of ints or from an object that supports the buffer protocol.
+ * See py_long_array_from_object() in src/cpy/Util/py_long_array.c for the fast paths.
+ * If intern is True then boxed values are cached and re-used, this suits data with few distinct values.
+ */
+static int
+SequenceOfLong_init_from_object(SequenceOfLong *self, PyObject *sequence, int intern) {
+    long *array_long = NULL;
+    Py_ssize_t size = 0;
+
+    if (py_long_array_from_object(sequence, &array_long, &size)) {
+        assert(PyErr_Occurred());
+        return -1;
+    }
+    /* __init__ can be called again on an existing object. */
+    free(self->array_long);
+    self->array_long = array_long;
+    self->size = size;
+    self->intern = intern;
+    long_intern_cache_clear(&self->cache);
+    return 0;
+}
+
 static int
 SequenceOfLong_init(SequenceOfLong *self, PyObject *args, PyObject *kwds) {
-    static char *kwlist[] = {"sequence", NULL};
+    static char *kwlist[] = {"sequence", "intern", NULL};
     PyObject *sequence = NULL;
+    int intern = 0;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O", kwlist, &sequence)) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|p", kwlist, &sequence, &intern)) {
         return -1;
     }
-    if (!PySequence_Check(sequence)) {
-        return -2;
+    return SequenceOfLong_init_from_object(self, sequence, intern);
+}
+
+static const char *const SequenceOfLong_keywords[] = {"sequence", "intern", NULL};
+static PyFastcallParser SequenceOfLong_parser = {"SequenceOfLong", SequenceOfLong_keywords, 1, NULL, 0};
+
+/**
+ * Calling the type, SequenceOfLong(sequence, intern=False), uses this rather than tp_new then tp_init.
+ * This avoids creating a tuple (and possibly a dict) of the arguments.
+ * tp_vectorcall is not inherited so subclasses use tp_new and tp_init as usual.
+ */
+static PyObject *
+SequenceOfLong_vectorcall(PyObject *type, PyObject *const *args, size_t nargsf, PyObject *kwnames) {
+    PyObject *argv[2];
+    int intern = 0;
+
+    if (py_fastcall_unpack(&SequenceOfLong_parser, args, PyVectorcall_NARGS(nargsf), kwnames, argv)) {
+        return NULL;
     }
-    self->size = PySequence_Length(sequence);
-    self->array_long = malloc(self->size * sizeof(long));
-    if (!self->array_long) {
-        return -3;
-    }
-    for (Py_ssize_t i = 0; i < PySequence_Length(sequence); ++i) {
-        // New reference.
-        PyObject *py_value = PySequence_GetItem(sequence, i);
-        if (PyLong_Check(py_value)) {
-            self->array_long[i] = PyLong_AsLong(py_value);
-            Py_DECREF(py_value);
-        } else {
-            PyErr_Format(
-                    PyExc_TypeError,
-                    "Argument [%zd] must be a int, not type %s",
-                    i,
-                    Py_TYPE(sequence)->tp_name
-            );
-            // Clean up on error.
-            free(self->array_long);
-            self->array_long = NULL;
-            Py_DECREF(py_value);
-            return -4;
+    if (argv[1]) {
+        intern = PyObject_IsTrue(argv[1]);
+        if (intern < 0) {
+            return NULL;
         }
     }
-    return 0;
+    PyObject *self = SequenceOfLong_new((PyTypeObject *) type, NULL, NULL);
+    if (self && SequenceOfLong_init_from_object((SequenceOfLong *) self, argv[0], intern)) {
+        Py_CLEAR(self);
+    }
+    return self;
 }
 
 static void
 SequenceOfLong_dealloc(SequenceOfLong *self) {
     free(self->array_long);
+    long_intern_cache_clear(&self->cache);
     Py_TYPE(self)->tp_free((PyObject *) self);
 }
 
@@ -183,6 +674,122 @@ SequenceOfLong_iter(SequenceOfLong *self) {
     return ret;
 }
 
+/* Pickling support, this is (type, (array.array('l', ...), intern)) which copies the values as a single block.
+ * An empty sequence has a NULL array_long, "y#" would make that None rather than b"". */
+static PyObject *
+SequenceOfLong___reduce__(SequenceOfLong *self, PyObject *Py_UNUSED(ignored)) {
+    PyObject *array_module = NULL;
+    PyObject *values = NULL;
+    PyObject *ret = NULL;
+
+    array_module = PyImport_ImportModule("array");
+    if (!array_module) {
+        goto except;
+    }
+    values = PyObject_CallMethod(
+            array_module, "array", "sy#", "l",
+            self->array_long ? (const char *) self->array_long : "", self->size * (Py_ssize_t) sizeof(long)
+    );
+    if (!values) {
+        goto except;
+    }
+    ret = Py_BuildValue("O(ON)", Py_TYPE(self), values, PyBool_FromLong(self->intern));
+    if (!ret) {
+        goto except;
+    }
+    goto finally;
+except:
+    assert(PyErr_Occurred());
+    ret = NULL;
+finally:
+    Py_XDECREF(values);
+    Py_XDECREF(array_module);
+    return ret;
+}
+
+static PyObject *
+SequenceOfLong___reversed__(SequenceOfLong *self, PyObject *Py_UNUSED(ignored)) {
+    return SequenceOfLongRangeIterator_create((PyObject *) self, self->size - 1, -1, self->size);
+}
+
+static PyObject *
+SequenceOfLong_iter_stride(SequenceOfLong *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"start", "stop", "step", NULL};
+    PyObject *start = Py_None;
+    PyObject *stop = Py_None;
+    PyObject *step = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OOO", kwlist, &start, &stop, &step)) {
+        return NULL;
+    }
+    return SequenceOfLongRangeIterator_from_slice((PyObject *) self, start, stop, step);
+}
+
+/**
+ * Return a list of n iterators over contiguous, disjoint, ranges that together cover the sequence.
+ * The sizes differ by at most one.
+ */
+static PyObject *
+SequenceOfLong_split(SequenceOfLong *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"n", NULL};
+    Py_ssize_t count = 0;
+    PyObject *ret = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "n", kwlist, &count)) {
+        return NULL;
+    }
+    if (count <= 0) {
+        PyErr_Format(PyExc_ValueError, "Number of splits must be > 0 not %zd", count);
+        return NULL;
+    }
+    ret = PyList_New(count);
+    if (!ret) {
+        return NULL;
+    }
+    Py_ssize_t quotient = self->size / count;
+    Py_ssize_t remainder = self->size % count;
+    Py_ssize_t start = 0;
+    for (Py_ssize_t i = 0; i < count; ++i) {
+        Py_ssize_t length = quotient + (i < remainder ? 1 : 0);
+        PyObject *iterator = SequenceOfLongRangeIterator_create((PyObject *) self, start, 1, length);
+        if (!iterator) {
+            Py_DECREF(ret);
+            return NULL;
+        }
+        /* Steals the reference. */
+        PyList_SET_ITEM(ret, i, iterator);
+        start += length;
+    }
+    return ret;
+}
+
+/* Clear the interning cache and reset the counters. */
+static PyObject *
+SequenceOfLong_clear_intern_cache(SequenceOfLong *self, PyObject *Py_UNUSED(ignored)) {
+    long_intern_cache_clear(&self->cache);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+SequenceOfLong_get_intern(SequenceOfLong *self, void *Py_UNUSED(closure)) {
+    return PyBool_FromLong(self->intern);
+}
+
+static PyGetSetDef SequenceOfLong_getsetters[] = {
+        {"intern", (getter) SequenceOfLong_get_intern, NULL, "True if boxed values are interned.", NULL},
+        {NULL, NULL, NULL, NULL, NULL}  /* Sentinel */
+};
+
+static PyMemberDef SequenceOfLong_members[] = {
+        {"intern_hits", T_PYSSIZET, offsetof(SequenceOfLong, cache.hits), READONLY,
+                "Number of values boxed from the interning cache."},
+        {"intern_misses", T_PYSSIZET, offsetof(SequenceOfLong, cache.misses), READONLY,
+                "Number of values that were not in the interning cache."},
+        {"intern_size", T_PYSSIZET, offsetof(SequenceOfLong, cache.size), READONLY,
+                "Number of distinct values in the interning cache."},
+        {NULL, 0, 0, 0, NULL}  /* Sentinel */
+};
+
 static PyMethodDef SequenceOfLong_methods[] = {
         {
                 "size",
@@ -190,6 +797,37 @@ static PyMethodDef SequenceOfLong_methods[] = {
                 METH_NOARGS,
                 "Return the size of the sequence."
         },
+        {
+                "__reversed__",
+                (PyCFunction) SequenceOfLong___reversed__,
+                METH_NOARGS,
+                "Return a reverse iterator."
+        },
+        {
+                "iter_stride",
+                (PyCFunction) SequenceOfLong_iter_stride,
+                METH_VARARGS | METH_KEYWORDS,
+                "Return an iterator over the sequence with slice semantics for start, stop and step."
+        },
+        {
+                "split",
+                (PyCFunction) SequenceOfLong_split,
+                METH_VARARGS | METH_KEYWORDS,
+                "Return a list of n iterators over disjoint contiguous ranges of the sequence,"
+                " for example to hand to worker threads."
+        },
+        {
+                "clear_intern_cache",
+                (PyCFunction) SequenceOfLong_clear_intern_cache,
+                METH_NOARGS,
+                "Clear the interning cache and reset the counters."
+        },
+        {
+                "__reduce__",
+                (PyCFunction) SequenceOfLong___reduce__,
+                METH_NOARGS,
+                "Return state information for pickling."
+        },
         {NULL, NULL, 0, NULL}  /* Sentinel */
 };
 
@@ -205,7 +843,7 @@ SequenceOfLong_getitem(PyObject *self, Py_ssize_t index) {
     if (my_index < 0) {
         my_index += SequenceOfLong_len(self);
     }
-    if (my_index > SequenceOfLong_len(self)) {
+    if (my_index < 0 || my_index >= SequenceOfLong_len(self)) {
         PyErr_Format(
             PyExc_IndexError,
             "Index %ld is out of range for length %ld",
@@ -214,7 +852,7 @@ SequenceOfLong_getitem(PyObject *self, Py_ssize_t index) {
         );
         return NULL;
     }
-    return PyLong_FromLong(((SequenceOfLong *)self)->array_long[my_index]);
+    return SequenceOfLong_box((SequenceOfLong *) self, ((SequenceOfLong *) self)->array_long[my_index]);
 }
 
 PySequenceMethods SequenceOfLong_sequence_methods = {
@@ -230,7 +868,7 @@ SequenceOfLong___str__(SequenceOfLong *self, PyObject *Py_UNUSED(ignored)) {
 
 static PyTypeObject SequenceOfLongType = {
         PyVarObject_HEAD_INIT(NULL, 0)
-        .tp_name = "SequenceOfLong",
+        .tp_name = "cPyExtPatt.Iterators.cIterator.SequenceOfLong",
         .tp_basicsize = sizeof(SequenceOfLong),
         .tp_itemsize = 0,
         .tp_dealloc = (destructor) SequenceOfLong_dealloc,
@@ -241,8 +879,11 @@ static PyTypeObject SequenceOfLongType = {
         .tp_iter = (getiterfunc) SequenceOfLong_iter,
 //        .tp_iternext = (iternextfunc) SequenceOfLongIterator_next,
         .tp_methods = SequenceOfLong_methods,
+        .tp_members = SequenceOfLong_members,
+        .tp_getset = SequenceOfLong_getsetters,
         .tp_init = (initproc) SequenceOfLong_init,
         .tp_new = SequenceOfLong_new,
+        .tp_vectorcall = SequenceOfLong_vectorcall,
 };
 
 static int
@@ -314,7 +955,7 @@ static PyModuleDef iterator_cmodule = {
         .m_name = "cIterator",
         .m_doc = (
                 "Example module that creates an extension type"
-                "that has forward and reverse iterators."
+                " that has forward, reverse, strided and chunked iterators."
         ),
         .m_size = -1,
         .m_methods = cIterator_methods,
@@ -328,6 +969,10 @@ PyInit_cIterator(void) {
         return NULL;
     }
 
+    if (py_fastcall_parser_init(&SequenceOfLong_parser)) {
+        Py_DECREF(m);
+        return NULL;
+    }
     if (PyType_Ready(&SequenceOfLongType) < 0) {
         Py_DECREF(m);
         return NULL;
@@ -346,6 +991,24 @@ PyInit_cIterator(void) {
         Py_DECREF(m);
         return NULL;
     }
+    if (PyType_Ready(&SequenceOfLongChunksType) < 0) {
+        Py_DECREF(m);
+        return NULL;
+    }
+    if (PyType_Ready(&SequenceOfLongRangeIteratorType) < 0) {
+        Py_DECREF(m);
+        return NULL;
+    }
+    Py_INCREF(&SequenceOfLongRangeIteratorType);
+    if (PyModule_AddObject(
+            m,
+            "SequenceOfLongRangeIterator",
+            (PyObject *) &SequenceOfLongRangeIteratorType) < 0
+            ) {
+        Py_DECREF(&SequenceOfLongRangeIteratorType);
+        Py_DECREF(m);
+        return NULL;
+    }
     Py_INCREF(&SequenceOfLongIteratorType);
     // Not strictly necessary unless you need to expose this type.
     // For type checking for example.
@@ -8,6 +8,9 @@
 /* For va_start, va_end */
 #include <stdarg.h>
 
+#include "py_fastcall_args.h"
+#include "py_free_threading.h"
+
 /* logging levels defined by logging module
  * From: https://docs.python.org/3/library/logging.html#logging-levels */
 #define LOGGING_DEBUG 10
@@ -17,7 +20,10 @@
 #define LOGGING_CRITICAL 50
 #define LOGGING_EXCEPTION 60
 
-/* This modules globals */
+/* This modules globals.
+ * These are only written by PyInit_cLogging() below, which runs once under the import lock, before the module is
+ * visible to any other thread. After that they are only read, the logging module does its own locking, so no lock is
+ * needed for a free-threaded build. */
 static PyObject *g_logging_module = NULL; /* Initialise by PyInit_cLogging() below. */
 static PyObject *g_logger = NULL;
 
@@ -103,6 +109,32 @@ py_log_message(PyObject *Py_UNUSED(module), PyObject *args) {
     return py_log_msg(log_level, "%s", message);
 }
 
+static const char *const log_message_fastcall_keywords[] = {"level", "message", NULL};
+static PyFastcallParser log_message_fastcall_parser = {"log_fastcall", log_message_fastcall_keywords, 2, NULL, 0};
+
+/* As py_log_message() but with METH_FASTCALL | METH_KEYWORDS. The message must be a str. */
+static PyObject *
+py_log_message_fastcall(PyObject *Py_UNUSED(module), PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+    PyObject *argv[2];
+
+    if (py_fastcall_unpack(&log_message_fastcall_parser, args, nargs, kwnames, argv)) {
+        return NULL;
+    }
+    long log_level = PyLong_AsLong(argv[0]);
+    if (log_level == -1 && PyErr_Occurred()) {
+        return NULL;
+    }
+    if (log_level < INT_MIN || log_level > INT_MAX) {
+        PyErr_SetString(PyExc_OverflowError, "signed integer is out of range for a C int");
+        return NULL;
+    }
+    if (!PyUnicode_Check(argv[1])) {
+        PyErr_Format(PyExc_TypeError, "message must be str, not %s", Py_TYPE(argv[1])->tp_name);
+        return NULL;
+    }
+    return py_log_msg((int) log_level, "%U", argv[1]);
+}
+
 static PyObject *
 py_log_set_level(PyObject *Py_UNUSED(module), PyObject *args) {
     assert(g_logger);
@@ -156,6 +188,12 @@ static PyMethodDef logging_methods[] = {
                 METH_VARARGS,
                 "Log a message."
         },
+        {
+                "log_fastcall",
+                (PyCFunction) (void (*)(void)) py_log_message_fastcall,
+                METH_FASTCALL | METH_KEYWORDS,
+                "Log a message, this uses METH_FASTCALL."
+        },
         {
                 "py_file_line_function",
                 (PyCFunction) py_file_line_function,
@@ -180,6 +218,9 @@ static PyModuleDef cLogging = {
 };
 
 PyMODINIT_FUNC PyInit_cLogging(void) {
+    if (py_fastcall_parser_init(&log_message_fastcall_parser)) {
+        return NULL;
+    }
     PyObject *m = PyModule_Create(&cLogging);
     if (!m) {
         goto except;
@@ -214,13 +255,16 @@ PyMODINIT_FUNC PyInit_cLogging(void) {
     if (PyModule_AddIntConstant(m, "EXCEPTION", LOGGING_EXCEPTION)) {
         goto except;
     }
+    if (PY_MODULE_GIL_NOT_USED(m)) {
+        goto except;
+    }
 
     goto finally;
     except:
     /* abnormal cleanup */
-    /* cleanup logger references */
-    Py_XDECREF(g_logging_module);
-    Py_XDECREF(g_logger);
+    /* cleanup logger references, these are NULLed so that a failed import leaves nothing dangling. */
+    Py_CLEAR(g_logging_module);
+    Py_CLEAR(g_logger);
     Py_XDECREF(m);
     m = NULL;
     finally:
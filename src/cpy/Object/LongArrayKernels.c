@@ -0,0 +1,448 @@
+//
+// LongArrayKernels.c
+//
+// Reductions, searching and sorting of a C array of longs used by src/cpy/Object/cSeqObject.c
+// See LongArrayKernels.h
+//
+
+#include "LongArrayKernels.h"
+
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The AVX2 kernels assume a 64 bit long in four lanes of a 256 bit register. */
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && LONG_MAX == 0x7FFFFFFFFFFFFFFFL
+#define LONG_ARRAY_HAVE_AVX2 1
+#include <immintrin.h>
+/* Compile just this function for AVX2, the rest of the module is for the baseline instruction set. */
+#define LONG_ARRAY_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define LONG_ARRAY_HAVE_AVX2 0
+#endif
+
+/**** Scalar kernels. ****/
+
+static void
+long_array_sum_scalar(const long *array, size_t count, LongArraySum *result) {
+    unsigned long long low = 0;
+    unsigned long long high = 0;
+    unsigned long long negatives = 0;
+    for (size_t i = 0; i < count; ++i) {
+        /* Sign extend to 64 bits then split into two unsigned 32 bit halves. */
+        unsigned long long value = (unsigned long long) (long long) array[i];
+        low += value & 0xFFFFFFFFULL;
+        high += value >> 32;
+        negatives += array[i] < 0;
+    }
+    result->low = low;
+    result->high = high;
+    result->negatives = negatives;
+}
+
+static size_t
+long_array_argmin_scalar(const long *array, size_t count) {
+    size_t index = 0;
+    for (size_t i = 1; i < count; ++i) {
+        if (array[i] < array[index]) {
+            index = i;
+        }
+    }
+    return index;
+}
+
+static size_t
+long_array_argmax_scalar(const long *array, size_t count) {
+    size_t index = 0;
+    for (size_t i = 1; i < count; ++i) {
+        if (array[i] > array[index]) {
+            index = i;
+        }
+    }
+    return index;
+}
+
+static size_t
+long_array_count_scalar(const long *array, size_t count, long value) {
+    size_t result = 0;
+    for (size_t i = 0; i < count; ++i) {
+        result += array[i] == value;
+    }
+    return result;
+}
+
+static size_t
+long_array_find_scalar(const long *array, size_t count, long value) {
+    for (size_t i = 0; i < count; ++i) {
+        if (array[i] == value) {
+            return i;
+        }
+    }
+    return count;
+}
+
+/**** AVX2 kernels. ****/
+
+#if LONG_ARRAY_HAVE_AVX2
+
+/* Horizontal add of four 64 bit lanes. */
+LONG_ARRAY_TARGET_AVX2
+static unsigned long long
+long_array_hadd_avx2(__m256i lanes) {
+    unsigned long long values[4];
+    _mm256_storeu_si256((__m256i *) values, lanes);
+    return values[0] + values[1] + values[2] + values[3];
+}
+
+LONG_ARRAY_TARGET_AVX2
+static void
+long_array_sum_avx2(const long *array, size_t count, LongArraySum *result) {
+    const __m256i mask_low = _mm256_set1_epi64x(0xFFFFFFFFLL);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i low = zero;
+    __m256i high = zero;
+    __m256i negatives = zero;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i values = _mm256_loadu_si256((const __m256i *) (array + i));
+        low = _mm256_add_epi64(low, _mm256_and_si256(values, mask_low));
+        high = _mm256_add_epi64(high, _mm256_srli_epi64(values, 32));
+        /* The comparison is -1 in each lane with a negative value. */
+        negatives = _mm256_sub_epi64(negatives, _mm256_cmpgt_epi64(zero, values));
+    }
+    /* Remainder. */
+    long_array_sum_scalar(array + i, count - i, result);
+    result->low += long_array_hadd_avx2(low);
+    result->high += long_array_hadd_avx2(high);
+    result->negatives += long_array_hadd_avx2(negatives);
+}
+
+/* Search for the first minimum, or maximum, keeping the best value and its index in each lane.
+ * Lanes are only updated on a strict comparison so each lane holds the first occurrence of its best value. */
+LONG_ARRAY_TARGET_AVX2
+static size_t
+long_array_arg_best_avx2(const long *array, size_t count, int find_max) {
+    if (count < 8) {
+        return find_max ? long_array_argmax_scalar(array, count) : long_array_argmin_scalar(array, count);
+    }
+    const __m256i step = _mm256_set1_epi64x(4);
+    __m256i index = _mm256_setr_epi64x(0, 1, 2, 3);
+    __m256i best = _mm256_loadu_si256((const __m256i *) array);
+    __m256i best_index = index;
+    size_t i = 4;
+    for (; i + 4 <= count; i += 4) {
+        __m256i values = _mm256_loadu_si256((const __m256i *) (array + i));
+        index = _mm256_add_epi64(index, step);
+        __m256i mask = find_max ? _mm256_cmpgt_epi64(values, best) : _mm256_cmpgt_epi64(best, values);
+        best = _mm256_blendv_epi8(best, values, mask);
+        best_index = _mm256_blendv_epi8(best_index, index, mask);
+    }
+    long long lane_values[4];
+    long long lane_indexes[4];
+    _mm256_storeu_si256((__m256i *) lane_values, best);
+    _mm256_storeu_si256((__m256i *) lane_indexes, best_index);
+    /* Reduce the lanes, on a tie take the lowest index. */
+    long result_value = (long) lane_values[0];
+    size_t result = (size_t) lane_indexes[0];
+    for (int lane = 1; lane < 4; ++lane) {
+        long value = (long) lane_values[lane];
+        size_t value_index = (size_t) lane_indexes[lane];
+        int better = find_max ? value > result_value : value < result_value;
+        if (better || (value == result_value && value_index < result)) {
+            result_value = value;
+            result = value_index;
+        }
+    }
+    /* Remainder, these indexes are all greater than any so far. */
+    for (; i < count; ++i) {
+        if (find_max ? array[i] > result_value : array[i] < result_value) {
+            result_value = array[i];
+            result = i;
+        }
+    }
+    return result;
+}
+
+LONG_ARRAY_TARGET_AVX2
+static size_t
+long_array_count_avx2(const long *array, size_t count, long value) {
+    const __m256i needle = _mm256_set1_epi64x(value);
+    __m256i matches = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i values = _mm256_loadu_si256((const __m256i *) (array + i));
+        /* The comparison is -1 in each lane that matches. */
+        matches = _mm256_sub_epi64(matches, _mm256_cmpeq_epi64(values, needle));
+    }
+    return (size_t) long_array_hadd_avx2(matches) + long_array_count_scalar(array + i, count - i, value);
+}
+
+LONG_ARRAY_TARGET_AVX2
+static size_t
+long_array_find_avx2(const long *array, size_t count, long value) {
+    const __m256i needle = _mm256_set1_epi64x(value);
+    size_t i = 0;
+    /* Two registers per iteration to hide the latency of the test. */
+    for (; i + 8 <= count; i += 8) {
+        __m256i match_a = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *) (array + i)), needle);
+        __m256i match_b = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *) (array + i + 4)), needle);
+        if (!_mm256_testz_si256(_mm256_or_si256(match_a, match_b), _mm256_or_si256(match_a, match_b))) {
+            /* One bit per lane. */
+            unsigned mask = (unsigned) _mm256_movemask_pd(_mm256_castsi256_pd(match_a))
+                            | ((unsigned) _mm256_movemask_pd(_mm256_castsi256_pd(match_b)) << 4);
+            return i + (size_t) __builtin_ctz(mask);
+        }
+    }
+    return i + long_array_find_scalar(array + i, count - i, value);
+}
+
+#endif // LONG_ARRAY_HAVE_AVX2
+
+/**** Runtime dispatch. ****/
+
+/* -1 means not yet detected. */
+static int g_long_array_simd_level = -1;
+
+LongArraySIMDLevel long_array_simd_level_available(void) {
+#if LONG_ARRAY_HAVE_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return LONG_ARRAY_SIMD_AVX2;
+    }
+#endif
+    return LONG_ARRAY_SIMD_SCALAR;
+}
+
+LongArraySIMDLevel long_array_simd_level(void) {
+    if (g_long_array_simd_level < 0) {
+        g_long_array_simd_level = long_array_simd_level_available();
+    }
+    return (LongArraySIMDLevel) g_long_array_simd_level;
+}
+
+int long_array_set_simd_level(LongArraySIMDLevel level) {
+    if ((int) level < (int) LONG_ARRAY_SIMD_SCALAR || level > long_array_simd_level_available()) {
+        return -1;
+    }
+    g_long_array_simd_level = level;
+    return 0;
+}
+
+void long_array_sum(const long *array, size_t count, LongArraySum *result) {
+    assert(count <= LONG_ARRAY_SUM_MAX_COUNT);
+    switch (long_array_simd_level()) {
+#if LONG_ARRAY_HAVE_AVX2
+        case LONG_ARRAY_SIMD_AVX2:
+            long_array_sum_avx2(array, count, result);
+            break;
+#endif
+        default:
+            long_array_sum_scalar(array, count, result);
+            break;
+    }
+}
+
+size_t long_array_argmin(const long *array, size_t count) {
+    assert(count > 0);
+    switch (long_array_simd_level()) {
+#if LONG_ARRAY_HAVE_AVX2
+        case LONG_ARRAY_SIMD_AVX2:
+            return long_array_arg_best_avx2(array, count, 0);
+#endif
+        default:
+            return long_array_argmin_scalar(array, count);
+    }
+}
+
+size_t long_array_argmax(const long *array, size_t count) {
+    assert(count > 0);
+    switch (long_array_simd_level()) {
+#if LONG_ARRAY_HAVE_AVX2
+        case LONG_ARRAY_SIMD_AVX2:
+            return long_array_arg_best_avx2(array, count, 1);
+#endif
+        default:
+            return long_array_argmax_scalar(array, count);
+    }
+}
+
+size_t long_array_count(const long *array, size_t count, long value) {
+    switch (long_array_simd_level()) {
+#if LONG_ARRAY_HAVE_AVX2
+        case LONG_ARRAY_SIMD_AVX2:
+            return long_array_count_avx2(array, count, value);
+#endif
+        default:
+            return long_array_count_scalar(array, count, value);
+    }
+}
+
+/* AVX2 has no 64 bit multiply so the dot product is scalar with overflow checking. */
+int long_array_dot(const long *array_a, const long *array_b, size_t count, long *result) {
+    long total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        long product;
+#if defined(__GNUC__) || defined(__clang__)
+        if (__builtin_mul_overflow(array_a[i], array_b[i], &product)
+            || __builtin_add_overflow(total, product, &total)) {
+            return -1;
+        }
+#else
+        long a = array_a[i];
+        long b = array_b[i];
+        if (a > 0) {
+            if (b > 0 ? a > LONG_MAX / b : b < LONG_MIN / a) {
+                return -1;
+            }
+        } else if (a < 0) {
+            if (b > 0 ? a < LONG_MIN / b : (b != 0 && a < LONG_MAX / b)) {
+                return -1;
+            }
+        }
+        product = a * b;
+        if ((product > 0 && total > LONG_MAX - product) || (product < 0 && total < LONG_MIN - product)) {
+            return -1;
+        }
+        total += product;
+#endif
+    }
+    *result = total;
+    return 0;
+}
+
+size_t long_array_find(const long *array, size_t count, long value) {
+    switch (long_array_simd_level()) {
+#if LONG_ARRAY_HAVE_AVX2
+        case LONG_ARRAY_SIMD_AVX2:
+            return long_array_find_avx2(array, count, value);
+#endif
+        default:
+            return long_array_find_scalar(array, count, value);
+    }
+}
+
+int long_array_is_sorted(const long *array, size_t count) {
+    /* Accumulate rather than exit early so that the compiler can vectorise this. */
+    int unsorted = 0;
+    for (size_t i = 1; i < count; ++i) {
+        unsorted |= array[i - 1] > array[i];
+    }
+    return !unsorted;
+}
+
+size_t long_array_lower_bound(const long *array, size_t count, long value) {
+    if (count == 0) {
+        return 0;
+    }
+    const long *base = array;
+    size_t n = count;
+    /* The answer is always in [base, base + n], the compiler turns the condition into a conditional move. */
+    while (n > 1) {
+        size_t half = n / 2;
+        base = base[half] < value ? base + half : base;
+        n -= half;
+    }
+    return (size_t) (base - array) + (*base < value);
+}
+
+/* Below this size an insertion sort is faster than the radix sort. */
+#define LONG_ARRAY_SORT_INSERTION_MAX 64
+
+static void
+long_array_insertion_sort(long *array, size_t count) {
+    for (size_t i = 1; i < count; ++i) {
+        long value = array[i];
+        size_t j = i;
+        while (j > 0 && array[j - 1] > value) {
+            array[j] = array[j - 1];
+            --j;
+        }
+        array[j] = value;
+    }
+}
+
+/* Flip the sign bit so that the unsigned order of the keys is the signed order of the values. */
+#define LONG_ARRAY_SORT_KEY(value) ((unsigned long) (value) ^ (1UL << (sizeof(long) * CHAR_BIT - 1)))
+
+int long_array_sort(long *array, size_t count) {
+    if (count < LONG_ARRAY_SORT_INSERTION_MAX) {
+        long_array_insertion_sort(array, count);
+        return 0;
+    }
+    /* One histogram per byte, all filled in a single pass. */
+    size_t histograms[sizeof(long)][256];
+    memset(histograms, 0, sizeof(histograms));
+    for (size_t i = 0; i < count; ++i) {
+        unsigned long key = LONG_ARRAY_SORT_KEY(array[i]);
+        for (size_t byte = 0; byte < sizeof(long); ++byte) {
+            histograms[byte][(key >> (byte * CHAR_BIT)) & 0xFF]++;
+        }
+    }
+    long *temp = malloc(count * sizeof(long));
+    if (!temp) {
+        return -1;
+    }
+    long *source = array;
+    long *destination = temp;
+    for (size_t byte = 0; byte < sizeof(long); ++byte) {
+        size_t *histogram = histograms[byte];
+        unsigned first_byte = (LONG_ARRAY_SORT_KEY(source[0]) >> (byte * CHAR_BIT)) & 0xFF;
+        if (histogram[first_byte] == count) {
+            /* Every value has the same byte so this pass would not change the order. */
+            continue;
+        }
+        /* Convert the counts to offsets. */
+        size_t offset = 0;
+        for (int bucket = 0; bucket < 256; ++bucket) {
+            size_t bucket_count = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucket_count;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            unsigned bucket = (LONG_ARRAY_SORT_KEY(source[i]) >> (byte * CHAR_BIT)) & 0xFF;
+            destination[histogram[bucket]++] = source[i];
+        }
+        long *swap = source;
+        source = destination;
+        destination = swap;
+    }
+    if (source != array) {
+        memcpy(array, source, count * sizeof(long));
+    }
+    free(temp);
+    return 0;
+}
+
+/* With fewer needles than this a linear search of each is faster than sorting a copy of the array. */
+#define LONG_ARRAY_CONTAINS_MANY_SORT_MIN 16
+
+int long_array_contains_many(const long *array, size_t count, int is_sorted,
+                             const long *needles, size_t needle_count, unsigned char *result) {
+    long *sorted_copy = NULL;
+    if (!is_sorted && needle_count >= LONG_ARRAY_CONTAINS_MANY_SORT_MIN && count > 0) {
+        sorted_copy = malloc(count * sizeof(long));
+        if (!sorted_copy) {
+            return -1;
+        }
+        memcpy(sorted_copy, array, count * sizeof(long));
+        if (long_array_sort(sorted_copy, count)) {
+            free(sorted_copy);
+            return -1;
+        }
+        array = sorted_copy;
+        is_sorted = 1;
+    }
+    if (is_sorted) {
+        for (size_t i = 0; i < needle_count; ++i) {
+            size_t index = long_array_lower_bound(array, count, needles[i]);
+            result[i] = index < count && array[index] == needles[i];
+        }
+    } else {
+        for (size_t i = 0; i < needle_count; ++i) {
+            result[i] = long_array_find(array, count, needles[i]) < count;
+        }
+    }
+    free(sorted_copy);
+    return 0;
+}
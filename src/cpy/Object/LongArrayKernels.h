@@ -0,0 +1,93 @@
+//
+// LongArrayKernels.h
+//
+// Reductions, searching and sorting of a C array of longs used by src/cpy/Object/cSeqObject.c
+// This knows nothing about Python so it can be called with the GIL released.
+//
+// Where available (x86_64 with gcc or clang) there are AVX2 versions of the kernels that are selected at runtime by
+// CPU feature detection. Otherwise, or if the CPU does not support AVX2, a scalar version is used that a release
+// build will auto-vectorise to the baseline instruction set (SSE2 on x86_64, NEON on arm64).
+//
+
+#ifndef PYTHONEXTENSIONPATTERNS_LONGARRAYKERNELS_H
+#define PYTHONEXTENSIONPATTERNS_LONGARRAYKERNELS_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Instruction set levels for the kernels. */
+typedef enum {
+    LONG_ARRAY_SIMD_SCALAR = 0,
+    LONG_ARRAY_SIMD_AVX2 = 1,
+} LongArraySIMDLevel;
+
+/* Returns the best instruction set level supported by this CPU and this build. */
+LongArraySIMDLevel long_array_simd_level_available(void);
+
+/* Returns the instruction set level currently used by the kernels. */
+LongArraySIMDLevel long_array_simd_level(void);
+
+/* Set the instruction set level used by the kernels, this is mostly for testing and benchmarking.
+ * Returns 0 on success, non-zero if the level is not available. */
+int long_array_set_simd_level(LongArraySIMDLevel level);
+
+/* The exact sum of an array of longs is the 128 bit value:
+ * high * 2**32 + low - negatives * 2**64
+ * Each value is split into its unsigned high and low 32 bits so that neither accumulator can overflow.
+ * This allows a wrapping SIMD add to give an exact result. */
+typedef struct {
+    unsigned long long low;
+    unsigned long long high;
+    unsigned long long negatives;
+} LongArraySum;
+
+/* The maximum number of values that can be summed by a single call to long_array_sum() without overflow of the
+ * LongArraySum accumulators. */
+#define LONG_ARRAY_SUM_MAX_COUNT ((size_t) 0xFFFFFFFFUL)
+
+/* Sum the values. count must be <= LONG_ARRAY_SUM_MAX_COUNT. */
+void long_array_sum(const long *array, size_t count, LongArraySum *result);
+
+/* Return the index of the first minimum value. count must be > 0. */
+size_t long_array_argmin(const long *array, size_t count);
+
+/* Return the index of the first maximum value. count must be > 0. */
+size_t long_array_argmax(const long *array, size_t count);
+
+/* Return the number of values equal to value. */
+size_t long_array_count(const long *array, size_t count, long value);
+
+/* Calculate the dot product of two arrays of the same length.
+ * Returns 0 on success with the result in *result or non-zero if the calculation overflows a long. */
+int long_array_dot(const long *array_a, const long *array_b, size_t count, long *result);
+
+/* Return the index of the first value equal to value or count if there is none. */
+size_t long_array_find(const long *array, size_t count, long value);
+
+/* Return non-zero if the values are in ascending order. */
+int long_array_is_sorted(const long *array, size_t count);
+
+/* Return the index of the first value that is not less than value, or count if there is none.
+ * The array must be sorted. This is a branchless binary search. */
+size_t long_array_lower_bound(const long *array, size_t count, long value);
+
+/* Sort the array in place in ascending order. This is a least significant digit radix sort on each byte of the
+ * values, passes where every value has the same byte are skipped.
+ * Returns 0 on success, non-zero if the temporary memory can not be allocated. */
+int long_array_sort(long *array, size_t count);
+
+/* For each of the needles set result[i] to 1 if it is in the array, 0 otherwise.
+ * If the array is sorted, as indicated by the caller, this uses a binary search for each needle.
+ * Otherwise, if there are enough needles, this sorts a copy of the array first.
+ * Returns 0 on success, non-zero if the temporary memory can not be allocated. */
+int long_array_contains_many(const long *array, size_t count, int is_sorted,
+                             const long *needles, size_t needle_count, unsigned char *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //PYTHONEXTENSIONPATTERNS_LONGARRAYKERNELS_H
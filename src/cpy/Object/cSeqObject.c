@@ -9,12 +9,60 @@
 #include <Python.h>
 #include "structmember.h"
 
+#include "py_long_array.h"
+#include "py_fastcall_args.h"
+#include "py_free_threading.h"
+#include "LongArrayKernels.h"
+
 typedef struct {
     PyObject_HEAD
     long *array_long;
-    ssize_t size;
+    Py_ssize_t size;
+    /* Number of longs allocated in array_long, always >= size. array_long is NULL if this is 0. */
+    Py_ssize_t capacity;
+    /* Number of outstanding buffer exports, see SequenceLongObject_bf_getbuffer().
+     * While this is non-zero array_long must not be re-allocated. */
+    Py_ssize_t exports;
+    /* Number of outstanding buffers, of this or its views, that a consumer could write to.
+     * This is a subset of exports, views and releasing the GIL also pin the array but the values can only change
+     * without our knowledge through a buffer. */
+    Py_ssize_t buffer_exports;
+    /* One of the SEQUENCE_LONG_*SORTED* values, see SequenceLongObject_is_sorted(). */
+    int sorted;
 } SequenceLongObject;
 
+/* Values of SequenceLongObject.sorted, this is maintained across mutations so that searches can use a binary search.
+ * NOT_SORTED means not known to be sorted, a mutation might have sorted the values by chance. */
+#define SEQUENCE_LONG_NOT_SORTED 0
+#define SEQUENCE_LONG_SORTED 1
+/* A writable buffer has been exported so the values might have been changed without our knowledge. */
+#define SEQUENCE_LONG_SORTED_UNKNOWN 2
+
+/* Free-threaded builds, see src/cpy/Util/py_free_threading.h
+ * Every entry point from the interpreter that reads or writes the array takes a critical section on the
+ * SequenceLongObject, views lock their base. The implementations below are written as if the GIL is held and
+ * SEQUENCE_LONG_LOCKED(ret_type, name, params, args, op) defines name_locked() that calls name() whilst op is locked.
+ * These are what go in the method and slot tables. */
+#define SEQUENCE_LONG_LOCKED(ret_type, name, params, args, op)      \
+    static ret_type name##_locked params {                          \
+        ret_type ret;                                               \
+        Py_BEGIN_CRITICAL_SECTION(op);                              \
+        ret = name args;                                            \
+        Py_END_CRITICAL_SECTION();                                  \
+        return ret;                                                 \
+    }
+
+/* As SEQUENCE_LONG_LOCKED() but for two objects, such as self and other in a binary operation.
+ * The objects are locked in a consistent order so this can not deadlock, op_a and op_b can be the same object. */
+#define SEQUENCE_LONG_LOCKED2(ret_type, name, params, args, op_a, op_b)   \
+    static ret_type name##_locked params {                              \
+        ret_type ret;                                                   \
+        Py_BEGIN_CRITICAL_SECTION2(op_a, op_b);                         \
+        ret = name args;                                                \
+        Py_END_CRITICAL_SECTION2();                                     \
+        return ret;                                                     \
+    }
+
 static PyObject *
 SequenceLongObject_new(PyTypeObject *type, PyObject *Py_UNUSED(args), PyObject *Py_UNUSED(kwds)) {
     SequenceLongObject *self;
@@ -22,11 +70,99 @@ SequenceLongObject_new(PyTypeObject *type, PyObject *Py_UNUSED(args), PyObject *
     if (self != NULL) {
         assert(!PyErr_Occurred());
         self->size = 0;
+        self->capacity = 0;
         self->array_long = NULL;
+        self->exports = 0;
+        self->buffer_exports = 0;
+        self->sorted = SEQUENCE_LONG_SORTED;
     }
     return (PyObject *) self;
 }
 
+/**
+ * Returns non-zero and sets a BufferError if the array is currently exported through the buffer protocol.
+ * This must be called before any operation that re-allocates or frees array_long.
+ * @param self
+ * @return 0 if the array can be re-allocated, -1 on error.
+ */
+static int
+SequenceLongObject_check_exports(SequenceLongObject *self) {
+    if (self->exports > 0) {
+        PyErr_Format(
+                PyExc_BufferError,
+                "Existing exports of data (%zd): object cannot be re-sized",
+                self->exports
+        );
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Set the sorted flag by examining every value.
+ */
+static void
+SequenceLongObject_update_sorted(SequenceLongObject *self) {
+    self->sorted = long_array_is_sorted(self->array_long, (size_t) self->size) ?
+                   SEQUENCE_LONG_SORTED : SEQUENCE_LONG_NOT_SORTED;
+}
+
+/**
+ * Returns non-zero if the values are known to be in ascending order.
+ * Whilst a writable buffer is exported this is O(n) as it examines every value, once the buffers have been released
+ * the result is cached again.
+ */
+static int
+SequenceLongObject_is_sorted(SequenceLongObject *self) {
+    if (self->sorted == SEQUENCE_LONG_SORTED_UNKNOWN) {
+        if (self->buffer_exports > 0) {
+            return long_array_is_sorted(self->array_long, (size_t) self->size);
+        }
+        SequenceLongObject_update_sorted(self);
+    }
+    return self->sorted == SEQUENCE_LONG_SORTED;
+}
+
+/**
+ * Maintain the sorted flag after array_long[index] has been written to by comparing it with its neighbours.
+ * For several writes call this for each index after all the writes.
+ */
+static void
+SequenceLongObject_note_write(SequenceLongObject *self, Py_ssize_t index) {
+    assert(index >= 0 && index < self->size);
+    if (self->sorted == SEQUENCE_LONG_SORTED) {
+        if ((index > 0 && self->array_long[index - 1] > self->array_long[index])
+            || (index + 1 < self->size && self->array_long[index] > self->array_long[index + 1])) {
+            self->sorted = SEQUENCE_LONG_NOT_SORTED;
+        }
+    }
+}
+
+/**
+ * Initialise from a sequence of ints or from an object that supports the buffer protocol.
+ * See py_long_array_from_object() for the fast paths.
+ */
+static int
+SequenceLongObject_init_from_object(SequenceLongObject *self, PyObject *sequence) {
+    long *array_long = NULL;
+    Py_ssize_t size = 0;
+
+    /* __init__ can be called again on an existing object. */
+    if (SequenceLongObject_check_exports(self)) {
+        return -1;
+    }
+    if (py_long_array_from_object(sequence, &array_long, &size)) {
+        assert(PyErr_Occurred());
+        return -1;
+    }
+    free(self->array_long);
+    self->array_long = array_long;
+    self->size = size;
+    self->capacity = size;
+    SequenceLongObject_update_sorted(self);
+    return 0;
+}
+
 static int
 SequenceLongObject_init(SequenceLongObject *self, PyObject *args, PyObject *kwds) {
     static char *kwlist[] = {"sequence", NULL};
@@ -35,346 +171,1696 @@ SequenceLongObject_init(SequenceLongObject *self, PyObject *args, PyObject *kwds
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "O", kwlist, &sequence)) {
         return -1;
     }
-    if (!PySequence_Check(sequence)) {
-        return -2;
+    return SequenceLongObject_init_from_object(self, sequence);
+}
+
+static const char *const SequenceLongObject_keywords[] = {"sequence", NULL};
+static PyFastcallParser SequenceLongObject_parser = {"SequenceLongObject", SequenceLongObject_keywords, 1, NULL, 0};
+
+/**
+ * Calling the type, SequenceLongObject(sequence), uses this rather than tp_new then tp_init.
+ * This avoids creating a tuple (and possibly a dict) of the arguments.
+ * tp_vectorcall is not inherited so subclasses use tp_new and tp_init as usual.
+ */
+static PyObject *
+SequenceLongObject_vectorcall(PyObject *type, PyObject *const *args, size_t nargsf, PyObject *kwnames) {
+    PyObject *argv[1];
+
+    if (py_fastcall_unpack(&SequenceLongObject_parser, args, PyVectorcall_NARGS(nargsf), kwnames, argv)) {
+        return NULL;
     }
-    self->size = PySequence_Length(sequence);
-    self->array_long = malloc(self->size * sizeof(long));
-    if (!self->array_long) {
-        return -3;
+    PyObject *self = SequenceLongObject_new((PyTypeObject *) type, NULL, NULL);
+    if (self && SequenceLongObject_init_from_object((SequenceLongObject *) self, argv[0])) {
+        Py_CLEAR(self);
     }
-    for (Py_ssize_t i = 0; i < self->size; ++i) {
-        // New reference.
-        PyObject *py_value = PySequence_GetItem(sequence, i);
-        if (PyLong_Check(py_value)) {
-            self->array_long[i] = PyLong_AsLong(py_value);
-            Py_DECREF(py_value);
-        } else {
-            PyErr_Format(
-                    PyExc_TypeError,
-                    "Argument [%zd] must be a int, not type %s",
-                    i,
-                    Py_TYPE(sequence)->tp_name
-            );
-            // Clean up on error.
-            free(self->array_long);
-            self->array_long = NULL;
-            Py_DECREF(py_value);
-            return -4;
-        }
+    return self;
+}
+
+/* Capacity management. */
+
+/* The smallest capacity allocated when growing. */
+#define SEQUENCE_LONG_MIN_CAPACITY 8
+
+/**
+ * Re-allocate array_long to exactly new_capacity longs, new_capacity must be >= size.
+ * Returns 0 on success, -1 with an exception set on failure in which case the object is unchanged.
+ */
+static int
+SequenceLongObject_set_capacity(SequenceLongObject *self, Py_ssize_t new_capacity) {
+    assert(new_capacity >= self->size);
+    if (new_capacity == self->capacity) {
+        return 0;
+    }
+    if (SequenceLongObject_check_exports(self)) {
+        return -1;
+    }
+    if (new_capacity == 0) {
+        free(self->array_long);
+        self->array_long = NULL;
+        self->capacity = 0;
+        return 0;
+    }
+    if ((size_t) new_capacity > PY_SSIZE_T_MAX / sizeof(long)) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    long *new_array = realloc(self->array_long, new_capacity * sizeof(long));
+    if (!new_array) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    self->array_long = new_array;
+    self->capacity = new_capacity;
+    return 0;
+}
+
+/**
+ * Make sure that there is room for at least additional more values.
+ * The capacity grows geometrically (by 1.5) so that a series of appends is amortised O(1).
+ * Returns 0 on success, -1 with an exception set on failure.
+ */
+static int
+SequenceLongObject_grow(SequenceLongObject *self, Py_ssize_t additional) {
+    assert(additional >= 0);
+    const Py_ssize_t max_capacity = (Py_ssize_t) (PY_SSIZE_T_MAX / sizeof(long));
+    if (additional > max_capacity - self->size) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    Py_ssize_t required = self->size + additional;
+    if (required <= self->capacity) {
+        return 0;
+    }
+    /* capacity <= max_capacity so this can not overflow. */
+    Py_ssize_t new_capacity = self->capacity + (self->capacity >> 1);
+    if (new_capacity > max_capacity) {
+        new_capacity = max_capacity;
+    }
+    if (new_capacity < required) {
+        new_capacity = required;
+    }
+    if (new_capacity < SEQUENCE_LONG_MIN_CAPACITY) {
+        new_capacity = SEQUENCE_LONG_MIN_CAPACITY;
+    }
+    return SequenceLongObject_set_capacity(self, new_capacity);
+}
+
+/**
+ * Append values to the end of the sequence.
+ * Returns 0 on success, -1 with an exception set on failure.
+ */
+static int
+SequenceLongObject_append_array(SequenceLongObject *self, const long *values, Py_ssize_t count) {
+    /* Any change of size invalidates the shape of a buffer export. */
+    if (SequenceLongObject_check_exports(self)) {
+        return -1;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    if (SequenceLongObject_grow(self, count)) {
+        return -1;
+    }
+    if (self->sorted == SEQUENCE_LONG_SORTED
+        && ((self->size > 0 && self->array_long[self->size - 1] > values[0])
+            || !long_array_is_sorted(values, (size_t) count))) {
+        self->sorted = SEQUENCE_LONG_NOT_SORTED;
     }
+    memcpy(self->array_long + self->size, values, count * sizeof(long));
+    self->size += count;
     return 0;
 }
 
 static void
 SequenceLongObject_dealloc(SequenceLongObject *self) {
+    /* A Py_buffer holds a reference to self so this should be impossible. */
+    assert(self->exports == 0);
     free(self->array_long);
     Py_TYPE(self)->tp_free((PyObject *) self);
 }
 
-static PyMethodDef SequenceLongObject_methods[] = {
-//        {
-//                "size",
-//                (PyCFunction) SequenceLongObject_size,
-//                METH_NOARGS,
-//                "Return the size of the sequence."
-//        },
-        {NULL, NULL, 0, NULL}  /* Sentinel */
-};
+// Forward references
+static PyTypeObject SequenceLongObjectType;
 
-/* Sequence methods. */
+static int is_sequence_of_long_type(PyObject *op);
+
+static PyObject *SequenceLongView_create(SequenceLongObject *base, Py_ssize_t start, Py_ssize_t step, Py_ssize_t size);
+
+/* Reductions, see LongArrayKernels.h for the SIMD implementations. */
+
+/* Sequences at least this long release the GIL during a reduction. */
+#define SEQUENCE_LONG_GIL_RELEASE_THRESHOLD (1L << 16)
+
+/**
+ * If the sequence is large this pins the arrays of self and, optionally, other as if they were exported through
+ * the buffer protocol then releases the GIL.
+ * Returns the thread state that must be passed to SequenceLongObject_acquire_gil(), this is NULL if the GIL is
+ * still held.
+ */
+static PyThreadState *
+SequenceLongObject_release_gil(SequenceLongObject *self, SequenceLongObject *other) {
+    if (self->size < SEQUENCE_LONG_GIL_RELEASE_THRESHOLD) {
+        return NULL;
+    }
+    self->exports++;
+    if (other) {
+        other->exports++;
+    }
+    return PyEval_SaveThread();
+}
+
+/**
+ * Re-acquire the GIL, if necessary, and un-pin the arrays.
+ */
+static void
+SequenceLongObject_acquire_gil(SequenceLongObject *self, SequenceLongObject *other, PyThreadState *thread_state) {
+    if (thread_state) {
+        PyEval_RestoreThread(thread_state);
+        self->exports--;
+        if (other) {
+            other->exports--;
+        }
+    }
+}
+
+/**
+ * Convert the LongArraySum to a Python int, the exact value is: high * 2**32 + low - negatives * 2**64
+ * Returns a new reference or NULL on failure.
+ */
+static PyObject *
+long_array_sum_as_py_long(const LongArraySum *sum) {
+    if (sum->high == 0 && sum->negatives == 0) {
+        /* Common case of small, positive, values. */
+        return PyLong_FromUnsignedLongLong(sum->low);
+    }
+    PyObject *ret = NULL;
+    PyObject *high = NULL;
+    PyObject *low = NULL;
+    PyObject *negatives = NULL;
+    PyObject *shift = NULL;
+    PyObject *temp = NULL;
+
+    high = PyLong_FromUnsignedLongLong(sum->high);
+    if (!high) {
+        goto except;
+    }
+    shift = PyLong_FromLong(32L);
+    if (!shift) {
+        goto except;
+    }
+    ret = PyNumber_Lshift(high, shift);
+    if (!ret) {
+        goto except;
+    }
+    low = PyLong_FromUnsignedLongLong(sum->low);
+    if (!low) {
+        goto except;
+    }
+    temp = PyNumber_Add(ret, low);
+    if (!temp) {
+        goto except;
+    }
+    Py_DECREF(ret);
+    ret = temp;
+    temp = NULL;
+    if (sum->negatives) {
+        negatives = PyLong_FromUnsignedLongLong(sum->negatives);
+        if (!negatives) {
+            goto except;
+        }
+        Py_DECREF(shift);
+        shift = PyLong_FromLong(64L);
+        if (!shift) {
+            goto except;
+        }
+        temp = PyNumber_Lshift(negatives, shift);
+        if (!temp) {
+            goto except;
+        }
+        Py_DECREF(negatives);
+        negatives = temp;
+        temp = PyNumber_Subtract(ret, negatives);
+        if (!temp) {
+            goto except;
+        }
+        Py_DECREF(ret);
+        ret = temp;
+        temp = NULL;
+    }
+    assert(!PyErr_Occurred());
+    goto finally;
+except:
+    assert(PyErr_Occurred());
+    Py_XDECREF(ret);
+    ret = NULL;
+finally:
+    Py_XDECREF(high);
+    Py_XDECREF(low);
+    Py_XDECREF(negatives);
+    Py_XDECREF(shift);
+    return ret;
+}
+
+/**
+ * Returns the sum of the sequence as a Python int. This never overflows.
+ */
+static PyObject *
+SequenceLongObject_sum(SequenceLongObject *self, PyObject *Py_UNUSED(ignored)) {
+    PyObject *ret = PyLong_FromLong(0L);
+    Py_ssize_t index = 0;
+    /* A single chunk unless the sequence has more than LONG_ARRAY_SUM_MAX_COUNT values. */
+    while (ret && index < self->size) {
+        size_t count = (size_t) (self->size - index);
+        if (count > LONG_ARRAY_SUM_MAX_COUNT) {
+            count = LONG_ARRAY_SUM_MAX_COUNT;
+        }
+        LongArraySum chunk_sum;
+        PyThreadState *thread_state = SequenceLongObject_release_gil(self, NULL);
+        long_array_sum(self->array_long + index, count, &chunk_sum);
+        SequenceLongObject_acquire_gil(self, NULL, thread_state);
+        index += (Py_ssize_t) count;
+
+        PyObject *py_chunk_sum = long_array_sum_as_py_long(&chunk_sum);
+        if (!py_chunk_sum) {
+            Py_DECREF(ret);
+            return NULL;
+        }
+        PyObject *temp = PyNumber_Add(ret, py_chunk_sum);
+        Py_DECREF(py_chunk_sum);
+        Py_DECREF(ret);
+        ret = temp;
+    }
+    return ret;
+}
+
+/**
+ * Returns the index of the first minimum, or maximum, value or -1 with a ValueError set if the sequence is empty.
+ */
 static Py_ssize_t
-SequenceLongObject_sq_length(PyObject *self) {
-//    fprintf(stdout, "%s(%p): returns=%zd\n", __FUNCTION__, (void *) self, ((SequenceLongObject *) self)->size);
-    return ((SequenceLongObject *) self)->size;
+SequenceLongObject_arg_best(SequenceLongObject *self, int find_max) {
+    if (self->size == 0) {
+        PyErr_Format(PyExc_ValueError, "%s() on empty sequence.", find_max ? "max" : "min");
+        return -1;
+    }
+    PyThreadState *thread_state = SequenceLongObject_release_gil(self, NULL);
+    size_t index = find_max ?
+                   long_array_argmax(self->array_long, (size_t) self->size) :
+                   long_array_argmin(self->array_long, (size_t) self->size);
+    SequenceLongObject_acquire_gil(self, NULL, thread_state);
+    return (Py_ssize_t) index;
 }
 
-// Forward references
-static PyTypeObject SequenceLongObjectType;
+static PyObject *
+SequenceLongObject_argmin(SequenceLongObject *self, PyObject *Py_UNUSED(ignored)) {
+    Py_ssize_t index = SequenceLongObject_arg_best(self, 0);
+    if (index < 0) {
+        return NULL;
+    }
+    return PyLong_FromSsize_t(index);
+}
 
-static int is_sequence_of_long_type(PyObject *op);
+static PyObject *
+SequenceLongObject_argmax(SequenceLongObject *self, PyObject *Py_UNUSED(ignored)) {
+    Py_ssize_t index = SequenceLongObject_arg_best(self, 1);
+    if (index < 0) {
+        return NULL;
+    }
+    return PyLong_FromSsize_t(index);
+}
+
+static PyObject *
+SequenceLongObject_min(SequenceLongObject *self, PyObject *Py_UNUSED(ignored)) {
+    Py_ssize_t index = SequenceLongObject_arg_best(self, 0);
+    if (index < 0) {
+        return NULL;
+    }
+    return PyLong_FromLong(self->array_long[index]);
+}
+
+static PyObject *
+SequenceLongObject_max(SequenceLongObject *self, PyObject *Py_UNUSED(ignored)) {
+    Py_ssize_t index = SequenceLongObject_arg_best(self, 1);
+    if (index < 0) {
+        return NULL;
+    }
+    return PyLong_FromLong(self->array_long[index]);
+}
 
 /**
- * Returns a new SequenceLongObject composed of self + other.
- * @param self
- * @param other
- * @return
+ * Returns the number of values equal to the argument.
+ * Like SequenceLongObject_sq_contains() a value that is not an int, or is too large for a C long, is benignly
+ * never found. If the values are sorted this is a binary search.
  */
 static PyObject *
-SequenceLongObject_sq_concat(PyObject *self, PyObject *other) {
-//    fprintf(stdout, "%s(%p):\n", __FUNCTION__, (void *) self);
+SequenceLongObject_count(SequenceLongObject *self, PyObject *value) {
+    if (!PyLong_Check(value)) {
+        return PyLong_FromLong(0L);
+    }
+    long c_value = PyLong_AsLong(value);
+    if (c_value == -1 && PyErr_Occurred()) {
+        if (PyErr_ExceptionMatches(PyExc_OverflowError)) {
+            PyErr_Clear();
+            return PyLong_FromLong(0L);
+        }
+        return NULL;
+    }
+    if (SequenceLongObject_is_sorted(self)) {
+        /* The difference between the lower and upper bounds. */
+        size_t lower = long_array_lower_bound(self->array_long, (size_t) self->size, c_value);
+        size_t upper = c_value == LONG_MAX ?
+                       (size_t) self->size :
+                       long_array_lower_bound(self->array_long, (size_t) self->size, c_value + 1);
+        return PyLong_FromSize_t(upper - lower);
+    }
+    PyThreadState *thread_state = SequenceLongObject_release_gil(self, NULL);
+    size_t count = long_array_count(self->array_long, (size_t) self->size, c_value);
+    SequenceLongObject_acquire_gil(self, NULL, thread_state);
+    return PyLong_FromSize_t(count);
+}
+
+/**
+ * Returns the dot product with another SequenceLongObject of the same length as a Python int.
+ * If the C calculation overflows this is repeated with Python ints.
+ */
+static PyObject *
+SequenceLongObject_dot(SequenceLongObject *self, PyObject *other) {
     if (!is_sequence_of_long_type(other)) {
         PyErr_Format(
                 PyExc_TypeError,
-                "%s(): argument 1 must have type \"SequenceLongObject\" not %s",
+                "dot() argument must have type \"SequenceLongObject\" not %s",
                 Py_TYPE(other)->tp_name
         );
         return NULL;
     }
-    PyObject *ret = SequenceLongObject_new(&SequenceLongObjectType, NULL, NULL);
-    if (!ret) {
-        assert(PyErr_Occurred());
+    SequenceLongObject *other_as_slo = (SequenceLongObject *) other;
+    if (other_as_slo->size != self->size) {
+        PyErr_Format(
+                PyExc_ValueError,
+                "dot() sequences must be the same length, not %zd and %zd",
+                self->size,
+                other_as_slo->size
+        );
         return NULL;
     }
-    /* For convenience. */
-    SequenceLongObject *ret_as_slo = (SequenceLongObject *) ret;
-    ret_as_slo->size = ((SequenceLongObject *) self)->size + ((SequenceLongObject *) other)->size;
-    ret_as_slo->array_long = malloc(ret_as_slo->size * sizeof(long));
-    if (!ret_as_slo->array_long) {
-        PyErr_Format(PyExc_MemoryError, "%s(): Can not create new object.", __FUNCTION__);
+    long result;
+    PyThreadState *thread_state = SequenceLongObject_release_gil(
+            self, other_as_slo == self ? NULL : other_as_slo
+    );
+    int overflow = long_array_dot(self->array_long, other_as_slo->array_long, (size_t) self->size, &result);
+    SequenceLongObject_acquire_gil(self, other_as_slo == self ? NULL : other_as_slo, thread_state);
+    if (!overflow) {
+        return PyLong_FromLong(result);
+    }
+    /* Slow path with Python ints. */
+    PyObject *ret = PyLong_FromLong(0L);
+    for (Py_ssize_t i = 0; ret && i < self->size; ++i) {
+        PyObject *a = PyLong_FromLong(self->array_long[i]);
+        PyObject *b = PyLong_FromLong(other_as_slo->array_long[i]);
+        PyObject *product = (a && b) ? PyNumber_Multiply(a, b) : NULL;
+        PyObject *temp = product ? PyNumber_Add(ret, product) : NULL;
+        Py_XDECREF(a);
+        Py_XDECREF(b);
+        Py_XDECREF(product);
         Py_DECREF(ret);
-        return NULL;
+        ret = temp;
     }
-//    fprintf(stdout, "%s(): New %p size=%zd\n", __FUNCTION__, (void *) ret_as_slo, ret_as_slo->size);
+    return ret;
+}
 
-    ssize_t i = 0;
-    ssize_t ub = ((SequenceLongObject *) self)->size;
-    while (i < ub) {
-//        fprintf(stdout, "%s(): Setting from %p [%zd] to [%zd]\n", __FUNCTION__, (void *) self, i, i);
-        ret_as_slo->array_long[i] = ((SequenceLongObject *) self)->array_long[i];
-        i++;
+/* Growable sequence methods. */
+
+/**
+ * Append a single int to the end of the sequence, this is amortised O(1).
+ */
+static PyObject *
+SequenceLongObject_append(SequenceLongObject *self, PyObject *value) {
+    if (!PyLong_Check(value)) {
+        PyErr_Format(PyExc_TypeError, "append() argument must be an int, not type %s", Py_TYPE(value)->tp_name);
+        return NULL;
     }
-    ssize_t j = 0;
-    ub = ((SequenceLongObject *) other)->size;
-    while (j < ub) {
-//        fprintf(stdout, "%s(): Setting %p [%zd] to [%zd]\n", __FUNCTION__, (void *) other, j, i);
-        ret_as_slo->array_long[i] = ((SequenceLongObject *) other)->array_long[j];
-        i++;
-        j++;
+    long c_value = PyLong_AsLong(value);
+    if (c_value == -1 && PyErr_Occurred()) {
+        return NULL;
+    }
+    if (self->size < self->capacity && self->exports == 0) {
+        /* Fast path. */
+        self->array_long[self->size++] = c_value;
+        SequenceLongObject_note_write(self, self->size - 1);
+        Py_RETURN_NONE;
+    }
+    if (SequenceLongObject_append_array(self, &c_value, 1)) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+/**
+ * Extend the sequence from an iterable of ints.
+ * Sequences and objects that support the buffer protocol are converted in one pass with py_long_array_from_object()
+ * other iterables, such as generators, are appended one value at a time.
+ * Returns 0 on success, -1 with an exception set on failure.
+ */
+static int
+SequenceLongObject_extend_from_object(SequenceLongObject *self, PyObject *iterable) {
+    if (PySequence_Check(iterable) || PyObject_CheckBuffer(iterable)) {
+        long *values = NULL;
+        Py_ssize_t values_size = 0;
+        /* This copies the values first so extending with self, or a view of self, is safe. */
+        if (py_long_array_from_object(iterable, &values, &values_size)) {
+            return -1;
+        }
+        int result = SequenceLongObject_append_array(self, values, values_size);
+        free(values);
+        return result;
+    }
+    PyObject *iterator = PyObject_GetIter(iterable);
+    if (!iterator) {
+        return -1;
+    }
+    Py_ssize_t hint = PyObject_LengthHint(iterable, 0);
+    if (hint < 0 || (hint > 0 && SequenceLongObject_grow(self, hint))) {
+        Py_DECREF(iterator);
+        return -1;
+    }
+    PyObject *item;
+    while ((item = PyIter_Next(iterator))) {
+        PyObject *result = SequenceLongObject_append(self, item);
+        Py_DECREF(item);
+        if (!result) {
+            Py_DECREF(iterator);
+            return -1;
+        }
+        Py_DECREF(result);
+    }
+    Py_DECREF(iterator);
+    return PyErr_Occurred() ? -1 : 0;
+}
+
+static PyObject *
+SequenceLongObject_extend(SequenceLongObject *self, PyObject *iterable) {
+    if (SequenceLongObject_extend_from_object(self, iterable)) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+/**
+ * Make sure that the capacity is at least the argument so that growing the sequence to that size does not
+ * re-allocate. This never reduces the capacity.
+ */
+static PyObject *
+SequenceLongObject_reserve(SequenceLongObject *self, PyObject *arg) {
+    Py_ssize_t capacity = PyNumber_AsSsize_t(arg, PyExc_OverflowError);
+    if (capacity == -1 && PyErr_Occurred()) {
+        return NULL;
+    }
+    if (capacity < 0) {
+        PyErr_Format(PyExc_ValueError, "reserve() argument must be >= 0 not %zd", capacity);
+        return NULL;
+    }
+    if (capacity > self->capacity && SequenceLongObject_grow(self, capacity - self->size)) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+/**
+ * Reduce the capacity to the size of the sequence.
+ */
+static PyObject *
+SequenceLongObject_shrink_to_fit(SequenceLongObject *self, PyObject *Py_UNUSED(ignored)) {
+    if (SequenceLongObject_set_capacity(self, self->size)) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+SequenceLongObject_get_capacity(SequenceLongObject *self, void *Py_UNUSED(closure)) {
+    return PyLong_FromSsize_t(self->capacity);
+}
+
+/* Searching and sorting. */
+
+/**
+ * Sort the values in place in ascending order with a radix sort.
+ */
+static PyObject *
+SequenceLongObject_sort(SequenceLongObject *self, PyObject *Py_UNUSED(ignored)) {
+    if (!SequenceLongObject_is_sorted(self)) {
+        PyThreadState *thread_state = SequenceLongObject_release_gil(self, NULL);
+        int failed = long_array_sort(self->array_long, (size_t) self->size);
+        SequenceLongObject_acquire_gil(self, NULL, thread_state);
+        if (failed) {
+            return PyErr_NoMemory();
+        }
+        /* A writable buffer that is still exported could un-sort the values. */
+        self->sorted = self->buffer_exports > 0 ? SEQUENCE_LONG_SORTED_UNKNOWN : SEQUENCE_LONG_SORTED;
+    }
+    Py_RETURN_NONE;
+}
+
+/**
+ * Test every int in an iterable for membership.
+ * Returns a bytes object with one byte for each value that is 1 if the value is in the sequence, 0 otherwise.
+ * This can be used with numpy as a boolean array with numpy.frombuffer(result, dtype=bool).
+ */
+static PyObject *
+SequenceLongObject_contains_many(SequenceLongObject *self, PyObject *iterable) {
+    PyObject *ret = NULL;
+    PyObject *sequence = NULL;
+    long *needles = NULL;
+    Py_ssize_t needle_count = 0;
+
+    if (PySequence_Check(iterable) || PyObject_CheckBuffer(iterable)) {
+        sequence = iterable;
+        Py_INCREF(sequence);
+    } else {
+        sequence = PySequence_List(iterable);
+        if (!sequence) {
+            goto except;
+        }
+    }
+    if (py_long_array_from_object(sequence, &needles, &needle_count)) {
+        goto except;
+    }
+    ret = PyBytes_FromStringAndSize(NULL, needle_count);
+    if (!ret) {
+        goto except;
+    }
+    int is_sorted = SequenceLongObject_is_sorted(self);
+    /* ret is not yet visible to any other thread so can be written to without the GIL. */
+    PyThreadState *thread_state = SequenceLongObject_release_gil(self, NULL);
+    int failed = long_array_contains_many(
+            self->array_long, (size_t) self->size, is_sorted,
+            needles, (size_t) needle_count, (unsigned char *) PyBytes_AS_STRING(ret)
+    );
+    SequenceLongObject_acquire_gil(self, NULL, thread_state);
+    if (failed) {
+        PyErr_NoMemory();
+        goto except;
+    }
+    assert(!PyErr_Occurred());
+    goto finally;
+except:
+    assert(PyErr_Occurred());
+    Py_XDECREF(ret);
+    ret = NULL;
+finally:
+    free(needles);
+    Py_XDECREF(sequence);
+    return ret;
+}
+
+static PyObject *
+SequenceLongObject_get_is_sorted(SequenceLongObject *self, void *Py_UNUSED(closure)) {
+    return PyBool_FromLong(SequenceLongObject_is_sorted(self));
+}
+
+/* Locked entry points for the methods and attributes. */
+#define SEQUENCE_LONG_METH_LOCKED(name) \
+    SEQUENCE_LONG_LOCKED(PyObject *, name, (SequenceLongObject *self, PyObject *arg), (self, arg), self)
+#define SEQUENCE_LONG_METH_LOCKED2(name) \
+    SEQUENCE_LONG_LOCKED2(PyObject *, name, (SequenceLongObject *self, PyObject *arg), (self, arg), self, arg)
+
+SEQUENCE_LONG_METH_LOCKED(SequenceLongObject_sum)
+SEQUENCE_LONG_METH_LOCKED(SequenceLongObject_min)
+SEQUENCE_LONG_METH_LOCKED(SequenceLongObject_max)
+SEQUENCE_LONG_METH_LOCKED(SequenceLongObject_argmin)
+SEQUENCE_LONG_METH_LOCKED(SequenceLongObject_argmax)
+SEQUENCE_LONG_METH_LOCKED(SequenceLongObject_count)
+SEQUENCE_LONG_METH_LOCKED2(SequenceLongObject_dot)
+SEQUENCE_LONG_METH_LOCKED(SequenceLongObject_append)
+SEQUENCE_LONG_METH_LOCKED2(SequenceLongObject_extend)
+SEQUENCE_LONG_METH_LOCKED(SequenceLongObject_reserve)
+SEQUENCE_LONG_METH_LOCKED(SequenceLongObject_shrink_to_fit)
+SEQUENCE_LONG_METH_LOCKED(SequenceLongObject_sort)
+SEQUENCE_LONG_METH_LOCKED2(SequenceLongObject_contains_many)
+SEQUENCE_LONG_LOCKED(PyObject *, SequenceLongObject_get_capacity, (SequenceLongObject *self, void *closure),
+                     (self, closure), self)
+SEQUENCE_LONG_LOCKED(PyObject *, SequenceLongObject_get_is_sorted, (SequenceLongObject *self, void *closure),
+                     (self, closure), self)
+
+static PyGetSetDef SequenceLongObject_getsetters[] = {
+        {"capacity", (getter) SequenceLongObject_get_capacity_locked, NULL,
+                "The number of values that the sequence can hold without re-allocating.", NULL},
+        {"is_sorted", (getter) SequenceLongObject_get_is_sorted_locked, NULL,
+                "True if the values are in ascending order, searches are then a binary search. "
+                "This is cached except whilst a buffer is exported when every value is examined.", NULL},
+        {NULL, NULL, NULL, NULL, NULL}  /* Sentinel */
+};
+
+static PyMethodDef SequenceLongObject_methods[] = {
+//        {
+//                "size",
+//                (PyCFunction) SequenceLongObject_size,
+//                METH_NOARGS,
+//                "Return the size of the sequence."
+//        },
+        {"sum",    (PyCFunction) SequenceLongObject_sum_locked,    METH_NOARGS, "Return the sum of the values."},
+        {"min",    (PyCFunction) SequenceLongObject_min_locked,    METH_NOARGS, "Return the minimum value."},
+        {"max",    (PyCFunction) SequenceLongObject_max_locked,    METH_NOARGS, "Return the maximum value."},
+        {"argmin", (PyCFunction) SequenceLongObject_argmin_locked, METH_NOARGS, "Return the index of the first minimum value."},
+        {"argmax", (PyCFunction) SequenceLongObject_argmax_locked, METH_NOARGS, "Return the index of the first maximum value."},
+        {"count",  (PyCFunction) SequenceLongObject_count_locked,  METH_O,      "Return the number of values equal to the argument."},
+        {"dot",    (PyCFunction) SequenceLongObject_dot_locked,    METH_O,      "Return the dot product with another SequenceLongObject."},
+        {"append", (PyCFunction) SequenceLongObject_append_locked, METH_O,      "Append an int to the end of the sequence."},
+        {"extend", (PyCFunction) SequenceLongObject_extend_locked, METH_O,      "Extend the sequence from an iterable of ints."},
+        {"reserve", (PyCFunction) SequenceLongObject_reserve_locked, METH_O,
+                "Make sure the capacity is at least the argument."},
+        {"shrink_to_fit", (PyCFunction) SequenceLongObject_shrink_to_fit_locked, METH_NOARGS,
+                "Reduce the capacity to the size of the sequence."},
+        {"sort", (PyCFunction) SequenceLongObject_sort_locked, METH_NOARGS, "Sort the values in place in ascending order."},
+        {"contains_many", (PyCFunction) SequenceLongObject_contains_many_locked, METH_O,
+                "Return bytes with 1 for each value of the iterable that is in the sequence, 0 otherwise."},
+        {NULL, NULL, 0, NULL}  /* Sentinel */
+};
+
+/* Sequence methods. */
+static Py_ssize_t
+SequenceLongObject_sq_length(PyObject *self) {
+//    fprintf(stdout, "%s(%p): returns=%zd\n", __FUNCTION__, (void *) self, ((SequenceLongObject *) self)->size);
+    return ((SequenceLongObject *) self)->size;
+}
+
+/**
+ * Returns a new SequenceLongObject composed of self + other.
+ * @param self
+ * @param other
+ * @return
+ */
+static PyObject *
+SequenceLongObject_sq_concat(PyObject *self, PyObject *other) {
+//    fprintf(stdout, "%s(%p):\n", __FUNCTION__, (void *) self);
+    if (!is_sequence_of_long_type(other)) {
+        PyErr_Format(
+                PyExc_TypeError,
+                "%s(): argument 1 must have type \"SequenceLongObject\" not %s",
+                Py_TYPE(other)->tp_name
+        );
+        return NULL;
+    }
+    PyObject *ret = SequenceLongObject_new(&SequenceLongObjectType, NULL, NULL);
+    if (!ret) {
+        assert(PyErr_Occurred());
+        return NULL;
+    }
+    /* For convenience. */
+    SequenceLongObject *ret_as_slo = (SequenceLongObject *) ret;
+    ret_as_slo->size = ((SequenceLongObject *) self)->size + ((SequenceLongObject *) other)->size;
+    ret_as_slo->capacity = ret_as_slo->size;
+    ret_as_slo->array_long = malloc(ret_as_slo->size * sizeof(long));
+    if (!ret_as_slo->array_long) {
+        PyErr_Format(PyExc_MemoryError, "%s(): Can not create new object.", __FUNCTION__);
+        Py_DECREF(ret);
+        return NULL;
+    }
+//    fprintf(stdout, "%s(): New %p size=%zd\n", __FUNCTION__, (void *) ret_as_slo, ret_as_slo->size);
+
+    ssize_t i = 0;
+    ssize_t ub = ((SequenceLongObject *) self)->size;
+    while (i < ub) {
+//        fprintf(stdout, "%s(): Setting from %p [%zd] to [%zd]\n", __FUNCTION__, (void *) self, i, i);
+        ret_as_slo->array_long[i] = ((SequenceLongObject *) self)->array_long[i];
+        i++;
+    }
+    ssize_t j = 0;
+    ub = ((SequenceLongObject *) other)->size;
+    while (j < ub) {
+//        fprintf(stdout, "%s(): Setting %p [%zd] to [%zd]\n", __FUNCTION__, (void *) other, j, i);
+        ret_as_slo->array_long[i] = ((SequenceLongObject *) other)->array_long[j];
+        i++;
+        j++;
+    }
+    SequenceLongObject_update_sorted(ret_as_slo);
+    return ret;
+}
+
+/**
+ * Return a new sequence which contains the old one repeated count times.
+ * @param self
+ * @param count
+ * @return
+ */
+static PyObject *
+SequenceLongObject_sq_repeat(PyObject *self, Py_ssize_t count) {
+    PyObject *ret = SequenceLongObject_new(&SequenceLongObjectType, NULL, NULL);
+    if (!ret) {
+        assert(PyErr_Occurred());
+        return NULL;
+    }
+    assert(ret != self);
+    if (((SequenceLongObject *) self)->size > 0 && count > 0) {
+        /* For convenience. */
+        SequenceLongObject *self_as_slo = (SequenceLongObject *) self;
+        SequenceLongObject *ret_as_slo = (SequenceLongObject *) ret;
+        ret_as_slo->size = self_as_slo->size * count;
+        ret_as_slo->capacity = ret_as_slo->size;
+        assert(ret_as_slo->size > 0);
+        ret_as_slo->array_long = malloc(ret_as_slo->size * sizeof(long));
+        if (!ret_as_slo->array_long) {
+            PyErr_Format(PyExc_MemoryError, "%s(): Can not create new object.", __FUNCTION__);
+            Py_DECREF(ret);
+            return NULL;
+        }
+        Py_ssize_t ret_index = 0;
+        for (Py_ssize_t i = 0; i < count; ++i) {
+//            fprintf(stdout, "%s(): Setting %p Count %zd\n", __FUNCTION__, (void *) ret, i);
+            for (Py_ssize_t j = 0; j < self_as_slo->size; ++j) {
+//                fprintf(
+//                    stdout, "%s(): Setting %p [%zd] to %zd\n",
+//                    __FUNCTION__, (void *) ret, ret_index, self_as_slo->array_long[j]
+//                );
+                ret_as_slo->array_long[ret_index] = self_as_slo->array_long[j];
+                ++ret_index;
+            }
+        }
+        SequenceLongObject_update_sorted(ret_as_slo);
+    } else {
+        /* Empty sequence. */
+    }
+    return ret;
+}
+
+/**
+ * Returns a new reference to an indexed item in a sequence.
+ * @param self
+ * @param index
+ * @return
+ */
+static PyObject *
+SequenceLongObject_sq_item(PyObject *self, Py_ssize_t index) {
+//    fprintf(stdout, "%s(): index=%zd\n", __FUNCTION__, index);
+    Py_ssize_t my_index = index;
+    if (my_index < 0) {
+        my_index += SequenceLongObject_sq_length(self);
+    }
+    // Corner case example: len(self) == 0 and index < 0
+    if (my_index < 0 || my_index >= SequenceLongObject_sq_length(self)) {
+//        fprintf(stdout, "%s(): index=%zd\n", __FUNCTION__, index);
+        PyErr_Format(
+                PyExc_IndexError,
+                "Index %ld is out of range for length %ld",
+                index,
+                SequenceLongObject_sq_length(self)
+        );
+        return NULL;
+    }
+    return PyLong_FromLong(((SequenceLongObject *) self)->array_long[my_index]);
+}
+
+static int
+SequenceLongObject_sq_ass_item(PyObject *self, Py_ssize_t index, PyObject *value) {
+    fprintf(
+        stdout, "%s()#%d: self=%p index=%zd value=%p\n",
+        __FUNCTION__, __LINE__, (void *) self, index, (void *) value
+    );
+    /* This is very weird.
+     * When the given index is negative and out of range PyObject_SetItem()
+     * and PyObject_DelItem() will have *already* added the sequence length
+     * before calling this function.
+     * So to get the original out of range negative index we have to *subtract*
+     * the sequence length. */
+    if (index < 0) {
+        fprintf(
+            stdout, "%s()#%d: Fixing index index=%zd to %zd\n", __FUNCTION__, __LINE__,
+            index, index - SequenceLongObject_sq_length(self)
+        );
+        index -= SequenceLongObject_sq_length(self);
+    }
+    /* Isn't it? */
+    Py_ssize_t my_index = index;
+    if (my_index < 0) {
+        my_index += SequenceLongObject_sq_length(self);
+    }
+    // Corner case example: len(self) == 0 and index < 0
+    fprintf(
+        stdout, "%s()#%d: len=%zd index=%zd my_index=%zd\n", __FUNCTION__, __LINE__,
+        SequenceLongObject_sq_length(self), index, my_index
+    );
+    if (my_index < 0 || my_index >= SequenceLongObject_sq_length(self)) {
+        PyErr_Format(
+                PyExc_IndexError,
+                "Index %ld is out of range for length %ld",
+                index,
+                SequenceLongObject_sq_length(self)
+        );
+        return -1;
+    }
+    if (value != NULL) {
+        /* Just set the value. */
+        if (!PyLong_Check(value)) {
+            PyErr_Format(
+                    PyExc_TypeError,
+                    "sq_ass_item value needs to be an int, not type %s",
+                    Py_TYPE(value)->tp_name
+            );
+            return -1;
+        }
+        ((SequenceLongObject *) self)->array_long[my_index] = PyLong_AsLong(value);
+        SequenceLongObject_note_write((SequenceLongObject *) self, my_index);
+    } else {
+        /* Delete the value. */
+        /* For convenience. */
+        SequenceLongObject *self_as_slo = (SequenceLongObject *) self;
+        if (SequenceLongObject_check_exports(self_as_slo)) {
+            return -1;
+        }
+        /* Special case: deleting the only item in the array. */
+        if (self_as_slo->size == 1) {
+            fprintf(stdout, "%s()#%d: deleting empty index\n", __FUNCTION__, __LINE__);
+            free(self_as_slo->array_long);
+            self_as_slo->array_long = NULL;
+            self_as_slo->size = 0;
+            self_as_slo->capacity = 0;
+        } else {
+            /* Delete the value and re-compose the array. */
+            fprintf(stdout, "%s()#%d: deleting index=%zd\n", __FUNCTION__, __LINE__, index);
+            long *new_array = malloc((self_as_slo->size - 1) * sizeof(long));
+            if (!new_array) {
+                PyErr_Format(
+                        PyExc_MemoryError,
+                        "sq_ass_item can not allocate new array. %s#%d",
+                        __FILE__, __LINE__
+                );
+                return -1;
+            }
+            /* Copy up to the index. */
+            Py_ssize_t index_new_array = 0;
+            for (Py_ssize_t i = 0; i < my_index; ++i, ++index_new_array) {
+                new_array[index_new_array] = self_as_slo->array_long[i];
+            }
+            /* Copy past the index. */
+            for (Py_ssize_t i = my_index + 1; i < self_as_slo->size; ++i, ++index_new_array) {
+                new_array[index_new_array] = self_as_slo->array_long[i];
+            }
+
+            free(self_as_slo->array_long);
+            self_as_slo->array_long = new_array;
+            --self_as_slo->size;
+            self_as_slo->capacity = self_as_slo->size;
+        }
+    }
+    return 0;
+}
+
+/**
+ * If an item in self is equal to value, return 1, otherwise return 0. On error, return -1.
+ * @param self
+ * @param value
+ * @return
+ */
+static int
+SequenceLongObject_sq_contains(PyObject *self, PyObject *value) {
+    if (!PyLong_Check(value)) {
+        /* Alternates: Could raise TypeError or return -1.
+         * Here we act benignly! */
+        return 0;
+    }
+    long c_value = PyLong_AsLong(value);
+    if (c_value == -1 && PyErr_Occurred()) {
+        if (PyErr_ExceptionMatches(PyExc_OverflowError)) {
+            /* Too large to be in the sequence. */
+            PyErr_Clear();
+            return 0;
+        }
+        return -1;
+    }
+    /* For convenience. */
+    SequenceLongObject *self_as_slo = (SequenceLongObject *) self;
+    size_t size = (size_t) self_as_slo->size;
+    if (SequenceLongObject_is_sorted(self_as_slo)) {
+        size_t index = long_array_lower_bound(self_as_slo->array_long, size, c_value);
+        return index < size && self_as_slo->array_long[index] == c_value;
+    }
+    PyThreadState *thread_state = SequenceLongObject_release_gil(self_as_slo, NULL);
+    size_t index = long_array_find(self_as_slo->array_long, size, c_value);
+    SequenceLongObject_acquire_gil(self_as_slo, NULL, thread_state);
+    return index < size;
+}
+
+/**
+ * Implements self += other where other is any iterable of ints.
+ * Returns a new reference to self.
+ */
+static PyObject *
+SequenceLongObject_sq_inplace_concat(PyObject *self, PyObject *other) {
+    if (SequenceLongObject_extend_from_object((SequenceLongObject *) self, other)) {
+        return NULL;
+    }
+    Py_INCREF(self);
+    return self;
+}
+
+/**
+ * Implements self *= count, this re-allocates at most once.
+ * Returns a new reference to self.
+ */
+static PyObject *
+SequenceLongObject_sq_inplace_repeat(PyObject *self, Py_ssize_t count) {
+    /* For convenience. */
+    SequenceLongObject *self_as_slo = (SequenceLongObject *) self;
+    Py_ssize_t size = self_as_slo->size;
+    if (count != 1 && size > 0) {
+        if (SequenceLongObject_check_exports(self_as_slo)) {
+            return NULL;
+        }
+        if (count <= 0) {
+            self_as_slo->size = 0;
+            self_as_slo->sorted = SEQUENCE_LONG_SORTED;
+        } else {
+            /* Repeating sorted values is only sorted if they are all equal. */
+            if (self_as_slo->sorted == SEQUENCE_LONG_SORTED
+                && self_as_slo->array_long[0] != self_as_slo->array_long[size - 1]) {
+                self_as_slo->sorted = SEQUENCE_LONG_NOT_SORTED;
+            }
+            if (size > (Py_ssize_t) (PY_SSIZE_T_MAX / sizeof(long)) / count) {
+                return PyErr_NoMemory();
+            }
+            if (SequenceLongObject_grow(self_as_slo, size * (count - 1))) {
+                return NULL;
+            }
+            for (Py_ssize_t i = 1; i < count; ++i) {
+                memcpy(self_as_slo->array_long + i * size, self_as_slo->array_long, size * sizeof(long));
+            }
+            self_as_slo->size = size * count;
+        }
+    }
+    Py_INCREF(self);
+    return self;
+}
+
+/* Locked entry points for the sequence methods. */
+SEQUENCE_LONG_LOCKED(Py_ssize_t, SequenceLongObject_sq_length, (PyObject *self), (self), self)
+SEQUENCE_LONG_LOCKED2(PyObject *, SequenceLongObject_sq_concat, (PyObject *self, PyObject *other), (self, other),
+                      self, other)
+SEQUENCE_LONG_LOCKED(PyObject *, SequenceLongObject_sq_repeat, (PyObject *self, Py_ssize_t count), (self, count), self)
+SEQUENCE_LONG_LOCKED(PyObject *, SequenceLongObject_sq_item, (PyObject *self, Py_ssize_t index), (self, index), self)
+SEQUENCE_LONG_LOCKED(int, SequenceLongObject_sq_ass_item, (PyObject *self, Py_ssize_t index, PyObject *value),
+                     (self, index, value), self)
+SEQUENCE_LONG_LOCKED(int, SequenceLongObject_sq_contains, (PyObject *self, PyObject *value), (self, value), self)
+SEQUENCE_LONG_LOCKED2(PyObject *, SequenceLongObject_sq_inplace_concat, (PyObject *self, PyObject *other),
+                      (self, other), self, other)
+SEQUENCE_LONG_LOCKED(PyObject *, SequenceLongObject_sq_inplace_repeat, (PyObject *self, Py_ssize_t count),
+                     (self, count), self)
+
+static PySequenceMethods SequenceLongObject_sequence_methods = {
+        .sq_length = (lenfunc)SequenceLongObject_sq_length_locked,
+        .sq_concat = (binaryfunc)SequenceLongObject_sq_concat_locked,
+        .sq_repeat = (ssizeargfunc)SequenceLongObject_sq_repeat_locked,
+        .sq_item = (ssizeargfunc)SequenceLongObject_sq_item_locked,
+        .sq_ass_item = (ssizeobjargproc)SequenceLongObject_sq_ass_item_locked,
+        .sq_contains = (objobjproc)SequenceLongObject_sq_contains_locked,
+        .sq_inplace_concat = (binaryfunc)SequenceLongObject_sq_inplace_concat_locked,
+        .sq_inplace_repeat = (ssizeargfunc)SequenceLongObject_sq_inplace_repeat_locked,
+};
+
+/* Mapping methods, these add slicing.
+ * Integer indexes are delegated to the sequence methods so behave exactly as before.
+ * A slice returns a SequenceLongView that shares array_long rather than copying it. */
+
+static Py_ssize_t
+SequenceLongObject_mp_length(PyObject *self) {
+    return ((SequenceLongObject *) self)->size;
+}
+
+static PyObject *
+SequenceLongObject_mp_subscript(PyObject *self, PyObject *key) {
+    /* For convenience. */
+    SequenceLongObject *self_as_slo = (SequenceLongObject *) self;
+    if (PySlice_Check(key)) {
+        Py_ssize_t start, stop, step;
+        if (PySlice_Unpack(key, &start, &stop, &step) < 0) {
+            return NULL;
+        }
+        Py_ssize_t slice_length = PySlice_AdjustIndices(self_as_slo->size, &start, &stop, step);
+        return SequenceLongView_create(self_as_slo, start, step, slice_length);
+    }
+    if (PyIndex_Check(key)) {
+        Py_ssize_t index = PyNumber_AsSsize_t(key, PyExc_IndexError);
+        if (index == -1 && PyErr_Occurred()) {
+            return NULL;
+        }
+        return PySequence_GetItem(self, index);
+    }
+    PyErr_Format(
+            PyExc_TypeError,
+            "SequenceLongObject indices must be integers or slices, not %s",
+            Py_TYPE(key)->tp_name
+    );
+    return NULL;
+}
+
+/**
+ * Delete the values in the slice, this compacts the array in place.
+ * The slice must have been adjusted by PySlice_AdjustIndices().
+ */
+static int
+SequenceLongObject_del_slice(SequenceLongObject *self, Py_ssize_t start, Py_ssize_t step, Py_ssize_t slice_length) {
+    if (slice_length == 0) {
+        return 0;
+    }
+    if (SequenceLongObject_check_exports(self)) {
+        return -1;
+    }
+    if (step < 0) {
+        /* Same values in ascending order. */
+        start += step * (slice_length - 1);
+        step = -step;
+    }
+    Py_ssize_t index_new_array = start;
+    Py_ssize_t next_deleted = start;
+    for (Py_ssize_t i = start; i < self->size; ++i) {
+        if (i == next_deleted && slice_length > 0) {
+            next_deleted += step;
+            --slice_length;
+        } else {
+            self->array_long[index_new_array++] = self->array_long[i];
+        }
+    }
+    self->size = index_new_array;
+    /* Keep the capacity for any future growth. */
+    return 0;
+}
+
+/**
+ * Assign any object acceptable to py_long_array_from_object() to a slice.
+ * A simple slice can change the size of the sequence, an extended slice must be the same length as the value.
+ * The slice must have been adjusted by PySlice_AdjustIndices().
+ */
+static int
+SequenceLongObject_ass_slice(SequenceLongObject *self, Py_ssize_t start, Py_ssize_t stop, Py_ssize_t step,
+                             Py_ssize_t slice_length, PyObject *value) {
+    long *values = NULL;
+    Py_ssize_t values_size = 0;
+    /* This copies the value first so assigning self, or a view of self, is safe. */
+    if (py_long_array_from_object(value, &values, &values_size)) {
+        return -1;
+    }
+    if (values_size == slice_length) {
+        for (Py_ssize_t i = 0; i < slice_length; ++i) {
+            self->array_long[start + i * step] = values[i];
+        }
+        for (Py_ssize_t i = 0; i < slice_length; ++i) {
+            SequenceLongObject_note_write(self, start + i * step);
+        }
+    } else if (step == 1) {
+        if (SequenceLongObject_check_exports(self)) {
+            goto except;
+        }
+        if (stop < start) {
+            stop = start;
+        }
+        Py_ssize_t new_size = self->size - slice_length + values_size;
+        long *new_array = NULL;
+        if (new_size > 0) {
+            new_array = malloc(new_size * sizeof(long));
+            if (!new_array) {
+                PyErr_NoMemory();
+                goto except;
+            }
+            memcpy(new_array, self->array_long, start * sizeof(long));
+            memcpy(new_array + start, values, values_size * sizeof(long));
+            memcpy(new_array + start + values_size, self->array_long + stop, (self->size - stop) * sizeof(long));
+        }
+        free(self->array_long);
+        self->array_long = new_array;
+        self->size = new_size;
+        self->capacity = new_size;
+        SequenceLongObject_update_sorted(self);
+    } else {
+        PyErr_Format(
+                PyExc_ValueError,
+                "attempt to assign sequence of size %zd to extended slice of size %zd",
+                values_size,
+                slice_length
+        );
+        goto except;
+    }
+    free(values);
+    return 0;
+except:
+    free(values);
+    return -1;
+}
+
+static int
+SequenceLongObject_mp_ass_subscript(PyObject *self, PyObject *key, PyObject *value) {
+    /* For convenience. */
+    SequenceLongObject *self_as_slo = (SequenceLongObject *) self;
+    if (PySlice_Check(key)) {
+        Py_ssize_t start, stop, step;
+        if (PySlice_Unpack(key, &start, &stop, &step) < 0) {
+            return -1;
+        }
+        Py_ssize_t slice_length = PySlice_AdjustIndices(self_as_slo->size, &start, &stop, step);
+        if (value == NULL) {
+            return SequenceLongObject_del_slice(self_as_slo, start, step, slice_length);
+        }
+        return SequenceLongObject_ass_slice(self_as_slo, start, stop, step, slice_length, value);
+    }
+    if (PyIndex_Check(key)) {
+        Py_ssize_t index = PyNumber_AsSsize_t(key, PyExc_IndexError);
+        if (index == -1 && PyErr_Occurred()) {
+            return -1;
+        }
+        if (value == NULL) {
+            return PySequence_DelItem(self, index);
+        }
+        return PySequence_SetItem(self, index, value);
+    }
+    PyErr_Format(
+            PyExc_TypeError,
+            "SequenceLongObject indices must be integers or slices, not %s",
+            Py_TYPE(key)->tp_name
+    );
+    return -1;
+}
+
+/* Locked entry points for the mapping methods. */
+SEQUENCE_LONG_LOCKED(Py_ssize_t, SequenceLongObject_mp_length, (PyObject *self), (self), self)
+SEQUENCE_LONG_LOCKED(PyObject *, SequenceLongObject_mp_subscript, (PyObject *self, PyObject *key), (self, key), self)
+
+/* The value is NULL for deletion, otherwise it might be a SequenceLongObject so is locked as well. */
+static int
+SequenceLongObject_mp_ass_subscript_locked(PyObject *self, PyObject *key, PyObject *value) {
+    int ret;
+    if (value) {
+        Py_BEGIN_CRITICAL_SECTION2(self, value);
+        ret = SequenceLongObject_mp_ass_subscript(self, key, value);
+        Py_END_CRITICAL_SECTION2();
+    } else {
+        Py_BEGIN_CRITICAL_SECTION(self);
+        ret = SequenceLongObject_mp_ass_subscript(self, key, value);
+        Py_END_CRITICAL_SECTION();
     }
     return ret;
 }
 
+static PyMappingMethods SequenceLongObject_mapping_methods = {
+        .mp_length = (lenfunc) SequenceLongObject_mp_length_locked,
+        .mp_subscript = (binaryfunc) SequenceLongObject_mp_subscript_locked,
+        .mp_ass_subscript = (objobjargproc) SequenceLongObject_mp_ass_subscript_locked,
+};
+
+/* Buffer protocol, see https://docs.python.org/3/c-api/buffer.html
+ * This exports array_long as a one dimensional, C contiguous, writable array of C longs with format "l".
+ * Consumers such as memoryview, struct, array.array or numpy can then read the data without copying or
+ * creating a Python int for every value. */
+
+/* The stride of every export. This is never written to by the consumer. */
+static Py_ssize_t SequenceLongObject_buffer_strides[1] = {sizeof(long)};
+/* An empty sequence has a NULL array_long so export a valid (but zero length) pointer instead. */
+static long SequenceLongObject_buffer_empty[1] = {0L};
+
+static int
+SequenceLongObject_bf_getbuffer(PyObject *self, Py_buffer *view, int flags) {
+    /* For convenience. */
+    SequenceLongObject *self_as_slo = (SequenceLongObject *) self;
+    if (view == NULL) {
+        PyErr_SetString(PyExc_BufferError, "SequenceLongObject_bf_getbuffer(): view is NULL.");
+        return -1;
+    }
+    view->obj = self;
+    Py_INCREF(view->obj);
+    view->buf = self_as_slo->array_long ? self_as_slo->array_long : SequenceLongObject_buffer_empty;
+    view->len = self_as_slo->size * (Py_ssize_t) sizeof(long);
+    view->readonly = 0;
+    view->itemsize = sizeof(long);
+    view->format = (flags & PyBUF_FORMAT) == PyBUF_FORMAT ? "l" : NULL;
+    view->ndim = 1;
+    /* shape points into the object, this is safe as the object can not be re-sized whilst exported. */
+    view->shape = (flags & PyBUF_ND) == PyBUF_ND ? &self_as_slo->size : NULL;
+    view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? SequenceLongObject_buffer_strides : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+    /* Pin the array. */
+    self_as_slo->exports++;
+    self_as_slo->buffer_exports++;
+    /* The consumer can write to the values. */
+    if (self_as_slo->sorted == SEQUENCE_LONG_SORTED) {
+        self_as_slo->sorted = SEQUENCE_LONG_SORTED_UNKNOWN;
+    }
+    return 0;
+}
+
+static void
+SequenceLongObject_bf_releasebuffer(PyObject *self, Py_buffer *Py_UNUSED(view)) {
+    assert(((SequenceLongObject *) self)->exports > 0);
+    assert(((SequenceLongObject *) self)->buffer_exports > 0);
+    ((SequenceLongObject *) self)->exports--;
+    ((SequenceLongObject *) self)->buffer_exports--;
+}
+
+/* Locked entry points for the buffer protocol. */
+SEQUENCE_LONG_LOCKED(int, SequenceLongObject_bf_getbuffer, (PyObject *self, Py_buffer *view, int flags),
+                     (self, view, flags), self)
+
+static void
+SequenceLongObject_bf_releasebuffer_locked(PyObject *self, Py_buffer *view) {
+    Py_BEGIN_CRITICAL_SECTION(self);
+    SequenceLongObject_bf_releasebuffer(self, view);
+    Py_END_CRITICAL_SECTION();
+}
+
+static PyBufferProcs SequenceLongObject_buffer_procs = {
+        .bf_getbuffer = (getbufferproc) SequenceLongObject_bf_getbuffer_locked,
+        .bf_releasebuffer = (releasebufferproc) SequenceLongObject_bf_releasebuffer_locked,
+};
+
+static PyObject *
+SequenceLongObject___str__(SequenceLongObject *self, PyObject *Py_UNUSED(ignored)) {
+    assert(!PyErr_Occurred());
+    return PyUnicode_FromFormat("<SequenceLongObject sequence size: %ld>", self->size);
+}
+
+SEQUENCE_LONG_LOCKED(PyObject *, SequenceLongObject___str__, (SequenceLongObject *self, PyObject *ignored),
+                     (self, ignored), self)
+SEQUENCE_LONG_LOCKED(int, SequenceLongObject_init, (SequenceLongObject *self, PyObject *args, PyObject *kwds),
+                     (self, args, kwds), self)
+
+static PyTypeObject SequenceLongObjectType = {
+        PyVarObject_HEAD_INIT(NULL, 0)
+        .tp_name = "SequenceLongObject",
+        .tp_basicsize = sizeof(SequenceLongObject),
+        .tp_itemsize = 0,
+        .tp_dealloc = (destructor) SequenceLongObject_dealloc,
+        .tp_as_sequence = &SequenceLongObject_sequence_methods,
+        .tp_as_mapping = &SequenceLongObject_mapping_methods,
+        .tp_str = (reprfunc) SequenceLongObject___str___locked,
+        .tp_as_buffer = &SequenceLongObject_buffer_procs,
+        .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+        .tp_doc = "Sequence of long integers.",
+//        .tp_iter = NULL,
+//        .tp_iternext = NULL,
+        .tp_methods = SequenceLongObject_methods,
+        .tp_getset = SequenceLongObject_getsetters,
+        .tp_init = (initproc) SequenceLongObject_init_locked,
+        .tp_new = SequenceLongObject_new,
+        .tp_vectorcall = SequenceLongObject_vectorcall,
+};
+
+static int
+is_sequence_of_long_type(PyObject *op) {
+    return Py_TYPE(op) == &SequenceLongObjectType;
+}
+
+/**** SequenceLongView, a slice of a SequenceLongObject that shares its array_long. ****/
+
+/* The view holds a reference to the base and pins its array in the same way as a buffer export so the base can not
+ * be re-sized whilst any view exists.
+ * Value i of the view is base->array_long[start + i * step]. */
+typedef struct {
+    PyObject_HEAD
+    SequenceLongObject *base;
+    Py_ssize_t start;
+    Py_ssize_t step;
+    Py_ssize_t size;
+    /* step * sizeof(long), the stride of buffer exports. */
+    Py_ssize_t buffer_stride;
+} SequenceLongView;
+
+static PyTypeObject SequenceLongViewType;
+
+/**
+ * Create a new view of base, the arguments must have been adjusted by PySlice_AdjustIndices().
+ * Returns a new reference or NULL on failure.
+ */
+static PyObject *
+SequenceLongView_create(SequenceLongObject *base, Py_ssize_t start, Py_ssize_t step, Py_ssize_t size) {
+    SequenceLongView *view = PyObject_New(SequenceLongView, &SequenceLongViewType);
+    if (!view) {
+        return NULL;
+    }
+    Py_INCREF(base);
+    view->base = base;
+    /* An empty or single value view has no meaningful start or step, normalise them so that composing slices of
+     * slices can not overflow. */
+    view->start = size > 0 ? start : 0;
+    view->step = size > 1 ? step : 1;
+    view->size = size;
+    view->buffer_stride = view->step * (Py_ssize_t) sizeof(long);
+    /* Pin the array. */
+    base->exports++;
+    return (PyObject *) view;
+}
+
+static void
+SequenceLongView_dealloc(SequenceLongView *self) {
+    Py_BEGIN_CRITICAL_SECTION(self->base);
+    assert(self->base->exports > 0);
+    self->base->exports--;
+    Py_END_CRITICAL_SECTION();
+    Py_DECREF(self->base);
+    PyObject_Free(self);
+}
+
+/* Returns a pointer to value index of the view, index must be in range. */
+static long *
+SequenceLongView_item_ptr(SequenceLongView *self, Py_ssize_t index) {
+    assert(index >= 0 && index < self->size);
+    return self->base->array_long + self->start + index * self->step;
+}
+
 /**
- * Return a new sequence which contains the old one repeated count times.
- * @param self
- * @param count
- * @return
+ * Returns a new SequenceLongObject with a copy of the values in the view.
  */
 static PyObject *
-SequenceLongObject_sq_repeat(PyObject *self, Py_ssize_t count) {
+SequenceLongView_copy(SequenceLongView *self, PyObject *Py_UNUSED(ignored)) {
     PyObject *ret = SequenceLongObject_new(&SequenceLongObjectType, NULL, NULL);
     if (!ret) {
-        assert(PyErr_Occurred());
         return NULL;
     }
-    assert(ret != self);
-    if (((SequenceLongObject *) self)->size > 0 && count > 0) {
+    if (self->size > 0) {
         /* For convenience. */
-        SequenceLongObject *self_as_slo = (SequenceLongObject *) self;
         SequenceLongObject *ret_as_slo = (SequenceLongObject *) ret;
-        ret_as_slo->size = self_as_slo->size * count;
-        assert(ret_as_slo->size > 0);
-        ret_as_slo->array_long = malloc(ret_as_slo->size * sizeof(long));
+        ret_as_slo->array_long = malloc(self->size * sizeof(long));
         if (!ret_as_slo->array_long) {
-            PyErr_Format(PyExc_MemoryError, "%s(): Can not create new object.", __FUNCTION__);
             Py_DECREF(ret);
-            return NULL;
+            return PyErr_NoMemory();
         }
-        Py_ssize_t ret_index = 0;
-        for (Py_ssize_t i = 0; i < count; ++i) {
-//            fprintf(stdout, "%s(): Setting %p Count %zd\n", __FUNCTION__, (void *) ret, i);
-            for (Py_ssize_t j = 0; j < self_as_slo->size; ++j) {
-//                fprintf(
-//                    stdout, "%s(): Setting %p [%zd] to %zd\n",
-//                    __FUNCTION__, (void *) ret, ret_index, self_as_slo->array_long[j]
-//                );
-                ret_as_slo->array_long[ret_index] = self_as_slo->array_long[j];
-                ++ret_index;
+        if (self->step == 1) {
+            memcpy(ret_as_slo->array_long, SequenceLongView_item_ptr(self, 0), self->size * sizeof(long));
+        } else {
+            for (Py_ssize_t i = 0; i < self->size; ++i) {
+                ret_as_slo->array_long[i] = *SequenceLongView_item_ptr(self, i);
             }
         }
-    } else {
-        /* Empty sequence. */
+        ret_as_slo->size = self->size;
+        ret_as_slo->capacity = self->size;
+        SequenceLongObject_update_sorted(ret_as_slo);
     }
     return ret;
 }
 
-/**
- * Returns a new reference to an indexed item in a sequence.
- * @param self
- * @param index
- * @return
- */
+/* A view has a fixed size, start and step so only needs to lock the values in its base. */
+#define SEQUENCE_LONG_VIEW_BASE(self) (((SequenceLongView *) (self))->base)
+
+SEQUENCE_LONG_LOCKED(PyObject *, SequenceLongView_copy, (SequenceLongView *self, PyObject *ignored), (self, ignored),
+                     self->base)
+
+static PyMethodDef SequenceLongView_methods[] = {
+        {"copy", (PyCFunction) SequenceLongView_copy_locked, METH_NOARGS,
+                "Return a new SequenceLongObject with a copy of the values in the view."},
+        {NULL, NULL, 0, NULL}  /* Sentinel */
+};
+
+static PyMemberDef SequenceLongView_members[] = {
+        {"base",  T_OBJECT, offsetof(SequenceLongView, base),  READONLY, "The SequenceLongObject being viewed."},
+        {"start", T_PYSSIZET, offsetof(SequenceLongView, start), READONLY, "Index in the base of the first value."},
+        {"step",  T_PYSSIZET, offsetof(SequenceLongView, step),  READONLY, "Step between values in the base."},
+        {NULL, 0, 0, 0, NULL}  /* Sentinel */
+};
+
+static Py_ssize_t
+SequenceLongView_sq_length(PyObject *self) {
+    return ((SequenceLongView *) self)->size;
+}
+
+/* The abstract layer has already added the length to a negative index. */
 static PyObject *
-SequenceLongObject_sq_item(PyObject *self, Py_ssize_t index) {
-//    fprintf(stdout, "%s(): index=%zd\n", __FUNCTION__, index);
-    Py_ssize_t my_index = index;
-    if (my_index < 0) {
-        my_index += SequenceLongObject_sq_length(self);
-    }
-    // Corner case example: len(self) == 0 and index < 0
-    if (my_index < 0 || my_index >= SequenceLongObject_sq_length(self)) {
-//        fprintf(stdout, "%s(): index=%zd\n", __FUNCTION__, index);
-        PyErr_Format(
-                PyExc_IndexError,
-                "Index %ld is out of range for length %ld",
-                index,
-                SequenceLongObject_sq_length(self)
-        );
+SequenceLongView_sq_item(PyObject *self, Py_ssize_t index) {
+    /* For convenience. */
+    SequenceLongView *self_as_view = (SequenceLongView *) self;
+    if (index < 0 || index >= self_as_view->size) {
+        PyErr_Format(PyExc_IndexError, "Index %zd is out of range for length %zd", index, self_as_view->size);
         return NULL;
     }
-    return PyLong_FromLong(((SequenceLongObject *) self)->array_long[my_index]);
+    return PyLong_FromLong(*SequenceLongView_item_ptr(self_as_view, index));
 }
 
+/* Writes through to the base. Values can not be deleted. */
 static int
-SequenceLongObject_sq_ass_item(PyObject *self, Py_ssize_t index, PyObject *value) {
-    fprintf(
-        stdout, "%s()#%d: self=%p index=%zd value=%p\n",
-        __FUNCTION__, __LINE__, (void *) self, index, (void *) value
-    );
-    /* This is very weird.
-     * When the given index is negative and out of range PyObject_SetItem()
-     * and PyObject_DelItem() will have *already* added the sequence length
-     * before calling this function.
-     * So to get the original out of range negative index we have to *subtract*
-     * the sequence length. */
-    if (index < 0) {
-        fprintf(
-            stdout, "%s()#%d: Fixing index index=%zd to %zd\n", __FUNCTION__, __LINE__,
-            index, index - SequenceLongObject_sq_length(self)
-        );
-        index -= SequenceLongObject_sq_length(self);
+SequenceLongView_sq_ass_item(PyObject *self, Py_ssize_t index, PyObject *value) {
+    /* For convenience. */
+    SequenceLongView *self_as_view = (SequenceLongView *) self;
+    if (value == NULL) {
+        PyErr_SetString(PyExc_TypeError, "SequenceLongView values can not be deleted");
+        return -1;
     }
-    /* Isn't it? */
-    Py_ssize_t my_index = index;
-    if (my_index < 0) {
-        my_index += SequenceLongObject_sq_length(self);
+    if (index < 0 || index >= self_as_view->size) {
+        PyErr_Format(PyExc_IndexError, "Index %zd is out of range for length %zd", index, self_as_view->size);
+        return -1;
     }
-    // Corner case example: len(self) == 0 and index < 0
-    fprintf(
-        stdout, "%s()#%d: len=%zd index=%zd my_index=%zd\n", __FUNCTION__, __LINE__,
-        SequenceLongObject_sq_length(self), index, my_index
-    );
-    if (my_index < 0 || my_index >= SequenceLongObject_sq_length(self)) {
+    if (!PyLong_Check(value)) {
         PyErr_Format(
-                PyExc_IndexError,
-                "Index %ld is out of range for length %ld",
-                index,
-                SequenceLongObject_sq_length(self)
+                PyExc_TypeError,
+                "sq_ass_item value needs to be an int, not type %s",
+                Py_TYPE(value)->tp_name
         );
         return -1;
     }
-    if (value != NULL) {
-        /* Just set the value. */
-        if (!PyLong_Check(value)) {
+    long c_value = PyLong_AsLong(value);
+    if (c_value == -1 && PyErr_Occurred()) {
+        return -1;
+    }
+    *SequenceLongView_item_ptr(self_as_view, index) = c_value;
+    SequenceLongObject_note_write(self_as_view->base, self_as_view->start + index * self_as_view->step);
+    return 0;
+}
+
+SEQUENCE_LONG_LOCKED(PyObject *, SequenceLongView_sq_item, (PyObject *self, Py_ssize_t index), (self, index),
+                     SEQUENCE_LONG_VIEW_BASE(self))
+SEQUENCE_LONG_LOCKED(int, SequenceLongView_sq_ass_item, (PyObject *self, Py_ssize_t index, PyObject *value),
+                     (self, index, value), SEQUENCE_LONG_VIEW_BASE(self))
+
+static PySequenceMethods SequenceLongView_sequence_methods = {
+        .sq_length = (lenfunc) SequenceLongView_sq_length,
+        .sq_item = (ssizeargfunc) SequenceLongView_sq_item_locked,
+        .sq_ass_item = (ssizeobjargproc) SequenceLongView_sq_ass_item_locked,
+};
+
+/* A slice of a view is another view of the same base. */
+static PyObject *
+SequenceLongView_mp_subscript(PyObject *self, PyObject *key) {
+    /* For convenience. */
+    SequenceLongView *self_as_view = (SequenceLongView *) self;
+    if (PySlice_Check(key)) {
+        Py_ssize_t start, stop, step;
+        if (PySlice_Unpack(key, &start, &stop, &step) < 0) {
+            return NULL;
+        }
+        Py_ssize_t slice_length = PySlice_AdjustIndices(self_as_view->size, &start, &stop, step);
+        /* With more than one value the composed step is bounded by the length of the base. Otherwise the step is
+         * unused and a large one could overflow. */
+        return SequenceLongView_create(
+                self_as_view->base,
+                self_as_view->start + start * self_as_view->step,
+                slice_length > 1 ? self_as_view->step * step : 1,
+                slice_length
+        );
+    }
+    if (PyIndex_Check(key)) {
+        Py_ssize_t index = PyNumber_AsSsize_t(key, PyExc_IndexError);
+        if (index == -1 && PyErr_Occurred()) {
+            return NULL;
+        }
+        return PySequence_GetItem(self, index);
+    }
+    PyErr_Format(
+            PyExc_TypeError,
+            "SequenceLongView indices must be integers or slices, not %s",
+            Py_TYPE(key)->tp_name
+    );
+    return NULL;
+}
+
+/* A view can not change size so slice assignment must be the same length as the slice. */
+static int
+SequenceLongView_mp_ass_subscript(PyObject *self, PyObject *key, PyObject *value) {
+    /* For convenience. */
+    SequenceLongView *self_as_view = (SequenceLongView *) self;
+    if (PySlice_Check(key)) {
+        if (value == NULL) {
+            PyErr_SetString(PyExc_TypeError, "SequenceLongView values can not be deleted");
+            return -1;
+        }
+        Py_ssize_t start, stop, step;
+        if (PySlice_Unpack(key, &start, &stop, &step) < 0) {
+            return -1;
+        }
+        Py_ssize_t slice_length = PySlice_AdjustIndices(self_as_view->size, &start, &stop, step);
+        long *values = NULL;
+        Py_ssize_t values_size = 0;
+        if (py_long_array_from_object(value, &values, &values_size)) {
+            return -1;
+        }
+        if (values_size != slice_length) {
             PyErr_Format(
-                    PyExc_TypeError,
-                    "sq_ass_item value needs to be an int, not type %s",
-                    Py_TYPE(value)->tp_name
+                    PyExc_ValueError,
+                    "SequenceLongView can not be re-sized, attempt to assign sequence of size %zd to slice of size %zd",
+                    values_size,
+                    slice_length
             );
+            free(values);
             return -1;
         }
-        ((SequenceLongObject *) self)->array_long[my_index] = PyLong_AsLong(value);
-    } else {
-        /* Delete the value. */
-        /* For convenience. */
-        SequenceLongObject *self_as_slo = (SequenceLongObject *) self;
-        /* Special case: deleting the only item in the array. */
-        if (self_as_slo->size == 1) {
-            fprintf(stdout, "%s()#%d: deleting empty index\n", __FUNCTION__, __LINE__);
-            free(self_as_slo->array_long);
-            self_as_slo->array_long = NULL;
-            self_as_slo->size = 0;
-        } else {
-            /* Delete the value and re-compose the array. */
-            fprintf(stdout, "%s()#%d: deleting index=%zd\n", __FUNCTION__, __LINE__, index);
-            long *new_array = malloc((self_as_slo->size - 1) * sizeof(long));
-            if (!new_array) {
-                PyErr_Format(
-                        PyExc_MemoryError,
-                        "sq_ass_item can not allocate new array. %s#%d",
-                        __FILE__, __LINE__
-                );
-                return -1;
-            }
-            /* Copy up to the index. */
-            Py_ssize_t index_new_array = 0;
-            for (Py_ssize_t i = 0; i < my_index; ++i, ++index_new_array) {
-                new_array[index_new_array] = self_as_slo->array_long[i];
-            }
-            /* Copy past the index. */
-            for (Py_ssize_t i = my_index + 1; i < self_as_slo->size; ++i, ++index_new_array) {
-                new_array[index_new_array] = self_as_slo->array_long[i];
-            }
-
-            free(self_as_slo->array_long);
-            self_as_slo->array_long = new_array;
-            --self_as_slo->size;
+        for (Py_ssize_t i = 0; i < slice_length; ++i) {
+            *SequenceLongView_item_ptr(self_as_view, start + i * step) = values[i];
+        }
+        for (Py_ssize_t i = 0; i < slice_length; ++i) {
+            SequenceLongObject_note_write(
+                    self_as_view->base, self_as_view->start + (start + i * step) * self_as_view->step
+            );
         }
+        free(values);
+        return 0;
     }
-    return 0;
+    if (PyIndex_Check(key)) {
+        Py_ssize_t index = PyNumber_AsSsize_t(key, PyExc_IndexError);
+        if (index == -1 && PyErr_Occurred()) {
+            return -1;
+        }
+        if (value == NULL) {
+            return PySequence_DelItem(self, index);
+        }
+        return PySequence_SetItem(self, index, value);
+    }
+    PyErr_Format(
+            PyExc_TypeError,
+            "SequenceLongView indices must be integers or slices, not %s",
+            Py_TYPE(key)->tp_name
+    );
+    return -1;
 }
 
-/**
- * If an item in self is equal to value, return 1, otherwise return 0. On error, return -1.
- * @param self
- * @param value
- * @return
- */
+SEQUENCE_LONG_LOCKED(PyObject *, SequenceLongView_mp_subscript, (PyObject *self, PyObject *key), (self, key),
+                     SEQUENCE_LONG_VIEW_BASE(self))
+SEQUENCE_LONG_LOCKED(int, SequenceLongView_mp_ass_subscript, (PyObject *self, PyObject *key, PyObject *value),
+                     (self, key, value), SEQUENCE_LONG_VIEW_BASE(self))
+
+static PyMappingMethods SequenceLongView_mapping_methods = {
+        .mp_length = (lenfunc) SequenceLongView_sq_length,
+        .mp_subscript = (binaryfunc) SequenceLongView_mp_subscript_locked,
+        .mp_ass_subscript = (objobjargproc) SequenceLongView_mp_ass_subscript_locked,
+};
+
+/* Buffer protocol, this is a strided export of the base's array_long so it is not C contiguous unless step is 1. */
 static int
-SequenceLongObject_sq_contains(PyObject *self, PyObject *value) {
-    fprintf(
-            stdout, "%s()#%d: self=%p value=%p\n",
-            __FUNCTION__, __LINE__, (void *) self, (void *) value
-    );
-    if (!PyLong_Check(value)) {
-        /* Alternates: Could raise TypeError or return -1.
-         * Here we act benignly! */
-        return 0;
-    }
-    long c_value = PyLong_AsLong(value);
+SequenceLongView_bf_getbuffer(PyObject *self, Py_buffer *view, int flags) {
     /* For convenience. */
-    SequenceLongObject *self_as_slo = (SequenceLongObject *) self;
-    for (Py_ssize_t i = 0; i < SequenceLongObject_sq_length(self); ++i) {
-        if (self_as_slo->array_long[i] == c_value) {
-            return 1;
-        }
+    SequenceLongView *self_as_view = (SequenceLongView *) self;
+    if (view == NULL) {
+        PyErr_SetString(PyExc_BufferError, "SequenceLongView_bf_getbuffer(): view is NULL.");
+        return -1;
+    }
+    if (self_as_view->step != 1 && (flags & PyBUF_STRIDES) != PyBUF_STRIDES) {
+        PyErr_SetString(PyExc_BufferError, "SequenceLongView with a step is not C contiguous.");
+        return -1;
+    }
+    view->obj = self;
+    Py_INCREF(view->obj);
+    view->buf = self_as_view->size ? SequenceLongView_item_ptr(self_as_view, 0) : SequenceLongObject_buffer_empty;
+    view->len = self_as_view->size * (Py_ssize_t) sizeof(long);
+    view->readonly = 0;
+    view->itemsize = sizeof(long);
+    view->format = (flags & PyBUF_FORMAT) == PyBUF_FORMAT ? "l" : NULL;
+    view->ndim = 1;
+    /* A view is never re-sized so these can point into it. */
+    view->shape = (flags & PyBUF_ND) == PyBUF_ND ? &self_as_view->size : NULL;
+    view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? &self_as_view->buffer_stride : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+    /* The consumer can write to the values of the base. The view already pins the array. */
+    self_as_view->base->buffer_exports++;
+    if (self_as_view->base->sorted == SEQUENCE_LONG_SORTED) {
+        self_as_view->base->sorted = SEQUENCE_LONG_SORTED_UNKNOWN;
     }
     return 0;
 }
 
-static PySequenceMethods SequenceLongObject_sequence_methods = {
-        .sq_length = (lenfunc)SequenceLongObject_sq_length,
-        .sq_concat = (binaryfunc)SequenceLongObject_sq_concat,
-        .sq_repeat = (ssizeargfunc)SequenceLongObject_sq_repeat,
-        .sq_item = (ssizeargfunc)SequenceLongObject_sq_item,
-        .sq_ass_item = (ssizeobjargproc)SequenceLongObject_sq_ass_item,
-        .sq_contains = (objobjproc)SequenceLongObject_sq_contains,
-        .sq_inplace_concat = (binaryfunc)NULL,
-        .sq_inplace_repeat = (ssizeargfunc)NULL,
+static void
+SequenceLongView_bf_releasebuffer(PyObject *self, Py_buffer *Py_UNUSED(view)) {
+    assert(((SequenceLongView *) self)->base->buffer_exports > 0);
+    ((SequenceLongView *) self)->base->buffer_exports--;
+}
+
+SEQUENCE_LONG_LOCKED(int, SequenceLongView_bf_getbuffer, (PyObject *self, Py_buffer *view, int flags),
+                     (self, view, flags), SEQUENCE_LONG_VIEW_BASE(self))
+
+static void
+SequenceLongView_bf_releasebuffer_locked(PyObject *self, Py_buffer *view) {
+    Py_BEGIN_CRITICAL_SECTION(SEQUENCE_LONG_VIEW_BASE(self));
+    SequenceLongView_bf_releasebuffer(self, view);
+    Py_END_CRITICAL_SECTION();
+}
+
+static PyBufferProcs SequenceLongView_buffer_procs = {
+        .bf_getbuffer = (getbufferproc) SequenceLongView_bf_getbuffer_locked,
+        .bf_releasebuffer = (releasebufferproc) SequenceLongView_bf_releasebuffer_locked,
 };
 
 static PyObject *
-SequenceLongObject___str__(SequenceLongObject *self, PyObject *Py_UNUSED(ignored)) {
+SequenceLongView___str__(SequenceLongView *self, PyObject *Py_UNUSED(ignored)) {
     assert(!PyErr_Occurred());
-    return PyUnicode_FromFormat("<SequenceLongObject sequence size: %ld>", self->size);
+    return PyUnicode_FromFormat(
+            "<SequenceLongView size: %zd start: %zd step: %zd>", self->size, self->start, self->step
+    );
 }
 
-static PyTypeObject SequenceLongObjectType = {
+static PyTypeObject SequenceLongViewType = {
         PyVarObject_HEAD_INIT(NULL, 0)
-        .tp_name = "SequenceLongObject",
-        .tp_basicsize = sizeof(SequenceLongObject),
+        .tp_name = "SequenceLongView",
+        .tp_basicsize = sizeof(SequenceLongView),
         .tp_itemsize = 0,
-        .tp_dealloc = (destructor) SequenceLongObject_dealloc,
-        .tp_as_sequence = &SequenceLongObject_sequence_methods,
-        .tp_str = (reprfunc) SequenceLongObject___str__,
-        .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
-        .tp_doc = "Sequence of long integers.",
-//        .tp_iter = NULL,
-//        .tp_iternext = NULL,
-        .tp_methods = SequenceLongObject_methods,
-        .tp_init = (initproc) SequenceLongObject_init,
-        .tp_new = SequenceLongObject_new,
+        .tp_dealloc = (destructor) SequenceLongView_dealloc,
+        .tp_as_sequence = &SequenceLongView_sequence_methods,
+        .tp_as_mapping = &SequenceLongView_mapping_methods,
+        .tp_str = (reprfunc) SequenceLongView___str__,
+        .tp_as_buffer = &SequenceLongView_buffer_procs,
+        .tp_flags = Py_TPFLAGS_DEFAULT,
+        .tp_doc = "A view of a slice of a SequenceLongObject that shares its values. "
+                  "The SequenceLongObject can not be re-sized whilst a view exists.",
+        .tp_methods = SequenceLongView_methods,
+        .tp_members = SequenceLongView_members,
 };
 
-static int
-is_sequence_of_long_type(PyObject *op) {
-    return Py_TYPE(op) == &SequenceLongObjectType;
+/* Names of the LongArraySIMDLevel values. */
+static const char *simd_level_names[] = {"scalar", "avx2", NULL};
+
+/**
+ * Returns the name of the instruction set level used by the reductions.
+ */
+static PyObject *
+simd_level(PyObject *Py_UNUSED(module), PyObject *Py_UNUSED(ignored)) {
+    return PyUnicode_FromString(simd_level_names[long_array_simd_level()]);
+}
+
+/**
+ * Set the instruction set level used by the reductions from its name, this is mostly for testing and benchmarking.
+ * Returns the name of the previous level.
+ */
+static PyObject *
+set_simd_level(PyObject *Py_UNUSED(module), PyObject *arg) {
+    if (!PyUnicode_Check(arg)) {
+        PyErr_Format(PyExc_TypeError, "set_simd_level() argument must be a str, not %s", Py_TYPE(arg)->tp_name);
+        return NULL;
+    }
+    const char *name = PyUnicode_AsUTF8(arg);
+    if (!name) {
+        return NULL;
+    }
+    LongArraySIMDLevel previous = long_array_simd_level();
+    for (int level = 0; simd_level_names[level]; ++level) {
+        if (strcmp(name, simd_level_names[level]) == 0) {
+            if (long_array_set_simd_level((LongArraySIMDLevel) level)) {
+                PyErr_Format(PyExc_ValueError, "SIMD level \"%s\" is not available on this machine.", name);
+                return NULL;
+            }
+            return PyUnicode_FromString(simd_level_names[previous]);
+        }
+    }
+    PyErr_Format(PyExc_ValueError, "Unknown SIMD level \"%s\".", name);
+    return NULL;
 }
 
 static PyMethodDef cIterator_methods[] = {
 //        {"iterate_and_print", (PyCFunction) iterate_and_print, METH_VARARGS,
 //                "Iteratee through the argument printing the values."},
+        {"simd_level",     (PyCFunction) simd_level,     METH_NOARGS,
+                "Return the name of the instruction set level used by the reductions."},
+        {"set_simd_level", (PyCFunction) set_simd_level, METH_O,
+                "Set the instruction set level used by the reductions, returns the previous level."},
         {NULL, NULL, 0, NULL} /* Sentinel */
 };
 
@@ -396,6 +1882,10 @@ PyInit_cSeqObject(void) {
         return NULL;
     }
 
+    if (py_fastcall_parser_init(&SequenceLongObject_parser)) {
+        Py_DECREF(m);
+        return NULL;
+    }
     if (PyType_Ready(&SequenceLongObjectType) < 0) {
         Py_DECREF(m);
         return NULL;
@@ -410,5 +1900,23 @@ PyInit_cSeqObject(void) {
         Py_DECREF(m);
         return NULL;
     }
+    if (PyType_Ready(&SequenceLongViewType) < 0) {
+        Py_DECREF(m);
+        return NULL;
+    }
+    Py_INCREF(&SequenceLongViewType);
+    if (PyModule_AddObject(
+            m,
+            "SequenceLongView",
+            (PyObject *) &SequenceLongViewType) < 0
+            ) {
+        Py_DECREF(&SequenceLongViewType);
+        Py_DECREF(m);
+        return NULL;
+    }
+    if (PY_MODULE_GIL_NOT_USED(m)) {
+        Py_DECREF(m);
+        return NULL;
+    }
     return m;
 }
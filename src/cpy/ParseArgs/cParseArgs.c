@@ -12,6 +12,8 @@
 
 #include "time.h"
 
+#include "py_fastcall_args.h"
+
 #define FPRINTF_DEBUG 0
 
 /****************** Parsing arguments. ****************/
@@ -63,6 +65,51 @@ static PyObject *parse_args(PyObject *Py_UNUSED(module), PyObject *args) {
     return Py_BuildValue("Ois", arg_0, arg_1, arg_2);
 }
 
+static const char *const parse_args_fastcall_keywords[] = {"a", "b", "c", NULL};
+static PyFastcallParser parse_args_fastcall_parser = {"parse_args_fastcall", parse_args_fastcall_keywords, 2, NULL, 0};
+
+/** As parse_args() but with METH_FASTCALL | METH_KEYWORDS so the arguments are not packed into a tuple.
+ * The arguments are unpacked by py_fastcall_unpack() in src/cpy/Util/py_fastcall_args.c then converted here.
+ *
+ * Signature is:
+ *
+ * def parse_args_fastcall(a: bytes, b: int, c: str = 'default_string') -> typing.Tuple[bytes, int, str]:
+ * */
+static PyObject *
+parse_args_fastcall(PyObject *Py_UNUSED(module), PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+    PyObject *argv[3];
+    long arg_1;
+    const char *arg_2 = "default_string";
+
+    if (py_fastcall_unpack(&parse_args_fastcall_parser, args, nargs, kwnames, argv)) {
+        return NULL;
+    }
+    if (!PyBytes_Check(argv[0])) {
+        PyErr_Format(PyExc_TypeError, "argument 1 must be bytes, not %s", Py_TYPE(argv[0])->tp_name);
+        return NULL;
+    }
+    arg_1 = PyLong_AsLong(argv[1]);
+    if (arg_1 == -1 && PyErr_Occurred()) {
+        return NULL;
+    }
+    if (arg_1 < INT_MIN || arg_1 > INT_MAX) {
+        PyErr_SetString(PyExc_OverflowError, "signed integer is out of range for a C int");
+        return NULL;
+    }
+    if (argv[2]) {
+        if (!PyUnicode_Check(argv[2])) {
+            PyErr_Format(PyExc_TypeError, "argument 3 must be str, not %s", Py_TYPE(argv[2])->tp_name);
+            return NULL;
+        }
+        arg_2 = PyUnicode_AsUTF8(argv[2]);
+        if (!arg_2) {
+            return NULL;
+        }
+    }
+    /* Your code here...*/
+
+    return Py_BuildValue("Ols", argv[0], arg_1, arg_2);
+}
 
 /** This takes a Python object, 'sequence', that supports the sequence protocol and, optionally, an integer, 'count'.
  * This returns a new sequence which is the old sequence multiplied by the count.
@@ -420,6 +467,8 @@ static PyMethodDef cParseArgs_methods[] = {
         {"parse_no_args",                            (PyCFunction) parse_no_args,                            METH_NOARGS,  "No arguments."},
         {"parse_one_arg",                            (PyCFunction) parse_one_arg,                            METH_O,       "One argument."},
         {"parse_args",                               (PyCFunction) parse_args,                               METH_VARARGS, "Reads args only."},
+        {"parse_args_fastcall",                      (PyCFunction) (void (*)(void)) parse_args_fastcall,     METH_FASTCALL |
+                                                                                                             METH_KEYWORDS, "Reads args with METH_FASTCALL."},
         {"parse_args_kwargs",                        (PyCFunction) parse_args_kwargs,                        METH_VARARGS |
                                                                                                              METH_KEYWORDS, parse_args_kwargs_docstring},
         {"parse_args_with_immutable_defaults",       (PyCFunction) parse_args_with_immutable_defaults,
@@ -448,6 +497,9 @@ static PyModuleDef cParseArgs_module = {
 };
 
 PyMODINIT_FUNC PyInit_cParseArgs(void) {
+    if (py_fastcall_parser_init(&parse_args_fastcall_parser)) {
+        return NULL;
+    }
     return PyModule_Create(&cParseArgs_module);
 }
 /****************** END: Parsing arguments. ****************/
@@ -1,7 +1,10 @@
-#define PPY_SSIZE_T_CLEAN
+#define PY_SSIZE_T_CLEAN
 
 #include "Python.h"
 
+#include "cFibFast.h"
+#include "py_fastcall_args.h"
+
 long fibonacci(long index) {
     if (index < 2) {
         return index;
@@ -48,12 +51,62 @@ py_fibonacci(PyObject *Py_UNUSED(module), PyObject *args) {
 //}
 //
 
+/**
+ * Fibonacci by fast doubling, see cFibFast.c
+ * This is O(log index) and returns a Python int of arbitrary size.
+ */
+static PyObject *
+py_fibonacci_fast(PyObject *Py_UNUSED(module), PyObject *args) {
+    long index;
+
+    if (!PyArg_ParseTuple(args, "l", &index)) {
+        return NULL;
+    }
+    if (index < 0) {
+        PyErr_Format(PyExc_ValueError, "Index must be >= 0 not %ld", index);
+        return NULL;
+    }
+    return fibonacci_fast_py_long(index);
+}
+
+static const char *const fibonacci_fastcall_keywords[] = {"index", NULL};
+static PyFastcallParser fibonacci_fastcall_parser = {"fibonacci_fastcall", fibonacci_fastcall_keywords, 1, NULL, 0};
+
+/**
+ * As py_fibonacci() but with METH_FASTCALL | METH_KEYWORDS which avoids creating a tuple of the arguments.
+ * See src/cpy/Util/py_fastcall_args.h
+ */
+static PyObject *
+py_fibonacci_fastcall(PyObject *Py_UNUSED(module), PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+    PyObject *argv[1];
+
+    if (py_fastcall_unpack(&fibonacci_fastcall_parser, args, nargs, kwnames, argv)) {
+        return NULL;
+    }
+    long index = PyLong_AsLong(argv[0]);
+    if (index == -1 && PyErr_Occurred()) {
+        return NULL;
+    }
+    long result = fibonacci(index);
+    return PyLong_FromLong(result);
+}
+
 static PyMethodDef module_methods[] = {
         {"fibonacci",
                 (PyCFunction) py_fibonacci,
                 METH_VARARGS,
                 "Returns the Fibonacci value."
         },
+        {"fibonacci_fastcall",
+                (PyCFunction) (void (*)(void)) py_fibonacci_fastcall,
+                METH_FASTCALL | METH_KEYWORDS,
+                "Returns the Fibonacci value, this uses METH_FASTCALL."
+        },
+        {"fibonacci_fast",
+                (PyCFunction) py_fibonacci_fast,
+                METH_VARARGS,
+                "Returns the Fibonacci value as an int of any size using fast doubling."
+        },
         {NULL, NULL, 0, NULL} /* Sentinel */
 };
 
@@ -66,6 +119,9 @@ static PyModuleDef cFibA = {
 };
 
 PyMODINIT_FUNC PyInit_cFibA(void) {
+    if (py_fastcall_parser_init(&fibonacci_fastcall_parser)) {
+        return NULL;
+    }
     PyObject *m = PyModule_Create(&cFibA);
     return m;
 }
@@ -1,22 +1,24 @@
-#define PPY_SSIZE_T_CLEAN
+#define PY_SSIZE_T_CLEAN
 
 #include "Python.h"
 
-long fibonacci(long index) {
-    static long *cache = NULL;
-    if (!cache) {
-        /* FIXME */
-        cache = calloc(1000, sizeof(long));
-    }
-    if (index < 2) {
-        return index;
-    }
-    if (!cache[index]) {
-        cache[index] = fibonacci(index - 2) + fibonacci(index - 1);
+#include "cFibFast.h"
+
+/* Memo table of every Fibonacci value that fits in a C long long, this is bounded by
+ * FIBONACCI_MAX_INDEX_LONG_LONG. It is filled once when the module is imported and never written to afterwards so
+ * it can be read by any thread without a lock. */
+static long long fibonacci_memo[FIBONACCI_MAX_INDEX_LONG_LONG + 1];
+
+static void
+fibonacci_memo_init(void) {
+    fibonacci_memo[0] = 0;
+    fibonacci_memo[1] = 1;
+    for (int i = 2; i <= FIBONACCI_MAX_INDEX_LONG_LONG; ++i) {
+        fibonacci_memo[i] = fibonacci_memo[i - 2] + fibonacci_memo[i - 1];
     }
-    return cache[index];
 }
 
+/* Larger values are calculated by fast doubling as Python ints. */
 static PyObject *
 py_fibonacci(PyObject *Py_UNUSED(module), PyObject *args) {
     long index;
@@ -24,8 +26,14 @@ py_fibonacci(PyObject *Py_UNUSED(module), PyObject *args) {
     if (!PyArg_ParseTuple(args, "l", &index)) {
         return NULL;
     }
-    long result = fibonacci(index);
-    return Py_BuildValue("l", result);
+    if (index < 0) {
+        PyErr_Format(PyExc_ValueError, "Index must be >= 0 not %ld", index);
+        return NULL;
+    }
+    if (index <= FIBONACCI_MAX_INDEX_LONG_LONG) {
+        return PyLong_FromLongLong(fibonacci_memo[index]);
+    }
+    return fibonacci_fast_py_long(index);
 }
 
 //static PyObject *
@@ -54,12 +62,13 @@ static PyMethodDef module_methods[] = {
 static PyModuleDef cFibB = {
         PyModuleDef_HEAD_INIT,
         .m_name = "cFibB",
-        .m_doc = "Fibonacci in C with cache.",
+        .m_doc = "Fibonacci in C with a memo table and arbitrary precision.",
         .m_size = -1,
         .m_methods = module_methods,
 };
 
 PyMODINIT_FUNC PyInit_cFibB(void) {
+    fibonacci_memo_init();
     PyObject *m = PyModule_Create(&cFibB);
     return m;
 }
@@ -0,0 +1,147 @@
+//
+// cFibFast.c
+//
+// Fast Fibonacci calculations shared by cFibA.c and cFibB.c
+//
+// This uses the fast doubling identities:
+//
+// F(2k) = F(k) * (2 * F(k + 1) - F(k))
+// F(2k + 1) = F(k) ** 2 + F(k + 1) ** 2
+//
+// Working from the most significant bit of the index each bit costs a few multiplications so the whole calculation
+// is O(log index) multiplications rather than the O(index) additions of the iterative version.
+//
+
+#define PY_SSIZE_T_CLEAN
+
+#include "Python.h"
+
+#include "cFibFast.h"
+
+#include <assert.h>
+
+/* Set *p_a = F(index) and *p_b = F(index + 1), both must fit in an unsigned long long. */
+static void
+fibonacci_fast_doubling_pair(unsigned long index, unsigned long long *p_a, unsigned long long *p_b) {
+    unsigned long long a = 0; /* F(k) */
+    unsigned long long b = 1; /* F(k + 1) */
+    int bit = 0;
+
+    while ((index >> bit) > 1) {
+        bit++;
+    }
+    for (; index && bit >= 0; --bit) {
+        /* k -> 2k */
+        unsigned long long c = a * (2 * b - a);
+        unsigned long long d = a * a + b * b;
+        if ((index >> bit) & 1) {
+            /* 2k -> 2k + 1 */
+            a = d;
+            b = c + d;
+        } else {
+            a = c;
+            b = d;
+        }
+    }
+    *p_a = a;
+    *p_b = b;
+}
+
+long long
+fibonacci_fast_doubling(long index) {
+    unsigned long long a;
+    unsigned long long b;
+
+    assert(index >= 0 && index <= FIBONACCI_MAX_INDEX_LONG_LONG);
+    /* F(index + 1) may exceed a long long but not an unsigned long long. */
+    fibonacci_fast_doubling_pair((unsigned long) index, &a, &b);
+    return (long long) a;
+}
+
+PyObject *
+fibonacci_fast_py_long(long index) {
+    PyObject *a = NULL; /* F(k) */
+    PyObject *b = NULL; /* F(k + 1) */
+    PyObject *c = NULL;
+    PyObject *d = NULL;
+    PyObject *temp = NULL;
+    unsigned long long c_a;
+    unsigned long long c_b;
+    int shift = 0;
+
+    assert(index >= 0);
+    if (index <= FIBONACCI_MAX_INDEX_LONG_LONG) {
+        return PyLong_FromLongLong(fibonacci_fast_doubling(index));
+    }
+    /* Find the leading bits k = index >> shift where F(k + 1) fits in C and calculate those in C. */
+    while ((index >> shift) >= FIBONACCI_MAX_INDEX_LONG_LONG) {
+        shift++;
+    }
+    fibonacci_fast_doubling_pair((unsigned long) (index >> shift), &c_a, &c_b);
+    a = PyLong_FromUnsignedLongLong(c_a);
+    if (!a) {
+        goto except;
+    }
+    b = PyLong_FromUnsignedLongLong(c_b);
+    if (!b) {
+        goto except;
+    }
+    /* The remaining bits with Python ints. */
+    for (--shift; shift >= 0; --shift) {
+        /* c = a * (2 * b - a) */
+        temp = PyNumber_Add(b, b);
+        if (!temp) {
+            goto except;
+        }
+        Py_SETREF(temp, PyNumber_Subtract(temp, a));
+        if (!temp) {
+            goto except;
+        }
+        c = PyNumber_Multiply(a, temp);
+        Py_CLEAR(temp);
+        if (!c) {
+            goto except;
+        }
+        /* d = a * a + b * b */
+        Py_SETREF(a, PyNumber_Multiply(a, a));
+        if (!a) {
+            goto except;
+        }
+        Py_SETREF(b, PyNumber_Multiply(b, b));
+        if (!b) {
+            goto except;
+        }
+        d = PyNumber_Add(a, b);
+        if (!d) {
+            goto except;
+        }
+        Py_CLEAR(a);
+        Py_CLEAR(b);
+        if ((index >> shift) & 1) {
+            /* a, b = d, c + d */
+            b = PyNumber_Add(c, d);
+            if (!b) {
+                goto except;
+            }
+            a = d;
+            d = NULL;
+            Py_CLEAR(c);
+        } else {
+            /* a, b = c, d */
+            a = c;
+            b = d;
+            c = NULL;
+            d = NULL;
+        }
+    }
+    Py_DECREF(b);
+    return a;
+except:
+    assert(PyErr_Occurred());
+    Py_XDECREF(a);
+    Py_XDECREF(b);
+    Py_XDECREF(c);
+    Py_XDECREF(d);
+    Py_XDECREF(temp);
+    return NULL;
+}
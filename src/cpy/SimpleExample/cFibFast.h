@@ -0,0 +1,25 @@
+//
+// cFibFast.h
+//
+// Fast Fibonacci calculations shared by cFibA.c and cFibB.c
+//
+
+#ifndef PYEXTEXAMPLE_CFIBFAST_H
+#define PYEXTEXAMPLE_CFIBFAST_H
+
+#include "Python.h"
+
+/* The largest index whose Fibonacci value fits in a signed 64 bit integer. */
+#define FIBONACCI_MAX_INDEX_LONG_LONG 92
+
+/* Calculate the Fibonacci value of index in O(log index) by fast doubling.
+ * index must be in the range [0, FIBONACCI_MAX_INDEX_LONG_LONG]. */
+long long fibonacci_fast_doubling(long index);
+
+/* Return the Fibonacci value of index as a Python int of arbitrary size.
+ * For index <= FIBONACCI_MAX_INDEX_LONG_LONG this is calculated in C, otherwise the leading bits of index are
+ * calculated in C and the remaining bits by fast doubling with Python ints.
+ * index must be >= 0. Returns NULL on failure with an exception set. */
+PyObject *fibonacci_fast_py_long(long index);
+
+#endif //PYEXTEXAMPLE_CFIBFAST_H
@@ -50,3 +50,17 @@ print(
     f'C is {ti_py / ti_c if ti_py > ti_c else ti_c / ti_py:.1f}'
     f' times {"FASTER" if ti_py > ti_c else "SLOWER"}.'
 )
+
+print()
+print('Fast doubling, O(log(n)):')
+ti_py = timeit.timeit(f'pFibB.fibonacci({index})', setup='import pFibB', number=number)
+print(f'Python timeit: {ti_py:8.6f}')
+
+ti_c = timeit.timeit(f'cFibA.fibonacci_fast({index})',
+                     setup='from cPyExtPatt.SimpleExample import cFibA', number=number)
+print(f'     C timeit: {ti_c:8.6f}')
+
+print(
+    f'C is {ti_py / ti_c if ti_py > ti_c else ti_c / ti_py:.1f}'
+    f' times {"FASTER" if ti_py > ti_c else "SLOWER"}.'
+)
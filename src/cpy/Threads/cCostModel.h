@@ -0,0 +1,150 @@
+//
+// cCostModel.h
+// The simulated work in the csublist and cppsublist examples, usable from C and C++.
+//
+// append() and the generic max() can simulate the cost of real work whilst holding the lock.
+// Each object has its own cost model, the default is no cost at all so that they can be used as a benchmark of the
+// locking itself. The modes are:
+//
+// - "sleep": sleep with the GIL released, like I/O or waiting on another resource.
+// - "busy": a busy loop with the GIL released, like native CPU bound work.
+// - "busy_gil": a busy loop holding the GIL, like CPU bound Python code.
+//
+// The fields are read without the lock so, on a free-threaded build, they are accessed atomically.
+//
+
+#ifndef PYTHONEXTENSIONPATTERNS_CCOSTMODEL_H
+#define PYTHONEXTENSIONPATTERNS_CCOSTMODEL_H
+
+#include <Python.h>
+#include <time.h>
+
+#include "py_free_threading.h"
+#include "cRWLock.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    COST_MODE_SLEEP,
+    COST_MODE_BUSY,
+    COST_MODE_BUSY_GIL,
+    COST_MODE_COUNT
+} CostMode;
+
+static const char *COST_MODE_NAMES[COST_MODE_COUNT] = {"sleep", "busy", "busy_gil"};
+
+typedef struct {
+    /* Microseconds of work in each append(). */
+    Py_ssize_t append_us;
+    /* Microseconds of work for each comparison in max(). */
+    Py_ssize_t compare_us;
+    /* A CostMode. */
+    int mode;
+} CostModel;
+
+static inline void
+cost_model_busy_wait(Py_ssize_t cost_us) {
+    long long deadline = lock_clock_ns() + (long long) cost_us * 1000LL;
+    while (lock_clock_ns() < deadline) {
+    }
+}
+
+/* Simulate cost_us microseconds of work with the GIL held. */
+static inline void
+CostModel_work(CostModel *model, Py_ssize_t cost_us) {
+    if (cost_us <= 0) {
+        return;
+    }
+    switch (PY_COUNTER_LOAD(model->mode)) {
+        case COST_MODE_SLEEP: {
+            struct timespec tim_request;
+            tim_request.tv_sec = (time_t) (cost_us / 1000000);
+            tim_request.tv_nsec = (long) (cost_us % 1000000) * 1000L;
+            Py_BEGIN_ALLOW_THREADS
+                nanosleep(&tim_request, NULL);
+            Py_END_ALLOW_THREADS
+            break;
+        }
+        case COST_MODE_BUSY:
+            Py_BEGIN_ALLOW_THREADS
+                cost_model_busy_wait(cost_us);
+            Py_END_ALLOW_THREADS
+            break;
+        default:
+            cost_model_busy_wait(cost_us);
+            break;
+    }
+}
+
+/* A getter of one of the cost fields, closure is its offset in the object. */
+static inline PyObject *
+CostModel_get_cost(PyObject *self, void *closure) {
+    Py_ssize_t *p_cost = (Py_ssize_t *) ((char *) self + (size_t) closure);
+    return PyLong_FromSsize_t(PY_COUNTER_LOAD(*p_cost));
+}
+
+/* A setter of one of the cost fields, closure is its offset in the object. */
+static inline int
+CostModel_set_cost(PyObject *self, PyObject *value, void *closure) {
+    Py_ssize_t *p_cost = (Py_ssize_t *) ((char *) self + (size_t) closure);
+    Py_ssize_t cost_us;
+
+    if (!value) {
+        PyErr_SetString(PyExc_AttributeError, "Can not delete the cost.");
+        return -1;
+    }
+    cost_us = PyNumber_AsSsize_t(value, PyExc_OverflowError);
+    if (cost_us == -1 && PyErr_Occurred()) {
+        return -2;
+    }
+    if (cost_us < 0) {
+        PyErr_Format(PyExc_ValueError, "The cost must be >= 0 microseconds not %zd.", cost_us);
+        return -3;
+    }
+    PY_COUNTER_STORE(*p_cost, cost_us);
+    return 0;
+}
+
+/* A getter of the mode field as a string, closure is its offset in the object. */
+static inline PyObject *
+CostModel_get_mode(PyObject *self, void *closure) {
+    int *p_mode = (int *) ((char *) self + (size_t) closure);
+    return PyUnicode_FromString(COST_MODE_NAMES[PY_COUNTER_LOAD(*p_mode)]);
+}
+
+/* A setter of the mode field from a string, closure is its offset in the object. */
+static inline int
+CostModel_set_mode(PyObject *self, PyObject *value, void *closure) {
+    int *p_mode = (int *) ((char *) self + (size_t) closure);
+    const char *name;
+    int mode;
+
+    if (!value) {
+        PyErr_SetString(PyExc_AttributeError, "Can not delete the cost mode.");
+        return -1;
+    }
+    if (!PyUnicode_Check(value)) {
+        PyErr_Format(PyExc_TypeError, "The cost mode must be a str not \"%s\".", Py_TYPE(value)->tp_name);
+        return -2;
+    }
+    name = PyUnicode_AsUTF8(value);
+    if (!name) {
+        return -3;
+    }
+    for (mode = 0; mode < COST_MODE_COUNT; ++mode) {
+        if (strcmp(name, COST_MODE_NAMES[mode]) == 0) {
+            PY_COUNTER_STORE(*p_mode, mode);
+            return 0;
+        }
+    }
+    PyErr_Format(PyExc_ValueError, "The cost mode must be 'sleep', 'busy' or 'busy_gil' not '%s'.", name);
+    return -4;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //PYTHONEXTENSIONPATTERNS_CCOSTMODEL_H
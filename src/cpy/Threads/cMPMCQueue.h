@@ -0,0 +1,122 @@
+//
+// cMPMCQueue.h
+// A bounded, lock-free, multi-producer multi-consumer ring buffer.
+//
+// Each slot has a 'turn' counter, position p of the ring uses slot p % capacity on lap p / capacity.
+// A producer may write the slot when its turn is 2 * lap, a consumer may read it when its turn is 2 * lap + 1.
+// Producers and consumers claim positions with a compare and swap on head and tail so none of them ever blocks.
+// This works for any capacity >= 1.
+//
+// Based on Erik Rigtorp's MPMCQueue https://github.com/rigtorp/MPMCQueue (MIT licence) which is in turn based on
+// Dmitry Vyukov's bounded MPMC queue.
+//
+// T must be trivially copyable, this is used for PyObject * in cppqueue.cpp and never touches a Python object.
+//
+
+#ifndef PYTHONEXTENSIONPATTERNS_CMPMCQUEUE_H
+#define PYTHONEXTENSIONPATTERNS_CMPMCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+template<typename T>
+class BoundedMPMCQueue {
+public:
+    /* capacity must be >= 1. This may throw std::bad_alloc. */
+    explicit BoundedMPMCQueue(size_t capacity) : m_capacity(capacity), m_slots(new Slot[capacity]) {}
+    BoundedMPMCQueue(const BoundedMPMCQueue &) = delete;
+    BoundedMPMCQueue &operator=(const BoundedMPMCQueue &) = delete;
+
+    size_t capacity() const {
+        return m_capacity;
+    }
+
+    /* Returns false if the queue is full. */
+    bool try_push(const T &value) {
+        size_t head = m_head.value.load(std::memory_order_acquire);
+        while (true) {
+            Slot &slot = m_slots[head % m_capacity];
+            if (slot.turn.load(std::memory_order_acquire) == 2 * (head / m_capacity)) {
+                if (m_head.value.compare_exchange_strong(head, head + 1)) {
+                    slot.value = value;
+                    slot.turn.store(2 * (head / m_capacity) + 1, std::memory_order_release);
+                    return true;
+                }
+                /* Another producer claimed head, compare_exchange_strong() has updated it. */
+            } else {
+                size_t previous = head;
+                head = m_head.value.load(std::memory_order_acquire);
+                if (head == previous) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    /* Returns false if the queue is empty. */
+    bool try_pop(T &value) {
+        size_t tail = m_tail.value.load(std::memory_order_acquire);
+        while (true) {
+            Slot &slot = m_slots[tail % m_capacity];
+            if (slot.turn.load(std::memory_order_acquire) == 2 * (tail / m_capacity) + 1) {
+                if (m_tail.value.compare_exchange_strong(tail, tail + 1)) {
+                    value = slot.value;
+                    slot.turn.store(2 * (tail / m_capacity) + 2, std::memory_order_release);
+                    return true;
+                }
+            } else {
+                size_t previous = tail;
+                tail = m_tail.value.load(std::memory_order_acquire);
+                if (tail == previous) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    /* The number of values, this is only a snapshot if other threads are using the queue. */
+    size_t size() const {
+        size_t tail = m_tail.value.load(std::memory_order_acquire);
+        size_t head = m_head.value.load(std::memory_order_acquire);
+        if (head <= tail) {
+            return 0;
+        }
+        return head - tail < m_capacity ? head - tail : m_capacity;
+    }
+
+    /* Call visit(value) on each value that has been pushed and not popped.
+     * The caller must make sure that nothing else is using the queue. */
+    template<typename Visit>
+    int for_each(Visit visit) const {
+        size_t head = m_head.value.load(std::memory_order_acquire);
+        for (size_t pos = m_tail.value.load(std::memory_order_acquire); pos < head; ++pos) {
+            const Slot &slot = m_slots[pos % m_capacity];
+            if (slot.turn.load(std::memory_order_acquire) == 2 * (pos / m_capacity) + 1) {
+                int ret = visit(slot.value);
+                if (ret) {
+                    return ret;
+                }
+            }
+        }
+        return 0;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> turn{0};
+        T value{};
+    };
+    /* Padding puts head and tail in separate cache lines so that producers and consumers do not contend.
+     * This is not alignas(64) as C++11 new does not respect that. */
+    struct PaddedPosition {
+        char pad[64];
+        std::atomic<size_t> value{0};
+    };
+    const size_t m_capacity;
+    std::unique_ptr<Slot[]> m_slots;
+    PaddedPosition m_head;
+    PaddedPosition m_tail;
+};
+
+#endif //PYTHONEXTENSIONPATTERNS_CMPMCQUEUE_H
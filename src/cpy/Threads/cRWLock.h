@@ -0,0 +1,245 @@
+//
+// cRWLock.h
+// A reader/writer lock for the csublist and cppsublist examples, usable from C and C++.
+//
+// Read-only methods take a shared lock so that readers proceed together, mutators take an exclusive lock.
+// As with ACQUIRE_LOCK in csublist.c the lock is first tried with the GIL held, if that fails then the GIL is
+// released whilst blocking on the lock.
+//
+// The exclusive counters are only modified whilst the lock is held. The shared counters are modified by concurrent
+// readers, with the GIL that is safe but on a free-threaded build they are incremented atomically.
+// The time spent waiting is only measured when the first try fails so the uncontended path is not slowed down.
+// The time that the lock is held is only measured when trace_hold is set.
+//
+
+#ifndef PYTHONEXTENSIONPATTERNS_CRWLOCK_H
+#define PYTHONEXTENSIONPATTERNS_CRWLOCK_H
+
+#include <Python.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "py_free_threading.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The number of buckets in the lock hold time histogram. */
+#define LOCK_HOLD_HISTOGRAM_SIZE 32
+
+/* Counts of lock acquisitions, 'contended' is the number of those that had to wait for the lock.
+ * The spin and timeout fields are only used by the C++ classes in cThreadLock.h. */
+typedef struct {
+    Py_ssize_t shared_acquired;
+    Py_ssize_t shared_contended;
+    Py_ssize_t exclusive_acquired;
+    Py_ssize_t exclusive_contended;
+    /* Total nanoseconds spent waiting, including any waits that timed out. */
+    long long shared_wait_ns;
+    long long exclusive_wait_ns;
+    /* Contended acquisitions that succeeded whilst spinning, without releasing the GIL. */
+    Py_ssize_t spin_acquired;
+    /* Acquisitions with a timeout that gave up. */
+    Py_ssize_t timeouts;
+    /* Not a counter, the adaptive spin estimate of this lock. */
+    Py_ssize_t spin_estimate;
+    /* If non-zero the time that the lock is held is recorded in hold_histogram.
+     * Bucket 0 counts holds of less than 1 microsecond, bucket i counts holds of [2**(i-1), 2**i) microseconds and the
+     * last bucket also counts anything longer. */
+    char trace_hold;
+    Py_ssize_t hold_histogram[LOCK_HOLD_HISTOGRAM_SIZE];
+} LockCounters;
+
+/* A monotonic clock in nanoseconds for measuring the time spent waiting. */
+static inline long long
+lock_clock_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long) now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+typedef struct {
+    pthread_rwlock_t rwlock;
+    /* Non-zero once rwlock has been initialised. */
+    int initialised;
+} RWLock;
+
+/* Call this once the lock is acquired, returns the start time to pass to LockCounters_record_hold() or 0 if the hold
+ * time is not being traced. */
+static inline long long
+LockCounters_hold_start(LockCounters *counters) {
+    return PY_COUNTER_LOAD(counters->trace_hold) ? lock_clock_ns() : 0;
+}
+
+/* Call this just before releasing the lock with the value from LockCounters_hold_start(). */
+static inline void
+LockCounters_record_hold(LockCounters *counters, long long start_ns) {
+    if (start_ns) {
+        long long hold_us = (lock_clock_ns() - start_ns) / 1000;
+        int bucket = 0;
+        while (hold_us && bucket < LOCK_HOLD_HISTOGRAM_SIZE - 1) {
+            hold_us >>= 1;
+            ++bucket;
+        }
+        PY_COUNTER_INCREMENT(counters->hold_histogram[bucket]);
+    }
+}
+
+/* Returns a new dict of {upper bound in microseconds: count} of the non-empty buckets of the hold time histogram.
+ * If clear is non-zero the histogram is then cleared. Returns NULL with an exception set on failure. */
+static inline PyObject *
+LockCounters_hold_histogram(LockCounters *counters, int clear) {
+    PyObject *ret = PyDict_New();
+    PyObject *key = NULL;
+    PyObject *value = NULL;
+    int bucket;
+
+    if (!ret) {
+        goto except;
+    }
+    for (bucket = 0; bucket < LOCK_HOLD_HISTOGRAM_SIZE; ++bucket) {
+        Py_ssize_t count = PY_COUNTER_LOAD(counters->hold_histogram[bucket]);
+        if (count) {
+            key = PyLong_FromLongLong(1LL << bucket);
+            value = PyLong_FromSsize_t(count);
+            if (!key || !value || PyDict_SetItem(ret, key, value)) {
+                goto except;
+            }
+            Py_CLEAR(key);
+            Py_CLEAR(value);
+        }
+        if (clear) {
+            PY_COUNTER_STORE(counters->hold_histogram[bucket], 0);
+        }
+    }
+    assert(!PyErr_Occurred());
+    goto finally;
+except:
+    assert(PyErr_Occurred());
+    Py_CLEAR(ret);
+finally:
+    Py_XDECREF(key);
+    Py_XDECREF(value);
+    return ret;
+}
+
+/* Initialise the lock, returns non-zero and sets an exception on failure. */
+static inline int
+RWLock_init(RWLock *lock) {
+    pthread_rwlockattr_t attr;
+    int err;
+
+    assert(!lock->initialised);
+    if (pthread_rwlockattr_init(&attr)) {
+        PyErr_SetString(PyExc_MemoryError, "Unable to allocate reader/writer lock attributes.");
+        return -1;
+    }
+#ifdef __GLIBC__
+    /* glibc prefers readers by default which starves writers when most of the calls are reads. */
+    pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+    err = pthread_rwlock_init(&lock->rwlock, &attr);
+    pthread_rwlockattr_destroy(&attr);
+    if (err) {
+        PyErr_SetString(PyExc_MemoryError, "Unable to allocate reader/writer lock.");
+        return -2;
+    }
+    lock->initialised = 1;
+    return 0;
+}
+
+static inline void
+RWLock_free(RWLock *lock) {
+    if (lock->initialised) {
+        pthread_rwlock_destroy(&lock->rwlock);
+        lock->initialised = 0;
+    }
+}
+
+/* Acquire a shared lock, the GIL must be held. */
+static inline void
+RWLock_acquire_shared(RWLock *lock, LockCounters *counters) {
+    assert(lock->initialised);
+    if (pthread_rwlock_tryrdlock(&lock->rwlock)) {
+        long long start = lock_clock_ns();
+        Py_BEGIN_ALLOW_THREADS
+            pthread_rwlock_rdlock(&lock->rwlock);
+        Py_END_ALLOW_THREADS
+        PY_COUNTER_ADD(counters->shared_wait_ns, lock_clock_ns() - start);
+        PY_COUNTER_INCREMENT(counters->shared_contended);
+    }
+    PY_COUNTER_INCREMENT(counters->shared_acquired);
+}
+
+/* Acquire an exclusive lock, the GIL must be held. */
+static inline void
+RWLock_acquire_exclusive(RWLock *lock, LockCounters *counters) {
+    assert(lock->initialised);
+    if (pthread_rwlock_trywrlock(&lock->rwlock)) {
+        long long start = lock_clock_ns();
+        Py_BEGIN_ALLOW_THREADS
+            pthread_rwlock_wrlock(&lock->rwlock);
+        Py_END_ALLOW_THREADS
+        counters->exclusive_wait_ns += lock_clock_ns() - start;
+        counters->exclusive_contended++;
+    }
+    counters->exclusive_acquired++;
+}
+
+/* Try a shared or an exclusive lock without blocking, returns non-zero if acquired. */
+static inline int
+RWLock_try(RWLock *lock, int shared) {
+    assert(lock->initialised);
+    return shared ? !pthread_rwlock_tryrdlock(&lock->rwlock) : !pthread_rwlock_trywrlock(&lock->rwlock);
+}
+
+/* Block on a shared or an exclusive lock for up to timeout_us microseconds, or forever if that is negative.
+ * This must be called with the GIL released. Returns non-zero if the lock was acquired. */
+static inline int
+RWLock_acquire_timed(RWLock *lock, int shared, long long timeout_us) {
+    assert(lock->initialised);
+    if (timeout_us < 0) {
+        return shared ? !pthread_rwlock_rdlock(&lock->rwlock) : !pthread_rwlock_wrlock(&lock->rwlock);
+    }
+#if defined(_POSIX_TIMEOUTS) && _POSIX_TIMEOUTS > 0
+    /* The timed functions take an absolute CLOCK_REALTIME deadline. */
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += (time_t) (timeout_us / 1000000);
+    deadline.tv_nsec += (long) (timeout_us % 1000000) * 1000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    if (shared) {
+        return !pthread_rwlock_timedrdlock(&lock->rwlock, &deadline);
+    }
+    return !pthread_rwlock_timedwrlock(&lock->rwlock, &deadline);
+#else
+    /* macOS has no timed reader/writer lock functions so poll every 100us. */
+    long long deadline_ns = lock_clock_ns() + timeout_us * 1000LL;
+    struct timespec poll_interval = {0, 100000L};
+    while (!RWLock_try(lock, shared)) {
+        if (lock_clock_ns() >= deadline_ns) {
+            return 0;
+        }
+        nanosleep(&poll_interval, NULL);
+    }
+    return 1;
+#endif
+}
+
+/* Release either a shared or an exclusive lock. */
+static inline void
+RWLock_release(RWLock *lock) {
+    assert(lock->initialised);
+    pthread_rwlock_unlock(&lock->rwlock);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //PYTHONEXTENSIONPATTERNS_CRWLOCK_H
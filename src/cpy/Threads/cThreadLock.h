@@ -10,31 +10,205 @@
 
 #ifdef WITH_THREAD
 #include "pythread.h"
+#include "cRWLock.h"
 #endif
 
 #ifdef WITH_THREAD
-/* A RAII wrapper around the PyThread_type_lock. */
+#include <algorithm>
+#include <atomic>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+/* A hint to the CPU that this is a spin wait loop. */
+static inline void
+lock_cpu_pause() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/* The upper limit of spins before parking for every lock, 0 disables spinning. */
+static inline std::atomic<Py_ssize_t> &
+lock_max_spins() {
+    static std::atomic<Py_ssize_t> max_spins(100);
+    return max_spins;
+}
+
+/* The operations on a PyThread_type_lock. */
+class ThreadLockOps {
+public:
+    explicit ThreadLockOps(PyThread_type_lock lock) : m_lock(lock) {}
+    bool try_lock() { return PyThread_acquire_lock(m_lock, NOWAIT_LOCK) != 0; }
+    /* Called with the GIL released. */
+    bool wait(PY_TIMEOUT_T timeout_us) {
+        return PyThread_acquire_lock_timed(m_lock, timeout_us, 0) == PY_LOCK_ACQUIRED;
+    }
+private:
+    PyThread_type_lock m_lock;
+};
+
+/* The operations on a RWLock as either shared or exclusive. */
+template<bool Shared>
+class RWLockOps {
+public:
+    explicit RWLockOps(RWLock *lock) : m_lock(lock) {}
+    bool try_lock() { return RWLock_try(m_lock, Shared) != 0; }
+    /* Called with the GIL released. */
+    bool wait(PY_TIMEOUT_T timeout_us) { return RWLock_acquire_timed(m_lock, Shared, timeout_us) != 0; }
+private:
+    RWLock *m_lock;
+};
+
+/**
+ * Acquire a lock with the GIL held, returns true if acquired.
+ *
+ * The lock is tried once, if that fails it is tried again up to the spin limit, with a CPU pause between tries,
+ * whilst holding the GIL. Only then is the GIL released whilst blocking on the lock, the 'park'.
+ * Spinning avoids the cost of releasing and re-acquiring the GIL when the lock is held briefly.
+ *
+ * The spin limit adapts as glibc's PTHREAD_MUTEX_ADAPTIVE_NP does: each lock keeps an estimate of the spins that recent
+ * contended acquisitions needed, the limit is twice that plus ten, capped by lock_max_spins().
+ *
+ * timeout_us < 0 waits forever, 0 only tries the lock, otherwise this gives up after that many microseconds.
+ */
+template<typename Ops>
+static bool
+lock_acquire_adaptive(Ops ops, LockCounters &counters, bool shared, PY_TIMEOUT_T timeout_us) {
+    Py_ssize_t &acquired = shared ? counters.shared_acquired : counters.exclusive_acquired;
+    Py_ssize_t &contended = shared ? counters.shared_contended : counters.exclusive_contended;
+    long long &wait_ns = shared ? counters.shared_wait_ns : counters.exclusive_wait_ns;
+
+    if (ops.try_lock()) {
+        PY_COUNTER_INCREMENT(acquired);
+        return true;
+    }
+    if (timeout_us == 0) {
+        PY_COUNTER_INCREMENT(counters.timeouts);
+        return false;
+    }
+    long long start = lock_clock_ns();
+    bool result = false;
+    /* Spin. */
+    Py_ssize_t spin_estimate = PY_COUNTER_LOAD(counters.spin_estimate);
+    Py_ssize_t spin_limit = std::min(lock_max_spins().load(std::memory_order_relaxed), spin_estimate * 2 + 10);
+    Py_ssize_t spins = 0;
+    while (spins < spin_limit && !result) {
+        ++spins;
+        lock_cpu_pause();
+        result = ops.try_lock();
+    }
+    PY_COUNTER_STORE(counters.spin_estimate, spin_estimate + (spins - spin_estimate) / 8);
+    if (result) {
+        PY_COUNTER_INCREMENT(counters.spin_acquired);
+    } else {
+        /* Park. */
+        if (timeout_us > 0) {
+            timeout_us = std::max(timeout_us - (PY_TIMEOUT_T) ((lock_clock_ns() - start) / 1000), (PY_TIMEOUT_T) 0);
+        }
+        Py_BEGIN_ALLOW_THREADS
+            result = ops.wait(timeout_us);
+        Py_END_ALLOW_THREADS
+    }
+    PY_COUNTER_ADD(wait_ns, lock_clock_ns() - start);
+    if (result) {
+        PY_COUNTER_INCREMENT(contended);
+        PY_COUNTER_INCREMENT(acquired);
+    } else {
+        PY_COUNTER_INCREMENT(counters.timeouts);
+    }
+    return result;
+}
+
+/* Convert a timeout in seconds to microseconds for the classes below, a negative value is no timeout. */
+static inline PY_TIMEOUT_T
+lock_timeout_us(double timeout) {
+    if (timeout < 0) {
+        return -1;
+    }
+    if (timeout * 1e6 >= (double) PY_TIMEOUT_MAX) {
+        return PY_TIMEOUT_MAX;
+    }
+    return (PY_TIMEOUT_T) (timeout * 1e6);
+}
+
+/* A RAII wrapper around the PyThread_type_lock with an adaptive spin, see lock_acquire_adaptive().
+ * T must have the members lock and lock_counters, if lock_counters.trace_hold is set the hold time is recorded.
+ * With a timeout acquired() must be checked before using the object. */
 template<typename T>
 class AcquireLock {
 public:
-    AcquireLock(T *pObject) : m_pObject(pObject) {
+    AcquireLock(T *pObject, PY_TIMEOUT_T timeout_us = -1) : m_pObject(pObject), m_acquired(false), m_hold_start(0) {
         assert(m_pObject);
         assert(m_pObject->lock);
         Py_INCREF(m_pObject);
-        if (!PyThread_acquire_lock(m_pObject->lock, NOWAIT_LOCK)) {
-            Py_BEGIN_ALLOW_THREADS
-                PyThread_acquire_lock(m_pObject->lock, WAIT_LOCK);
-            Py_END_ALLOW_THREADS
+        m_acquired = lock_acquire_adaptive(ThreadLockOps(m_pObject->lock), m_pObject->lock_counters, false,
+                                           timeout_us);
+        if (m_acquired) {
+            m_hold_start = LockCounters_hold_start(&m_pObject->lock_counters);
         }
     }
+    bool acquired() const { return m_acquired; }
     ~AcquireLock() {
         assert(m_pObject);
         assert(m_pObject->lock);
-        PyThread_release_lock(m_pObject->lock);
+        if (m_acquired) {
+            LockCounters_record_hold(&m_pObject->lock_counters, m_hold_start);
+            PyThread_release_lock(m_pObject->lock);
+        }
+        Py_DECREF(m_pObject);
+    }
+private:
+    T *m_pObject;
+    bool m_acquired;
+    long long m_hold_start;
+};
+
+/* A RAII wrapper that, if the object is in reader/writer mode, acquires the RWLock rw_lock as shared or exclusive.
+ * Otherwise this acquires the PyThread_type_lock lock. Both have an adaptive spin, see lock_acquire_adaptive().
+ * T must have the members lock, rwlock, rw_lock and lock_counters, if lock_counters.trace_hold is set the hold time is
+ * recorded.
+ * With a timeout acquired() must be checked before using the object. */
+template<typename T, bool Shared>
+class AcquireReadWriteLock {
+public:
+    AcquireReadWriteLock(T *pObject, PY_TIMEOUT_T timeout_us = -1) : m_pObject(pObject), m_acquired(false),
+                                                                     m_hold_start(0) {
+        assert(m_pObject);
+        assert(m_pObject->lock);
+        Py_INCREF(m_pObject);
+        if (m_pObject->rwlock) {
+            m_acquired = lock_acquire_adaptive(RWLockOps<Shared>(&m_pObject->rw_lock), m_pObject->lock_counters,
+                                               Shared, timeout_us);
+        } else {
+            m_acquired = lock_acquire_adaptive(ThreadLockOps(m_pObject->lock), m_pObject->lock_counters, false,
+                                               timeout_us);
+        }
+        if (m_acquired) {
+            m_hold_start = LockCounters_hold_start(&m_pObject->lock_counters);
+        }
+    }
+    bool acquired() const { return m_acquired; }
+    ~AcquireReadWriteLock() {
+        assert(m_pObject);
+        assert(m_pObject->lock);
+        if (m_acquired) {
+            LockCounters_record_hold(&m_pObject->lock_counters, m_hold_start);
+            if (m_pObject->rwlock) {
+                RWLock_release(&m_pObject->rw_lock);
+            } else {
+                PyThread_release_lock(m_pObject->lock);
+            }
+        }
         Py_DECREF(m_pObject);
     }
 private:
     T *m_pObject;
+    bool m_acquired;
+    long long m_hold_start;
 };
 
 #else
@@ -42,10 +216,25 @@ private:
 template<typename T>
 class AcquireLock {
 public:
-    AcquireLock(T *) {}
+    AcquireLock(T *, long long = -1) {}
+    bool acquired() const { return true; }
+};
+
+template<typename T, bool Shared>
+class AcquireReadWriteLock {
+public:
+    AcquireReadWriteLock(T *, long long = -1) {}
+    bool acquired() const { return true; }
 };
 #endif
 
+/* For read-only methods. */
+template<typename T>
+using AcquireReadLock = AcquireReadWriteLock<T, true>;
+/* For mutators. */
+template<typename T>
+using AcquireWriteLock = AcquireReadWriteLock<T, false>;
+
 // From https://github.com/python/cpython/blob/main/Modules/_bz2module.c
 // #define ACQUIRE_LOCK(obj) do { \
 //    if (!PyThread_acquire_lock((obj)->lock, 0)) { \
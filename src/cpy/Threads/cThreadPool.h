@@ -0,0 +1,104 @@
+//
+// cThreadPool.h
+// A small fixed size pool of C++ threads for reductions over native data with the GIL released.
+//
+// The threads never touch a Python object so the pool must only be used on data that has been copied out of Python,
+// see SubList_max() in cppsublist.cpp.
+//
+
+#ifndef PYTHONEXTENSIONPATTERNS_CTHREADPOOL_H
+#define PYTHONEXTENSIONPATTERNS_CTHREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Runs a batch of tasks, task(0) ... task(count - 1), across the worker threads and the calling thread.
+ * Only one batch runs at a time, concurrent callers of run() wait their turn. */
+class ThreadPool {
+public:
+    /* thread_count is the total number of threads that run tasks, including the caller, so 1 has no workers. */
+    explicit ThreadPool(size_t thread_count) {
+        for (size_t i = 1; i < thread_count; ++i) {
+            m_workers.emplace_back(&ThreadPool::worker, this);
+        }
+    }
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv_work.notify_all();
+        for (auto &worker: m_workers) {
+            worker.join();
+        }
+    }
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t thread_count() const {
+        return m_workers.size() + 1;
+    }
+
+    /* Run task(i) for every i in [0, count), returns when they have all completed. task must not throw. */
+    void run(size_t count, const std::function<void(size_t)> &task) {
+        std::lock_guard<std::mutex> run_lock(m_run_mutex);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_task = &task;
+            m_next = 0;
+            m_count = count;
+            m_done = 0;
+        }
+        m_cv_work.notify_all();
+        /* The caller works as well. */
+        std::unique_lock<std::mutex> lock(m_mutex);
+        run_tasks(lock);
+        m_cv_done.wait(lock, [this] { return m_done == m_count; });
+        m_task = nullptr;
+    }
+
+private:
+    /* Claim and run tasks until there are none left, lock must be held on entry and is held on exit. */
+    void run_tasks(std::unique_lock<std::mutex> &lock) {
+        while (m_task && m_next < m_count) {
+            size_t index = m_next++;
+            const std::function<void(size_t)> *task = m_task;
+            lock.unlock();
+            (*task)(index);
+            lock.lock();
+            if (++m_done == m_count) {
+                m_cv_done.notify_all();
+            }
+        }
+    }
+
+    void worker() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_cv_work.wait(lock, [this] { return m_stop || (m_task && m_next < m_count); });
+            if (m_stop) {
+                return;
+            }
+            run_tasks(lock);
+        }
+    }
+
+    std::vector<std::thread> m_workers;
+    /* Serialises calls to run(). */
+    std::mutex m_run_mutex;
+    /* Protects everything below. */
+    std::mutex m_mutex;
+    std::condition_variable m_cv_work;
+    std::condition_variable m_cv_done;
+    const std::function<void(size_t)> *m_task = nullptr;
+    size_t m_next = 0;
+    size_t m_count = 0;
+    size_t m_done = 0;
+    bool m_stop = false;
+};
+
+#endif //PYTHONEXTENSIONPATTERNS_CTHREADPOOL_H
@@ -0,0 +1,589 @@
+//
+//  cppqueue.cpp
+//  A bounded multi-producer, multi-consumer queue of Python objects for handing work between threads.
+//
+// The ring buffer, src/cpy/Threads/cMPMCQueue.h, is lock-free so put() and get() on a queue that is neither full
+// nor empty never take a lock. Only a thread that has to wait takes the mutex and, with the GIL released, sleeps on a
+// condition variable. A successful put() or get() only touches the mutex if there is a thread waiting.
+//
+// cppQueue(maxsize) has the same API as queue.Queue, apart from task_done() and join(), and raises queue.Full and
+// queue.Empty. It adds put_many(items, block=True, timeout=None) and get_many(max_items, block=True, timeout=None).
+
+#define PY_SSIZE_T_CLEAN
+
+#include <Python.h>
+#include "structmember.h"
+
+#include "py_fastcall_args.h"
+#include "py_free_threading.h"
+#include "cMPMCQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <vector>
+
+/* queue.Empty and queue.Full, set by PyInit_cppqueue(). */
+static PyObject *g_queue_empty = NULL;
+static PyObject *g_queue_full = NULL;
+
+typedef std::chrono::steady_clock QueueClock;
+
+/* A waiting thread wakes at least this often to check for signals such as KeyboardInterrupt. */
+static const std::chrono::milliseconds QUEUE_WAIT_SLICE(50);
+/* Timeouts longer than this, in seconds, are treated as no timeout. */
+static const double QUEUE_TIMEOUT_MAX = 1e9;
+
+/* The C++ state of a queue, created by cppQueue_init(). */
+struct QueueState {
+    explicit QueueState(size_t capacity) : ring(capacity) {}
+    /* The queue owns a reference to each object in the ring. */
+    BoundedMPMCQueue<PyObject *> ring;
+    /* Only taken by threads that have to wait, by the threads that wake them and by the garbage collector.
+     * A thread holding this never needs the GIL. */
+    std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    /* The number of threads waiting on not_empty and not_full. */
+    std::atomic<size_t> getters_waiting{0};
+    std::atomic<size_t> putters_waiting{0};
+};
+
+typedef struct {
+    PyObject_HEAD
+    QueueState *state;
+    Py_ssize_t maxsize;
+} cppQueueObject;
+
+/* Returns the state, or NULL with an exception set if __init__() has not been called. */
+static QueueState *
+cppQueue_state(cppQueueObject *self) {
+    if (!self->state) {
+        PyErr_SetString(PyExc_ValueError, "cppQueue has not been initialised.");
+    }
+    return self->state;
+}
+
+/* When, if ever, to stop waiting. */
+struct QueueDeadline {
+    /* False for a non-blocking call. */
+    bool wait;
+    /* False to wait forever. */
+    bool has_deadline;
+    QueueClock::time_point deadline;
+};
+
+/**
+ * Parse the block and timeout arguments in the same way as queue.Queue, either may be NULL.
+ * Returns 0 on success, -1 with an exception set.
+ */
+static int
+cppQueue_parse_deadline(PyObject *block, PyObject *timeout, QueueDeadline *deadline) {
+    deadline->wait = true;
+    deadline->has_deadline = false;
+    if (block) {
+        int truth = PyObject_IsTrue(block);
+        if (truth < 0) {
+            return -1;
+        }
+        deadline->wait = truth != 0;
+    }
+    if (deadline->wait && timeout && timeout != Py_None) {
+        double seconds = PyFloat_AsDouble(timeout);
+        if (seconds == -1.0 && PyErr_Occurred()) {
+            return -1;
+        }
+        if (seconds < 0.0) {
+            PyErr_SetString(PyExc_ValueError, "'timeout' must be a non-negative number");
+            return -1;
+        }
+        if (seconds < QUEUE_TIMEOUT_MAX) {
+            deadline->has_deadline = true;
+            deadline->deadline = QueueClock::now() + std::chrono::duration_cast<QueueClock::duration>(
+                    std::chrono::duration<double>(seconds)
+            );
+        }
+    }
+    return 0;
+}
+
+/**
+ * Wake the threads waiting on cv, if there are any, after a successful put or get.
+ * This does not need the GIL.
+ */
+static void
+cppQueue_notify(QueueState *state, std::condition_variable &cv, std::atomic<size_t> &waiting) {
+    /* Pairs with the fence in cppQueue_wait(), either this sees the waiter or the waiter sees the change. */
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting.load(std::memory_order_relaxed)) {
+        /* Once we have the mutex the waiter is either before its attempt or is waiting on cv. */
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+        }
+        cv.notify_all();
+    }
+}
+
+/**
+ * Wait, with the GIL released, until attempt() succeeds or the deadline passes.
+ * attempt() is called with the mutex held and must not touch a Python object.
+ * Returns 1 if attempt() succeeded, 0 on timeout or -1 with an exception set if a signal handler raised.
+ */
+template<typename Attempt>
+static int
+cppQueue_wait(QueueState *state, std::condition_variable &cv, std::atomic<size_t> &waiting,
+              const QueueDeadline &deadline, Attempt attempt) {
+    if (!deadline.wait) {
+        return 0;
+    }
+    while (true) {
+        bool done;
+        Py_BEGIN_ALLOW_THREADS
+            {
+                std::unique_lock<std::mutex> lock(state->mutex);
+                waiting.fetch_add(1);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                QueueClock::time_point wake = QueueClock::now() + QUEUE_WAIT_SLICE;
+                if (deadline.has_deadline && deadline.deadline < wake) {
+                    wake = deadline.deadline;
+                }
+                done = cv.wait_until(lock, wake, attempt);
+                waiting.fetch_sub(1);
+            }
+        Py_END_ALLOW_THREADS
+        if (done) {
+            return 1;
+        }
+        if (PyErr_CheckSignals()) {
+            return -1;
+        }
+        if (deadline.has_deadline && QueueClock::now() >= deadline.deadline) {
+            return 0;
+        }
+    }
+}
+
+/**
+ * Put a new reference to item in the queue, waiting for space if necessary.
+ * Returns 0 on success, -1 with an exception set, queue.Full on timeout.
+ */
+static int
+cppQueue_put_item(QueueState *state, PyObject *item, const QueueDeadline &deadline) {
+    Py_INCREF(item);
+    if (!state->ring.try_push(item)) {
+        int ret = cppQueue_wait(state, state->not_full, state->putters_waiting, deadline,
+                                [state, item]() { return state->ring.try_push(item); });
+        if (ret <= 0) {
+            Py_DECREF(item);
+            if (ret == 0) {
+                PyErr_SetNone(g_queue_full);
+            }
+            return -1;
+        }
+    }
+    cppQueue_notify(state, state->not_empty, state->getters_waiting);
+    return 0;
+}
+
+/**
+ * Remove an item from the queue, waiting for one if necessary.
+ * Returns a new reference or NULL with an exception set, queue.Empty on timeout.
+ */
+static PyObject *
+cppQueue_get_item(QueueState *state, const QueueDeadline &deadline) {
+    PyObject *item = NULL;
+    if (!state->ring.try_pop(item)) {
+        int ret = cppQueue_wait(state, state->not_empty, state->getters_waiting, deadline,
+                                [state, &item]() { return state->ring.try_pop(item); });
+        if (ret <= 0) {
+            if (ret == 0) {
+                PyErr_SetNone(g_queue_empty);
+            }
+            return NULL;
+        }
+    }
+    cppQueue_notify(state, state->not_full, state->putters_waiting);
+    return item;
+}
+
+static int
+cppQueue_init(cppQueueObject *self, PyObject *args, PyObject *kwds) {
+    static const char *kwlist[] = {"maxsize", NULL};
+    Py_ssize_t maxsize;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "n", const_cast<char **>(kwlist), &maxsize)) {
+        return -1;
+    }
+    if (self->state) {
+        PyErr_SetString(PyExc_RuntimeError, "cppQueue can not be re-initialised.");
+        return -1;
+    }
+    if (maxsize < 1) {
+        PyErr_Format(PyExc_ValueError, "maxsize must be >= 1 not %zd.", maxsize);
+        return -1;
+    }
+    try {
+        self->state = new QueueState((size_t) maxsize);
+    } catch (const std::bad_alloc &) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    self->maxsize = maxsize;
+    return 0;
+}
+
+/* The queue owns references so can be part of a reference cycle. */
+static int
+cppQueue_traverse(cppQueueObject *self, visitproc visit, void *arg) {
+    if (self->state) {
+        /* Threads without the GIL only use the ring with the mutex held. */
+        std::lock_guard<std::mutex> lock(self->state->mutex);
+        return self->state->ring.for_each([visit, arg](PyObject *item) {
+            Py_VISIT(item);
+            return 0;
+        });
+    }
+    return 0;
+}
+
+static int
+cppQueue_clear(cppQueueObject *self) {
+    if (self->state) {
+        PyObject *item = NULL;
+        while (self->state->ring.try_pop(item)) {
+            Py_DECREF(item);
+        }
+        cppQueue_notify(self->state, self->state->not_full, self->state->putters_waiting);
+    }
+    return 0;
+}
+
+static void
+cppQueue_dealloc(cppQueueObject *self) {
+    PyObject_GC_UnTrack(self);
+    cppQueue_clear(self);
+    delete self->state;
+    self->state = NULL;
+    Py_TYPE(self)->tp_free((PyObject *) self);
+}
+
+static const char *const put_keywords[] = {"item", "block", "timeout", NULL};
+static PyFastcallParser put_parser = {"put", put_keywords, 1, NULL, 0};
+
+static PyObject *
+cppQueue_put(cppQueueObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+    PyObject *argv[3];
+    QueueDeadline deadline;
+
+    QueueState *state = cppQueue_state(self);
+    if (!state || py_fastcall_unpack(&put_parser, args, nargs, kwnames, argv)) {
+        return NULL;
+    }
+    if (cppQueue_parse_deadline(argv[1], argv[2], &deadline) || cppQueue_put_item(state, argv[0], deadline)) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+cppQueue_put_nowait(cppQueueObject *self, PyObject *item) {
+    QueueDeadline deadline = {false, false, QueueClock::time_point()};
+
+    QueueState *state = cppQueue_state(self);
+    if (!state || cppQueue_put_item(state, item, deadline)) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static const char *const get_keywords[] = {"block", "timeout", NULL};
+static PyFastcallParser get_parser = {"get", get_keywords, 0, NULL, 0};
+
+static PyObject *
+cppQueue_get(cppQueueObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+    PyObject *argv[2];
+    QueueDeadline deadline;
+
+    QueueState *state = cppQueue_state(self);
+    if (!state || py_fastcall_unpack(&get_parser, args, nargs, kwnames, argv)) {
+        return NULL;
+    }
+    if (cppQueue_parse_deadline(argv[0], argv[1], &deadline)) {
+        return NULL;
+    }
+    return cppQueue_get_item(state, deadline);
+}
+
+static PyObject *
+cppQueue_get_nowait(cppQueueObject *self, PyObject *Py_UNUSED(ignored)) {
+    QueueDeadline deadline = {false, false, QueueClock::time_point()};
+
+    QueueState *state = cppQueue_state(self);
+    if (!state) {
+        return NULL;
+    }
+    return cppQueue_get_item(state, deadline);
+}
+
+static const char *const put_many_keywords[] = {"items", "block", "timeout", NULL};
+static PyFastcallParser put_many_parser = {"put_many", put_many_keywords, 1, NULL, 0};
+
+/**
+ * Put the items in order, waiting for space as necessary.
+ * Returns the number put, this is less than the number of items if the queue is full and block is False or the
+ * timeout expires. If a signal handler raises the items already put remain in the queue.
+ */
+static PyObject *
+cppQueue_put_many(cppQueueObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+    PyObject *argv[3];
+    QueueDeadline deadline;
+    PyObject *items = NULL;
+    PyObject *ret = NULL;
+    Py_ssize_t count = 0;
+
+    QueueState *state = cppQueue_state(self);
+    if (!state || py_fastcall_unpack(&put_many_parser, args, nargs, kwnames, argv)) {
+        return NULL;
+    }
+    if (cppQueue_parse_deadline(argv[1], argv[2], &deadline)) {
+        return NULL;
+    }
+    /* A tuple as another thread could change a list whilst we are waiting. */
+    items = PySequence_Tuple(argv[0]);
+    if (!items) {
+        goto except;
+    }
+    while (count < PyTuple_GET_SIZE(items)) {
+        PyObject *item = PyTuple_GET_ITEM(items, count);
+        Py_INCREF(item);
+        if (state->ring.try_push(item)) {
+            ++count;
+            continue;
+        }
+        /* Full, let the consumers have what has been put so far. */
+        cppQueue_notify(state, state->not_empty, state->getters_waiting);
+        int waited = cppQueue_wait(state, state->not_full, state->putters_waiting, deadline,
+                                   [state, item]() { return state->ring.try_push(item); });
+        if (waited <= 0) {
+            Py_DECREF(item);
+            if (waited < 0) {
+                goto except;
+            }
+            break;
+        }
+        ++count;
+    }
+    ret = PyLong_FromSsize_t(count);
+    goto finally;
+except:
+    assert(PyErr_Occurred());
+    ret = NULL;
+finally:
+    if (count) {
+        cppQueue_notify(state, state->not_empty, state->getters_waiting);
+    }
+    Py_XDECREF(items);
+    return ret;
+}
+
+static const char *const get_many_keywords[] = {"max_items", "block", "timeout", NULL};
+static PyFastcallParser get_many_parser = {"get_many", get_many_keywords, 1, NULL, 0};
+
+/**
+ * Wait for the first item exactly as get() then remove up to max_items - 1 more without waiting.
+ * Returns a list of at least one item.
+ */
+static PyObject *
+cppQueue_get_many(cppQueueObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+    PyObject *argv[3];
+    QueueDeadline deadline;
+    std::vector<PyObject *> items;
+
+    QueueState *state = cppQueue_state(self);
+    if (!state || py_fastcall_unpack(&get_many_parser, args, nargs, kwnames, argv)) {
+        return NULL;
+    }
+    Py_ssize_t max_items = PyNumber_AsSsize_t(argv[0], PyExc_OverflowError);
+    if (max_items == -1 && PyErr_Occurred()) {
+        return NULL;
+    }
+    if (max_items < 1) {
+        PyErr_Format(PyExc_ValueError, "max_items must be >= 1 not %zd.", max_items);
+        return NULL;
+    }
+    if (cppQueue_parse_deadline(argv[1], argv[2], &deadline)) {
+        return NULL;
+    }
+    /* Allocate before removing anything from the queue so nothing is lost on failure. */
+    try {
+        items.reserve((size_t) std::min(max_items, self->maxsize));
+    } catch (const std::bad_alloc &) {
+        return PyErr_NoMemory();
+    }
+    PyObject *item = cppQueue_get_item(state, deadline);
+    if (!item) {
+        return NULL;
+    }
+    items.push_back(item);
+    while ((Py_ssize_t) items.size() < max_items && items.size() < items.capacity() && state->ring.try_pop(item)) {
+        items.push_back(item);
+    }
+    if (items.size() > 1) {
+        cppQueue_notify(state, state->not_full, state->putters_waiting);
+    }
+    PyObject *ret = PyList_New((Py_ssize_t) items.size());
+    if (!ret) {
+        for (PyObject *lost: items) {
+            Py_DECREF(lost);
+        }
+        return NULL;
+    }
+    for (size_t i = 0; i < items.size(); ++i) {
+        /* Steals the reference. */
+        PyList_SET_ITEM(ret, (Py_ssize_t) i, items[i]);
+    }
+    return ret;
+}
+
+static PyObject *
+cppQueue_qsize(cppQueueObject *self, PyObject *Py_UNUSED(ignored)) {
+    QueueState *state = cppQueue_state(self);
+    if (!state) {
+        return NULL;
+    }
+    return PyLong_FromSize_t(state->ring.size());
+}
+
+static PyObject *
+cppQueue_empty(cppQueueObject *self, PyObject *Py_UNUSED(ignored)) {
+    QueueState *state = cppQueue_state(self);
+    if (!state) {
+        return NULL;
+    }
+    return PyBool_FromLong(state->ring.size() == 0);
+}
+
+static PyObject *
+cppQueue_full(cppQueueObject *self, PyObject *Py_UNUSED(ignored)) {
+    QueueState *state = cppQueue_state(self);
+    if (!state) {
+        return NULL;
+    }
+    return PyBool_FromLong(state->ring.size() >= state->ring.capacity());
+}
+
+static Py_ssize_t
+cppQueue_sq_length(cppQueueObject *self) {
+    QueueState *state = cppQueue_state(self);
+    if (!state) {
+        return -1;
+    }
+    return (Py_ssize_t) state->ring.size();
+}
+
+static PySequenceMethods cppQueue_sequence_methods = {
+        .sq_length = (lenfunc) cppQueue_sq_length,
+};
+
+static PyMethodDef cppQueue_methods[] = {
+        {"put",        (PyCFunction) (void (*)(void)) cppQueue_put,      METH_FASTCALL | METH_KEYWORDS,
+                PyDoc_STR("put(item, block=True, timeout=None) Put an item into the queue, raises queue.Full.")},
+        {"put_nowait", (PyCFunction) cppQueue_put_nowait,                 METH_O,
+                PyDoc_STR("Put an item into the queue without blocking, raises queue.Full.")},
+        {"get",        (PyCFunction) (void (*)(void)) cppQueue_get,      METH_FASTCALL | METH_KEYWORDS,
+                PyDoc_STR("get(block=True, timeout=None) Remove and return an item, raises queue.Empty.")},
+        {"get_nowait", (PyCFunction) cppQueue_get_nowait,                 METH_NOARGS,
+                PyDoc_STR("Remove and return an item without blocking, raises queue.Empty.")},
+        {"put_many",   (PyCFunction) (void (*)(void)) cppQueue_put_many, METH_FASTCALL | METH_KEYWORDS,
+                PyDoc_STR("put_many(items, block=True, timeout=None) Put the items in order."
+                          " Returns the number put which is less than the number of items on a timeout.")},
+        {"get_many",   (PyCFunction) (void (*)(void)) cppQueue_get_many, METH_FASTCALL | METH_KEYWORDS,
+                PyDoc_STR("get_many(max_items, block=True, timeout=None) Wait for one item, as get(), then"
+                          " return a list of up to max_items without waiting again.")},
+        {"qsize",      (PyCFunction) cppQueue_qsize,                      METH_NOARGS,
+                PyDoc_STR("Return the approximate size of the queue.")},
+        {"empty",      (PyCFunction) cppQueue_empty,                      METH_NOARGS,
+                PyDoc_STR("Return True if the queue is empty, this is only a snapshot.")},
+        {"full",       (PyCFunction) cppQueue_full,                       METH_NOARGS,
+                PyDoc_STR("Return True if the queue is full, this is only a snapshot.")},
+        {NULL, NULL, 0, NULL},
+};
+
+static PyMemberDef cppQueue_members[] = {
+        {"maxsize", T_PYSSIZET, offsetof(cppQueueObject, maxsize), READONLY,
+                PyDoc_STR("The maximum number of items in the queue.")},
+        {NULL, 0, 0, 0, NULL}  /* Sentinel */
+};
+
+static PyTypeObject cppQueueType = {
+        PyVarObject_HEAD_INIT(NULL, 0)
+        .tp_name = "cppqueue.cppQueue",
+        .tp_basicsize = sizeof(cppQueueObject),
+        .tp_itemsize = 0,
+        .tp_dealloc = (destructor) cppQueue_dealloc,
+        .tp_as_sequence = &cppQueue_sequence_methods,
+        .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC,
+        .tp_doc = PyDoc_STR("cppQueue(maxsize) a bounded, lock-free, multi-producer multi-consumer queue."),
+        .tp_traverse = (traverseproc) cppQueue_traverse,
+        .tp_clear = (inquiry) cppQueue_clear,
+        .tp_methods = cppQueue_methods,
+        .tp_members = cppQueue_members,
+        .tp_init = (initproc) cppQueue_init,
+        .tp_new = PyType_GenericNew,
+};
+
+static PyModuleDef cppqueuemodule = {
+        PyModuleDef_HEAD_INIT,
+        .m_name = "cppqueue",
+        .m_doc = "Example module that creates a lock-free queue type.",
+        .m_size = -1,
+};
+
+PyMODINIT_FUNC
+PyInit_cppqueue(void) {
+    PyObject *m = NULL;
+    PyObject *queue_module = NULL;
+
+    if (py_fastcall_parser_init(&put_parser) || py_fastcall_parser_init(&get_parser)
+        || py_fastcall_parser_init(&put_many_parser) || py_fastcall_parser_init(&get_many_parser)) {
+        goto except;
+    }
+    queue_module = PyImport_ImportModule("queue");
+    if (!queue_module) {
+        goto except;
+    }
+    g_queue_empty = PyObject_GetAttrString(queue_module, "Empty");
+    if (!g_queue_empty) {
+        goto except;
+    }
+    g_queue_full = PyObject_GetAttrString(queue_module, "Full");
+    if (!g_queue_full) {
+        goto except;
+    }
+    if (PyType_Ready(&cppQueueType) < 0) {
+        goto except;
+    }
+    m = PyModule_Create(&cppqueuemodule);
+    if (!m) {
+        goto except;
+    }
+    Py_INCREF(&cppQueueType);
+    if (PyModule_AddObject(m, "cppQueue", (PyObject *) &cppQueueType) < 0) {
+        Py_DECREF(&cppQueueType);
+        goto except;
+    }
+    if (PY_MODULE_GIL_NOT_USED(m)) {
+        goto except;
+    }
+    goto finally;
+except:
+    Py_CLEAR(g_queue_empty);
+    Py_CLEAR(g_queue_full);
+    Py_CLEAR(m);
+finally:
+    Py_XDECREF(queue_module);
+    return m;
+}
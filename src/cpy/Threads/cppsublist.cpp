@@ -10,6 +10,18 @@
 // This is very like src/cpy/SubClass/sublist.c but it includes a slow max() method
 // to illustrate thread contention.
 // So it needs a thread lock.
+//
+// cppSubList(iterable=(), rwlock=False) with rwlock=True uses a reader/writer lock where the read-only methods,
+// max(), __getitem__, __len__ and __contains__, take a shared lock and the mutators take an exclusive lock.
+//
+// max() on a long list of only ints, or only floats, copies the values out under the lock then finds the maximum
+// with the lock and the GIL released using a pool of C++ threads.
+//
+// The locks spin briefly before releasing the GIL and blocking, see cThreadLock.h, max(timeout=...) gives up with a
+// TimeoutError. The lock_* attributes count the acquisitions, contention and time spent waiting.
+//
+// The simulated work in append() and the generic max() is set by the cost model attributes, see cCostModel.h, and with
+// trace_lock_hold=True the time that the lock is held is recorded in a histogram, see lock_hold_histogram().
 
 #define PY_SSIZE_T_CLEAN
 
@@ -17,30 +29,82 @@
 #include "structmember.h"
 
 #include "py_call_super.h"
+#include "py_free_threading.h"
 #include "cThreadLock.h"
-#include <time.h>
+#include "cThreadPool.h"
+#include "cCostModel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <new>
+#include <system_error>
 
 
 typedef struct {
     PyListObject list;
 #ifdef WITH_THREAD
     PyThread_type_lock lock;
+    /* Non-zero if this uses rw_lock rather than lock. */
+    char rwlock;
+    RWLock rw_lock;
+    LockCounters lock_counters;
 #endif
+    CostModel cost_model;
 } SubListObject;
 
 static int
 SubList_init(SubListObject *self, PyObject *args, PyObject *kwds) {
-    if (PyList_Type.tp_init((PyObject *) self, args, kwds) < 0) {
-        return -1;
+    int ret = -1;
+    int rwlock = 0;
+    PyObject *list_kwds = NULL;
+
+    /* Remove rwlock from the keyword arguments before passing them to list. */
+    if (kwds) {
+        PyObject *value = PyDict_GetItemString(kwds, "rwlock");
+        if (value) {
+            rwlock = PyObject_IsTrue(value);
+            if (rwlock < 0) {
+                goto except;
+            }
+            list_kwds = PyDict_Copy(kwds);
+            if (!list_kwds || PyDict_DelItemString(list_kwds, "rwlock")) {
+                goto except;
+            }
+        }
+    }
+    if (PyList_Type.tp_init((PyObject *) self, args, list_kwds ? list_kwds : kwds) < 0) {
+        goto except;
     }
 #ifdef WITH_THREAD
-    self->lock = PyThread_allocate_lock();
-    if (self->lock == NULL) {
-        PyErr_SetString(PyExc_MemoryError, "Unable to allocate thread lock.");
-        return -2;
+    if (self->lock) {
+        /* __init__() called again. */
+        if (rwlock != self->rwlock) {
+            PyErr_SetString(PyExc_ValueError, "The lock mode can not be changed.");
+            goto except;
+        }
+    } else {
+        self->lock = PyThread_allocate_lock();
+        if (self->lock == NULL) {
+            PyErr_SetString(PyExc_MemoryError, "Unable to allocate thread lock.");
+            goto except;
+        }
+        if (rwlock && RWLock_init(&self->rw_lock)) {
+            goto except;
+        }
+        self->rwlock = (char) rwlock;
     }
 #endif
-    return 0;
+    assert(!PyErr_Occurred());
+    ret = 0;
+    goto finally;
+except:
+    assert(PyErr_Occurred());
+    ret = -1;
+finally:
+    Py_XDECREF(list_kwds);
+    return ret;
 }
 
 static void
@@ -51,91 +115,615 @@ SubList_dealloc(SubListObject *self) {
         PyThread_free_lock(self->lock);
         self->lock = NULL;
     }
+    RWLock_free(&self->rw_lock);
 #endif
     Py_TYPE(self)->tp_free((PyObject *)self);
 }
 
-void sleep_milliseconds(long ms) {
-    struct timespec tim_request, tim_remain;
-    tim_request.tv_sec = 0;
-    tim_request.tv_nsec = ms * 1000L * 1000L;
-    nanosleep(&tim_request, &tim_remain);
-}
-
 /** append with a thread lock. */
 static PyObject *
 SubList_append(SubListObject *self, PyObject *args) {
-    AcquireLock<SubListObject> local_lock((SubListObject *)self);
+    AcquireWriteLock<SubListObject> local_lock((SubListObject *)self);
     PyObject *result = call_super_name(
             (PyObject *) self, "append", args, NULL
     );
-    // 0.25s delay to demonstrate holding on to the thread.
-    sleep_milliseconds(250L);
+    // Simulated work whilst holding on to the lock.
+    CostModel_work(&self->cost_model, PY_COUNTER_LOAD(self->cost_model.append_us));
     return result;
 }
 
 /** This is a deliberately laborious find of the maximum value to
  * demonstrate protection against thread contention.
+ * The caller must hold the lock.
  */
 static PyObject *
-SubList_max(PyObject *self, PyObject *Py_UNUSED(unused)) {
-    assert(!PyErr_Occurred());
-    AcquireLock<SubListObject> local_lock((SubListObject *)self);
+SubList_max_generic(PyObject *self) {
     PyObject *ret = NULL;
-    // SubListObject
+    CostModel *cost_model = &((SubListObject *)self)->cost_model;
     size_t length = PyList_Size(self);
     if (length == 0) {
         // Raise
         PyErr_SetString(PyExc_ValueError, "max() on empty list.");
     } else {
-        // Return first
-        ret = PyList_GetItem(self, 0);
-        if (length > 1) {
-            // laborious compare
-            PyObject *item = NULL;
-            for(Py_ssize_t i = 1; i <PyList_Size(self); ++i) {
-                item = PyList_GetItem(self, i);
-                int result = PyObject_RichCompareBool(item, ret, Py_GT);
-                if (result < 0) {
-                    // Error, not comparable.
-                    ret = NULL;
-                } else if (result > 0) {
-                    ret = item;
+        // Return first, these are strong references as other threads might be changing the list.
+        ret = PyList_Type.tp_as_sequence->sq_item(self, 0);
+        // Laborious compare
+        PyObject *item = NULL;
+        for(Py_ssize_t i = 1; ret && i < PyList_Size(self); ++i) {
+            item = PyList_Type.tp_as_sequence->sq_item(self, i);
+            if (!item) {
+                // The list has been shortened by another thread.
+                Py_CLEAR(ret);
+                break;
+            }
+            int result = PyObject_RichCompareBool(item, ret, Py_GT);
+            if (result < 0) {
+                // Error, not comparable.
+                Py_CLEAR(ret);
+            } else if (result > 0) {
+                Py_DECREF(ret);
+                ret = item;
+                item = NULL;
+            }
+            Py_XDECREF(item);
+            // Simulated work whilst holding on to the lock.
+            CostModel_work(cost_model, PY_COUNTER_LOAD(cost_model->compare_us));
+        }
+    }
+    return ret;
+}
+
+/** Returns a new reference to the maximum of the items in a list that no other thread can change, or NULL with an
+ * exception set. */
+static PyObject *
+SubList_max_of_snapshot(PyObject *snapshot) {
+    if (PyList_GET_SIZE(snapshot) == 0) {
+        PyErr_SetString(PyExc_ValueError, "max() on empty list.");
+        return NULL;
+    }
+    PyObject *ret = PyList_GET_ITEM(snapshot, 0);
+    for (Py_ssize_t i = 1; i < PyList_GET_SIZE(snapshot); ++i) {
+        PyObject *item = PyList_GET_ITEM(snapshot, i);
+        int result = PyObject_RichCompareBool(item, ret, Py_GT);
+        if (result < 0) {
+            // Error, not comparable.
+            return NULL;
+        } else if (result > 0) {
+            ret = item;
+        }
+    }
+    Py_INCREF(ret);
+    return ret;
+}
+
+/** The generic max() with a reader/writer lock.
+ * The comparisons can call back into Python and so into this list, a nested shared lock would deadlock if a writer
+ * were waiting. So this copies the items and does the simulated work, the caller compares the copy with
+ * SubList_max_of_snapshot() after releasing the lock.
+ * The caller must hold the shared lock.
+ */
+static PyObject *
+SubList_max_generic_snapshot(PyObject *self) {
+    CostModel *cost_model = &((SubListObject *)self)->cost_model;
+    PyObject *snapshot = PyList_GetSlice(self, 0, PY_SSIZE_T_MAX);
+    for (Py_ssize_t i = 1; snapshot && i < PyList_GET_SIZE(snapshot); ++i) {
+        // Simulated work for each comparison whilst holding on to the lock.
+        CostModel_work(cost_model, PY_COUNTER_LOAD(cost_model->compare_us));
+    }
+    return snapshot;
+}
+
+/**** The native max() for lists of only ints or only floats. ****/
+
+/* Lists at least this long are copied out and reduced with the GIL released. Always >= 1. */
+static std::atomic<Py_ssize_t> g_parallel_max_threshold(1 << 12);
+/* The number of threads, including the caller, that share the reduction. 0 is std::thread::hardware_concurrency(). */
+static std::atomic<size_t> g_parallel_max_threads(0);
+/* Each thread reduces at least this many values. */
+static const size_t PARALLEL_MAX_MIN_CHUNK = 1 << 14;
+/* Created on first use, replaced by set_parallel_max_threads().
+ * g_thread_pool_mutex protects g_thread_pool and is only acquired with the GIL released. */
+static std::unique_ptr<ThreadPool> g_thread_pool;
+static std::mutex g_thread_pool_mutex;
+
+static size_t
+parallel_max_thread_count() {
+    size_t count = g_parallel_max_threads;
+    if (count == 0) {
+        count = std::thread::hardware_concurrency();
+    }
+    return count ? count : 1;
+}
+
+/* Convert an item, returns false if it can not be represented exactly or, for a NaN, ordered. */
+static bool
+sublist_native_value(PyObject *item, long long &value) {
+    if (!PyLong_CheckExact(item)) {
+        return false;
+    }
+    int overflow;
+    value = PyLong_AsLongLongAndOverflow(item, &overflow);
+    return !overflow;
+}
+
+static bool
+sublist_native_value(PyObject *item, double &value) {
+    if (!PyFloat_CheckExact(item)) {
+        return false;
+    }
+    value = PyFloat_AS_DOUBLE(item);
+    return !std::isnan(value);
+}
+
+template<typename T>
+static bool
+sublist_native_values(PyObject *self, std::vector<T> &values) {
+    Py_ssize_t size = PyList_GET_SIZE(self);
+    values.resize(size);
+    for (Py_ssize_t i = 0; i < size; ++i) {
+        if (!sublist_native_value(PyList_GET_ITEM(self, i), values[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Copy the values of the list if it is long enough and they are all ints that fit in a long long or all floats
+ * that are not NaN. Mixed ints and floats are not copied as the conversion might change how they compare.
+ * The caller must hold the lock.
+ * Returns 1 if longs or doubles has been filled, 0 if the generic path must be used or -1 with an exception set.
+ */
+static int
+SubList_max_snapshot(PyObject *self, std::vector<long long> &longs, std::vector<double> &doubles) {
+    int ret = 0;
+    /* Other list methods do not take our lock, on a free-threaded build this stops them changing the list. */
+    Py_BEGIN_CRITICAL_SECTION(self);
+    try {
+        if (PyList_GET_SIZE(self) >= g_parallel_max_threshold) {
+            PyObject *first = PyList_GET_ITEM(self, 0);
+            if (PyLong_CheckExact(first)) {
+                ret = sublist_native_values(self, longs);
+            } else if (PyFloat_CheckExact(first)) {
+                ret = sublist_native_values(self, doubles);
+            }
+        }
+    } catch (const std::bad_alloc &) {
+        PyErr_NoMemory();
+        ret = -1;
+    }
+    Py_END_CRITICAL_SECTION();
+    return ret;
+}
+
+/**
+ * Returns the index of the first maximum value, values must not be empty.
+ * This is split into chunks, one per thread, if pool is NULL the caller reduces all of them.
+ * This does not need the GIL.
+ */
+template<typename T>
+static size_t
+parallel_argmax(const std::vector<T> &values, ThreadPool *pool) {
+    size_t thread_count = pool ? pool->thread_count() : 1;
+    size_t chunk_size = std::max(PARALLEL_MAX_MIN_CHUNK, (values.size() + thread_count - 1) / thread_count);
+    size_t chunk_count = (values.size() + chunk_size - 1) / chunk_size;
+    std::vector<size_t> chunk_best(chunk_count);
+    auto reduce_chunk = [&values, &chunk_best, chunk_size](size_t chunk) {
+        size_t begin = chunk * chunk_size;
+        size_t end = std::min(begin + chunk_size, values.size());
+        size_t best = begin;
+        for (size_t i = begin + 1; i < end; ++i) {
+            if (values[i] > values[best]) {
+                best = i;
+            }
+        }
+        chunk_best[chunk] = best;
+    };
+    if (pool && chunk_count > 1) {
+        pool->run(chunk_count, reduce_chunk);
+    } else {
+        for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+            reduce_chunk(chunk);
+        }
+    }
+    /* As max() the first of equal values wins. */
+    size_t best = chunk_best[0];
+    for (size_t chunk = 1; chunk < chunk_count; ++chunk) {
+        if (values[chunk_best[chunk]] > values[best]) {
+            best = chunk_best[chunk];
+        }
+    }
+    return best;
+}
+
+/* Reduce the copied values with the GIL released, returns the index of the maximum. */
+template<typename T>
+static size_t
+parallel_argmax_allow_threads(const std::vector<T> &values) {
+    size_t index;
+    Py_BEGIN_ALLOW_THREADS
+        {
+            std::lock_guard<std::mutex> pool_lock(g_thread_pool_mutex);
+            size_t thread_count = parallel_max_thread_count();
+            if (!g_thread_pool && thread_count > 1) {
+                try {
+                    g_thread_pool.reset(new ThreadPool(thread_count));
+                } catch (const std::system_error &) {
+                    /* Unable to create the threads, reduce in this thread. */
                 }
-                // 2ms delay to demonstrate holding on to the thread.
-                sleep_milliseconds(2L);
             }
+            index = parallel_argmax(values, g_thread_pool.get());
         }
-        Py_INCREF(ret);
+    Py_END_ALLOW_THREADS
+    return index;
+}
+
+/**
+ * max() with a native path for long lists of only ints or only floats, otherwise SubList_max_generic().
+ * If the lock can not be acquired within the optional timeout, in seconds, this raises a TimeoutError.
+ */
+static PyObject *
+SubList_max(PyObject *self, PyObject *args, PyObject *kwds) {
+    assert(!PyErr_Occurred());
+    static const char *kwlist[] = {"timeout", NULL};
+    PyObject *py_timeout = Py_None;
+    PY_TIMEOUT_T timeout_us = -1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O:max", (char **) kwlist, &py_timeout)) {
+        return NULL;
+    }
+    if (py_timeout != Py_None) {
+        double timeout = PyFloat_AsDouble(py_timeout);
+        if (timeout == -1.0 && PyErr_Occurred()) {
+            return NULL;
+        }
+        if (!(timeout >= 0)) {
+            PyErr_SetString(PyExc_ValueError, "'timeout' must be a non-negative number");
+            return NULL;
+        }
+        timeout_us = lock_timeout_us(timeout);
+    }
+    std::vector<long long> longs;
+    std::vector<double> doubles;
+    PyObject *generic_snapshot = NULL;
+    {
+        AcquireReadLock<SubListObject> local_lock((SubListObject *)self, timeout_us);
+        if (!local_lock.acquired()) {
+            PyErr_SetString(PyExc_TimeoutError, "Unable to acquire the lock within the timeout.");
+            return NULL;
+        }
+        int snapshot = SubList_max_snapshot(self, longs, doubles);
+        if (snapshot < 0) {
+            return NULL;
+        }
+        if (snapshot == 0) {
+            if (!((SubListObject *)self)->rwlock) {
+                return SubList_max_generic(self);
+            }
+            generic_snapshot = SubList_max_generic_snapshot(self);
+            if (!generic_snapshot) {
+                return NULL;
+            }
+        }
+    }
+    if (generic_snapshot) {
+        /* The lock has been released. */
+        PyObject *ret = SubList_max_of_snapshot(generic_snapshot);
+        Py_DECREF(generic_snapshot);
+        return ret;
+    }
+    /* The values have been copied so neither the lock nor the GIL is needed. */
+    if (!longs.empty()) {
+        return PyLong_FromLongLong(longs[parallel_argmax_allow_threads(longs)]);
+    }
+    return PyFloat_FromDouble(doubles[parallel_argmax_allow_threads(doubles)]);
+}
+
+/* Returns a new slice equivalent to slice with exact int members so that using it calls no Python code.
+ * Returns NULL with an exception set on failure, for example if __index__() raises or the step is zero. */
+static PyObject *
+sublist_exact_slice(PyObject *slice) {
+    Py_ssize_t start, stop, step;
+    PyObject *py_start = NULL;
+    PyObject *py_stop = NULL;
+    PyObject *py_step = NULL;
+    PyObject *ret = NULL;
+
+    if (PySlice_Unpack(slice, &start, &stop, &step) < 0) {
+        goto except;
+    }
+    py_start = PyLong_FromSsize_t(start);
+    py_stop = PyLong_FromSsize_t(stop);
+    py_step = PyLong_FromSsize_t(step);
+    if (!py_start || !py_stop || !py_step) {
+        goto except;
+    }
+    ret = PySlice_New(py_start, py_stop, py_step);
+    if (!ret) {
+        goto except;
+    }
+    goto finally;
+except:
+    assert(PyErr_Occurred());
+    ret = NULL;
+finally:
+    Py_XDECREF(py_start);
+    Py_XDECREF(py_stop);
+    Py_XDECREF(py_step);
+    return ret;
+}
+
+/* The read-only sequence and mapping methods of list.
+ * With a reader/writer lock these take the shared lock, otherwise, as list, they take no lock at all as the single
+ * lock is not re-entrant and these can be called by the comparisons in max().
+ * The lock is never held whilst calling back into Python, such as __eq__() or __index__(), as that might use this
+ * list again and a nested shared lock deadlocks if a writer is waiting. */
+static Py_ssize_t
+SubList_length(PyObject *self) {
+    if (!((SubListObject *)self)->rwlock) {
+        return PyList_Type.tp_as_sequence->sq_length(self);
+    }
+    AcquireReadLock<SubListObject> local_lock((SubListObject *)self);
+    return PyList_Type.tp_as_sequence->sq_length(self);
+}
+
+/* The comparisons are made with a copy of the list after the lock has been released. */
+static int
+SubList_contains(PyObject *self, PyObject *value) {
+    if (!((SubListObject *)self)->rwlock) {
+        return PyList_Type.tp_as_sequence->sq_contains(self, value);
+    }
+    PyObject *snapshot = NULL;
+    {
+        AcquireReadLock<SubListObject> local_lock((SubListObject *)self);
+        snapshot = PyList_GetSlice(self, 0, PY_SSIZE_T_MAX);
+    }
+    if (!snapshot) {
+        return -1;
     }
-//    // 0.25s delay to demonstrate holding on to the thread.
-//    sleep_milliseconds(250L);
+    int ret = PyList_Type.tp_as_sequence->sq_contains(snapshot, value);
+    Py_DECREF(snapshot);
     return ret;
 }
 
+static PyObject *
+SubList_item(PyObject *self, Py_ssize_t index) {
+    if (!((SubListObject *)self)->rwlock) {
+        return PyList_Type.tp_as_sequence->sq_item(self, index);
+    }
+    AcquireReadLock<SubListObject> local_lock((SubListObject *)self);
+    return PyList_Type.tp_as_sequence->sq_item(self, index);
+}
+
+/* The key is converted with __index__() before taking the lock, a slice becomes one of exact ints. */
+static PyObject *
+SubList_subscript(PyObject *self, PyObject *key) {
+    if (!((SubListObject *)self)->rwlock) {
+        return PyList_Type.tp_as_mapping->mp_subscript(self, key);
+    }
+    if (PyIndex_Check(key)) {
+        Py_ssize_t index = PyNumber_AsSsize_t(key, PyExc_IndexError);
+        if (index == -1 && PyErr_Occurred()) {
+            return NULL;
+        }
+        AcquireReadLock<SubListObject> local_lock((SubListObject *)self);
+        if (index < 0) {
+            index += PyList_GET_SIZE(self);
+        }
+        return PyList_Type.tp_as_sequence->sq_item(self, index);
+    }
+    if (PySlice_Check(key)) {
+        PyObject *slice = sublist_exact_slice(key);
+        if (!slice) {
+            return NULL;
+        }
+        PyObject *ret = NULL;
+        {
+            AcquireReadLock<SubListObject> local_lock((SubListObject *)self);
+            ret = PyList_Type.tp_as_mapping->mp_subscript(self, slice);
+        }
+        Py_DECREF(slice);
+        return ret;
+    }
+    /* Raises a TypeError. */
+    return PyList_Type.tp_as_mapping->mp_subscript(self, key);
+}
+
+/* The remaining slots are inherited from list by PyType_Ready(). */
+static PySequenceMethods SubList_sequence_methods = {
+        .sq_length = SubList_length,
+        .sq_item = SubList_item,
+        .sq_contains = SubList_contains,
+};
+
+static PyMappingMethods SubList_mapping_methods = {
+        .mp_length = SubList_length,
+        .mp_subscript = SubList_subscript,
+};
+
+#ifdef WITH_THREAD
+/** Returns the lock hold time histogram as a dict of {upper bound in microseconds: count}, optionally clearing it. */
+static PyObject *
+SubList_lock_hold_histogram(SubListObject *self, PyObject *args, PyObject *kwds) {
+    static const char *kwlist[] = {"clear", NULL};
+    int clear = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|p:lock_hold_histogram", (char **) kwlist, &clear)) {
+        return NULL;
+    }
+    return LockCounters_hold_histogram(&self->lock_counters, clear);
+}
+#endif
+
 static PyMethodDef SubList_methods[] = {
         {"append",    (PyCFunction) SubList_append,    METH_VARARGS,
-                        PyDoc_STR("append an item with sleep(1).")},
-        {"max",       (PyCFunction) SubList_max,       METH_NOARGS,
-                        PyDoc_STR("Return the maximum value with sleep(1).")},
+                        PyDoc_STR("append an item with the simulated work of append_cost_us.")},
+        {"max",       (PyCFunction) SubList_max,       METH_VARARGS | METH_KEYWORDS,
+                        PyDoc_STR("Return the maximum value with the simulated work of compare_cost_us. "
+                                  "If the lock is not acquired within the optional timeout this raises TimeoutError.")},
+#ifdef WITH_THREAD
+        {"lock_hold_histogram", (PyCFunction) SubList_lock_hold_histogram, METH_VARARGS | METH_KEYWORDS,
+                        PyDoc_STR("Return the lock hold times as a dict of {upper bound in microseconds: count}. "
+                                  "clear=True clears the histogram.")},
+#endif
         {NULL, NULL, 0, NULL},
 };
 
 static PyMemberDef SubList_members[] = {
+#ifdef WITH_THREAD
+        {"rwlock", T_BOOL, offsetof(SubListObject, rwlock), READONLY,
+                PyDoc_STR("True if reads take a shared lock and writes an exclusive lock.")},
+        {"lock_shared_acquired", T_PYSSIZET, offsetof(SubListObject, lock_counters.shared_acquired), READONLY,
+                PyDoc_STR("The number of times that the shared lock has been acquired.")},
+        {"lock_shared_contended", T_PYSSIZET, offsetof(SubListObject, lock_counters.shared_contended), READONLY,
+                PyDoc_STR("The number of times that acquiring the shared lock had to wait.")},
+        {"lock_exclusive_acquired", T_PYSSIZET, offsetof(SubListObject, lock_counters.exclusive_acquired), READONLY,
+                PyDoc_STR("The number of times that the exclusive lock has been acquired.")},
+        {"lock_exclusive_contended", T_PYSSIZET, offsetof(SubListObject, lock_counters.exclusive_contended), READONLY,
+                PyDoc_STR("The number of times that acquiring the exclusive lock had to wait.")},
+        {"lock_shared_wait_ns", T_LONGLONG, offsetof(SubListObject, lock_counters.shared_wait_ns), READONLY,
+                PyDoc_STR("The total time in nanoseconds spent waiting for the shared lock.")},
+        {"lock_exclusive_wait_ns", T_LONGLONG, offsetof(SubListObject, lock_counters.exclusive_wait_ns), READONLY,
+                PyDoc_STR("The total time in nanoseconds spent waiting for the exclusive lock.")},
+        {"lock_spin_acquired", T_PYSSIZET, offsetof(SubListObject, lock_counters.spin_acquired), READONLY,
+                PyDoc_STR("The number of contended acquisitions that succeeded whilst spinning.")},
+        {"lock_timeouts", T_PYSSIZET, offsetof(SubListObject, lock_counters.timeouts), READONLY,
+                PyDoc_STR("The number of acquisitions with a timeout that gave up.")},
+        {"trace_lock_hold", T_BOOL, offsetof(SubListObject, lock_counters.trace_hold), 0,
+                PyDoc_STR("If True the time that the lock is held is recorded, see lock_hold_histogram().")},
+#endif
         {NULL, 0, 0, 0, NULL}  /* Sentinel */
 };
 
+static PyGetSetDef SubList_getsetters[] = {
+        {"append_cost_us", CostModel_get_cost, CostModel_set_cost,
+                PyDoc_STR("The simulated work, in microseconds, in each append()."),
+                (void *) offsetof(SubListObject, cost_model.append_us)},
+        {"compare_cost_us", CostModel_get_cost, CostModel_set_cost,
+                PyDoc_STR("The simulated work, in microseconds, for each comparison in max()."),
+                (void *) offsetof(SubListObject, cost_model.compare_us)},
+        {"cost_mode", CostModel_get_mode, CostModel_set_mode,
+                PyDoc_STR("How the work is simulated, 'sleep', 'busy' or 'busy_gil'."),
+                (void *) offsetof(SubListObject, cost_model.mode)},
+        {NULL, NULL, NULL, NULL, NULL}  /* Sentinel */
+};
+
 static PyTypeObject cppSubListType = {
         PyVarObject_HEAD_INIT(NULL, 0)
         .tp_name = "cppsublist.cppSubList",
         .tp_basicsize = sizeof(SubListObject),
         .tp_itemsize = 0,
+        .tp_dealloc = (destructor) SubList_dealloc,
+        .tp_as_sequence = &SubList_sequence_methods,
+        .tp_as_mapping = &SubList_mapping_methods,
         .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
         .tp_doc = PyDoc_STR("C++ SubList object"),
         .tp_methods = SubList_methods,
         .tp_members = SubList_members,
+        .tp_getset = SubList_getsetters,
         .tp_init = (initproc) SubList_init,
-        .tp_dealloc = (destructor) SubList_dealloc,
+};
+
+/**
+ * Returns the number of threads, including the caller, that share the native max().
+ */
+static PyObject *
+parallel_max_threads(PyObject *Py_UNUSED(module), PyObject *Py_UNUSED(ignored)) {
+    return PyLong_FromSize_t(parallel_max_thread_count());
+}
+
+/**
+ * Set the number of threads, including the caller, that share the native max(), 0 is the number of CPUs.
+ * The thread pool is replaced when next used. Returns the previous number of threads.
+ */
+static PyObject *
+set_parallel_max_threads(PyObject *Py_UNUSED(module), PyObject *arg) {
+    Py_ssize_t thread_count = PyNumber_AsSsize_t(arg, PyExc_OverflowError);
+    if (thread_count == -1 && PyErr_Occurred()) {
+        return NULL;
+    }
+    if (thread_count < 0) {
+        PyErr_Format(PyExc_ValueError, "The number of threads must be >= 0 not %zd.", thread_count);
+        return NULL;
+    }
+    size_t previous = parallel_max_thread_count();
+    Py_BEGIN_ALLOW_THREADS
+        {
+            /* Wait for any reduction in progress then join the old pool's threads. */
+            std::lock_guard<std::mutex> pool_lock(g_thread_pool_mutex);
+            g_thread_pool.reset();
+            g_parallel_max_threads = (size_t) thread_count;
+        }
+    Py_END_ALLOW_THREADS
+    return PyLong_FromSize_t(previous);
+}
+
+/**
+ * Returns the length at which a list of only ints or only floats uses the native max().
+ */
+static PyObject *
+parallel_max_threshold(PyObject *Py_UNUSED(module), PyObject *Py_UNUSED(ignored)) {
+    return PyLong_FromSsize_t(g_parallel_max_threshold);
+}
+
+/**
+ * Set the length at which a list of only ints or only floats uses the native max(), returns the previous value.
+ */
+static PyObject *
+set_parallel_max_threshold(PyObject *Py_UNUSED(module), PyObject *arg) {
+    Py_ssize_t threshold = PyNumber_AsSsize_t(arg, PyExc_OverflowError);
+    if (threshold == -1 && PyErr_Occurred()) {
+        return NULL;
+    }
+    if (threshold < 1) {
+        PyErr_Format(PyExc_ValueError, "The threshold must be >= 1 not %zd.", threshold);
+        return NULL;
+    }
+    return PyLong_FromSsize_t(g_parallel_max_threshold.exchange(threshold));
+}
+
+/**
+ * Returns the upper limit of spins before a contended lock releases the GIL and blocks.
+ */
+static PyObject *
+lock_max_spins_get(PyObject *Py_UNUSED(module), PyObject *Py_UNUSED(ignored)) {
+    return PyLong_FromSsize_t(lock_max_spins());
+}
+
+/**
+ * Set the upper limit of spins before a contended lock releases the GIL and blocks, 0 disables spinning.
+ * Returns the previous value.
+ */
+static PyObject *
+lock_max_spins_set(PyObject *Py_UNUSED(module), PyObject *arg) {
+    Py_ssize_t max_spins = PyNumber_AsSsize_t(arg, PyExc_OverflowError);
+    if (max_spins == -1 && PyErr_Occurred()) {
+        return NULL;
+    }
+    if (max_spins < 0) {
+        PyErr_Format(PyExc_ValueError, "The maximum number of spins must be >= 0 not %zd.", max_spins);
+        return NULL;
+    }
+    return PyLong_FromSsize_t(lock_max_spins().exchange(max_spins));
+}
+
+static PyMethodDef cppsublist_methods[] = {
+        {"parallel_max_threads", (PyCFunction) parallel_max_threads, METH_NOARGS,
+                PyDoc_STR("Return the number of threads that share the native max().")},
+        {"set_parallel_max_threads", (PyCFunction) set_parallel_max_threads, METH_O,
+                PyDoc_STR("Set the number of threads that share the native max(), 0 is the number of CPUs. "
+                          "Returns the previous number.")},
+        {"parallel_max_threshold", (PyCFunction) parallel_max_threshold, METH_NOARGS,
+                PyDoc_STR("Return the length at which a list of only ints or only floats uses the native max().")},
+        {"set_parallel_max_threshold", (PyCFunction) set_parallel_max_threshold, METH_O,
+                PyDoc_STR("Set the length at which a list of only ints or only floats uses the native max(). "
+                          "Returns the previous value.")},
+        {"lock_max_spins", (PyCFunction) lock_max_spins_get, METH_NOARGS,
+                PyDoc_STR("Return the upper limit of spins before a contended lock releases the GIL and blocks.")},
+        {"set_lock_max_spins", (PyCFunction) lock_max_spins_set, METH_O,
+                PyDoc_STR("Set the upper limit of spins before a contended lock releases the GIL and blocks, "
+                          "0 disables spinning. Returns the previous value.")},
+        {NULL, NULL, 0, NULL} /* Sentinel */
 };
 
 static PyModuleDef cppsublistmodule = {
@@ -143,6 +731,7 @@ static PyModuleDef cppsublistmodule = {
         .m_name = "cppsublist",
         .m_doc = "Example module that creates an extension type.",
         .m_size = -1,
+        .m_methods = cppsublist_methods,
 };
 
 PyMODINIT_FUNC
@@ -162,5 +751,9 @@ PyInit_cppsublist(void) {
         Py_DECREF(m);
         return NULL;
     }
+    if (PY_MODULE_GIL_NOT_USED(m)) {
+        Py_DECREF(m);
+        return NULL;
+    }
     return m;
 }
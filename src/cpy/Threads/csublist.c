@@ -10,6 +10,12 @@
 // This is very like src/cpy/SubClass/sublist.c but it includes a slow max() method
 // to illustrate thread contention.
 // So it needs a thread lock.
+//
+// cSubList(iterable=(), rwlock=False) with rwlock=True uses a reader/writer lock where the read-only methods,
+// max(), __getitem__, __len__ and __contains__, take a shared lock and the mutators take an exclusive lock.
+//
+// The simulated work in append() and max() is set by the cost model attributes, see cCostModel.h, and with
+// trace_lock_hold=True the time that the lock is held is recorded in a histogram, see lock_hold_histogram().
 
 #define PY_SSIZE_T_CLEAN
 
@@ -17,37 +23,115 @@
 #include "structmember.h"
 
 #include "py_call_super.h"
-#include <time.h>
+#include "py_free_threading.h"
+#include "cRWLock.h"
+#include "cCostModel.h"
 
 // From https://github.com/python/cpython/blob/main/Modules/_bz2module.c
+// This also counts the acquisitions, those that had to wait and the time spent waiting.
 #define ACQUIRE_LOCK(obj) do { \
     if (!PyThread_acquire_lock((obj)->lock, 0)) { \
+        long long _wait_start = lock_clock_ns(); \
         Py_BEGIN_ALLOW_THREADS \
         PyThread_acquire_lock((obj)->lock, 1); \
         Py_END_ALLOW_THREADS \
-    } } while (0)
+        (obj)->lock_counters.exclusive_wait_ns += lock_clock_ns() - _wait_start; \
+        (obj)->lock_counters.exclusive_contended++; \
+    } \
+    (obj)->lock_counters.exclusive_acquired++; \
+    } while (0)
 #define RELEASE_LOCK(obj) PyThread_release_lock((obj)->lock)
 
+/* Mutators. In reader/writer mode this takes the exclusive lock, otherwise the single lock.
+ * hold_start is a long long that is set for RELEASE_READ_WRITE_LOCK() to record the time that the lock is held. */
+#define ACQUIRE_WRITE_LOCK(obj, hold_start) do { \
+    if ((obj)->rwlock) { \
+        RWLock_acquire_exclusive(&(obj)->rw_lock, &(obj)->lock_counters); \
+    } else { \
+        ACQUIRE_LOCK(obj); \
+    } \
+    hold_start = LockCounters_hold_start(&(obj)->lock_counters); \
+    } while (0)
+/* Read-only methods. In reader/writer mode this takes a shared lock, otherwise the single lock. */
+#define ACQUIRE_READ_LOCK(obj, hold_start) do { \
+    if ((obj)->rwlock) { \
+        RWLock_acquire_shared(&(obj)->rw_lock, &(obj)->lock_counters); \
+    } else { \
+        ACQUIRE_LOCK(obj); \
+    } \
+    hold_start = LockCounters_hold_start(&(obj)->lock_counters); \
+    } while (0)
+#define RELEASE_READ_WRITE_LOCK(obj, hold_start) do { \
+    LockCounters_record_hold(&(obj)->lock_counters, hold_start); \
+    if ((obj)->rwlock) { \
+        RWLock_release(&(obj)->rw_lock); \
+    } else { \
+        RELEASE_LOCK(obj); \
+    } } while (0)
+
 typedef struct {
     PyListObject list;
 #ifdef WITH_THREAD
     PyThread_type_lock lock;
+    /* Non-zero if this uses rw_lock rather than lock. */
+    char rwlock;
+    RWLock rw_lock;
+    LockCounters lock_counters;
 #endif
+    CostModel cost_model;
 } SubListObject;
 
 static int
 SubList_init(SubListObject *self, PyObject *args, PyObject *kwds) {
-    if (PyList_Type.tp_init((PyObject *) self, args, kwds) < 0) {
-        return -1;
+    int ret = -1;
+    int rwlock = 0;
+    PyObject *list_kwds = NULL;
+
+    /* Remove rwlock from the keyword arguments before passing them to list. */
+    if (kwds) {
+        PyObject *value = PyDict_GetItemString(kwds, "rwlock");
+        if (value) {
+            rwlock = PyObject_IsTrue(value);
+            if (rwlock < 0) {
+                goto except;
+            }
+            list_kwds = PyDict_Copy(kwds);
+            if (!list_kwds || PyDict_DelItemString(list_kwds, "rwlock")) {
+                goto except;
+            }
+        }
+    }
+    if (PyList_Type.tp_init((PyObject *) self, args, list_kwds ? list_kwds : kwds) < 0) {
+        goto except;
     }
 #ifdef WITH_THREAD
-    self->lock = PyThread_allocate_lock();
-    if (self->lock == NULL) {
-        PyErr_SetString(PyExc_MemoryError, "Unable to allocate thread lock.");
-        return -2;
+    if (self->lock) {
+        /* __init__() called again. */
+        if (rwlock != self->rwlock) {
+            PyErr_SetString(PyExc_ValueError, "The lock mode can not be changed.");
+            goto except;
+        }
+    } else {
+        self->lock = PyThread_allocate_lock();
+        if (self->lock == NULL) {
+            PyErr_SetString(PyExc_MemoryError, "Unable to allocate thread lock.");
+            goto except;
+        }
+        if (rwlock && RWLock_init(&self->rw_lock)) {
+            goto except;
+        }
+        self->rwlock = (char) rwlock;
     }
 #endif
-    return 0;
+    assert(!PyErr_Occurred());
+    ret = 0;
+    goto finally;
+except:
+    assert(PyErr_Occurred());
+    ret = -1;
+finally:
+    Py_XDECREF(list_kwds);
+    return ret;
 }
 
 static void
@@ -58,37 +142,84 @@ SubList_dealloc(SubListObject *self) {
         PyThread_free_lock(self->lock);
         self->lock = NULL;
     }
+    RWLock_free(&self->rw_lock);
 #endif
     Py_TYPE(self)->tp_free((PyObject *)self);
 }
 
-void sleep_milliseconds(long ms) {
-    struct timespec tim_request, tim_remain;
-    tim_request.tv_sec = 0;
-    tim_request.tv_nsec = ms * 1000L * 1000L;
-    nanosleep(&tim_request, &tim_remain);
-}
-
 /** append with a thread lock. */
 static PyObject *
 SubList_append(SubListObject *self, PyObject *args) {
-    ACQUIRE_LOCK(self);
+    long long hold_start;
+    ACQUIRE_WRITE_LOCK(self, hold_start);
     PyObject *result = call_super_name(
             (PyObject *) self, "append", args, NULL
     );
-    // 0.25s delay to demonstrate holding on to the thread.
-    sleep_milliseconds(250L);
-    RELEASE_LOCK(self);
+    // Simulated work whilst holding on to the lock.
+    CostModel_work(&self->cost_model, PY_COUNTER_LOAD(self->cost_model.append_us));
+    RELEASE_READ_WRITE_LOCK(self, hold_start);
     return result;
 }
 
+/** Returns a new reference to the maximum of the items in a list that no other thread can change, or NULL with an
+ * exception set. */
+static PyObject *
+SubList_max_of_snapshot(PyObject *snapshot) {
+    if (PyList_GET_SIZE(snapshot) == 0) {
+        PyErr_SetString(PyExc_ValueError, "max() on empty list.");
+        return NULL;
+    }
+    PyObject *ret = PyList_GET_ITEM(snapshot, 0);
+    for (Py_ssize_t i = 1; i < PyList_GET_SIZE(snapshot); ++i) {
+        PyObject *item = PyList_GET_ITEM(snapshot, i);
+        int result = PyObject_RichCompareBool(item, ret, Py_GT);
+        if (result < 0) {
+            // Error, not comparable.
+            return NULL;
+        } else if (result > 0) {
+            ret = item;
+        }
+    }
+    Py_INCREF(ret);
+    return ret;
+}
+
+/** max() with a reader/writer lock.
+ * The comparisons can call back into Python and so into this list, a nested shared lock would deadlock if a writer
+ * were waiting. So the items are copied and the simulated work done whilst holding the shared lock, then the copy is
+ * compared after the lock has been released.
+ */
+static PyObject *
+SubList_max_rwlock(PyObject *self) {
+    CostModel *cost_model = &((SubListObject *)self)->cost_model;
+    long long hold_start;
+    ACQUIRE_READ_LOCK((SubListObject *)self, hold_start);
+    PyObject *snapshot = PyList_GetSlice(self, 0, PY_SSIZE_T_MAX);
+    for (Py_ssize_t i = 1; snapshot && i < PyList_GET_SIZE(snapshot); ++i) {
+        // Simulated work for each comparison whilst holding on to the lock.
+        CostModel_work(cost_model, PY_COUNTER_LOAD(cost_model->compare_us));
+    }
+    RELEASE_READ_WRITE_LOCK((SubListObject *)self, hold_start);
+    if (!snapshot) {
+        return NULL;
+    }
+    PyObject *ret = SubList_max_of_snapshot(snapshot);
+    Py_DECREF(snapshot);
+    return ret;
+}
+
 /** This is a deliberately laborious find of the maximum value to
  * demonstrate protection against thread contention.
  */
 static PyObject *
 SubList_max(PyObject *self, PyObject *Py_UNUSED(unused)) {
     assert(!PyErr_Occurred());
-    ACQUIRE_LOCK((SubListObject *)self);
+    if (((SubListObject *)self)->rwlock) {
+        return SubList_max_rwlock(self);
+    }
+    CostModel *cost_model = &((SubListObject *)self)->cost_model;
+    long long hold_start;
+    ACQUIRE_READ_LOCK((SubListObject *)self, hold_start);
     PyObject *ret = NULL;
     // SubListObject
     size_t length = PyList_Size(self);
@@ -96,53 +227,237 @@ SubList_max(PyObject *self, PyObject *Py_UNUSED(unused)) {
         // Raise
         PyErr_SetString(PyExc_ValueError, "max() on empty list.");
     } else {
-        // Return first
-        ret = PyList_GetItem(self, 0);
-        if (length > 1) {
-            // Laborious compare
-            PyObject *item = NULL;
-            for(Py_ssize_t i = 1; i <PyList_Size(self); ++i) {
-                item = PyList_GetItem(self, i);
-                int result = PyObject_RichCompareBool(item, ret, Py_GT);
-                if (result < 0) {
-                    // Error, not comparable.
-                    ret = NULL;
-                } else if (result > 0) {
-                    ret = item;
-                }
-                // 2ms delay to demonstrate holding on to the thread.
-                sleep_milliseconds(2L);
+        // Return first, these are strong references as other threads might be changing the list.
+        ret = PyList_Type.tp_as_sequence->sq_item(self, 0);
+        // Laborious compare
+        PyObject *item = NULL;
+        for(Py_ssize_t i = 1; ret && i < PyList_Size(self); ++i) {
+            item = PyList_Type.tp_as_sequence->sq_item(self, i);
+            if (!item) {
+                // The list has been shortened by another thread.
+                Py_CLEAR(ret);
+                break;
+            }
+            int result = PyObject_RichCompareBool(item, ret, Py_GT);
+            if (result < 0) {
+                // Error, not comparable.
+                Py_CLEAR(ret);
+            } else if (result > 0) {
+                Py_DECREF(ret);
+                ret = item;
+                item = NULL;
             }
+            Py_XDECREF(item);
+            // Simulated work whilst holding on to the lock.
+            CostModel_work(cost_model, PY_COUNTER_LOAD(cost_model->compare_us));
+        }
+    }
+    RELEASE_READ_WRITE_LOCK((SubListObject *)self, hold_start);
+    return ret;
+}
+
+/* Returns a new slice equivalent to slice with exact int members so that using it calls no Python code.
+ * Returns NULL with an exception set on failure, for example if __index__() raises or the step is zero. */
+static PyObject *
+sublist_exact_slice(PyObject *slice) {
+    Py_ssize_t start, stop, step;
+    PyObject *py_start = NULL;
+    PyObject *py_stop = NULL;
+    PyObject *py_step = NULL;
+    PyObject *ret = NULL;
+
+    if (PySlice_Unpack(slice, &start, &stop, &step) < 0) {
+        goto except;
+    }
+    py_start = PyLong_FromSsize_t(start);
+    py_stop = PyLong_FromSsize_t(stop);
+    py_step = PyLong_FromSsize_t(step);
+    if (!py_start || !py_stop || !py_step) {
+        goto except;
+    }
+    ret = PySlice_New(py_start, py_stop, py_step);
+    if (!ret) {
+        goto except;
+    }
+    goto finally;
+except:
+    assert(PyErr_Occurred());
+    ret = NULL;
+finally:
+    Py_XDECREF(py_start);
+    Py_XDECREF(py_stop);
+    Py_XDECREF(py_step);
+    return ret;
+}
+
+/* The read-only sequence and mapping methods of list.
+ * With a reader/writer lock these take the shared lock, otherwise, as list, they take no lock at all as the single
+ * lock is not re-entrant and these can be called by the comparisons in max().
+ * The lock is never held whilst calling back into Python, such as __eq__() or __index__(), as that might use this
+ * list again and a nested shared lock deadlocks if a writer is waiting. */
+static Py_ssize_t
+SubList_length(PyObject *self) {
+    if (!((SubListObject *)self)->rwlock) {
+        return PyList_Type.tp_as_sequence->sq_length(self);
+    }
+    long long hold_start;
+    ACQUIRE_READ_LOCK((SubListObject *)self, hold_start);
+    Py_ssize_t ret = PyList_Type.tp_as_sequence->sq_length(self);
+    RELEASE_READ_WRITE_LOCK((SubListObject *)self, hold_start);
+    return ret;
+}
+
+/* The comparisons are made with a copy of the list after the lock has been released. */
+static int
+SubList_contains(PyObject *self, PyObject *value) {
+    if (!((SubListObject *)self)->rwlock) {
+        return PyList_Type.tp_as_sequence->sq_contains(self, value);
+    }
+    long long hold_start;
+    ACQUIRE_READ_LOCK((SubListObject *)self, hold_start);
+    PyObject *snapshot = PyList_GetSlice(self, 0, PY_SSIZE_T_MAX);
+    RELEASE_READ_WRITE_LOCK((SubListObject *)self, hold_start);
+    if (!snapshot) {
+        return -1;
+    }
+    int ret = PyList_Type.tp_as_sequence->sq_contains(snapshot, value);
+    Py_DECREF(snapshot);
+    return ret;
+}
+
+static PyObject *
+SubList_item(PyObject *self, Py_ssize_t index) {
+    if (!((SubListObject *)self)->rwlock) {
+        return PyList_Type.tp_as_sequence->sq_item(self, index);
+    }
+    long long hold_start;
+    ACQUIRE_READ_LOCK((SubListObject *)self, hold_start);
+    PyObject *ret = PyList_Type.tp_as_sequence->sq_item(self, index);
+    RELEASE_READ_WRITE_LOCK((SubListObject *)self, hold_start);
+    return ret;
+}
+
+/* The key is converted with __index__() before taking the lock, a slice becomes one of exact ints. */
+static PyObject *
+SubList_subscript(PyObject *self, PyObject *key) {
+    if (!((SubListObject *)self)->rwlock) {
+        return PyList_Type.tp_as_mapping->mp_subscript(self, key);
+    }
+    long long hold_start;
+    PyObject *ret = NULL;
+    if (PyIndex_Check(key)) {
+        Py_ssize_t index = PyNumber_AsSsize_t(key, PyExc_IndexError);
+        if (index == -1 && PyErr_Occurred()) {
+            return NULL;
         }
-        Py_INCREF(ret);
+        ACQUIRE_READ_LOCK((SubListObject *)self, hold_start);
+        if (index < 0) {
+            index += PyList_GET_SIZE(self);
+        }
+        ret = PyList_Type.tp_as_sequence->sq_item(self, index);
+        RELEASE_READ_WRITE_LOCK((SubListObject *)self, hold_start);
+    } else if (PySlice_Check(key)) {
+        PyObject *slice = sublist_exact_slice(key);
+        if (!slice) {
+            return NULL;
+        }
+        ACQUIRE_READ_LOCK((SubListObject *)self, hold_start);
+        ret = PyList_Type.tp_as_mapping->mp_subscript(self, slice);
+        RELEASE_READ_WRITE_LOCK((SubListObject *)self, hold_start);
+        Py_DECREF(slice);
+    } else {
+        /* Raises a TypeError. */
+        ret = PyList_Type.tp_as_mapping->mp_subscript(self, key);
     }
-//    // 0.25s delay to demonstrate holding on to the thread.
-//    sleep_milliseconds(250L);
-    RELEASE_LOCK((SubListObject *)self);
     return ret;
 }
 
+/* The remaining slots are inherited from list by PyType_Ready(). */
+static PySequenceMethods SubList_sequence_methods = {
+        .sq_length = SubList_length,
+        .sq_item = SubList_item,
+        .sq_contains = SubList_contains,
+};
+
+static PyMappingMethods SubList_mapping_methods = {
+        .mp_length = SubList_length,
+        .mp_subscript = SubList_subscript,
+};
+
+#ifdef WITH_THREAD
+/** Returns the lock hold time histogram as a dict of {upper bound in microseconds: count}, optionally clearing it. */
+static PyObject *
+SubList_lock_hold_histogram(SubListObject *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"clear", NULL};
+    int clear = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|p:lock_hold_histogram", kwlist, &clear)) {
+        return NULL;
+    }
+    return LockCounters_hold_histogram(&self->lock_counters, clear);
+}
+#endif
+
 static PyMethodDef SubList_methods[] = {
         {"append",    (PyCFunction) SubList_append,    METH_VARARGS,
-                        PyDoc_STR("append an item with sleep().")},
+                        PyDoc_STR("append an item with the simulated work of append_cost_us.")},
         {"max",       (PyCFunction) SubList_max,       METH_NOARGS,
-                        PyDoc_STR("Return the maximum value with sleep(1).")},
+                        PyDoc_STR("Return the maximum value with the simulated work of compare_cost_us.")},
+#ifdef WITH_THREAD
+        {"lock_hold_histogram", (PyCFunction) SubList_lock_hold_histogram, METH_VARARGS | METH_KEYWORDS,
+                        PyDoc_STR("Return the lock hold times as a dict of {upper bound in microseconds: count}. "
+                                  "clear=True clears the histogram.")},
+#endif
         {NULL, NULL, 0, NULL},
 };
 
 static PyMemberDef SubList_members[] = {
+#ifdef WITH_THREAD
+        {"rwlock", T_BOOL, offsetof(SubListObject, rwlock), READONLY,
+                PyDoc_STR("True if reads take a shared lock and writes an exclusive lock.")},
+        {"lock_shared_acquired", T_PYSSIZET, offsetof(SubListObject, lock_counters.shared_acquired), READONLY,
+                PyDoc_STR("The number of times that the shared lock has been acquired.")},
+        {"lock_shared_contended", T_PYSSIZET, offsetof(SubListObject, lock_counters.shared_contended), READONLY,
+                PyDoc_STR("The number of times that acquiring the shared lock had to wait.")},
+        {"lock_exclusive_acquired", T_PYSSIZET, offsetof(SubListObject, lock_counters.exclusive_acquired), READONLY,
+                PyDoc_STR("The number of times that the exclusive lock has been acquired.")},
+        {"lock_exclusive_contended", T_PYSSIZET, offsetof(SubListObject, lock_counters.exclusive_contended), READONLY,
+                PyDoc_STR("The number of times that acquiring the exclusive lock had to wait.")},
+        {"lock_shared_wait_ns", T_LONGLONG, offsetof(SubListObject, lock_counters.shared_wait_ns), READONLY,
+                PyDoc_STR("The total time in nanoseconds spent waiting for the shared lock.")},
+        {"lock_exclusive_wait_ns", T_LONGLONG, offsetof(SubListObject, lock_counters.exclusive_wait_ns), READONLY,
+                PyDoc_STR("The total time in nanoseconds spent waiting for the exclusive lock.")},
+        {"trace_lock_hold", T_BOOL, offsetof(SubListObject, lock_counters.trace_hold), 0,
+                PyDoc_STR("If True the time that the lock is held is recorded, see lock_hold_histogram().")},
+#endif
         {NULL, 0, 0, 0, NULL}  /* Sentinel */
 };
 
+static PyGetSetDef SubList_getsetters[] = {
+        {"append_cost_us", CostModel_get_cost, CostModel_set_cost,
+                PyDoc_STR("The simulated work, in microseconds, in each append()."),
+                (void *) offsetof(SubListObject, cost_model.append_us)},
+        {"compare_cost_us", CostModel_get_cost, CostModel_set_cost,
+                PyDoc_STR("The simulated work, in microseconds, for each comparison in max()."),
+                (void *) offsetof(SubListObject, cost_model.compare_us)},
+        {"cost_mode", CostModel_get_mode, CostModel_set_mode,
+                PyDoc_STR("How the work is simulated, 'sleep', 'busy' or 'busy_gil'."),
+                (void *) offsetof(SubListObject, cost_model.mode)},
+        {NULL, NULL, NULL, NULL, NULL}  /* Sentinel */
+};
+
 static PyTypeObject SubListType = {
         PyVarObject_HEAD_INIT(NULL, 0)
         .tp_name = "csublist.cSubList",
         .tp_basicsize = sizeof(SubListObject),
         .tp_itemsize = 0,
+        .tp_as_sequence = &SubList_sequence_methods,
+        .tp_as_mapping = &SubList_mapping_methods,
         .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
         .tp_doc = PyDoc_STR("SubList objects"),
         .tp_methods = SubList_methods,
         .tp_members = SubList_members,
+        .tp_getset = SubList_getsetters,
         .tp_init = (initproc) SubList_init,
         .tp_dealloc = (destructor) SubList_dealloc,
 };
@@ -171,5 +486,9 @@ PyInit_csublist(void) {
         Py_DECREF(m);
         return NULL;
     }
+    if (PY_MODULE_GIL_NOT_USED(m)) {
+        Py_DECREF(m);
+        return NULL;
+    }
     return m;
 }
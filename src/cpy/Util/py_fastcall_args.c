@@ -0,0 +1,107 @@
+//
+//  py_fastcall_args.c
+//  PythonExtensionPatterns
+//
+// Provides C functions to unpack the arguments of a METH_FASTCALL | METH_KEYWORDS function or a vectorcall.
+//
+
+#include "py_fastcall_args.h"
+
+int
+py_fastcall_parser_init(PyFastcallParser *parser) {
+    assert(parser);
+    assert(parser->keywords);
+
+    if (parser->kwtuple) {
+        return 0;
+    }
+    Py_ssize_t count = 0;
+    while (parser->keywords[count]) {
+        ++count;
+    }
+    assert(parser->min_args <= count);
+    PyObject *kwtuple = PyTuple_New(count);
+    if (!kwtuple) {
+        return -1;
+    }
+    for (Py_ssize_t i = 0; i < count; ++i) {
+        PyObject *name = PyUnicode_InternFromString(parser->keywords[i]);
+        if (!name) {
+            Py_DECREF(kwtuple);
+            return -1;
+        }
+        /* Steals the reference. */
+        PyTuple_SET_ITEM(kwtuple, i, name);
+    }
+    parser->max_args = count;
+    parser->kwtuple = kwtuple;
+    return 0;
+}
+
+/* Return the index of the keyword name or -1 if not found. No exception is set. */
+static Py_ssize_t
+find_keyword(const PyFastcallParser *parser, PyObject *name) {
+    /* Keyword names from Python source are interned so try identity first. */
+    for (Py_ssize_t i = 0; i < parser->max_args; ++i) {
+        if (PyTuple_GET_ITEM(parser->kwtuple, i) == name) {
+            return i;
+        }
+    }
+    for (Py_ssize_t i = 0; i < parser->max_args; ++i) {
+        if (PyUnicode_Compare(PyTuple_GET_ITEM(parser->kwtuple, i), name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int
+py_fastcall_unpack(PyFastcallParser *parser, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames,
+                   PyObject **out) {
+    assert(parser->kwtuple && "py_fastcall_parser_init() has not been called.");
+    Py_ssize_t nkwargs = kwnames ? PyTuple_GET_SIZE(kwnames) : 0;
+
+    if (nargs > parser->max_args) {
+        PyErr_Format(
+                PyExc_TypeError,
+                "%s() takes at most %zd positional arguments (%zd given)",
+                parser->fname, parser->max_args, nargs
+        );
+        return -1;
+    }
+    for (Py_ssize_t i = 0; i < parser->max_args; ++i) {
+        out[i] = i < nargs ? args[i] : NULL;
+    }
+    for (Py_ssize_t i = 0; i < nkwargs; ++i) {
+        PyObject *name = PyTuple_GET_ITEM(kwnames, i);
+        Py_ssize_t index = find_keyword(parser, name);
+        if (index < 0) {
+            PyErr_Format(
+                    PyExc_TypeError,
+                    "%s() got an unexpected keyword argument '%U'",
+                    parser->fname, name
+            );
+            return -1;
+        }
+        if (out[index]) {
+            PyErr_Format(
+                    PyExc_TypeError,
+                    "argument for %s() given by name ('%U') and position (%zd)",
+                    parser->fname, name, index + 1
+            );
+            return -1;
+        }
+        out[index] = args[nargs + i];
+    }
+    for (Py_ssize_t i = 0; i < parser->min_args; ++i) {
+        if (!out[i]) {
+            PyErr_Format(
+                    PyExc_TypeError,
+                    "%s() missing required argument '%s' (pos %zd)",
+                    parser->fname, parser->keywords[i], i + 1
+            );
+            return -1;
+        }
+    }
+    return 0;
+}
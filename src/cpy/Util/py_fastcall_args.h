@@ -0,0 +1,59 @@
+//
+//  py_fastcall_args.h
+//  PythonExtensionPatterns
+//
+// Provides C functions to unpack the arguments of a METH_FASTCALL | METH_KEYWORDS function or a vectorcall.
+//
+// This is similar to CPython's private _PyArg_Parser and _PyArg_UnpackKeywords() as used by Argument Clinic.
+// The keyword names are interned once, when the module is initialised, so that matching a keyword is usually a
+// pointer comparison. The caller then converts each argument to C, for example with PyLong_AsLong().
+//
+
+#ifndef __UTIL_PY_FASTCALL_ARGS__
+#define __UTIL_PY_FASTCALL_ARGS__
+
+#define PY_SSIZE_T_CLEAN
+
+#include <Python.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Declare one of these statically for each function, for example:
+ *
+ * static const char *const read_keywords[] = {"file_object", "size", NULL};
+ * static PyFastcallParser read_parser = {"read", read_keywords, 1, NULL, 0};
+ */
+typedef struct {
+    /* The function name for error messages. */
+    const char *fname;
+    /* NULL terminated list of the argument names. */
+    const char *const *keywords;
+    /* The number of required arguments, these are the first min_args of keywords. */
+    Py_ssize_t min_args;
+    /* Created by py_fastcall_parser_init(), a tuple of the interned keyword names. */
+    PyObject *kwtuple;
+    /* Set by py_fastcall_parser_init(), the number of keywords. */
+    Py_ssize_t max_args;
+} PyFastcallParser;
+
+/* Intern the keyword names, call this once when the module is initialised.
+ * Returns 0 on success, -1 on failure with an exception set. */
+int
+py_fastcall_parser_init(PyFastcallParser *parser);
+
+/* Unpack the fastcall arguments into out[0] to out[max_args - 1] in the order of the keywords.
+ * The values are borrowed references, optional arguments that are not given are NULL.
+ * nargs is the number of positional arguments, use PyVectorcall_NARGS() for a vectorcall.
+ * kwnames is the tuple of keyword names, or NULL, the values follow the positional arguments in args.
+ * Returns 0 on success, -1 on failure with an exception set. */
+int
+py_fastcall_unpack(PyFastcallParser *parser, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames,
+                   PyObject **out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef __UTIL_PY_FASTCALL_ARGS__ */
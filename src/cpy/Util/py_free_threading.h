@@ -0,0 +1,47 @@
+//
+// py_free_threading.h
+//
+// Support for the free-threaded (PEP 703) build of CPython 3.13+ where Py_GIL_DISABLED is defined.
+// These compile to nothing, or plain C, on a build with the GIL and on earlier versions of Python.
+//
+// See: https://docs.python.org/3/howto/free-threading-extensions.html
+//
+
+#ifndef PYTHONEXTENSIONPATTERNS_PY_FREE_THREADING_H
+#define PYTHONEXTENSIONPATTERNS_PY_FREE_THREADING_H
+
+#include <Python.h>
+
+/* Py_BEGIN_CRITICAL_SECTION() is available from Python 3.13, before that there is always a GIL so a critical section
+ * is just a block. */
+#if PY_VERSION_HEX < 0x030D0000
+#define Py_BEGIN_CRITICAL_SECTION(op) {
+#define Py_END_CRITICAL_SECTION() }
+#define Py_BEGIN_CRITICAL_SECTION2(a, b) {
+#define Py_END_CRITICAL_SECTION2() }
+#endif
+
+/* Declare that a module, created with single phase initialisation, is safe without the GIL.
+ * Without this importing the module re-enables the GIL for the whole process.
+ * Returns 0 on success, -1 on failure. */
+#ifdef Py_GIL_DISABLED
+#define PY_MODULE_GIL_NOT_USED(module) PyUnstable_Module_SetGIL(module, Py_MOD_GIL_NOT_USED)
+#else
+#define PY_MODULE_GIL_NOT_USED(module) 0
+#endif
+
+/* Relaxed atomic increment, addition, load and store of a counter that is updated from several threads.
+ * With the GIL these are plain arithmetic, reads and writes. */
+#ifdef Py_GIL_DISABLED
+#define PY_COUNTER_INCREMENT(counter) __atomic_fetch_add(&(counter), 1, __ATOMIC_RELAXED)
+#define PY_COUNTER_ADD(counter, value) __atomic_fetch_add(&(counter), (value), __ATOMIC_RELAXED)
+#define PY_COUNTER_LOAD(counter) __atomic_load_n(&(counter), __ATOMIC_RELAXED)
+#define PY_COUNTER_STORE(counter, value) __atomic_store_n(&(counter), (value), __ATOMIC_RELAXED)
+#else
+#define PY_COUNTER_INCREMENT(counter) ((counter)++)
+#define PY_COUNTER_ADD(counter, value) ((counter) += (value))
+#define PY_COUNTER_LOAD(counter) (counter)
+#define PY_COUNTER_STORE(counter, value) ((counter) = (value))
+#endif
+
+#endif //PYTHONEXTENSIONPATTERNS_PY_FREE_THREADING_H
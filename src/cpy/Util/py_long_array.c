@@ -0,0 +1,287 @@
+//
+//  py_long_array.c
+//  PythonExtensionPatterns
+//
+// Provides C functions to create a C array of longs from a Python object.
+// This is shared by src/cpy/Object/cSeqObject.c and src/cpy/Iterators/cIterator.c
+//
+
+#include "py_long_array.h"
+
+#include <limits.h>
+#include <string.h>
+
+/* Widen every value of type c_type in a (possibly strided) buffer to a C long.
+ * memcpy() is used for each value as the buffer might not be aligned, optimising compilers reduce this to a load. */
+#define PY_LONG_ARRAY_WIDEN(c_type)                                 \
+    for (i = 0; i < size; ++i) {                                    \
+        c_type value;                                               \
+        memcpy(&value, ptr + i * stride, sizeof(c_type));           \
+        array[i] = (long) value;                                    \
+    }
+
+/* As PY_LONG_ARRAY_WIDEN but for signed types that might not fit in a C long. */
+#define PY_LONG_ARRAY_NARROW_SIGNED(c_type)                         \
+    for (i = 0; i < size; ++i) {                                    \
+        c_type value;                                               \
+        memcpy(&value, ptr + i * stride, sizeof(c_type));           \
+        if (value < LONG_MIN || value > LONG_MAX) {                 \
+            goto overflow;                                          \
+        }                                                           \
+        array[i] = (long) value;                                    \
+    }
+
+/* As PY_LONG_ARRAY_WIDEN but for unsigned types that might not fit in a C long. */
+#define PY_LONG_ARRAY_NARROW_UNSIGNED(c_type)                       \
+    for (i = 0; i < size; ++i) {                                    \
+        c_type value;                                               \
+        memcpy(&value, ptr + i * stride, sizeof(c_type));           \
+        if (value > (c_type) LONG_MAX) {                            \
+            goto overflow;                                          \
+        }                                                           \
+        array[i] = (long) value;                                    \
+    }
+
+/**
+ * Returns the struct format character of a buffer if it is a native integer type that can be converted to a C long.
+ * Returns 0 if the format is not supported.
+ * See https://docs.python.org/3/library/struct.html#format-characters
+ */
+static char
+native_integer_format(const Py_buffer *view) {
+    /* A NULL format means unsigned bytes. */
+    const char *format = view->format ? view->format : "B";
+    size_t item_size = 0;
+
+    if (format[0] == '@') {
+        /* Explicit native size and alignment. */
+        format++;
+    }
+    if (format[0] == '\0' || format[1] != '\0') {
+        return 0;
+    }
+    switch (format[0]) {
+        case '?':
+            item_size = sizeof(_Bool);
+            break;
+        case 'b':
+        case 'B':
+            item_size = sizeof(char);
+            break;
+        case 'h':
+        case 'H':
+            item_size = sizeof(short);
+            break;
+        case 'i':
+        case 'I':
+            item_size = sizeof(int);
+            break;
+        case 'l':
+        case 'L':
+            item_size = sizeof(long);
+            break;
+        case 'q':
+        case 'Q':
+            item_size = sizeof(long long);
+            break;
+        case 'n':
+        case 'N':
+            item_size = sizeof(Py_ssize_t);
+            break;
+        default:
+            return 0;
+    }
+    if ((size_t) view->itemsize != item_size) {
+        /* Exporter is inconsistent, let the sequence path sort it out. */
+        return 0;
+    }
+    return format[0];
+}
+
+/**
+ * Create an array of longs from a buffer.
+ * Returns 0 on success, -1 on failure with an exception set or 1 if the buffer is not a one dimensional array of
+ * native integers in which case no exception is set.
+ */
+static int
+long_array_from_buffer(const Py_buffer *view, long **p_array, Py_ssize_t *p_size) {
+    char format = native_integer_format(view);
+    if (view->ndim != 1 || !format) {
+        return 1;
+    }
+    Py_ssize_t size = view->shape ? view->shape[0] : view->len / view->itemsize;
+    Py_ssize_t stride = view->strides ? view->strides[0] : view->itemsize;
+    const char *ptr = (const char *) view->buf;
+    long *array = NULL;
+    Py_ssize_t i = 0;
+
+    if (size > 0) {
+        if ((size_t) size > PY_SSIZE_T_MAX / sizeof(long)) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        array = malloc(size * sizeof(long));
+        if (!array) {
+            PyErr_NoMemory();
+            return -1;
+        }
+    }
+    if (format == 'l' && stride == sizeof(long)) {
+        /* Same type and contiguous so a single memcpy() will do. */
+        if (size > 0) {
+            memcpy(array, ptr, size * sizeof(long));
+        }
+    } else {
+        switch (format) {
+            case '?':
+                PY_LONG_ARRAY_WIDEN(_Bool);
+                break;
+            case 'b':
+                PY_LONG_ARRAY_WIDEN(signed char);
+                break;
+            case 'B':
+                PY_LONG_ARRAY_WIDEN(unsigned char);
+                break;
+            case 'h':
+                PY_LONG_ARRAY_WIDEN(short);
+                break;
+            case 'H':
+                PY_LONG_ARRAY_WIDEN(unsigned short);
+                break;
+            case 'i':
+                PY_LONG_ARRAY_WIDEN(int);
+                break;
+            case 'I':
+#if SIZEOF_INT < SIZEOF_LONG
+                PY_LONG_ARRAY_WIDEN(unsigned int);
+#else
+                PY_LONG_ARRAY_NARROW_UNSIGNED(unsigned int);
+#endif
+                break;
+            case 'l':
+                PY_LONG_ARRAY_WIDEN(long);
+                break;
+            case 'L':
+                PY_LONG_ARRAY_NARROW_UNSIGNED(unsigned long);
+                break;
+            case 'q':
+#if SIZEOF_LONG_LONG > SIZEOF_LONG
+                PY_LONG_ARRAY_NARROW_SIGNED(long long);
+#else
+                PY_LONG_ARRAY_WIDEN(long long);
+#endif
+                break;
+            case 'Q':
+                PY_LONG_ARRAY_NARROW_UNSIGNED(unsigned long long);
+                break;
+            case 'n':
+#if SIZEOF_SIZE_T > SIZEOF_LONG
+                PY_LONG_ARRAY_NARROW_SIGNED(Py_ssize_t);
+#else
+                PY_LONG_ARRAY_WIDEN(Py_ssize_t);
+#endif
+                break;
+            case 'N':
+                PY_LONG_ARRAY_NARROW_UNSIGNED(size_t);
+                break;
+            default:
+                Py_UNREACHABLE();
+        }
+    }
+    *p_array = array;
+    *p_size = size;
+    return 0;
+overflow:
+    PyErr_Format(
+            PyExc_OverflowError,
+            "Argument [%zd] with buffer format '%c' is too large to convert to C long",
+            i,
+            format
+    );
+    free(array);
+    return -1;
+}
+
+/**
+ * Create an array of longs from a sequence of Python ints.
+ * Returns 0 on success, -1 on failure with an exception set.
+ */
+static int
+long_array_from_sequence(PyObject *op, long **p_array, Py_ssize_t *p_size) {
+    if (!PySequence_Check(op)) {
+        PyErr_Format(
+                PyExc_TypeError,
+                "Argument must be a sequence or support the buffer protocol, not type %s",
+                Py_TYPE(op)->tp_name
+        );
+        return -1;
+    }
+    /* New reference. For a list or tuple this is op itself. */
+    PyObject *fast = PySequence_Fast(op, "Argument must be a sequence.");
+    if (!fast) {
+        return -1;
+    }
+    Py_ssize_t size = PySequence_Fast_GET_SIZE(fast);
+    /* Borrowed references. */
+    PyObject **items = PySequence_Fast_ITEMS(fast);
+    long *array = NULL;
+
+    if (size > 0) {
+        if ((size_t) size > PY_SSIZE_T_MAX / sizeof(long)) {
+            PyErr_NoMemory();
+            goto except;
+        }
+        array = malloc(size * sizeof(long));
+        if (!array) {
+            PyErr_NoMemory();
+            goto except;
+        }
+    }
+    for (Py_ssize_t i = 0; i < size; ++i) {
+        if (!PyLong_Check(items[i])) {
+            PyErr_Format(
+                    PyExc_TypeError,
+                    "Argument [%zd] must be a int, not type %s",
+                    i,
+                    Py_TYPE(items[i])->tp_name
+            );
+            goto except;
+        }
+        array[i] = PyLong_AsLong(items[i]);
+        if (array[i] == -1 && PyErr_Occurred()) {
+            goto except;
+        }
+    }
+    Py_DECREF(fast);
+    *p_array = array;
+    *p_size = size;
+    return 0;
+except:
+    assert(PyErr_Occurred());
+    free(array);
+    Py_DECREF(fast);
+    return -1;
+}
+
+int
+py_long_array_from_object(PyObject *op, long **p_array, Py_ssize_t *p_size) {
+    assert(op);
+    assert(p_array);
+    assert(p_size);
+
+    if (PyObject_CheckBuffer(op)) {
+        Py_buffer view;
+        if (PyObject_GetBuffer(op, &view, PyBUF_RECORDS_RO) == 0) {
+            int result = long_array_from_buffer(&view, p_array, p_size);
+            PyBuffer_Release(&view);
+            if (result <= 0) {
+                return result;
+            }
+            /* Not an integer buffer so fall through to the sequence path. */
+        } else {
+            /* The exporter can not supply a strided buffer so try it as a sequence. */
+            PyErr_Clear();
+        }
+    }
+    return long_array_from_sequence(op, p_array, p_size);
+}
@@ -0,0 +1,35 @@
+//
+//  py_long_array.h
+//  PythonExtensionPatterns
+//
+// Provides C functions to create a C array of longs from a Python object.
+// This is shared by src/cpy/Object/cSeqObject.c and src/cpy/Iterators/cIterator.c
+//
+
+#ifndef __UTIL_PY_LONG_ARRAY__
+#define __UTIL_PY_LONG_ARRAY__
+
+#define PY_SSIZE_T_CLEAN
+
+#include <Python.h>
+
+/* Create a new C array of longs from a Python object, typically for an __init__ method.
+ *
+ * There are two fast paths:
+ *
+ * - If the object supports the buffer protocol with a one dimensional array of a native integer format
+ *   (bytes, bytearray, array.array, memoryview, numpy integer arrays etc.) then the data is copied with memcpy()
+ *   if the format is a C long or widened to a C long in a single pass otherwise.
+ *   Other formats, such as floating point, fall back to the sequence path.
+ * - Otherwise the object must be a sequence and PySequence_Fast() is used so that list and tuple items are read
+ *   directly without creating a new reference to each item.
+ *   Every item must be a Python int.
+ *
+ * On success this returns 0, *p_array is a new array created with malloc() that the caller must free() and *p_size
+ * is the number of items. If the sequence is empty *p_array will be NULL.
+ * On failure this returns -1 with an exception set and *p_array and *p_size are unchanged.
+ */
+int
+py_long_array_from_object(PyObject *op, long **p_array, Py_ssize_t *p_size);
+
+#endif /* #ifndef __UTIL_PY_LONG_ARRAY__ */
@@ -7,6 +7,7 @@
 
 #include "DictWatcher.h"
 #include "pyextpatt_util.h"
+#include "py_free_threading.h"
 
 /* Version as a single 4-byte hex number, e.g. 0x010502B2 == 1.5.2b2
  * Therefore 0x030C0000 == 3.12.0
@@ -17,7 +18,9 @@
 
 #else
 
-// Event counters for a dictionary
+// Event counters for a dictionary.
+// The watcher callback can be called from several threads at once in a free-threaded build so these are updated
+// and read with PY_COUNTER_INCREMENT() and PY_COUNTER_LOAD().
 static long static_dict_added = 0L;
 static long static_dict_modified = 0L;
 static long static_dict_deleted = 0L;
@@ -25,10 +28,10 @@ static long static_dict_cloned = 0L;
 static long static_dict_cleared = 0L;
 static long static_dict_deallocated = 0L;
 
-#define GET_STATIC_DICT_VALUE(name) \
-    long get_##name(void) {         \
-        return name;                \
-    }                               \
+#define GET_STATIC_DICT_VALUE(name)     \
+    long get_##name(void) {             \
+        return PY_COUNTER_LOAD(name);   \
+    }                                   \
 
 
 GET_STATIC_DICT_VALUE(static_dict_added)
@@ -49,22 +52,22 @@ static int dict_watcher_inc_event_counter(PyDict_WatchEvent event, PyObject *Py_
                                           PyObject *Py_UNUSED(new_value)) {
     switch (event) {
         case PyDict_EVENT_ADDED:
-            static_dict_added++;
+            PY_COUNTER_INCREMENT(static_dict_added);
             break;
         case PyDict_EVENT_MODIFIED:
-            static_dict_modified++;
+            PY_COUNTER_INCREMENT(static_dict_modified);
             break;
         case PyDict_EVENT_DELETED:
-            static_dict_deleted++;
+            PY_COUNTER_INCREMENT(static_dict_deleted);
             break;
         case PyDict_EVENT_CLONED:
-            static_dict_cloned++;
+            PY_COUNTER_INCREMENT(static_dict_cloned);
             break;
         case PyDict_EVENT_CLEARED:
-            static_dict_cleared++;
+            PY_COUNTER_INCREMENT(static_dict_cleared);
             break;
         case PyDict_EVENT_DEALLOCATED:
-            static_dict_deallocated++;
+            PY_COUNTER_INCREMENT(static_dict_deallocated);
             break;
         default:
             Py_UNREACHABLE();
@@ -221,10 +224,10 @@ void dbg_PyDict_EVENT_MODIFIED_same_value_no_event(void) {
     event_value_added_current = get_static_dict_added();
     assert(event_value_added_current == event_value_added_previous + 1);
     // Now modify the dictionary by resetting the same value.
-    event_value_modified_previous = static_dict_modified;
+    event_value_modified_previous = get_static_dict_modified();
     api_ret_val = PyDict_SetItem(container, key, val);
     assert(api_ret_val == 0);
-    event_value_modified_current = static_dict_modified;
+    event_value_modified_current = get_static_dict_modified();
     assert(event_value_modified_current == event_value_modified_previous + 0);
     // Clean up.
     api_ret_val = PyDict_Unwatch(watcher_id, container);
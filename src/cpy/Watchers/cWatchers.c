@@ -19,6 +19,7 @@
 #pragma mark Dictionary Watcher
 
 #include "DictWatcher.h"
+#include "py_free_threading.h"
 
 static PyObject *
 py_dict_watcher_verbose_add(PyObject *Py_UNUSED(module), PyObject *arg) {
@@ -161,6 +162,9 @@ PyMODINIT_FUNC PyInit_cWatchers(void) {
     if (PyModule_AddObject(m, "PyDictWatcher", (PyObject *) &PyDictWatcher_Type)) {
         goto fail;
     }
+    if (PY_MODULE_GIL_NOT_USED(m)) {
+        goto fail;
+    }
     return m;
 fail:
     Py_XDECREF(m);
@@ -0,0 +1,823 @@
+//
+// cTypedSequence.cpp
+//
+// A family of sequence types that each hold a single C numeric type, for example SequenceInt8 holds int8_t values
+// and SequenceFloat64 holds doubles. Compared with src/cpy/Object/cSeqObject.c which always uses a C long this can
+// reduce the memory footprint by up to 8x.
+//
+// There is a single implementation, templated on the C type, of:
+//
+// - __init__ from a sequence or from an object that supports the buffer protocol with compile time specialised
+//   conversion kernels for every native buffer format.
+// - The sequence methods.
+// - Buffer export.
+// - An iterator.
+//
+// Each C type has a TypedSequenceTraits<T> specialisation that provides the Python type names and buffer format.
+//
+
+#define PY_SSIZE_T_CLEAN
+
+#include <Python.h>
+#include "structmember.h"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/**** Traits. ****/
+
+/* The C type used to convert to and from a Python object:
+ * long long for signed integers, unsigned long long for unsigned integers and double for floating point. */
+template<typename S>
+struct TypedWide {
+    typedef typename std::conditional<
+            std::is_floating_point<S>::value,
+            double,
+            typename std::conditional<std::is_signed<S>::value, long long, unsigned long long>::type
+    >::type type;
+};
+
+template<typename T>
+struct TypedSequenceTraits;
+
+#define TYPED_SEQUENCE_TRAITS(c_type, py_name, format_char)                         \
+    template<>                                                                      \
+    struct TypedSequenceTraits<c_type> {                                            \
+        static constexpr const char *name = py_name;                                \
+        static constexpr const char *type_name = "cTypedSequence." py_name;        \
+        static constexpr const char *iterator_type_name =                           \
+                "cTypedSequence." py_name "Iterator";                               \
+        static constexpr char format = format_char;                                 \
+    }
+
+TYPED_SEQUENCE_TRAITS(int8_t, "SequenceInt8", 'b');
+TYPED_SEQUENCE_TRAITS(uint8_t, "SequenceUInt8", 'B');
+TYPED_SEQUENCE_TRAITS(int16_t, "SequenceInt16", 'h');
+TYPED_SEQUENCE_TRAITS(uint16_t, "SequenceUInt16", 'H');
+TYPED_SEQUENCE_TRAITS(int32_t, "SequenceInt32", 'i');
+TYPED_SEQUENCE_TRAITS(uint32_t, "SequenceUInt32", 'I');
+TYPED_SEQUENCE_TRAITS(int64_t, "SequenceInt64", 'q');
+TYPED_SEQUENCE_TRAITS(uint64_t, "SequenceUInt64", 'Q');
+TYPED_SEQUENCE_TRAITS(float, "SequenceFloat32", 'f');
+TYPED_SEQUENCE_TRAITS(double, "SequenceFloat64", 'd');
+
+/* The buffer formats above assume these sizes. */
+static_assert(sizeof(int) == 4, "Format 'i' must be a 32 bit int.");
+static_assert(sizeof(long long) == 8, "Format 'q' must be a 64 bit int.");
+static_assert(sizeof(float) == 4, "Format 'f' must be a 32 bit float.");
+static_assert(sizeof(double) == 8, "Format 'd' must be a 64 bit float.");
+
+/**** Conversion kernels. ****/
+
+/* Returns true if the value can be represented by T. Floating point narrowing is allowed. */
+template<typename T>
+static bool
+typed_in_range(long long value) {
+    if (std::is_floating_point<T>::value) {
+        return true;
+    }
+    if (std::is_signed<T>::value) {
+        return value >= (long long) std::numeric_limits<T>::min() && value <= (long long) std::numeric_limits<T>::max();
+    }
+    return value >= 0 && (unsigned long long) value <= (unsigned long long) std::numeric_limits<T>::max();
+}
+
+template<typename T>
+static bool
+typed_in_range(unsigned long long value) {
+    if (std::is_floating_point<T>::value) {
+        return true;
+    }
+    return value <= (unsigned long long) std::numeric_limits<T>::max();
+}
+
+template<typename T>
+static bool
+typed_in_range(double Py_UNUSED(value)) {
+    return true;
+}
+
+/* Convert a Python object to the wide type.
+ * Returns 0 on success, 1 if the object is the wrong type (no exception set) or -1 with an exception set. */
+static int
+typed_wide_from_py(PyObject *op, long long &value) {
+    if (!PyLong_Check(op)) {
+        return 1;
+    }
+    value = PyLong_AsLongLong(op);
+    return value == -1 && PyErr_Occurred() ? -1 : 0;
+}
+
+static int
+typed_wide_from_py(PyObject *op, unsigned long long &value) {
+    if (!PyLong_Check(op)) {
+        return 1;
+    }
+    value = PyLong_AsUnsignedLongLong(op);
+    return value == (unsigned long long) -1 && PyErr_Occurred() ? -1 : 0;
+}
+
+static int
+typed_wide_from_py(PyObject *op, double &value) {
+    if (PyFloat_Check(op)) {
+        value = PyFloat_AS_DOUBLE(op);
+        return 0;
+    }
+    if (!PyLong_Check(op)) {
+        return 1;
+    }
+    value = PyLong_AsDouble(op);
+    return value == -1.0 && PyErr_Occurred() ? -1 : 0;
+}
+
+static PyObject *typed_wide_to_py(long long value) { return PyLong_FromLongLong(value); }
+
+static PyObject *typed_wide_to_py(unsigned long long value) { return PyLong_FromUnsignedLongLong(value); }
+
+static PyObject *typed_wide_to_py(double value) { return PyFloat_FromDouble(value); }
+
+template<typename T>
+static PyObject *
+typed_value_to_py(T value) {
+    return typed_wide_to_py(static_cast<typename TypedWide<T>::type>(value));
+}
+
+/**
+ * Convert a Python object to a T.
+ * Returns 0 on success, 1 if the object is the wrong type (no exception set) or -1 with an exception set.
+ */
+template<typename T>
+static int
+typed_value_from_py(PyObject *op, T &value) {
+    typename TypedWide<T>::type wide;
+    int result = typed_wide_from_py(op, wide);
+    if (result) {
+        return result;
+    }
+    if (!typed_in_range<T>(wide)) {
+        PyErr_Format(PyExc_OverflowError, "Value %R is out of range for %s", op, TypedSequenceTraits<T>::name);
+        return -1;
+    }
+    value = static_cast<T>(wide);
+    return 0;
+}
+
+/* The description of the expected Python type in error messages. */
+template<typename T>
+static const char *
+typed_py_type_name() {
+    return std::is_floating_point<T>::value ? "a float or int" : "an int";
+}
+
+/**
+ * Convert a strided buffer of S to T.
+ * If S and T have the same representation and the buffer is contiguous this is a single memcpy().
+ * Returns the index of the first value that is out of range for T or size on success.
+ */
+template<typename T, typename S>
+static Py_ssize_t
+typed_convert_strided(const char *ptr, Py_ssize_t stride, Py_ssize_t size, T *out) {
+    if (sizeof(S) == sizeof(T)
+        && std::is_floating_point<S>::value == std::is_floating_point<T>::value
+        && std::is_signed<S>::value == std::is_signed<T>::value
+        && stride == (Py_ssize_t) sizeof(T)) {
+        if (size > 0) {
+            std::memcpy(out, ptr, size * sizeof(T));
+        }
+        return size;
+    }
+    for (Py_ssize_t i = 0; i < size; ++i) {
+        S value;
+        /* The buffer might not be aligned, optimising compilers reduce this to a load. */
+        std::memcpy(&value, ptr + i * stride, sizeof(S));
+        typename TypedWide<S>::type wide = value;
+        if (!typed_in_range<T>(wide)) {
+            return i;
+        }
+        out[i] = static_cast<T>(wide);
+    }
+    return size;
+}
+
+/**
+ * Create the values from a buffer.
+ * Returns 0 on success, -1 on failure with an exception set or 1 if the buffer is not a one dimensional array of a
+ * supported format in which case no exception is set.
+ * Integer sequences do not accept floating point buffers.
+ */
+template<typename T>
+static int
+typed_values_from_buffer(const Py_buffer *view, std::vector<T> &values) {
+    /* A NULL format means unsigned bytes. */
+    const char *format = view->format ? view->format : "B";
+    if (format[0] == '@') {
+        format++;
+    }
+    if (view->ndim != 1 || format[0] == '\0' || format[1] != '\0') {
+        return 1;
+    }
+    Py_ssize_t size = view->shape ? view->shape[0] : view->len / view->itemsize;
+    Py_ssize_t stride = view->strides ? view->strides[0] : view->itemsize;
+    const char *ptr = static_cast<const char *>(view->buf);
+    values.resize(size);
+    T *out = values.data();
+    Py_ssize_t converted;
+
+#define TYPED_CONVERT(c_type)                                                       \
+    if (view->itemsize != (Py_ssize_t) sizeof(c_type)) {                            \
+        return 1;                                                                   \
+    }                                                                               \
+    converted = typed_convert_strided<T, c_type>(ptr, stride, size, out);           \
+    break
+
+    switch (format[0]) {
+        case '?':
+            TYPED_CONVERT(bool);
+        case 'b':
+            TYPED_CONVERT(signed char);
+        case 'B':
+            TYPED_CONVERT(unsigned char);
+        case 'h':
+            TYPED_CONVERT(short);
+        case 'H':
+            TYPED_CONVERT(unsigned short);
+        case 'i':
+            TYPED_CONVERT(int);
+        case 'I':
+            TYPED_CONVERT(unsigned int);
+        case 'l':
+            TYPED_CONVERT(long);
+        case 'L':
+            TYPED_CONVERT(unsigned long);
+        case 'q':
+            TYPED_CONVERT(long long);
+        case 'Q':
+            TYPED_CONVERT(unsigned long long);
+        case 'n':
+            TYPED_CONVERT(Py_ssize_t);
+        case 'N':
+            TYPED_CONVERT(size_t);
+        case 'f':
+            if (!std::is_floating_point<T>::value) {
+                return 1;
+            }
+            TYPED_CONVERT(float);
+        case 'd':
+            if (!std::is_floating_point<T>::value) {
+                return 1;
+            }
+            TYPED_CONVERT(double);
+        default:
+            return 1;
+    }
+#undef TYPED_CONVERT
+
+    if (converted != size) {
+        PyErr_Format(
+                PyExc_OverflowError,
+                "Argument [%zd] with buffer format '%c' is out of range for %s",
+                converted,
+                format[0],
+                TypedSequenceTraits<T>::name
+        );
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Create the values from a sequence with PySequence_Fast().
+ * Returns 0 on success, -1 on failure with an exception set.
+ */
+template<typename T>
+static int
+typed_values_from_sequence(PyObject *op, std::vector<T> &values) {
+    if (!PySequence_Check(op)) {
+        PyErr_Format(
+                PyExc_TypeError,
+                "Argument must be a sequence or support the buffer protocol, not type %s",
+                Py_TYPE(op)->tp_name
+        );
+        return -1;
+    }
+    PyObject *fast = PySequence_Fast(op, "Argument must be a sequence.");
+    if (!fast) {
+        return -1;
+    }
+    Py_ssize_t size = PySequence_Fast_GET_SIZE(fast);
+    /* Borrowed references. */
+    PyObject **items = PySequence_Fast_ITEMS(fast);
+    values.resize(size);
+    for (Py_ssize_t i = 0; i < size; ++i) {
+        int result = typed_value_from_py(items[i], values[i]);
+        if (result > 0) {
+            PyErr_Format(
+                    PyExc_TypeError,
+                    "Argument [%zd] must be %s, not type %s",
+                    i,
+                    typed_py_type_name<T>(),
+                    Py_TYPE(items[i])->tp_name
+            );
+        }
+        if (result) {
+            Py_DECREF(fast);
+            return -1;
+        }
+    }
+    Py_DECREF(fast);
+    return 0;
+}
+
+/**
+ * Create the values from a Python object, the buffer protocol is tried first then the sequence protocol.
+ * Returns 0 on success, -1 on failure with an exception set in which case values is unspecified.
+ */
+template<typename T>
+static int
+typed_values_from_object(PyObject *op, std::vector<T> &values) {
+    try {
+        if (PyObject_CheckBuffer(op)) {
+            Py_buffer view;
+            if (PyObject_GetBuffer(op, &view, PyBUF_RECORDS_RO) == 0) {
+                int result = typed_values_from_buffer(&view, values);
+                PyBuffer_Release(&view);
+                if (result <= 0) {
+                    return result;
+                }
+            } else {
+                PyErr_Clear();
+            }
+        }
+        return typed_values_from_sequence(op, values);
+    } catch (const std::bad_alloc &) {
+        PyErr_NoMemory();
+        return -1;
+    }
+}
+
+/**** The sequence object. ****/
+
+template<typename T>
+struct TypedSequence {
+    PyObject_HEAD
+    /* Constructed with placement new in TypedSequence_new() and destroyed in TypedSequence_dealloc(). */
+    std::vector<T> values;
+    /* Number of outstanding buffer exports. While this is non-zero values must not be re-sized. */
+    Py_ssize_t exports;
+    /* The shape of buffer exports, this is fixed whilst exported. */
+    Py_ssize_t buffer_shape;
+};
+
+template<typename T>
+struct TypedSequenceIterator {
+    PyObject_HEAD
+    TypedSequence<T> *sequence;
+    Py_ssize_t index;
+};
+
+/* The Python types for each T. The definitions are after the functions that they refer to. */
+template<typename T>
+struct TypedSequenceTypes {
+    static PySequenceMethods sequence_methods;
+    static PyBufferProcs buffer_procs;
+    static PyMethodDef methods[];
+    static PyGetSetDef getsetters[];
+    static PyTypeObject sequence_type;
+    static PyTypeObject iterator_type;
+};
+
+template<typename T>
+static PyObject *
+TypedSequence_new(PyTypeObject *type, PyObject *Py_UNUSED(args), PyObject *Py_UNUSED(kwds)) {
+    TypedSequence<T> *self = (TypedSequence<T> *) type->tp_alloc(type, 0);
+    if (self != NULL) {
+        new(&self->values) std::vector<T>();
+        self->exports = 0;
+        self->buffer_shape = 0;
+    }
+    return (PyObject *) self;
+}
+
+template<typename T>
+static int
+TypedSequence_check_exports(TypedSequence<T> *self) {
+    if (self->exports > 0) {
+        PyErr_Format(
+                PyExc_BufferError,
+                "Existing exports of data (%zd): object cannot be re-sized",
+                self->exports
+        );
+        return -1;
+    }
+    return 0;
+}
+
+template<typename T>
+static int
+TypedSequence_init(TypedSequence<T> *self, PyObject *args, PyObject *kwds) {
+    static const char *kwlist[] = {"sequence", NULL};
+    PyObject *sequence = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O", const_cast<char **>(kwlist), &sequence)) {
+        return -1;
+    }
+    if (TypedSequence_check_exports(self)) {
+        return -1;
+    }
+    std::vector<T> values;
+    if (typed_values_from_object(sequence, values)) {
+        return -1;
+    }
+    self->values.swap(values);
+    return 0;
+}
+
+template<typename T>
+static void
+TypedSequence_dealloc(TypedSequence<T> *self) {
+    assert(self->exports == 0);
+    self->values.~vector<T>();
+    Py_TYPE(self)->tp_free((PyObject *) self);
+}
+
+template<typename T>
+static TypedSequence<T> *
+TypedSequence_create(const std::vector<T> &values) {
+    PyTypeObject *type = &TypedSequenceTypes<T>::sequence_type;
+    TypedSequence<T> *ret = (TypedSequence<T> *) TypedSequence_new<T>(type, NULL, NULL);
+    if (ret) {
+        try {
+            ret->values = values;
+        } catch (const std::bad_alloc &) {
+            Py_DECREF(ret);
+            PyErr_NoMemory();
+            return NULL;
+        }
+    }
+    return ret;
+}
+
+/* Sequence methods. */
+
+template<typename T>
+static Py_ssize_t
+TypedSequence_sq_length(PyObject *self) {
+    return (Py_ssize_t) ((TypedSequence<T> *) self)->values.size();
+}
+
+/* Returns non-zero and sets an IndexError if index is out of range. The abstract layer has already added the length
+ * to a negative index so that is taken away again to report the index that the caller gave. */
+template<typename T>
+static int
+TypedSequence_check_index(TypedSequence<T> *self, Py_ssize_t index) {
+    Py_ssize_t size = (Py_ssize_t) self->values.size();
+    if (index < 0 || index >= size) {
+        PyErr_Format(
+                PyExc_IndexError, "Index %zd is out of range for length %zd", index < 0 ? index - size : index, size
+        );
+        return -1;
+    }
+    return 0;
+}
+
+template<typename T>
+static PyObject *
+TypedSequence_sq_item(PyObject *self, Py_ssize_t index) {
+    TypedSequence<T> *self_as_ts = (TypedSequence<T> *) self;
+    if (TypedSequence_check_index(self_as_ts, index)) {
+        return NULL;
+    }
+    return typed_value_to_py(self_as_ts->values[index]);
+}
+
+template<typename T>
+static int
+TypedSequence_sq_ass_item(PyObject *self, Py_ssize_t index, PyObject *value) {
+    TypedSequence<T> *self_as_ts = (TypedSequence<T> *) self;
+    if (TypedSequence_check_index(self_as_ts, index)) {
+        return -1;
+    }
+    if (value == NULL) {
+        if (TypedSequence_check_exports(self_as_ts)) {
+            return -1;
+        }
+        self_as_ts->values.erase(self_as_ts->values.begin() + index);
+        return 0;
+    }
+    T c_value;
+    int result = typed_value_from_py(value, c_value);
+    if (result > 0) {
+        PyErr_Format(
+                PyExc_TypeError,
+                "%s value must be %s, not type %s",
+                TypedSequenceTraits<T>::name,
+                typed_py_type_name<T>(),
+                Py_TYPE(value)->tp_name
+        );
+    }
+    if (result) {
+        return -1;
+    }
+    self_as_ts->values[index] = c_value;
+    return 0;
+}
+
+/* A value that is the wrong type or out of range is benignly never found.
+ * The comparison is in the wide type, as == on the Python values, so a float is not narrowed to a float32. */
+template<typename T>
+static int
+TypedSequence_sq_contains(PyObject *self, PyObject *value) {
+    TypedSequence<T> *self_as_ts = (TypedSequence<T> *) self;
+    typename TypedWide<T>::type wide;
+    int result = typed_wide_from_py(value, wide);
+    if (result < 0 && PyErr_ExceptionMatches(PyExc_OverflowError)) {
+        PyErr_Clear();
+        return 0;
+    }
+    if (result) {
+        return result > 0 ? 0 : -1;
+    }
+    if (!typed_in_range<T>(wide)) {
+        return 0;
+    }
+    for (const T &v: self_as_ts->values) {
+        if (static_cast<typename TypedWide<T>::type>(v) == wide) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+template<typename T>
+static PyObject *
+TypedSequence_sq_concat(PyObject *self, PyObject *other) {
+    if (Py_TYPE(other) != &TypedSequenceTypes<T>::sequence_type) {
+        PyErr_Format(
+                PyExc_TypeError,
+                "can only concatenate %s (not \"%s\") to %s",
+                TypedSequenceTraits<T>::name,
+                Py_TYPE(other)->tp_name,
+                TypedSequenceTraits<T>::name
+        );
+        return NULL;
+    }
+    TypedSequence<T> *ret = TypedSequence_create(((TypedSequence<T> *) self)->values);
+    if (ret) {
+        const std::vector<T> &other_values = ((TypedSequence<T> *) other)->values;
+        try {
+            ret->values.insert(ret->values.end(), other_values.begin(), other_values.end());
+        } catch (const std::bad_alloc &) {
+            Py_DECREF(ret);
+            return PyErr_NoMemory();
+        }
+    }
+    return (PyObject *) ret;
+}
+
+template<typename T>
+static PyObject *
+TypedSequence_sq_repeat(PyObject *self, Py_ssize_t count) {
+    const std::vector<T> &values = ((TypedSequence<T> *) self)->values;
+    TypedSequence<T> *ret = TypedSequence_create(std::vector<T>());
+    if (ret && count > 0 && !values.empty()) {
+        try {
+            ret->values.reserve(values.size() * count);
+            for (Py_ssize_t i = 0; i < count; ++i) {
+                ret->values.insert(ret->values.end(), values.begin(), values.end());
+            }
+        } catch (const std::exception &) {
+            Py_DECREF(ret);
+            return PyErr_NoMemory();
+        }
+    }
+    return (PyObject *) ret;
+}
+
+/* Buffer protocol, a one dimensional, C contiguous, writable array of T. */
+
+template<typename T>
+static int
+TypedSequence_bf_getbuffer(PyObject *self, Py_buffer *view, int flags) {
+    /* The format is a static string. */
+    static const char format[2] = {TypedSequenceTraits<T>::format, '\0'};
+    /* A zero length, but valid, pointer for an empty sequence. */
+    static T empty[1];
+    TypedSequence<T> *self_as_ts = (TypedSequence<T> *) self;
+    if (view == NULL) {
+        PyErr_SetString(PyExc_BufferError, "TypedSequence_bf_getbuffer(): view is NULL.");
+        return -1;
+    }
+    self_as_ts->buffer_shape = (Py_ssize_t) self_as_ts->values.size();
+    view->obj = self;
+    Py_INCREF(view->obj);
+    view->buf = self_as_ts->values.empty() ? empty : self_as_ts->values.data();
+    view->len = self_as_ts->buffer_shape * (Py_ssize_t) sizeof(T);
+    view->readonly = 0;
+    view->itemsize = sizeof(T);
+    view->format = (flags & PyBUF_FORMAT) == PyBUF_FORMAT ? const_cast<char *>(format) : NULL;
+    view->ndim = 1;
+    view->shape = (flags & PyBUF_ND) == PyBUF_ND ? &self_as_ts->buffer_shape : NULL;
+    view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? &view->itemsize : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+    self_as_ts->exports++;
+    return 0;
+}
+
+template<typename T>
+static void
+TypedSequence_bf_releasebuffer(PyObject *self, Py_buffer *Py_UNUSED(view)) {
+    assert(((TypedSequence<T> *) self)->exports > 0);
+    ((TypedSequence<T> *) self)->exports--;
+}
+
+/* Methods and attributes. */
+
+/* The memory used by the object including its values. */
+template<typename T>
+static PyObject *
+TypedSequence___sizeof__(TypedSequence<T> *self, PyObject *Py_UNUSED(ignored)) {
+    return PyLong_FromSize_t(Py_TYPE(self)->tp_basicsize + self->values.capacity() * sizeof(T));
+}
+
+template<typename T>
+static PyObject *
+TypedSequence_get_itemsize(TypedSequence<T> *Py_UNUSED(self), void *Py_UNUSED(closure)) {
+    return PyLong_FromSize_t(sizeof(T));
+}
+
+template<typename T>
+static PyObject *
+TypedSequence_get_typecode(TypedSequence<T> *Py_UNUSED(self), void *Py_UNUSED(closure)) {
+    return PyUnicode_FromOrdinal(TypedSequenceTraits<T>::format);
+}
+
+template<typename T>
+static PyObject *
+TypedSequence___str__(TypedSequence<T> *self) {
+    return PyUnicode_FromFormat("<%s sequence size: %zd>", TypedSequenceTraits<T>::name, self->values.size());
+}
+
+/**** The iterator. ****/
+
+template<typename T>
+static PyObject *
+TypedSequence_iter(PyObject *self) {
+    TypedSequenceIterator<T> *iterator = PyObject_New(TypedSequenceIterator<T>, &TypedSequenceTypes<T>::iterator_type);
+    if (iterator) {
+        Py_INCREF(self);
+        iterator->sequence = (TypedSequence<T> *) self;
+        iterator->index = 0;
+    }
+    return (PyObject *) iterator;
+}
+
+template<typename T>
+static void
+TypedSequenceIterator_dealloc(TypedSequenceIterator<T> *self) {
+    Py_XDECREF(self->sequence);
+    PyObject_Del(self);
+}
+
+/* The sequence can be re-sized during iteration so check the size every time. */
+template<typename T>
+static PyObject *
+TypedSequenceIterator_next(TypedSequenceIterator<T> *self) {
+    if (self->sequence && self->index < (Py_ssize_t) self->sequence->values.size()) {
+        return typed_value_to_py(self->sequence->values[self->index++]);
+    }
+    /* Exhausted, release the sequence. */
+    Py_CLEAR(self->sequence);
+    return NULL;
+}
+
+/**** Type definitions. ****/
+
+template<typename T>
+PySequenceMethods TypedSequenceTypes<T>::sequence_methods = {
+        .sq_length = (lenfunc) TypedSequence_sq_length<T>,
+        .sq_concat = (binaryfunc) TypedSequence_sq_concat<T>,
+        .sq_repeat = (ssizeargfunc) TypedSequence_sq_repeat<T>,
+        .sq_item = (ssizeargfunc) TypedSequence_sq_item<T>,
+        .was_sq_slice = NULL,
+        .sq_ass_item = (ssizeobjargproc) TypedSequence_sq_ass_item<T>,
+        .was_sq_ass_slice = NULL,
+        .sq_contains = (objobjproc) TypedSequence_sq_contains<T>,
+        .sq_inplace_concat = NULL,
+        .sq_inplace_repeat = NULL,
+};
+
+template<typename T>
+PyBufferProcs TypedSequenceTypes<T>::buffer_procs = {
+        .bf_getbuffer = (getbufferproc) TypedSequence_bf_getbuffer<T>,
+        .bf_releasebuffer = (releasebufferproc) TypedSequence_bf_releasebuffer<T>,
+};
+
+template<typename T>
+PyMethodDef TypedSequenceTypes<T>::methods[] = {
+        {"__sizeof__", (PyCFunction) TypedSequence___sizeof__<T>, METH_NOARGS,
+                "Return the memory used by the object including its values."},
+        {NULL, NULL, 0, NULL}  /* Sentinel */
+};
+
+template<typename T>
+PyGetSetDef TypedSequenceTypes<T>::getsetters[] = {
+        {"itemsize", (getter) TypedSequence_get_itemsize<T>, NULL, "The size in bytes of each value.", NULL},
+        {"typecode", (getter) TypedSequence_get_typecode<T>, NULL, "The buffer protocol format of each value.", NULL},
+        {NULL, NULL, NULL, NULL, NULL}  /* Sentinel */
+};
+
+/* The designated initialisers below leave the remaining PyTypeObject fields zero, which is what is intended.
+ * The fields differ between Python versions so they are not listed, instead the warning is silenced here. */
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+#endif
+
+template<typename T>
+PyTypeObject TypedSequenceTypes<T>::sequence_type = {
+        PyVarObject_HEAD_INIT(NULL, 0)
+        .tp_name = TypedSequenceTraits<T>::type_name,
+        .tp_basicsize = sizeof(TypedSequence<T>),
+        .tp_itemsize = 0,
+        .tp_dealloc = (destructor) TypedSequence_dealloc<T>,
+        .tp_as_sequence = &TypedSequenceTypes<T>::sequence_methods,
+        .tp_str = (reprfunc) TypedSequence___str__<T>,
+        .tp_as_buffer = &TypedSequenceTypes<T>::buffer_procs,
+        .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+        .tp_doc = "Sequence of a single C numeric type.",
+        .tp_iter = (getiterfunc) TypedSequence_iter<T>,
+        .tp_methods = TypedSequenceTypes<T>::methods,
+        .tp_getset = TypedSequenceTypes<T>::getsetters,
+        .tp_init = (initproc) TypedSequence_init<T>,
+        .tp_new = TypedSequence_new<T>,
+};
+
+template<typename T>
+PyTypeObject TypedSequenceTypes<T>::iterator_type = {
+        PyVarObject_HEAD_INIT(NULL, 0)
+        .tp_name = TypedSequenceTraits<T>::iterator_type_name,
+        .tp_basicsize = sizeof(TypedSequenceIterator<T>),
+        .tp_itemsize = 0,
+        .tp_dealloc = (destructor) TypedSequenceIterator_dealloc<T>,
+        .tp_flags = Py_TPFLAGS_DEFAULT,
+        .tp_doc = "Iterator over a typed sequence.",
+        .tp_iter = PyObject_SelfIter,
+        .tp_iternext = (iternextfunc) TypedSequenceIterator_next<T>,
+};
+
+/**
+ * Ready the sequence and iterator types for T and add the sequence type to the module.
+ * Returns 0 on success, -1 on failure.
+ */
+template<typename T>
+static int
+TypedSequence_add_to_module(PyObject *module) {
+    PyTypeObject *sequence_type = &TypedSequenceTypes<T>::sequence_type;
+    if (PyType_Ready(sequence_type) < 0 || PyType_Ready(&TypedSequenceTypes<T>::iterator_type) < 0) {
+        return -1;
+    }
+    Py_INCREF(sequence_type);
+    if (PyModule_AddObject(module, TypedSequenceTraits<T>::name, (PyObject *) sequence_type) < 0) {
+        Py_DECREF(sequence_type);
+        return -1;
+    }
+    return 0;
+}
+
+static PyModuleDef typed_sequence_module = {
+        PyModuleDef_HEAD_INIT,
+        .m_name = "cTypedSequence",
+        .m_doc = "Example module that creates a family of sequence types for each C numeric type from a C++ template.",
+        .m_size = -1,
+};
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+PyMODINIT_FUNC
+PyInit_cTypedSequence(void) {
+    PyObject *m = PyModule_Create(&typed_sequence_module);
+    if (m == NULL) {
+        return NULL;
+    }
+    if (TypedSequence_add_to_module<int8_t>(m)
+        || TypedSequence_add_to_module<uint8_t>(m)
+        || TypedSequence_add_to_module<int16_t>(m)
+        || TypedSequence_add_to_module<uint16_t>(m)
+        || TypedSequence_add_to_module<int32_t>(m)
+        || TypedSequence_add_to_module<uint32_t>(m)
+        || TypedSequence_add_to_module<int64_t>(m)
+        || TypedSequence_add_to_module<uint64_t>(m)
+        || TypedSequence_add_to_module<float>(m)
+        || TypedSequence_add_to_module<double>(m)) {
+        Py_DECREF(m);
+        return NULL;
+    }
+    return m;
+}
@@ -80,6 +80,26 @@ def test_read_python_file_to_c(file_object, size, expected):
     assert result == expected
 
 
+@pytest.mark.parametrize(
+    'args, kwargs, expected',
+    (
+            ((io.BytesIO(b'Some bytes.'), 4), {}, b'Some'),
+            ((io.BytesIO(b'Some bytes.'),), {}, b'Some bytes.'),
+            ((io.BytesIO(b'Some bytes.'),), {'size': 4}, b'Some'),
+            ((), {'file_object': io.BytesIO(b'Some bytes.'), 'size': -1}, b'Some bytes.'),
+    )
+)
+def test_read_python_file_to_c_fastcall(args, kwargs, expected):
+    result = cFile.read_python_file_to_c_fastcall(*args, **kwargs)
+    assert result == expected
+
+
+def test_read_python_file_to_c_fastcall_raises():
+    with pytest.raises(TypeError) as err:
+        cFile.read_python_file_to_c_fastcall(io.BytesIO(b''), sz=4)
+    assert err.value.args[0] == "read_python_file_to_c_fastcall() got an unexpected keyword argument 'sz'"
+
+
 @pytest.mark.parametrize(
     'bytes_to_write, expected',
     (
@@ -138,4 +158,588 @@ def test_wrap_python_file():
     print(get_value)
     print(' file.getvalue() DONE '.center(75, '-'))
     assert get_value == b'Test write to python file'
-    
\ No newline at end of file
+    
+
+class NoReadInto:
+    """A binary file like object without readinto()."""
+
+    def __init__(self, data):
+        self._file = io.BytesIO(data)
+
+    def read(self, size=-1):
+        return self._file.read(size)
+
+    def write(self, data):
+        return self._file.write(data)
+
+    def seek(self, pos, whence=0):
+        return self._file.seek(pos, whence)
+
+    def tell(self):
+        return self._file.tell()
+
+
+class ShortReadInto(NoReadInto):
+    """readinto() returns at most 3 bytes, like a raw file."""
+
+    def readinto(self, buffer):
+        data = self._file.read(min(3, len(buffer)))
+        buffer[:len(data)] = data
+        return len(data)
+
+
+class KeepsReadIntoBuffer(NoReadInto):
+    """readinto() keeps a reference to the memoryview."""
+
+    def __init__(self, data):
+        super().__init__(data)
+        self.buffers = []
+
+    def readinto(self, buffer):
+        self.buffers.append(buffer)
+        return self._file.readinto(buffer)
+
+
+DATA = bytes(range(256)) * 41
+
+
+@pytest.mark.parametrize('method', ('buffer', 'vector', 'iostream'))
+@pytest.mark.parametrize('use_readinto', (True, False))
+@pytest.mark.parametrize('chunk_size', (1, 7, 256, len(DATA), len(DATA) + 1, 65536))
+@pytest.mark.parametrize('file_class', (io.BytesIO, NoReadInto, ShortReadInto))
+def test_read_python_file_via_wrapper(file_class, chunk_size, use_readinto, method):
+    file = file_class(DATA)
+    assert cFile.read_python_file_via_wrapper(
+        file, chunk_size=chunk_size, method=method, use_readinto=use_readinto
+    ) == DATA
+
+
+@pytest.mark.parametrize('method', ('buffer', 'vector', 'iostream'))
+@pytest.mark.parametrize('use_readinto', (True, False))
+def test_read_python_file_via_wrapper_real_file(tmp_path, method, use_readinto):
+    path = tmp_path / 'data.bin'
+    path.write_bytes(DATA)
+    for buffering in (0, -1):
+        with open(path, 'rb', buffering=buffering) as file:
+            assert cFile.read_python_file_via_wrapper(
+                file, chunk_size=1000, method=method, use_readinto=use_readinto
+            ) == DATA
+            assert file.tell() == len(DATA)
+
+
+@pytest.mark.parametrize('method', ('buffer', 'vector', 'iostream'))
+def test_read_python_file_via_wrapper_empty(method):
+    assert cFile.read_python_file_via_wrapper(io.BytesIO(), method=method) == b''
+
+
+def test_read_python_file_via_wrapper_releases_memoryview():
+    file = KeepsReadIntoBuffer(DATA)
+    assert cFile.read_python_file_via_wrapper(file, chunk_size=1024) == DATA
+    assert len(file.buffers) > 0
+    for buffer in file.buffers:
+        with pytest.raises(ValueError):
+            buffer[0]
+
+
+@pytest.mark.parametrize('method', ('vector', 'iostream'))
+def test_read_python_file_via_wrapper_text(method):
+    file = io.StringIO('Some text.')
+    assert cFile.read_python_file_via_wrapper(file, chunk_size=4, method=method) == b'Some text.'
+
+
+def test_read_python_file_via_wrapper_text_buffer_raises():
+    file = io.StringIO('Some text.')
+    with pytest.raises(TypeError) as err:
+        cFile.read_python_file_via_wrapper(file, method='buffer')
+    assert err.value.args[0] == 'Reading into a buffer needs a file opened in binary mode.'
+
+
+@pytest.mark.parametrize(
+    'kwargs, expected',
+    (
+            ({'chunk_size': 0}, 'chunk_size must be > 0 not 0.'),
+            ({'method': 'foo'}, "method must be 'buffer', 'vector' or 'iostream' not 'foo'."),
+    )
+)
+def test_read_python_file_via_wrapper_raises(kwargs, expected):
+    with pytest.raises(ValueError) as err:
+        cFile.read_python_file_via_wrapper(io.BytesIO(DATA), **kwargs)
+    assert err.value.args[0] == expected
+
+
+@pytest.mark.parametrize('method', ('buffer', 'vector', 'iostream'))
+def test_read_python_file_via_wrapper_chunk_size_too_large(method):
+    with pytest.raises(MemoryError):
+        cFile.read_python_file_via_wrapper(io.BytesIO(DATA), chunk_size=1 << 62, method=method)
+
+
+@pytest.mark.parametrize('use_fd', (True, False))
+@pytest.mark.parametrize('method', ('buffer', 'vector', 'iostream'))
+def test_read_python_file_via_wrapper_file_io(tmp_path, method, use_fd):
+    path = tmp_path / 'data.bin'
+    path.write_bytes(DATA)
+    with io.FileIO(path, 'r') as file:
+        file.seek(100)
+        assert cFile.read_python_file_via_wrapper(file, chunk_size=999, method=method, use_fd=use_fd) == DATA[100:]
+        assert file.tell() == len(DATA)
+
+
+def test_read_python_file_via_wrapper_file_io_closed(tmp_path):
+    path = tmp_path / 'data.bin'
+    path.write_bytes(DATA)
+    file = io.FileIO(path, 'r')
+    file.close()
+    with pytest.raises(ValueError):
+        cFile.read_python_file_via_wrapper(file)
+
+
+def _open_for_positional_io(kind, path):
+    if kind == 'FileIO':
+        return io.FileIO(path, 'r+')
+    if kind == 'buffered':
+        return open(path, 'r+b')
+    if kind == 'BytesIO':
+        return io.BytesIO(path.read_bytes())
+    return NoReadInto(path.read_bytes())
+
+
+POSITIONAL_IO_KINDS = ('FileIO', 'buffered', 'BytesIO', 'NoReadInto')
+
+
+@pytest.mark.parametrize('kind', POSITIONAL_IO_KINDS)
+@pytest.mark.parametrize(
+    'size, offset',
+    (
+            (0, 0),
+            (10, 0),
+            (100, 1000),
+            (len(DATA), 0),
+            (100, len(DATA) - 10),
+            (100, len(DATA) + 10),
+    )
+)
+def test_pread_python_file(tmp_path, kind, size, offset):
+    path = tmp_path / 'data.bin'
+    path.write_bytes(DATA)
+    file = _open_for_positional_io(kind, path)
+    file.seek(17)
+    assert cFile.pread_python_file(file, size, offset) == DATA[offset:offset + size]
+    # The position is unchanged.
+    assert file.tell() == 17
+    assert file.read(3) == DATA[17:20]
+
+
+@pytest.mark.parametrize('kind', POSITIONAL_IO_KINDS)
+@pytest.mark.parametrize(
+    'sizes, offset',
+    (
+            ([], 0),
+            ([0, 10, 0, 20], 0),
+            ([100] * 50, 7),
+            ([100, 100, 100], len(DATA) - 150),
+    )
+)
+def test_preadv_python_file(tmp_path, kind, sizes, offset):
+    path = tmp_path / 'data.bin'
+    path.write_bytes(DATA)
+    file = _open_for_positional_io(kind, path)
+    result = cFile.preadv_python_file(file, sizes, offset)
+    expected = []
+    for size in sizes:
+        expected.append(DATA[offset:offset + size])
+        offset += size
+    assert result == expected
+    assert file.tell() == 0
+
+
+@pytest.mark.parametrize('kind', POSITIONAL_IO_KINDS)
+def test_pwrite_python_file(tmp_path, kind):
+    path = tmp_path / 'data.bin'
+    path.write_bytes(DATA)
+    file = _open_for_positional_io(kind, path)
+    file.seek(5)
+    assert cFile.pwrite_python_file(file, b'abc', 1000) == 3
+    assert file.tell() == 5
+    assert cFile.pread_python_file(file, 5, 999) == DATA[999:1000] + b'abc' + DATA[1003:1004]
+
+
+@pytest.mark.parametrize(
+    'function, args, expected',
+    (
+            (cFile.pread_python_file, (-1, 0), 'size must be >= 0 not -1.'),
+            (cFile.pread_python_file, (1, -1), 'The offset must be >= 0 not -1.'),
+            (cFile.preadv_python_file, ([1, -2], 0), 'sizes must be >= 0 not -2.'),
+            (cFile.preadv_python_file, ([1], -1), 'The offset must be >= 0 not -1.'),
+            (cFile.pwrite_python_file, (b'abc', -1), 'The offset must be >= 0 not -1.'),
+    )
+)
+def test_positional_io_raises(function, args, expected):
+    with pytest.raises(ValueError) as err:
+        function(io.BytesIO(DATA), *args)
+    assert err.value.args[0] == expected
+
+
+@pytest.mark.parametrize(
+    'function, args',
+    (
+            (cFile.pread_python_file, (1 << 62, 0)),
+            (cFile.preadv_python_file, ([1, 1 << 62], 0)),
+    )
+)
+def test_positional_io_size_too_large(function, args):
+    with pytest.raises(MemoryError):
+        function(io.BytesIO(DATA), *args)
+
+
+def test_preadv_python_file_total_too_large():
+    with pytest.raises(OverflowError) as err:
+        cFile.preadv_python_file(io.BytesIO(DATA), [1 << 62] * 2, 0)
+    assert err.value.args[0] == 'The total of sizes is too large.'
+
+
+def test_pread_python_file_threads(tmp_path):
+    """Concurrent positional reads of one file."""
+    import threading
+
+    path = tmp_path / 'data.bin'
+    path.write_bytes(DATA)
+    errors = []
+    with io.FileIO(path, 'r') as file:
+        def read(thread_index):
+            try:
+                for offset in range(thread_index, len(DATA), 997):
+                    assert cFile.pread_python_file(file, 64, offset) == DATA[offset:offset + 64]
+            except Exception as err:
+                errors.append(err)
+
+        threads = [threading.Thread(target=read, args=(i,)) for i in range(4)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        assert file.tell() == 0
+    assert errors == []
+
+
+def test_mapped_file_dir():
+    assert [name for name in dir(cFile.MappedFile) if not name.startswith('_')] == [
+        'close', 'closed', 'flush', 'huge_pages', 'madvise', 'offset', 'readonly',
+    ]
+    for name in ('__enter__', '__exit__', '__getitem__', '__len__'):
+        assert hasattr(cFile.MappedFile, name)
+
+
+@pytest.mark.parametrize('path_type', (str, pathlib.Path, lambda p: str(p).encode()))
+def test_mapped_file(tmp_path, path_type):
+    path = tmp_path / 'data.bin'
+    path.write_bytes(DATA)
+    with cFile.MappedFile(path_type(path)) as mapped:
+        assert len(mapped) == len(DATA)
+        assert mapped.readonly
+        assert not mapped.closed
+        assert mapped.offset == 0
+        assert mapped[0] == DATA[0]
+        assert mapped[-1] == DATA[-1]
+        assert bytes(mapped) == DATA
+        assert memoryview(mapped).readonly
+    assert mapped.closed
+
+
+@pytest.mark.parametrize(
+    'offset, length',
+    (
+            (0, 0),
+            (0, 10),
+            (1, 10),
+            (4095, 2),
+            (4096, 100),
+            (5000, -1),
+            (len(DATA), -1),
+    )
+)
+def test_mapped_file_offset_and_length(tmp_path, offset, length):
+    path = tmp_path / 'data.bin'
+    path.write_bytes(DATA)
+    with cFile.MappedFile(path, offset=offset, length=length) as mapped:
+        expected = DATA[offset:] if length < 0 else DATA[offset:offset + length]
+        assert len(mapped) == len(expected)
+        assert bytes(mapped) == expected
+        assert mapped.offset == offset
+
+
+def test_mapped_file_empty(tmp_path):
+    path = tmp_path / 'empty.bin'
+    path.write_bytes(b'')
+    with cFile.MappedFile(path) as mapped:
+        assert len(mapped) == 0
+        assert bytes(mapped) == b''
+        assert bytes(mapped[:]) == b''
+        # There is no mapping so these must not touch any memory.
+        mapped.madvise(cFile.MADV_DONTNEED)
+        mapped.madvise(cFile.MADV_WILLNEED, 0, 0)
+        mapped.flush()
+    with cFile.MappedFile(path, writable=True) as mapped:
+        mapped.madvise(cFile.MADV_DONTNEED)
+        mapped.flush()
+        assert bytes(mapped) == b''
+    # The module is still usable.
+    path.write_bytes(DATA)
+    with cFile.MappedFile(path) as mapped:
+        assert bytes(mapped) == DATA
+    assert cFile.read_python_file_via_wrapper(io.BytesIO(DATA)) == DATA
+
+
+@pytest.mark.parametrize(
+    'key',
+    (
+            slice(None),
+            slice(10, 20),
+            slice(-100, None),
+            slice(None, None, 3),
+            slice(200, 100, -1),
+    )
+)
+def test_mapped_file_slice(tmp_path, key):
+    path = tmp_path / 'data.bin'
+    path.write_bytes(DATA)
+    mapped = cFile.MappedFile(path)
+    view = mapped[key]
+    assert isinstance(view, memoryview)
+    assert bytes(view) == DATA[key]
+    view.release()
+    mapped.close()
+
+
+def test_mapped_file_close_with_slice_raises(tmp_path):
+    path = tmp_path / 'data.bin'
+    path.write_bytes(DATA)
+    mapped = cFile.MappedFile(path)
+    view = mapped[10:20]
+    with pytest.raises(BufferError) as err:
+        mapped.close()
+    assert err.value.args[0] == 'Can not close a MappedFile whilst a buffer is exported.'
+    assert bytes(view) == DATA[10:20]
+    del view
+    mapped.close()
+    assert mapped.closed
+    # Closing again is fine.
+    mapped.close()
+
+
+def test_mapped_file_closed_raises(tmp_path):
+    path = tmp_path / 'data.bin'
+    path.write_bytes(DATA)
+    mapped = cFile.MappedFile(path)
+    mapped.close()
+    for function in (len, bytes, memoryview, lambda m: m[0], lambda m: m[:], lambda m: m.madvise(cFile.MADV_RANDOM)):
+        with pytest.raises(ValueError) as err:
+            function(mapped)
+        assert err.value.args[0] == 'I/O operation on a closed MappedFile.'
+
+
+def test_mapped_file_writable(tmp_path):
+    path = tmp_path / 'data.bin'
+    path.write_bytes(DATA)
+    with cFile.MappedFile(path, writable=True, offset=100) as mapped:
+        assert not mapped.readonly
+        view = memoryview(mapped)
+        view[0:3] = b'abc'
+        view.release()
+        mapped.flush()
+    assert path.read_bytes() == DATA[:100] + b'abc' + DATA[103:]
+
+
+def test_mapped_file_read_only_write_raises(tmp_path):
+    path = tmp_path / 'data.bin'
+    path.write_bytes(DATA)
+    with cFile.MappedFile(path) as mapped:
+        view = mapped[:]
+        with pytest.raises(TypeError):
+            view[0] = 1
+        view.release()
+
+
+@pytest.mark.parametrize(
+    'advice',
+    ('MADV_NORMAL', 'MADV_SEQUENTIAL', 'MADV_RANDOM', 'MADV_WILLNEED', 'MADV_DONTNEED'),
+)
+@pytest.mark.parametrize('start, length', ((0, -1), (1, 10), (5000, 100), (len(DATA) - 7, 0)))
+def test_mapped_file_madvise(tmp_path, advice, start, length):
+    path = tmp_path / 'data.bin'
+    path.write_bytes(DATA)
+    with cFile.MappedFile(path, offset=7) as mapped:
+        assert mapped.madvise(getattr(cFile, advice), start, length) is None
+        assert bytes(mapped) == DATA[7:]
+
+
+def test_mapped_file_huge_pages(tmp_path):
+    path = tmp_path / 'data.bin'
+    path.write_bytes(DATA)
+    # Huge pages are a hint so whether they are accepted depends on the platform.
+    with cFile.MappedFile(path, huge_pages=True) as mapped:
+        assert mapped.huge_pages in (True, False)
+        assert bytes(mapped) == DATA
+
+
+@pytest.mark.parametrize(
+    'kwargs, expected',
+    (
+            ({'offset': -1}, 'offset must be >= 0 not -1.'),
+            ({'offset': len(DATA) + 1}, f'offset {len(DATA) + 1} is beyond the end of the file of {len(DATA)} bytes.'),
+            (
+                    {'offset': 10, 'length': len(DATA)},
+                    f'length {len(DATA)} from offset 10 is beyond the end of the file of {len(DATA)} bytes.',
+            ),
+    )
+)
+def test_mapped_file_init_raises(tmp_path, kwargs, expected):
+    path = tmp_path / 'data.bin'
+    path.write_bytes(DATA)
+    with pytest.raises(ValueError) as err:
+        cFile.MappedFile(path, **kwargs)
+    assert err.value.args[0] == expected
+
+
+def test_mapped_file_not_found_raises(tmp_path):
+    with pytest.raises(FileNotFoundError):
+        cFile.MappedFile(tmp_path / 'missing.bin')
+
+
+@pytest.mark.parametrize(
+    'start, length, expected',
+    (
+            (-1, -1, f'start must be 0 to {len(DATA)} not -1.'),
+            (len(DATA) + 1, -1, f'start must be 0 to {len(DATA)} not {len(DATA) + 1}.'),
+            (10, len(DATA), f'length must be 0 to {len(DATA) - 10} not {len(DATA)}.'),
+    )
+)
+def test_mapped_file_madvise_raises(tmp_path, start, length, expected):
+    path = tmp_path / 'data.bin'
+    path.write_bytes(DATA)
+    with cFile.MappedFile(path) as mapped:
+        with pytest.raises(ValueError) as err:
+            mapped.madvise(cFile.MADV_RANDOM, start, length)
+        assert err.value.args[0] == expected
+
+
+def test_mapped_file_index_raises(tmp_path):
+    path = tmp_path / 'data.bin'
+    path.write_bytes(DATA)
+    with cFile.MappedFile(path) as mapped:
+        with pytest.raises(IndexError):
+            mapped[len(DATA)]
+        with pytest.raises(TypeError):
+            mapped['a']
+
+
+class CountingFile(io.BytesIO):
+    """Counts the calls to read(), readinto() and write()."""
+
+    def __init__(self, *args):
+        super().__init__(*args)
+        self.calls = {'read': 0, 'readinto': 0, 'write': 0}
+
+    def read(self, *args):
+        self.calls['read'] += 1
+        return super().read(*args)
+
+    def readinto(self, buffer):
+        self.calls['readinto'] += 1
+        return super().readinto(buffer)
+
+    def write(self, data):
+        self.calls['write'] += 1
+        return super().write(data)
+
+
+LINES = [b'Line %d ' % i + b'x' * (i % 37) for i in range(500)]
+LINES_DATA = b'\n'.join(LINES) + b'\n'
+
+
+@pytest.mark.parametrize('buffer_size', (1, 7, 4096, 65536, 4 * 1024 * 1024))
+@pytest.mark.parametrize('file_class', (io.BytesIO, NoReadInto, ShortReadInto))
+def test_read_lines_via_streambuf(file_class, buffer_size):
+    assert cFile.read_lines_via_streambuf(file_class(LINES_DATA), buffer_size) == LINES
+
+
+@pytest.mark.parametrize(
+    'data, expected',
+    (
+            (b'', []),
+            (b'\n', [b'']),
+            (b'a', [b'a']),
+            (b'a\n\nb', [b'a', b'', b'b']),
+    )
+)
+def test_read_lines_via_streambuf_edges(data, expected):
+    assert cFile.read_lines_via_streambuf(io.BytesIO(data), 2) == expected
+
+
+def test_read_lines_via_streambuf_text():
+    text = LINES_DATA.decode('ascii')
+    assert cFile.read_lines_via_streambuf(io.StringIO(text), 100) == LINES
+
+
+@pytest.mark.parametrize('buffer_size', (100, 1000, 4096))
+def test_read_lines_via_streambuf_read_calls(buffer_size):
+    file = CountingFile(LINES_DATA)
+    assert cFile.read_lines_via_streambuf(file, buffer_size) == LINES
+    # One call for each fill of the buffer. At EOF the short fill makes one more call that returns 0, to allow for a
+    # raw file that returns less than asked for, and the stream makes one more that finds EOF.
+    fills = (len(LINES_DATA) + buffer_size - 1) // buffer_size
+    assert file.calls['readinto'] == fills + 2
+    assert file.calls['read'] == 0
+
+
+@pytest.mark.parametrize('buffer_size', (1, 3, 4096))
+def test_sum_integers_via_streambuf(buffer_size):
+    values = list(range(-500, 1000, 7))
+    data = ' '.join(str(v) for v in values).encode('ascii') + b'\n'
+    assert cFile.sum_integers_via_streambuf(io.BytesIO(data), buffer_size) == sum(values)
+
+
+def test_sum_integers_via_streambuf_raises_and_positions_file():
+    file = io.BytesIO(b'1 2 x 3')
+    with pytest.raises(ValueError) as err:
+        cFile.sum_integers_via_streambuf(file)
+    assert err.value.args[0] == 'Can not parse an integer from the file.'
+    # The read ahead data has been given back so the file is where the parsing stopped.
+    assert file.tell() == 4
+    assert file.read() == b'x 3'
+
+
+@pytest.mark.parametrize('buffer_size', (1, 7, 4096, 65536))
+def test_write_lines_via_streambuf(buffer_size):
+    file = CountingFile()
+    assert cFile.write_lines_via_streambuf(file, LINES, buffer_size) == len(LINES_DATA)
+    assert file.getvalue() == LINES_DATA
+    if buffer_size == 4096:
+        assert file.calls['write'] == (len(LINES_DATA) + buffer_size - 1) // buffer_size
+
+
+def test_write_lines_via_streambuf_large_line():
+    """A line larger than the buffer is written directly."""
+    lines = [b'a', b'b' * 10_000, b'c']
+    file = CountingFile()
+    assert cFile.write_lines_via_streambuf(file, lines, 1000) == 10_005
+    assert file.getvalue() == b'a\n' + b'b' * 10_000 + b'\nc\n'
+    assert file.calls['write'] == 3
+
+
+def test_write_lines_via_streambuf_text_raises():
+    with pytest.raises(TypeError):
+        cFile.write_lines_via_streambuf(io.StringIO(), [b'a'])
+
+
+@pytest.mark.parametrize(
+    'function, args',
+    (
+            (cFile.read_lines_via_streambuf, (io.BytesIO(), 0)),
+            (cFile.sum_integers_via_streambuf, (io.BytesIO(), -1)),
+            (cFile.write_lines_via_streambuf, (io.BytesIO(), [], 0)),
+    )
+)
+def test_streambuf_buffer_size_raises(function, args):
+    with pytest.raises(ValueError) as err:
+        function(*args)
+    assert err.value.args[0] == f'buffer_size must be > 0 not {args[-1]}.'
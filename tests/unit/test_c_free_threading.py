@@ -0,0 +1,178 @@
+"""Multi-threaded stress tests of the extensions that support a free-threaded (PEP 703) build.
+
+With the GIL these check that the locking is correct, on a free-threaded build they also check that importing the
+extensions does not re-enable the GIL.
+"""
+import sys
+import sysconfig
+import threading
+
+import pytest
+
+from cPyExtPatt import cSeqObject
+from cPyExtPatt.Logging import cLogging
+from cPyExtPatt.Threads import cppqueue
+from cPyExtPatt.Threads import cppsublist
+from cPyExtPatt.Threads import csublist
+
+THREAD_COUNT = 8
+
+FREE_THREADED_BUILD = bool(sysconfig.get_config_var('Py_GIL_DISABLED'))
+
+
+def run_in_threads(target, thread_count=THREAD_COUNT):
+    """Run target(thread_index) in thread_count threads that start together.
+    Returns the list of exceptions raised by the threads."""
+    barrier = threading.Barrier(thread_count)
+    errors = []
+
+    def wrapper(thread_index):
+        barrier.wait()
+        try:
+            target(thread_index)
+        except Exception as err:
+            errors.append(err)
+
+    threads = [threading.Thread(target=wrapper, args=(i,)) for i in range(thread_count)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    return errors
+
+
+@pytest.mark.skipif(not FREE_THREADED_BUILD, reason='Requires a free-threaded build of Python.')
+def test_gil_not_enabled():
+    # The modules are imported above, any one of them without Py_MOD_GIL_NOT_USED would have re-enabled the GIL.
+    assert not sys._is_gil_enabled()
+
+
+def test_sequence_long_object_append():
+    values_per_thread = 2_000
+    obj = cSeqObject.SequenceLongObject([])
+
+    def append(thread_index):
+        for i in range(values_per_thread):
+            obj.append(thread_index)
+
+    assert run_in_threads(append) == []
+    assert len(obj) == THREAD_COUNT * values_per_thread
+    assert obj.sum() == values_per_thread * sum(range(THREAD_COUNT))
+    assert obj.capacity >= len(obj)
+    for thread_index in range(THREAD_COUNT):
+        assert obj.count(thread_index) == values_per_thread
+
+
+def test_sequence_long_object_append_and_read():
+    values_per_thread = 1_000
+    obj = cSeqObject.SequenceLongObject([0])
+
+    def append_or_read(thread_index):
+        for i in range(values_per_thread):
+            if thread_index % 2:
+                obj.append(1)
+            else:
+                # Every value is 0 or 1.
+                assert obj[-1] in (0, 1)
+                assert 0 <= obj.sum() <= len(obj)
+                assert obj.max() <= 1
+
+    assert run_in_threads(append_or_read) == []
+    assert len(obj) == 1 + values_per_thread * THREAD_COUNT // 2
+    assert obj.sum() == values_per_thread * THREAD_COUNT // 2
+
+
+def test_sequence_long_object_setitem():
+    repeat = 100
+    obj = cSeqObject.SequenceLongObject([0] * THREAD_COUNT)
+
+    def set_item(thread_index):
+        for i in range(repeat):
+            obj[thread_index] += 1
+
+    assert run_in_threads(set_item) == []
+    assert list(obj) == [repeat] * THREAD_COUNT
+
+
+def test_sequence_long_view_write_through():
+    repeat = 100
+    obj = cSeqObject.SequenceLongObject([0] * THREAD_COUNT * 2)
+
+    def view_write(thread_index):
+        for i in range(repeat):
+            # Each thread has its own pair of values in the base.
+            view = obj[thread_index::THREAD_COUNT]
+            view[0] = i
+            view[1] = -i
+            assert len(view.copy()) == 2
+            del view
+
+    assert run_in_threads(view_write) == []
+    assert list(obj) == [repeat - 1] * THREAD_COUNT + [1 - repeat] * THREAD_COUNT
+    # All the views have gone so the array is no longer pinned.
+    obj.append(0)
+    assert len(obj) == THREAD_COUNT * 2 + 1
+
+
+@pytest.mark.parametrize('cls', (csublist.cSubList, cppsublist.cppSubList))
+def test_sublist_rwlock_reads(cls):
+    reads_per_thread = 500
+    obj = cls(range(8), rwlock=True)
+
+    def read(thread_index):
+        for i in range(reads_per_thread):
+            assert len(obj) == 8
+            assert obj[i % 8] == i % 8
+            assert (i % 8) in obj
+
+    assert run_in_threads(read) == []
+    assert obj.max() == 7
+    assert obj.lock_shared_acquired == THREAD_COUNT * reads_per_thread * 3 + 1
+    assert obj.lock_shared_contended <= obj.lock_shared_acquired
+
+
+@pytest.mark.parametrize('rwlock', (False, True))
+@pytest.mark.parametrize('cls', (csublist.cSubList, cppsublist.cppSubList))
+def test_sublist_max_and_append(cls, rwlock):
+    obj = cls(range(4), rwlock=rwlock)
+
+    def max_or_append(thread_index):
+        if thread_index == 0:
+            obj.append(100)
+        else:
+            assert obj.max() in (3, 100)
+
+    assert run_in_threads(max_or_append, 4) == []
+    assert obj.max() == 100
+    assert len(obj) == 5
+
+
+def test_logging_log():
+    messages_per_thread = 200
+    cLogging.py_log_set_level(cLogging.CRITICAL)
+    try:
+        def log(thread_index):
+            for i in range(messages_per_thread):
+                assert cLogging.log(cLogging.DEBUG, f'Thread {thread_index} message {i}') is None
+                assert cLogging.log_fastcall(cLogging.DEBUG, f'Thread {thread_index} message {i}') is None
+
+        assert run_in_threads(log) == []
+    finally:
+        cLogging.py_log_set_level(cLogging.WARNING)
+
+
+def test_cppqueue_put_get():
+    items_per_thread = 1_000
+    obj = cppqueue.cppQueue(16)
+    got = []
+
+    def put_or_get(thread_index):
+        for i in range(items_per_thread):
+            if thread_index % 2:
+                obj.put(i)
+            else:
+                got.append(obj.get(timeout=10.0))
+
+    assert run_in_threads(put_or_get) == []
+    assert sorted(got) == sorted(list(range(items_per_thread)) * (THREAD_COUNT // 2))
+    assert obj.empty()
@@ -1,3 +1,4 @@
+import array
 import sys
 
 import pytest
@@ -9,6 +10,7 @@ def test_c_iterator_dir():
     result = dir(cIterator)
     assert result == ['SequenceOfLong',
                       'SequenceOfLongIterator',
+                      'SequenceOfLongRangeIterator',
                       '__doc__',
                       '__file__',
                       '__loader__',
@@ -43,11 +45,19 @@ def test_c_iterator_sequence_of_long_dir_pre_311():
                       '__reduce__',
                       '__reduce_ex__',
                       '__repr__',
+                      '__reversed__',
                       '__setattr__',
                       '__sizeof__',
                       '__str__',
                       '__subclasshook__',
-                      'size']
+                      'clear_intern_cache',
+                      'intern',
+                      'intern_hits',
+                      'intern_misses',
+                      'intern_size',
+                      'iter_stride',
+                      'size',
+                      'split']
 
 
 @pytest.mark.skipif(not (sys.version_info.minor >= 11), reason='Python >= 3.11')
@@ -76,11 +86,19 @@ def test_c_iterator_sequence_of_long_dir_311_plus():
                       '__reduce__',
                       '__reduce_ex__',
                       '__repr__',
+                      '__reversed__',
                       '__setattr__',
                       '__sizeof__',
                       '__str__',
                       '__subclasshook__',
-                      'size']
+                      'clear_intern_cache',
+                      'intern',
+                      'intern_hits',
+                      'intern_misses',
+                      'intern_size',
+                      'iter_stride',
+                      'size',
+                      'split']
 
 
 @pytest.mark.skipif(not (sys.version_info.minor < 11), reason='Python < 3.11')
@@ -100,6 +118,7 @@ def test_c_iterator_sequence_of_long_iterator_dir_pre_311():
                       '__init_subclass__',
                       '__iter__',
                       '__le__',
+                      '__length_hint__',
                       '__lt__',
                       '__ne__',
                       '__new__',
@@ -108,9 +127,12 @@ def test_c_iterator_sequence_of_long_iterator_dir_pre_311():
                       '__reduce_ex__',
                       '__repr__',
                       '__setattr__',
+                      '__setstate__',
                       '__sizeof__',
                       '__str__',
-                      '__subclasshook__']
+                      '__subclasshook__',
+                      'chunks',
+                      'next_chunk']
 
 
 @pytest.mark.skipif(not (sys.version_info.minor >= 11), reason='Python >= 3.11')
@@ -131,6 +153,7 @@ def test_c_iterator_sequence_of_long_iterator_dir_311_plus():
                       '__init_subclass__',
                       '__iter__',
                       '__le__',
+                      '__length_hint__',
                       '__lt__',
                       '__ne__',
                       '__new__',
@@ -139,9 +162,12 @@ def test_c_iterator_sequence_of_long_iterator_dir_311_plus():
                       '__reduce_ex__',
                       '__repr__',
                       '__setattr__',
+                      '__setstate__',
                       '__sizeof__',
                       '__str__',
-                      '__subclasshook__']
+                      '__subclasshook__',
+                      'chunks',
+                      'next_chunk']
 
 
 def test_c_iterator_ctor():
@@ -293,3 +319,403 @@ def test_iterate_and_print_raises(arg, error):
     with pytest.raises(TypeError) as err:
         cIterator.iterate_and_print(arg)
     assert err.value.args[0] == error
+
+
+@pytest.mark.parametrize(
+    'initial_sequence, expected',
+    (
+            ((1, 7, 4, ), [1, 7, 4, ]),
+            (range(3), [0, 1, 2, ]),
+            (b'\x01\x07\x04', [1, 7, 4, ]),
+            (array.array('i', [1, -7, 4, ]), [1, -7, 4, ]),
+            (array.array('l', [1, -7, 4, ]), [1, -7, 4, ]),
+            (memoryview(array.array('q', range(6)))[1::2], [1, 3, 5, ]),
+    )
+)
+def test_c_iterator_ctor_fast_paths(initial_sequence, expected):
+    sequence = cIterator.SequenceOfLong(initial_sequence)
+    assert sequence.size() == len(expected)
+    assert list(sequence) == expected
+
+
+@pytest.mark.parametrize(
+    'initial_sequence, error, message',
+    (
+            ([1, 'a', ], TypeError, 'Argument [1] must be a int, not type str'),
+            (None, TypeError, 'Argument must be a sequence or support the buffer protocol, not type NoneType'),
+    )
+)
+def test_c_iterator_ctor_raises(initial_sequence, error, message):
+    with pytest.raises(error) as err:
+        cIterator.SequenceOfLong(initial_sequence)
+    assert err.value.args[0] == message
+
+
+def test_c_iterator_type_module():
+    assert cIterator.SequenceOfLong.__module__ == 'cPyExtPatt.Iterators.cIterator'
+    assert cIterator.SequenceOfLongIterator.__module__ == 'cPyExtPatt.Iterators.cIterator'
+
+
+@pytest.mark.parametrize(
+    'size, n, expected',
+    (
+            (0, 1, []),
+            (5, 1, [[0], [1], [2], [3], [4], ]),
+            (5, 2, [[0, 1], [2, 3], [4], ]),
+            (5, 5, [[0, 1, 2, 3, 4], ]),
+            (5, 100, [[0, 1, 2, 3, 4], ]),
+    )
+)
+def test_c_iterator_next_chunk(size, n, expected):
+    iterator = iter(cIterator.SequenceOfLong(range(size)))
+    result = []
+    while True:
+        chunk = iterator.next_chunk(n)
+        assert chunk.format == 'l'
+        assert chunk.readonly
+        if not len(chunk):
+            break
+        result.append(chunk.tolist())
+    assert result == expected
+
+
+def test_c_iterator_next_chunk_mixed_with_next():
+    iterator = iter(cIterator.SequenceOfLong([1, 7, 4, 9]))
+    assert next(iterator) == 1
+    assert iterator.next_chunk(2).tolist() == [7, 4]
+    assert next(iterator) == 9
+    with pytest.raises(StopIteration):
+        next(iterator)
+
+
+def test_c_iterator_next_chunk_survives_reinit():
+    sequence = cIterator.SequenceOfLong([1, 7, 4])
+    chunk = iter(sequence).next_chunk(3)
+    sequence.__init__([0])
+    assert chunk.tolist() == [1, 7, 4]
+
+
+@pytest.mark.parametrize('n', (0, -1))
+def test_c_iterator_next_chunk_raises(n):
+    iterator = iter(cIterator.SequenceOfLong([1, 7, 4]))
+    with pytest.raises(ValueError) as err:
+        iterator.next_chunk(n)
+    assert err.value.args[0] == f'Chunk size must be > 0 not {n}'
+
+
+@pytest.mark.parametrize(
+    'size, chunk_size, expected',
+    (
+            (0, 2, []),
+            (5, 2, [[0, 1], [2, 3], [4], ]),
+            (6, 3, [[0, 1, 2], [3, 4, 5], ]),
+    )
+)
+def test_c_iterator_chunks(size, chunk_size, expected):
+    iterator = iter(cIterator.SequenceOfLong(range(size)))
+    result = [chunk.tolist() for chunk in iterator.chunks(chunk_size)]
+    assert result == expected
+    assert list(iterator) == []
+
+
+def test_c_iterator_chunks_raises():
+    iterator = iter(cIterator.SequenceOfLong([1, 7, 4]))
+    with pytest.raises(ValueError) as err:
+        iterator.chunks(0)
+    assert err.value.args[0] == 'Chunk size must be > 0 not 0'
+
+
+def test_c_iterator_length_hint():
+    import operator
+
+    iterator = iter(cIterator.SequenceOfLong([1, 7, 4]))
+    assert operator.length_hint(iterator) == 3
+    next(iterator)
+    assert operator.length_hint(iterator) == 2
+    iterator.next_chunk(5)
+    assert operator.length_hint(iterator) == 0
+
+
+def test_c_iterator_sequence_pickle():
+    import pickle
+
+    sequence = cIterator.SequenceOfLong([1, -7, 4, 2 ** 40])
+    result = pickle.loads(pickle.dumps(sequence))
+    assert type(result) is cIterator.SequenceOfLong
+    assert list(result) == [1, -7, 4, 2 ** 40]
+
+
+def test_c_iterator_sequence_pickle_empty():
+    import pickle
+
+    sequence = cIterator.SequenceOfLong([])
+    result = pickle.loads(pickle.dumps(sequence))
+    assert type(result) is cIterator.SequenceOfLong
+    assert list(result) == []
+    iterator = iter(sequence)
+    assert list(iterator) == []
+    result = pickle.loads(pickle.dumps(iterator))
+    assert type(result) is cIterator.SequenceOfLongIterator
+    assert list(result) == []
+
+
+@pytest.mark.parametrize('advance', (0, 1, 3, 4))
+def test_c_iterator_pickle_mid_stream(advance):
+    import pickle
+
+    values = [1, 7, 4, 9]
+    iterator = iter(cIterator.SequenceOfLong(values))
+    for _i in range(advance):
+        next(iterator)
+    result = pickle.loads(pickle.dumps(iterator))
+    assert type(result) is cIterator.SequenceOfLongIterator
+    assert list(result) == values[advance:]
+    # Original is unaffected.
+    assert list(iterator) == values[advance:]
+
+
+@pytest.mark.parametrize('state, expected', ((-1, [1, 7, 4]), (1, [7, 4]), (10, [])))
+def test_c_iterator_setstate(state, expected):
+    iterator = iter(cIterator.SequenceOfLong([1, 7, 4]))
+    iterator.__setstate__(state)
+    assert list(iterator) == expected
+
+
+def test_c_iterator_uninitialised():
+    import operator
+
+    iterator_type = type(iter(cIterator.SequenceOfLong([])))
+    iterator = iterator_type.__new__(iterator_type)
+    assert operator.length_hint(iterator) == 0
+    message = 'SequenceOfLongIterator has no sequence, it has not been initialised.'
+    for method, args in (
+            (next, ()),
+            (iterator_type.next_chunk, (1,)),
+            (iterator_type.__reduce__, ()),
+            (iterator_type.__setstate__, (0,)),
+    ):
+        with pytest.raises(ValueError) as err:
+            method(iterator, *args)
+        assert err.value.args[0] == message
+    with pytest.raises(ValueError) as err:
+        next(iterator.chunks(1))
+    assert err.value.args[0] == message
+
+
+def test_c_iterator_setstate_raises():
+    iterator = iter(cIterator.SequenceOfLong([1, 7, 4]))
+    with pytest.raises(TypeError) as err:
+        iterator.__setstate__('1')
+    assert err.value.args[0] == 'State must be an int, not type str'
+
+
+def test_c_iterator_getitem_out_of_range():
+    sequence = cIterator.SequenceOfLong([1, 7, 4])
+    assert sequence[-1] == 4
+    with pytest.raises(IndexError) as err:
+        sequence[3]
+    assert err.value.args[0] == 'Index 3 is out of range for length 3'
+
+
+def test_c_iterator_intern_default():
+    sequence = cIterator.SequenceOfLong([1, 7, 4])
+    assert not sequence.intern
+    assert list(sequence) == [1, 7, 4]
+    assert sequence.intern_hits == 0
+    assert sequence.intern_misses == 0
+    assert sequence.intern_size == 0
+
+
+def test_c_iterator_intern_iteration():
+    values = [1000, 2000, 1000, 3000, 2000, 1000]
+    sequence = cIterator.SequenceOfLong(values, intern=True)
+    assert sequence.intern
+    result = list(sequence)
+    assert result == values
+    assert sequence.intern_misses == 3
+    assert sequence.intern_hits == 3
+    assert sequence.intern_size == 3
+    # Repeated values are the same object.
+    assert result[0] is result[2]
+    assert result[1] is result[4]
+
+
+def test_c_iterator_intern_getitem():
+    sequence = cIterator.SequenceOfLong([10 ** 6, 10 ** 6], intern=True)
+    assert sequence[0] is sequence[1]
+    assert sequence[-1] is sequence[0]
+    assert sequence.intern_misses == 1
+    assert sequence.intern_hits == 3
+
+
+def test_c_iterator_intern_many_values():
+    values = list(range(-50_000, 50_000)) * 2
+    sequence = cIterator.SequenceOfLong(values, intern=True)
+    assert list(sequence) == values
+    # The cache is bounded.
+    assert sequence.intern_size == 2 ** 16
+    assert sequence.intern_hits + sequence.intern_misses == len(values)
+
+
+def test_c_iterator_clear_intern_cache():
+    sequence = cIterator.SequenceOfLong([1000, 1000], intern=True)
+    list(sequence)
+    sequence.clear_intern_cache()
+    assert sequence.intern_hits == 0
+    assert sequence.intern_misses == 0
+    assert sequence.intern_size == 0
+    assert list(sequence) == [1000, 1000]
+    assert sequence.intern_size == 1
+
+
+def test_c_iterator_intern_pickle():
+    import pickle
+
+    sequence = cIterator.SequenceOfLong([1000, 1000], intern=True)
+    result = pickle.loads(pickle.dumps(sequence))
+    assert result.intern
+    assert list(result) == [1000, 1000]
+
+
+def test_c_iterator_reversed_type():
+    sequence = cIterator.SequenceOfLong([1, 7, 4])
+    iterator = reversed(sequence)
+    assert type(iterator) is cIterator.SequenceOfLongRangeIterator
+    assert str(iterator) == '<SequenceOfLong range iterator index: 2 step: -1 remaining: 3>'
+    assert list(iterator) == [4, 7, 1]
+    assert list(reversed(cIterator.SequenceOfLong([]))) == []
+
+
+def _start_stop_step(args):
+    """iter_stride() arguments are start, stop, step unlike slice() where a single argument is stop."""
+    return slice(*(tuple(args) + (None, None, None))[:3])
+
+
+@pytest.mark.parametrize(
+    'args',
+    (
+            (),
+            (None, None, None),
+            (2,),
+            (2, 8),
+            (2, 8, 3),
+            (-3,),
+            (None, None, -1),
+            (8, 2, -2),
+            (100, 200),
+            (-100, 100, 7),
+    )
+)
+def test_c_iterator_iter_stride(args):
+    values = list(range(10))
+    sequence = cIterator.SequenceOfLong(values)
+    assert list(sequence.iter_stride(*args)) == values[_start_stop_step(args)]
+    assert list(cIterator.SequenceOfLongRangeIterator(sequence, *args)) == values[_start_stop_step(args)]
+
+
+def test_c_iterator_iter_stride_raises():
+    sequence = cIterator.SequenceOfLong([1, 7, 4])
+    with pytest.raises(ValueError) as err:
+        sequence.iter_stride(0, 3, 0)
+    assert err.value.args[0] == 'slice step cannot be zero'
+
+
+def test_c_iterator_range_iterator_raises():
+    with pytest.raises(ValueError) as err:
+        cIterator.SequenceOfLongRangeIterator([1, 2])
+    assert err.value.args[0] == 'Argument must be a SequenceOfLongType, not type list'
+
+
+def test_c_iterator_iter_stride_length_hint():
+    import operator
+
+    iterator = cIterator.SequenceOfLong(range(10)).iter_stride(1, None, 3)
+    assert operator.length_hint(iterator) == 3
+    next(iterator)
+    assert operator.length_hint(iterator) == 2
+
+
+def test_c_iterator_iter_stride_sequence_reinit():
+    sequence = cIterator.SequenceOfLong(range(10))
+    iterator = sequence.iter_stride()
+    assert next(iterator) == 0
+    sequence.__init__([5, 6])
+    assert list(iterator) == [6]
+
+
+@pytest.mark.parametrize('size', (0, 1, 7, 10, 100))
+@pytest.mark.parametrize('n', (1, 2, 3, 8))
+def test_c_iterator_split(size, n):
+    values = list(range(size))
+    sequence = cIterator.SequenceOfLong(values)
+    iterators = sequence.split(n)
+    assert len(iterators) == n
+    parts = [list(iterator) for iterator in iterators]
+    assert [v for part in parts for v in part] == values
+    lengths = [len(part) for part in parts]
+    assert max(lengths) - min(lengths) <= 1
+
+
+def test_c_iterator_split_raises():
+    with pytest.raises(ValueError) as err:
+        cIterator.SequenceOfLong([1, 7, 4]).split(0)
+    assert err.value.args[0] == 'Number of splits must be > 0 not 0'
+
+
+def test_c_iterator_split_threads():
+    import concurrent.futures
+
+    values = list(range(10_000))
+    sequence = cIterator.SequenceOfLong(values)
+    with concurrent.futures.ThreadPoolExecutor(max_workers=4) as executor:
+        result = sum(executor.map(sum, sequence.split(4)))
+    assert result == sum(values)
+
+
+@pytest.mark.parametrize('args', ((), (None, None, -1), (1, 9, 2), (8, None, -3)))
+@pytest.mark.parametrize('advance', (0, 1, 2))
+def test_c_iterator_range_iterator_pickle(args, advance):
+    import pickle
+
+    values = list(range(10))
+    iterator = cIterator.SequenceOfLong(values).iter_stride(*args)
+    for _i in range(advance):
+        next(iterator)
+    result = pickle.loads(pickle.dumps(iterator))
+    assert list(result) == values[_start_stop_step(args)][advance:]
+
+
+@pytest.mark.parametrize('step', (sys.maxsize, -sys.maxsize))
+def test_c_iterator_range_iterator_large_step(step):
+    import pickle
+
+    iterator = cIterator.SequenceOfLong([1, 7, 4]).iter_stride(1, None, step)
+    result = pickle.loads(pickle.dumps(iterator))
+    assert list(result) == [7]
+    assert next(iterator) == 7
+    assert list(pickle.loads(pickle.dumps(iterator))) == []
+    assert list(iterator) == []
+
+
+def test_c_iterator_vectorcall_keywords():
+    sequence = cIterator.SequenceOfLong(sequence=[1, 2, 3, ], intern=True)
+    assert list(sequence) == [1, 2, 3, ]
+    assert sequence.intern
+
+
+def test_c_iterator_vectorcall_raises():
+    with pytest.raises(TypeError) as err:
+        cIterator.SequenceOfLong()
+    assert err.value.args[0] == "SequenceOfLong() missing required argument 'sequence' (pos 1)"
+
+
+def test_c_iterator_subclass_init():
+    """tp_vectorcall is not inherited so a subclass goes through tp_new and tp_init."""
+
+    class SubClass(cIterator.SequenceOfLong):
+        pass
+
+    sequence = SubClass([1, 2, 3, ], intern=True)
+    assert type(sequence) is SubClass
+    assert len(sequence) == 3
+    assert sequence.intern
@@ -39,6 +39,7 @@ def test_c_logging_dir():
         '__spec__',
         'c_file_line_function',
         'log',
+        'log_fastcall',
         'py_file_line_function',
         'py_log_set_level',
     ]
@@ -51,10 +52,32 @@ def test_c_logging_log():
     assert result is None
 
 
+def test_c_logging_log_fastcall():
+    cLogging.py_log_set_level(10)
+    result = cLogging.log_fastcall(cLogging.ERROR, "Test log message")
+    assert result is None
+    result = cLogging.log_fastcall(message="Test log message", level=cLogging.ERROR)
+    assert result is None
+
+
+@pytest.mark.parametrize(
+    'args, kwargs, expected',
+    (
+            ((), {}, "log_fastcall() missing required argument 'level' (pos 1)"),
+            ((cLogging.ERROR,), {}, "log_fastcall() missing required argument 'message' (pos 2)"),
+            ((cLogging.ERROR, 123), {}, "message must be str, not int"),
+    )
+)
+def test_c_logging_log_fastcall_raises(args, kwargs, expected):
+    with pytest.raises(TypeError) as err:
+        cLogging.log_fastcall(*args, **kwargs)
+    assert err.value.args[0] == expected
+
+
 def test_c_file_line_function_file():
     file, line, function = cLogging.c_file_line_function()
     assert file == 'src/cpy/Logging/cLogging.c'
-    assert line == 143
+    assert line == 175
     assert function == 'c_file_line_function'
 
 
@@ -65,7 +88,7 @@ def test_py_file_line_function_file():
 
 def test_py_file_line_function_line():
     _file, line, _function = cLogging.py_file_line_function()
-    assert line == 67
+    assert line == 90
 
 
 def test_py_file_line_function_function():
@@ -7,7 +7,7 @@ from cPyExtPatt import cParseArgs
 
 def test_module_dir():
     assert dir(cParseArgs) == ['__doc__', '__file__', '__loader__', '__name__', '__package__', '__spec__', 'parse_args',
-                               'parse_args_kwargs', 'parse_args_with_function_conversion_to_c',
+                               'parse_args_fastcall', 'parse_args_kwargs', 'parse_args_with_function_conversion_to_c',
                                'parse_args_with_immutable_defaults', 'parse_args_with_mutable_defaults',
                                'parse_default_bytes_object',
                                'parse_no_args', 'parse_one_arg', 'parse_pos_only_kwd_only', ]
@@ -437,3 +437,39 @@ def test_parse_args_with_function_conversion_to_c_raises(arg, expected):
     with pytest.raises(TypeError) as err:
         cParseArgs.parse_args_with_function_conversion_to_c(arg)
     assert err.value.args[0] == expected
+
+
+@pytest.mark.parametrize(
+    'args, kwargs, expected',
+    (
+            ((b'bytes', 123), {}, (b'bytes', 123, 'default_string')),
+            ((b'bytes', 123, 'local_string'), {}, (b'bytes', 123, 'local_string')),
+            ((b'bytes',), {'b': 123}, (b'bytes', 123, 'default_string')),
+            ((b'bytes', 123), {'c': 'local_string'}, (b'bytes', 123, 'local_string')),
+            ((), {'c': 'local_string', 'b': 123, 'a': b'bytes'}, (b'bytes', 123, 'local_string')),
+    )
+)
+def test_parse_args_fastcall(args, kwargs, expected):
+    assert cParseArgs.parse_args_fastcall(*args, **kwargs) == expected
+
+
+@pytest.mark.parametrize(
+    'args, kwargs, expected',
+    (
+            # Number of arguments.
+            ((), {}, "parse_args_fastcall() missing required argument 'a' (pos 1)"),
+            ((b'bytes',), {}, "parse_args_fastcall() missing required argument 'b' (pos 2)"),
+            ((b'bytes', 123, 'str', 7), {}, 'parse_args_fastcall() takes at most 3 positional arguments (4 given)'),
+            ((b'bytes', 123), {'d': 7}, "parse_args_fastcall() got an unexpected keyword argument 'd'"),
+            ((b'bytes', 123), {'a': b'bytes'},
+             "argument for parse_args_fastcall() given by name ('a') and position (1)"),
+            # Type of arguments.
+            (('str', 456), {}, 'argument 1 must be bytes, not str'),
+            ((b'bytes', 456, 456), {}, 'argument 3 must be str, not int'),
+            ((b'bytes', 456.0), {}, "'float' object cannot be interpreted as an integer"),
+    )
+)
+def test_parse_args_fastcall_raises(args, kwargs, expected):
+    with pytest.raises(TypeError) as err:
+        cParseArgs.parse_args_fastcall(*args, **kwargs)
+    assert err.value.args[0] == expected
@@ -0,0 +1,261 @@
+import gc
+import queue
+import sys
+import threading
+import time
+
+import pytest
+
+from cPyExtPatt.Threads import cppqueue
+
+
+def test_cppqueue_dir():
+    result = dir(cppqueue)
+    assert result == ['__doc__',
+                      '__file__',
+                      '__loader__',
+                      '__name__',
+                      '__package__',
+                      '__spec__',
+                      'cppQueue',
+                      ]
+
+
+def test_cppqueue_cppqueue_dir():
+    result = [name for name in dir(cppqueue.cppQueue) if not name.startswith('__')]
+    assert result == [
+        'empty',
+        'full',
+        'get',
+        'get_many',
+        'get_nowait',
+        'maxsize',
+        'put',
+        'put_many',
+        'put_nowait',
+        'qsize',
+    ]
+
+
+@pytest.mark.parametrize('maxsize', (1, 2, 3, 1024))
+def test_cppqueue_ctor(maxsize):
+    obj = cppqueue.cppQueue(maxsize)
+    assert obj.maxsize == maxsize
+    assert obj.qsize() == 0
+    assert len(obj) == 0
+    assert obj.empty()
+    assert not obj.full()
+
+
+@pytest.mark.parametrize('maxsize', (0, -1))
+def test_cppqueue_ctor_raises(maxsize):
+    with pytest.raises(ValueError) as err:
+        cppqueue.cppQueue(maxsize)
+    assert err.value.args[0] == f'maxsize must be >= 1 not {maxsize}.'
+
+
+def test_cppqueue_reinit_raises():
+    obj = cppqueue.cppQueue(4)
+    with pytest.raises(RuntimeError) as err:
+        obj.__init__(4)
+    assert err.value.args[0] == 'cppQueue can not be re-initialised.'
+
+
+def test_cppqueue_not_initialised_raises():
+    obj = cppqueue.cppQueue.__new__(cppqueue.cppQueue)
+    with pytest.raises(ValueError) as err:
+        obj.get_nowait()
+    assert err.value.args[0] == 'cppQueue has not been initialised.'
+
+
+@pytest.mark.parametrize('maxsize', (1, 2, 3, 7))
+def test_cppqueue_fifo(maxsize):
+    """Put and get more items than the capacity so the ring wraps around."""
+    obj = cppqueue.cppQueue(maxsize)
+    result = []
+    for i in range(maxsize * 5):
+        obj.put(i)
+        if obj.full():
+            while not obj.empty():
+                result.append(obj.get())
+    while not obj.empty():
+        result.append(obj.get())
+    assert result == list(range(maxsize * 5))
+
+
+def test_cppqueue_put_nowait_full():
+    obj = cppqueue.cppQueue(2)
+    obj.put_nowait('a')
+    obj.put_nowait('b')
+    assert obj.full()
+    with pytest.raises(queue.Full):
+        obj.put_nowait('c')
+    with pytest.raises(queue.Full):
+        obj.put('c', block=False)
+    assert obj.qsize() == 2
+
+
+def test_cppqueue_get_nowait_empty():
+    obj = cppqueue.cppQueue(2)
+    with pytest.raises(queue.Empty):
+        obj.get_nowait()
+    with pytest.raises(queue.Empty):
+        obj.get(False)
+
+
+def test_cppqueue_get_timeout():
+    obj = cppqueue.cppQueue(2)
+    start = time.monotonic()
+    with pytest.raises(queue.Empty):
+        obj.get(timeout=0.1)
+    assert time.monotonic() - start >= 0.09
+
+
+def test_cppqueue_put_timeout():
+    obj = cppqueue.cppQueue(1)
+    obj.put(1)
+    start = time.monotonic()
+    with pytest.raises(queue.Full):
+        obj.put(2, timeout=0.1)
+    assert time.monotonic() - start >= 0.09
+    assert obj.get() == 1
+
+
+def test_cppqueue_timeout_raises():
+    obj = cppqueue.cppQueue(1)
+    with pytest.raises(ValueError) as err:
+        obj.get(timeout=-1)
+    assert err.value.args[0] == "'timeout' must be a non-negative number"
+
+
+def test_cppqueue_refcount():
+    obj = cppqueue.cppQueue(4)
+    value = object()
+    ref_count = sys.getrefcount(value)
+    obj.put(value)
+    assert sys.getrefcount(value) == ref_count + 1
+    assert obj.put_many([value] * 4, block=False) == 3
+    assert sys.getrefcount(value) == ref_count + 4
+    with pytest.raises(queue.Full):
+        obj.put_nowait(value)
+    assert sys.getrefcount(value) == ref_count + 4
+    del obj
+    assert sys.getrefcount(value) == ref_count
+
+
+def test_cppqueue_cycle_is_collected():
+    obj = cppqueue.cppQueue(2)
+    obj.put(obj)
+    del obj
+    assert gc.collect() > 0
+
+
+def test_cppqueue_get_blocks_until_put():
+    obj = cppqueue.cppQueue(2)
+
+    def put_later():
+        time.sleep(0.05)
+        obj.put('value')
+
+    thread = threading.Thread(target=put_later)
+    thread.start()
+    assert obj.get(timeout=5.0) == 'value'
+    thread.join()
+
+
+def test_cppqueue_put_blocks_until_get():
+    obj = cppqueue.cppQueue(1)
+    obj.put('first')
+
+    def get_later():
+        time.sleep(0.05)
+        assert obj.get() == 'first'
+
+    thread = threading.Thread(target=get_later)
+    thread.start()
+    obj.put('second', timeout=5.0)
+    thread.join()
+    assert obj.get_nowait() == 'second'
+
+
+def test_cppqueue_put_many():
+    obj = cppqueue.cppQueue(8)
+    assert obj.put_many(range(5)) == 5
+    assert obj.qsize() == 5
+    assert obj.put_many(iter(range(5, 10)), block=False) == 3
+    assert obj.full()
+    assert obj.put_many([10, 11], timeout=0.01) == 0
+    assert obj.get_many(100) == list(range(8))
+
+
+def test_cppqueue_put_many_raises():
+    obj = cppqueue.cppQueue(8)
+    with pytest.raises(TypeError):
+        obj.put_many(42)
+
+
+def test_cppqueue_get_many():
+    obj = cppqueue.cppQueue(8)
+    obj.put_many(range(6))
+    assert obj.get_many(4) == [0, 1, 2, 3]
+    assert obj.get_many(max_items=4) == [4, 5]
+    with pytest.raises(queue.Empty):
+        obj.get_many(4, block=False)
+    with pytest.raises(queue.Empty):
+        obj.get_many(4, timeout=0.01)
+
+
+def test_cppqueue_get_many_raises():
+    obj = cppqueue.cppQueue(8)
+    with pytest.raises(ValueError) as err:
+        obj.get_many(0)
+    assert err.value.args[0] == 'max_items must be >= 1 not 0.'
+
+
+@pytest.mark.parametrize('maxsize', (1, 16))
+@pytest.mark.parametrize('producers, consumers', ((1, 1), (4, 1), (1, 4), (4, 4)))
+def test_cppqueue_producers_consumers(maxsize, producers, consumers):
+    """Every item put by the producers is got exactly once by the consumers."""
+    items_per_producer = 2_000
+    obj = cppqueue.cppQueue(maxsize)
+    results = [[] for _i in range(consumers)]
+    sentinel = object()
+
+    def produce(index):
+        base = index * items_per_producer
+        if index % 2:
+            obj.put_many(range(base, base + items_per_producer))
+        else:
+            for i in range(base, base + items_per_producer):
+                obj.put(i)
+
+    def consume(index):
+        while True:
+            if index % 2:
+                items = obj.get_many(8)
+            else:
+                items = [obj.get()]
+            sentinels = sum(1 for item in items if item is sentinel)
+            results[index].extend(item for item in items if item is not sentinel)
+            if sentinels:
+                # get_many() might have taken the sentinels of other consumers.
+                obj.put_many([sentinel] * (sentinels - 1))
+                return
+
+    consumer_threads = [threading.Thread(target=consume, args=(i,)) for i in range(consumers)]
+    producer_threads = [threading.Thread(target=produce, args=(i,)) for i in range(producers)]
+    for thread in consumer_threads + producer_threads:
+        thread.start()
+    for thread in producer_threads:
+        thread.join()
+    for _i in range(consumers):
+        obj.put(sentinel)
+    for thread in consumer_threads:
+        thread.join()
+    assert sorted(sum(results, [])) == list(range(producers * items_per_producer))
+    # Each consumer sees the items from each producer in order.
+    for result in results:
+        for producer in range(producers):
+            from_producer = [v for v in result if v // items_per_producer == producer]
+            assert from_producer == sorted(from_producer)
+    assert obj.empty()
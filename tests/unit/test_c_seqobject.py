@@ -1,3 +1,6 @@
+import array
+import random
+import struct
 import sys
 
 import pytest
@@ -6,8 +9,8 @@ from cPyExtPatt import cSeqObject
 
 
 def test_module_dir():
-    assert dir(cSeqObject) == ['SequenceLongObject', '__doc__', '__file__', '__loader__', '__name__',
-                               '__package__', '__spec__', ]
+    assert dir(cSeqObject) == ['SequenceLongObject', 'SequenceLongView', '__doc__', '__file__', '__loader__', '__name__',
+                               '__package__', '__spec__', 'set_simd_level', 'simd_level', ]
 
 
 @pytest.mark.skipif(not (sys.version_info.minor < 11), reason='Python < 3.11')
@@ -28,6 +31,8 @@ def test_SequenceLongObject_dir_pre_311():
         '__getitem__',
         '__gt__',
         '__hash__',
+        '__iadd__',
+        '__imul__',
         '__init__',
         '__init_subclass__',
         '__le__',
@@ -45,11 +50,26 @@ def test_SequenceLongObject_dir_pre_311():
         '__sizeof__',
         '__str__',
         '__subclasshook__',
+        'append',
+        'argmax',
+        'argmin',
+        'capacity',
+        'contains_many',
+        'count',
+        'dot',
+        'extend',
+        'is_sorted',
+        'max',
+        'min',
+        'reserve',
+        'shrink_to_fit',
+        'sort',
+        'sum',
     ]
 
 
-@pytest.mark.skipif(not (sys.version_info.minor >= 11), reason='Python >= 3.11')
-def test_SequenceLongObject_dir_311_plus():
+@pytest.mark.skipif(not (sys.version_info.minor == 11), reason='Python 3.11')
+def test_SequenceLongObject_dir_311():
     result = dir(cSeqObject.SequenceLongObject)
     assert result == [
         '__add__',
@@ -67,6 +87,8 @@ def test_SequenceLongObject_dir_311_plus():
         '__getstate__',  # New
         '__gt__',
         '__hash__',
+        '__iadd__',
+        '__imul__',
         '__init__',
         '__init_subclass__',
         '__le__',
@@ -84,6 +106,79 @@ def test_SequenceLongObject_dir_311_plus():
         '__sizeof__',
         '__str__',
         '__subclasshook__',
+        'append',
+        'argmax',
+        'argmin',
+        'capacity',
+        'contains_many',
+        'count',
+        'dot',
+        'extend',
+        'is_sorted',
+        'max',
+        'min',
+        'reserve',
+        'shrink_to_fit',
+        'sort',
+        'sum',
+    ]
+
+
+@pytest.mark.skipif(not (sys.version_info.minor >= 12), reason='Python >= 3.12')
+def test_SequenceLongObject_dir_312_plus():
+    result = dir(cSeqObject.SequenceLongObject)
+    assert result == [
+        '__add__',
+        '__buffer__',  # New
+        '__class__',
+        '__contains__',
+        '__delattr__',
+        '__delitem__',
+        '__dir__',
+        '__doc__',
+        '__eq__',
+        '__format__',
+        '__ge__',
+        '__getattribute__',
+        '__getitem__',
+        '__getstate__',
+        '__gt__',
+        '__hash__',
+        '__iadd__',
+        '__imul__',
+        '__init__',
+        '__init_subclass__',
+        '__le__',
+        '__len__',
+        '__lt__',
+        '__mul__',
+        '__ne__',
+        '__new__',
+        '__reduce__',
+        '__reduce_ex__',
+        '__release_buffer__',  # New
+        '__repr__',
+        '__rmul__',
+        '__setattr__',
+        '__setitem__',
+        '__sizeof__',
+        '__str__',
+        '__subclasshook__',
+        'append',
+        'argmax',
+        'argmin',
+        'capacity',
+        'contains_many',
+        'count',
+        'dot',
+        'extend',
+        'is_sorted',
+        'max',
+        'min',
+        'reserve',
+        'shrink_to_fit',
+        'sort',
+        'sum',
     ]
 
 
@@ -347,3 +442,695 @@ def test_SequenceLongObject_repeat_inplace(initial_sequence, count, expected):
     obj *= count
     assert list(obj) == expected
     assert list(obj) == (initial_sequence * count)
+
+
+def test_SequenceLongObject_buffer_memoryview():
+    obj = cSeqObject.SequenceLongObject([7, 4, 1, ])
+    view = memoryview(obj)
+    assert view.format == 'l'
+    assert view.itemsize == struct.calcsize('l')
+    assert view.ndim == 1
+    assert view.shape == (3,)
+    assert view.strides == (struct.calcsize('l'),)
+    assert view.c_contiguous
+    assert not view.readonly
+    assert view.tolist() == [7, 4, 1, ]
+    view.release()
+
+
+def test_SequenceLongObject_buffer_empty():
+    obj = cSeqObject.SequenceLongObject([])
+    with memoryview(obj) as view:
+        assert view.shape == (0,)
+        assert view.tolist() == []
+        assert view.nbytes == 0
+
+
+def test_SequenceLongObject_buffer_write_through():
+    obj = cSeqObject.SequenceLongObject([7, 4, 1, ])
+    with memoryview(obj) as view:
+        view[1] = -42
+    assert list(obj) == [7, -42, 1, ]
+
+
+def test_SequenceLongObject_buffer_struct_and_array():
+    values = [7, -4, 2**62, -2**62, ]
+    obj = cSeqObject.SequenceLongObject(values)
+    assert list(struct.unpack(f'{len(values)}l', obj)) == values
+    arr = array.array('l')
+    arr.frombytes(memoryview(obj).cast('B'))
+    assert arr.tolist() == values
+    assert bytes(obj) == array.array('l', values).tobytes()
+
+
+@pytest.mark.parametrize(
+    'index',
+    (0, -1, ),
+)
+def test_SequenceLongObject_buffer_delitem_raises_while_exported(index):
+    obj = cSeqObject.SequenceLongObject([7, 4, 1, ])
+    view = memoryview(obj)
+    with pytest.raises(BufferError) as err:
+        del obj[index]
+    assert err.value.args[0] == 'Existing exports of data (1): object cannot be re-sized'
+    assert list(obj) == [7, 4, 1, ]
+    view.release()
+    del obj[index]
+    assert len(obj) == 2
+
+
+def test_SequenceLongObject_buffer_init_raises_while_exported():
+    obj = cSeqObject.SequenceLongObject([7, 4, 1, ])
+    with memoryview(obj):
+        with pytest.raises(BufferError):
+            obj.__init__([1, 2, 3, 4, ])
+        assert list(obj) == [7, 4, 1, ]
+    obj.__init__([1, 2, 3, 4, ])
+    assert list(obj) == [1, 2, 3, 4, ]
+
+
+@pytest.mark.parametrize(
+    'initial_sequence, expected',
+    (
+            ([7, 4, 1, ], [7, 4, 1, ]),
+            ((7, 4, 1, ), [7, 4, 1, ]),
+            (range(4), [0, 1, 2, 3, ]),
+            (b'\x00\x01\xff', [0, 1, 255, ]),
+            (bytearray(b'\x00\x01\xff'), [0, 1, 255, ]),
+            (array.array('b', [-128, 0, 127, ]), [-128, 0, 127, ]),
+            (array.array('B', [0, 1, 255, ]), [0, 1, 255, ]),
+            (array.array('h', [-2 ** 15, 2 ** 15 - 1, ]), [-2 ** 15, 2 ** 15 - 1, ]),
+            (array.array('H', [2 ** 16 - 1, ]), [2 ** 16 - 1, ]),
+            (array.array('i', [-2 ** 31, 2 ** 31 - 1, ]), [-2 ** 31, 2 ** 31 - 1, ]),
+            (array.array('I', [2 ** 32 - 1, ]), [2 ** 32 - 1, ]),
+            (array.array('l', [-2 ** 63, 2 ** 63 - 1, ]), [-2 ** 63, 2 ** 63 - 1, ]),
+            (array.array('L', [2 ** 63 - 1, ]), [2 ** 63 - 1, ]),
+            (array.array('q', [-2 ** 63, 2 ** 63 - 1, ]), [-2 ** 63, 2 ** 63 - 1, ]),
+            (array.array('Q', [2 ** 63 - 1, ]), [2 ** 63 - 1, ]),
+            (array.array('l', []), []),
+            (memoryview(array.array('l', range(8)))[::3], [0, 3, 6, ]),
+            (memoryview(array.array('h', range(8)))[::-2], [7, 5, 3, 1, ]),
+    ),
+)
+def test_SequenceLongObject_init_fast_paths(initial_sequence, expected):
+    obj = cSeqObject.SequenceLongObject(initial_sequence)
+    assert len(obj) == len(expected)
+    assert list(obj) == expected
+
+
+def test_SequenceLongObject_init_from_SequenceLongObject():
+    obj_a = cSeqObject.SequenceLongObject([7, 4, 1, ])
+    obj_b = cSeqObject.SequenceLongObject(obj_a)
+    assert list(obj_b) == [7, 4, 1, ]
+    # A copy, not a view.
+    obj_a[0] = 100
+    assert list(obj_b) == [7, 4, 1, ]
+
+
+@pytest.mark.parametrize(
+    'initial_sequence, error, message',
+    (
+            (
+                    [7, 4.0, 1, ],
+                    TypeError,
+                    'Argument [1] must be a int, not type float',
+            ),
+            (
+                    array.array('d', [7.0, ]),
+                    TypeError,
+                    'Argument [0] must be a int, not type float',
+            ),
+            (
+                    42,
+                    TypeError,
+                    'Argument must be a sequence or support the buffer protocol, not type int',
+            ),
+            (
+                    [2 ** 64, ],
+                    OverflowError,
+                    'Python int too large to convert to C long',
+            ),
+            (
+                    array.array('Q', [1, 2 ** 64 - 1, ]),
+                    OverflowError,
+                    "Argument [1] with buffer format 'Q' is too large to convert to C long",
+            ),
+    ),
+)
+def test_SequenceLongObject_init_raises(initial_sequence, error, message):
+    with pytest.raises(error) as err:
+        cSeqObject.SequenceLongObject(initial_sequence)
+    assert err.value.args[0] == message
+
+
+SIMD_LEVELS = [level for level in ('scalar', 'avx2') if level == 'scalar' or cSeqObject.simd_level() == level]
+
+LONG_MIN = -2 ** (8 * struct.calcsize('l') - 1)
+LONG_MAX = 2 ** (8 * struct.calcsize('l') - 1) - 1
+
+
+def reduction_test_sequences():
+    """A range of sequences that exercise SIMD loop remainders, extreme values and the GIL release threshold."""
+    rng = random.Random(1234)
+    ret = []
+    for length in range(1, 11):
+        ret.append([rng.randint(-100, 100) for _i in range(length)])
+    ret.append([LONG_MAX] * 9)
+    ret.append([LONG_MIN] * 9)
+    ret.append([LONG_MIN, LONG_MAX] * 5)
+    ret.append([rng.randint(LONG_MIN, LONG_MAX) for _i in range(1001)])
+    ret.append([rng.randint(-5, 5) for _i in range(2 ** 16 + 3)])
+    return ret
+
+
+@pytest.mark.parametrize('simd_level', SIMD_LEVELS)
+@pytest.mark.parametrize('values', reduction_test_sequences())
+def test_SequenceLongObject_reductions(values, simd_level):
+    previous = cSeqObject.set_simd_level(simd_level)
+    try:
+        obj = cSeqObject.SequenceLongObject(values)
+        assert obj.sum() == sum(values)
+        assert obj.min() == min(values)
+        assert obj.max() == max(values)
+        assert obj.argmin() == values.index(min(values))
+        assert obj.argmax() == values.index(max(values))
+        assert obj.count(values[-1]) == values.count(values[-1])
+        assert obj.count(LONG_MAX + 1) == 0
+        assert obj.count('a') == 0
+        assert obj.dot(obj) == sum(v * v for v in values)
+    finally:
+        cSeqObject.set_simd_level(previous)
+
+
+def test_SequenceLongObject_reductions_empty():
+    obj = cSeqObject.SequenceLongObject([])
+    assert obj.sum() == 0
+    assert obj.count(0) == 0
+    assert obj.dot(obj) == 0
+    for name in ('min', 'max', 'argmin', 'argmax'):
+        with pytest.raises(ValueError) as err:
+            getattr(obj, name)()
+        assert err.value.args[0] == f'{name[-3:]}() on empty sequence.'
+
+
+@pytest.mark.parametrize(
+    'values_a, values_b, expected',
+    (
+            ([1, 2, 3, ], [4, 5, 6, ], 32),
+            ([LONG_MAX, LONG_MAX, ], [2, -1, ], 2 * LONG_MAX - LONG_MAX),
+            ([LONG_MAX, LONG_MAX, ], [LONG_MAX, LONG_MAX, ], 2 * LONG_MAX ** 2),
+            ([LONG_MIN, ], [-1, ], -LONG_MIN),
+    )
+)
+def test_SequenceLongObject_dot(values_a, values_b, expected):
+    obj_a = cSeqObject.SequenceLongObject(values_a)
+    obj_b = cSeqObject.SequenceLongObject(values_b)
+    assert obj_a.dot(obj_b) == expected
+
+
+@pytest.mark.parametrize(
+    'other, error, message',
+    (
+            ([1, 2, 3, ], TypeError, 'dot() argument must have type "SequenceLongObject" not list'),
+            (cSeqObject.SequenceLongObject([1, 2, ]), ValueError, 'dot() sequences must be the same length, not 3 and 2'),
+    )
+)
+def test_SequenceLongObject_dot_raises(other, error, message):
+    obj = cSeqObject.SequenceLongObject([1, 2, 3, ])
+    with pytest.raises(error) as err:
+        obj.dot(other)
+    assert err.value.args[0] == message
+
+
+def test_SequenceLongObject_set_simd_level_raises():
+    with pytest.raises(ValueError) as err:
+        cSeqObject.set_simd_level('avx1024')
+    assert err.value.args[0] == 'Unknown SIMD level "avx1024".'
+
+
+@pytest.mark.parametrize(
+    'key',
+    (
+            slice(None), slice(1, None), slice(None, -1), slice(2, 5), slice(None, None, 2), slice(1, None, 3),
+            slice(None, None, -1), slice(-2, 1, -2), slice(5, 2), slice(100, 200), slice(-100, 100, 4),
+    )
+)
+def test_SequenceLongObject_slice(key):
+    values = list(range(10))
+    obj = cSeqObject.SequenceLongObject(values)
+    view = obj[key]
+    assert type(view) == cSeqObject.SequenceLongView
+    assert view.base is obj
+    assert len(view) == len(values[key])
+    assert list(view) == values[key]
+    assert list(view.copy()) == values[key]
+    assert memoryview(view).tolist() == values[key]
+
+
+@pytest.mark.parametrize(
+    'key_a, key_b',
+    (
+            (slice(2, 9), slice(1, 4)),
+            (slice(None, None, 2), slice(None, None, -1)),
+            (slice(None, None, -3), slice(1, None, 2)),
+            (slice(8, 1, -1), slice(100, None)),
+            # A large step of a view with a step, at most one value so the composed step is not used.
+            (slice(None, None, 2), slice(None, None, sys.maxsize)),
+            (slice(None, None, -3), slice(1, None, -sys.maxsize)),
+            (slice(None, None, 3), slice(5, None, sys.maxsize)),
+    )
+)
+def test_SequenceLongView_slice(key_a, key_b):
+    values = list(range(10))
+    obj = cSeqObject.SequenceLongObject(values)
+    view = obj[key_a][key_b]
+    assert view.base is obj
+    assert list(view) == values[key_a][key_b]
+
+
+def test_SequenceLongView_shares_values():
+    obj = cSeqObject.SequenceLongObject([0, 1, 2, 3, 4, 5, ])
+    view = obj[1::2]
+    assert str(view) == '<SequenceLongView size: 3 start: 1 step: 2>'
+    view[0] = 10
+    view[-1] = 50
+    assert list(obj) == [0, 10, 2, 3, 4, 50, ]
+    obj[3] = 30
+    assert list(view) == [10, 30, 50, ]
+    view[1:] = [300, 500, ]
+    assert list(obj) == [0, 10, 2, 300, 4, 500, ]
+    copy = view.copy()
+    copy[0] = -1
+    assert list(obj) == [0, 10, 2, 300, 4, 500, ]
+
+
+def test_SequenceLongView_pins_base():
+    obj = cSeqObject.SequenceLongObject([0, 1, 2, 3, ])
+    view = obj[1:]
+    with pytest.raises(BufferError) as err:
+        del obj[0]
+    assert err.value.args[0] == 'Existing exports of data (1): object cannot be re-sized'
+    with pytest.raises(BufferError):
+        obj[1:] = [7, ]
+    # Same length slice assignment does not re-size.
+    obj[1:3] = [7, 8, ]
+    assert list(view) == [7, 8, 3, ]
+    del view
+    del obj[0]
+    assert list(obj) == [7, 8, 3, ]
+
+
+@pytest.mark.parametrize(
+    'key, error, message',
+    (
+            (3, IndexError, 'Index 3 is out of range for length 3'),
+            ('a', TypeError, 'SequenceLongView indices must be integers or slices, not str'),
+    )
+)
+def test_SequenceLongView_item_raises(key, error, message):
+    obj = cSeqObject.SequenceLongObject([0, 1, 2, 3, 4, 5, ])
+    view = obj[::2]
+    with pytest.raises(error) as err:
+        view[key]
+    assert err.value.args[0] == message
+
+
+def test_SequenceLongView_resize_raises():
+    obj = cSeqObject.SequenceLongObject([0, 1, 2, 3, 4, 5, ])
+    view = obj[::2]
+    with pytest.raises(TypeError) as err:
+        del view[0]
+    assert err.value.args[0] == 'SequenceLongView values can not be deleted'
+    with pytest.raises(ValueError) as err:
+        view[:] = [1, 2, ]
+    assert err.value.args[0] == (
+        'SequenceLongView can not be re-sized, attempt to assign sequence of size 2 to slice of size 3'
+    )
+
+
+def test_SequenceLongView_buffer_strides():
+    obj = cSeqObject.SequenceLongObject([0, 1, 2, 3, ])
+    view = memoryview(obj[::-2])
+    assert not view.c_contiguous
+    assert view.strides == (-2 * struct.calcsize('l'),)
+    assert bytes(view) == struct.pack('2l', 3, 1)
+    assert memoryview(obj[1:3]).c_contiguous
+
+
+@pytest.mark.parametrize(
+    'key',
+    (
+            slice(None), slice(1, 3), slice(None, None, 2), slice(None, None, -3), slice(7, 1, -2), slice(5, 2),
+    )
+)
+def test_SequenceLongObject_del_slice(key):
+    values = list(range(8))
+    obj = cSeqObject.SequenceLongObject(values)
+    del values[key]
+    del obj[key]
+    assert list(obj) == values
+
+
+@pytest.mark.parametrize(
+    'key, value',
+    (
+            (slice(1, 3), [10, 20, ]),
+            (slice(1, 3), [10, 20, 30, 40, ]),
+            (slice(1, 3), []),
+            (slice(None), [9, ]),
+            (slice(5, 2), [9, 9, ]),
+            (slice(None, None, 2), [10, 20, 30, 40, ]),
+            (slice(None, None, -3), [10, 20, 30, ]),
+            (slice(1, 3), array.array('h', [-1, -2, -3])),
+    )
+)
+def test_SequenceLongObject_ass_slice(key, value):
+    values = list(range(8))
+    obj = cSeqObject.SequenceLongObject(values)
+    values[key] = value
+    obj[key] = value
+    assert list(obj) == values
+
+
+def test_SequenceLongObject_ass_slice_from_self():
+    obj = cSeqObject.SequenceLongObject([0, 1, 2, 3, ])
+    obj[1:] = obj[:3].copy()
+    assert list(obj) == [0, 0, 1, 2, ]
+
+
+def test_SequenceLongObject_ass_slice_raises():
+    obj = cSeqObject.SequenceLongObject(list(range(8)))
+    with pytest.raises(ValueError) as err:
+        obj[::2] = [1, 2, ]
+    assert err.value.args[0] == 'attempt to assign sequence of size 2 to extended slice of size 4'
+
+
+def test_SequenceLongObject_append():
+    obj = cSeqObject.SequenceLongObject([])
+    assert obj.capacity == 0
+    capacities = set()
+    for i in range(1000):
+        obj.append(i)
+        assert obj.capacity >= len(obj)
+        capacities.add(obj.capacity)
+    assert list(obj) == list(range(1000))
+    # Geometric growth.
+    assert len(capacities) < 20
+
+
+def test_SequenceLongObject_append_raises():
+    obj = cSeqObject.SequenceLongObject([])
+    with pytest.raises(TypeError) as err:
+        obj.append('a')
+    assert err.value.args[0] == 'append() argument must be an int, not type str'
+    with pytest.raises(OverflowError):
+        obj.append(2 ** 64)
+    assert list(obj) == []
+
+
+@pytest.mark.parametrize(
+    'initial_sequence, iterable, expected',
+    (
+            ([], [], []),
+            ([1, ], [2, 3, ], [1, 2, 3, ]),
+            ([1, ], (2, 3,), [1, 2, 3, ]),
+            ([1, ], array.array('h', [2, 3, ]), [1, 2, 3, ]),
+            ([1, ], cSeqObject.SequenceLongObject([2, 3, ]), [1, 2, 3, ]),
+            ([1, ], (v for v in (2, 3,)), [1, 2, 3, ]),
+            ([1, ], iter([2, 3, ]), [1, 2, 3, ]),
+            ([1, ], {2: 'a', }, [1, 2, ]),
+    )
+)
+def test_SequenceLongObject_extend(initial_sequence, iterable, expected):
+    obj = cSeqObject.SequenceLongObject(initial_sequence)
+    obj.extend(iterable)
+    assert list(obj) == expected
+
+
+def test_SequenceLongObject_extend_self():
+    obj = cSeqObject.SequenceLongObject([1, 2, ])
+    obj.extend(obj)
+    assert list(obj) == [1, 2, 1, 2, ]
+
+
+@pytest.mark.parametrize(
+    'iterable, error, message',
+    (
+            (['a', ], TypeError, 'Argument [0] must be a int, not type str'),
+            (iter(['a', ]), TypeError, 'append() argument must be an int, not type str'),
+            (1, TypeError, "'int' object is not iterable"),
+    )
+)
+def test_SequenceLongObject_extend_raises(iterable, error, message):
+    obj = cSeqObject.SequenceLongObject([1, ])
+    with pytest.raises(error) as err:
+        obj.extend(iterable)
+    assert err.value.args[0] == message
+
+
+def test_SequenceLongObject_inplace_concat():
+    obj = cSeqObject.SequenceLongObject([1, 2, ])
+    original = obj
+    obj += [3, ]
+    obj += cSeqObject.SequenceLongObject([4, ])
+    obj += (v for v in (5, 6,))
+    assert obj is original
+    assert list(obj) == [1, 2, 3, 4, 5, 6, ]
+
+
+@pytest.mark.parametrize(
+    'initial_sequence, count, expected',
+    (
+            ([], 3, []),
+            ([1, 2, ], 1, [1, 2, ]),
+            ([1, 2, ], 3, [1, 2, 1, 2, 1, 2, ]),
+            ([1, 2, ], 0, []),
+            ([1, 2, ], -1, []),
+    )
+)
+def test_SequenceLongObject_inplace_repeat(initial_sequence, count, expected):
+    obj = cSeqObject.SequenceLongObject(initial_sequence)
+    original = obj
+    obj *= count
+    assert obj is original
+    assert list(obj) == expected
+
+
+def test_SequenceLongObject_reserve_shrink_to_fit():
+    obj = cSeqObject.SequenceLongObject([1, 2, 3, ])
+    assert obj.capacity == 3
+    obj.reserve(100)
+    assert obj.capacity >= 100
+    capacity = obj.capacity
+    for i in range(97):
+        obj.append(i)
+    assert obj.capacity == capacity
+    # Never reduces the capacity.
+    obj.reserve(1)
+    assert obj.capacity == capacity
+    obj.shrink_to_fit()
+    assert obj.capacity == len(obj) == 100
+    del obj[:]
+    obj.shrink_to_fit()
+    assert obj.capacity == 0
+
+
+def test_SequenceLongObject_reserve_raises():
+    obj = cSeqObject.SequenceLongObject([])
+    with pytest.raises(ValueError) as err:
+        obj.reserve(-1)
+    assert err.value.args[0] == 'reserve() argument must be >= 0 not -1'
+
+
+def test_SequenceLongObject_grow_with_export_raises():
+    obj = cSeqObject.SequenceLongObject([1, 2, ])
+    obj.reserve(10)
+    view = memoryview(obj)
+    for operation in (
+            lambda: obj.append(3),
+            lambda: obj.extend([3, ]),
+            lambda: obj.shrink_to_fit(),
+    ):
+        with pytest.raises(BufferError):
+            operation()
+    view.release()
+    obj.append(3)
+    assert list(obj) == [1, 2, 3, ]
+
+
+def search_test_sequences():
+    """Unsorted and sorted sequences that exercise the SIMD loop remainders and the radix sort."""
+    rng = random.Random(4321)
+    ret = []
+    for length in (0, 1, 7, 8, 9, 63, 64, 65, 1000, 2 ** 16 + 5):
+        ret.append([rng.randint(-20, 20) for _i in range(length)])
+    ret.append([rng.randint(LONG_MIN, LONG_MAX) for _i in range(1000)])
+    ret.append([LONG_MAX, LONG_MIN] * 40)
+    ret.append(list(range(100)))
+    return ret
+
+
+@pytest.mark.parametrize('simd_level', SIMD_LEVELS)
+@pytest.mark.parametrize('values', search_test_sequences())
+def test_SequenceLongObject_search(values, simd_level):
+    previous = cSeqObject.set_simd_level(simd_level)
+    try:
+        obj = cSeqObject.SequenceLongObject(values)
+        assert obj.is_sorted == (values == sorted(values))
+        needles = list(range(-25, 25)) + [LONG_MIN, LONG_MAX, ]
+        for needle in needles:
+            assert (needle in obj) == (needle in values)
+        assert obj.contains_many(needles) == bytes(needle in values for needle in needles)
+        obj.sort()
+        assert obj.is_sorted
+        assert list(obj) == sorted(values)
+        for needle in needles:
+            assert (needle in obj) == (needle in values)
+            assert obj.count(needle) == values.count(needle)
+        assert obj.contains_many(needles) == bytes(needle in values for needle in needles)
+    finally:
+        cSeqObject.set_simd_level(previous)
+
+
+@pytest.mark.parametrize(
+    'value, expected',
+    (
+            (2 ** 64, False),
+            ('a', False),
+            (4, True),
+    )
+)
+def test_SequenceLongObject_contains_benign(value, expected):
+    obj = cSeqObject.SequenceLongObject([1, 4, 7, ])
+    assert (value in obj) == expected
+
+
+@pytest.mark.parametrize(
+    'iterable, expected',
+    (
+            ([], b''),
+            ([4, 5, ], b'\x01\x00'),
+            ((v for v in (7, 0,)), b'\x01\x00'),
+            (array.array('h', [1, 2, ]), b'\x01\x00'),
+    )
+)
+def test_SequenceLongObject_contains_many(iterable, expected):
+    obj = cSeqObject.SequenceLongObject([7, 4, 1, ])
+    assert obj.contains_many(iterable) == expected
+
+
+def test_SequenceLongObject_contains_many_raises():
+    obj = cSeqObject.SequenceLongObject([7, 4, 1, ])
+    with pytest.raises(TypeError) as err:
+        obj.contains_many(['a', ])
+    assert err.value.args[0] == 'Argument [0] must be a int, not type str'
+
+
+def test_SequenceLongObject_is_sorted_maintained():
+    obj = cSeqObject.SequenceLongObject([1, 2, 3, ])
+    assert obj.is_sorted
+    obj.append(3)
+    obj.extend([4, 5, ])
+    obj += [6, ]
+    assert obj.is_sorted
+    obj[0] = 2
+    assert obj.is_sorted
+    obj[0] = 3
+    assert not obj.is_sorted
+    obj.sort()
+    assert obj.is_sorted
+    obj.append(0)
+    assert not obj.is_sorted
+    obj.sort()
+    obj.extend([7, 6, ])
+    assert not obj.is_sorted
+    obj.sort()
+    del obj[0]
+    del obj[1::2]
+    assert obj.is_sorted
+    obj *= 2
+    assert not obj.is_sorted
+
+
+def test_SequenceLongObject_is_sorted_views_and_buffers():
+    obj = cSeqObject.SequenceLongObject([1, 2, 3, 4, ])
+    view = obj[::2]
+    view[1] = 2
+    assert obj.is_sorted
+    view[0] = 5
+    assert not obj.is_sorted
+    del view
+    obj.sort()
+    # The buffer is writable so the values can change without the object knowing.
+    buffer = memoryview(obj)
+    buffer[0] = 100
+    assert not obj.is_sorted
+    assert 100 in obj
+    buffer[0] = 0
+    assert obj.is_sorted
+    buffer.release()
+    assert obj.is_sorted
+
+
+def test_SequenceLongObject_is_sorted_view_buffer():
+    obj = cSeqObject.SequenceLongObject([1, 2, 3, 4, ])
+    assert obj.is_sorted
+    buffer = memoryview(obj[1:3])
+    buffer[0] = 100
+    assert not obj.is_sorted
+    assert 100 in obj
+    assert 2 not in obj
+    assert obj.count(100) == 1
+    assert obj.count(2) == 0
+    buffer.release()
+
+
+def test_SequenceLongObject_is_sorted_cached_after_view_buffer_release():
+    obj = cSeqObject.SequenceLongObject([1, 2, 3, 4, ])
+    view = obj[1:3]
+    buffer = memoryview(view)
+    buffer[0] = 100
+    assert not obj.is_sorted
+    buffer[0] = 2
+    assert obj.is_sorted
+    buffer[0] = 100
+    buffer.release()
+    # The view is still alive but, with no buffers, the flag is cached and maintained again.
+    assert not obj.is_sorted
+    obj.sort()
+    assert obj.is_sorted
+    view[0] = 0
+    assert not obj.is_sorted
+    del view
+    obj.append(200)
+    assert list(obj) == [1, 0, 4, 100, 200, ]
+
+
+def test_SequenceLongObject_vectorcall_keyword():
+    obj = cSeqObject.SequenceLongObject(sequence=[1, 2, 3, ])
+    assert list(obj) == [1, 2, 3, ]
+
+
+@pytest.mark.parametrize(
+    'args, kwargs, expected',
+    (
+            ((), {}, "SequenceLongObject() missing required argument 'sequence' (pos 1)"),
+            (([], []), {}, 'SequenceLongObject() takes at most 1 positional arguments (2 given)'),
+            (([],), {'seq': []}, "SequenceLongObject() got an unexpected keyword argument 'seq'"),
+    )
+)
+def test_SequenceLongObject_vectorcall_raises(args, kwargs, expected):
+    with pytest.raises(TypeError) as err:
+        cSeqObject.SequenceLongObject(*args, **kwargs)
+    assert err.value.args[0] == expected
+
+
+def test_SequenceLongObject_subclass_init():
+    """tp_vectorcall is not inherited so a subclass goes through tp_new and tp_init."""
+
+    class SubClass(cSeqObject.SequenceLongObject):
+        pass
+
+    obj = SubClass([1, 2, 3, ])
+    assert type(obj) is SubClass
+    assert len(obj) == 3
@@ -32,3 +32,48 @@ def test_cFibA_fibonacci(index, expected):
 def test_cFibB_fibonacci(index, expected):
     result = cFibB.fibonacci(index)
     assert result == expected
+
+
+def _fibonacci_iterative(index):
+    a, b = 0, 1
+    for _i in range(index):
+        a, b = b, a + b
+    return a
+
+
+@pytest.mark.parametrize('index', list(range(0, 200)) + [500, 1_000, 1_001, 4_096, 10_007])
+def test_cFibA_fibonacci_fast(index):
+    assert cFibA.fibonacci_fast(index) == _fibonacci_iterative(index)
+
+
+@pytest.mark.parametrize('index', list(range(0, 200)) + [500, 1_000, 1_001, 4_096, 10_007])
+def test_cFibB_fibonacci_large(index):
+    assert cFibB.fibonacci(index) == _fibonacci_iterative(index)
+
+
+@pytest.mark.parametrize('function', (cFibA.fibonacci_fast, cFibB.fibonacci))
+def test_fibonacci_negative_raises(function):
+    with pytest.raises(ValueError) as err:
+        function(-1)
+    assert err.value.args[0] == 'Index must be >= 0 not -1'
+
+
+def test_cFibA_fibonacci_fast_very_large():
+    assert cFibA.fibonacci_fast(100_000) == _fibonacci_iterative(100_000)
+    # F(n) is close to golden_ratio ** n / sqrt(5) so has about 0.694 * n bits.
+    assert cFibA.fibonacci_fast(1_000_000).bit_length() == 694_241
+
+
+def test_cFibB_fibonacci_threads():
+    import concurrent.futures
+
+    indexes = list(range(0, 300)) * 10
+    with concurrent.futures.ThreadPoolExecutor(max_workers=8) as executor:
+        result = list(executor.map(cFibB.fibonacci, indexes))
+    assert result == [_fibonacci_iterative(i) for i in indexes]
+
+
+@pytest.mark.parametrize('index', (1, 2, 3, 8, 30))
+def test_cFibA_fibonacci_fastcall(index):
+    assert cFibA.fibonacci_fastcall(index) == cFibA.fibonacci(index)
+    assert cFibA.fibonacci_fastcall(index=index) == cFibA.fibonacci(index)
@@ -23,6 +23,12 @@ def test_cppsublist_dir():
                       '__package__',
                       '__spec__',
                       'cppSubList',
+                      'lock_max_spins',
+                      'parallel_max_threads',
+                      'parallel_max_threshold',
+                      'set_lock_max_spins',
+                      'set_parallel_max_threads',
+                      'set_parallel_max_threshold',
                       ]
 
 
@@ -79,17 +85,31 @@ def test_cppsublist_cppsublist_dir_pre_311():
                       '__str__',
                       '__subclasshook__',
                       'append',
+                      'append_cost_us',
                       'clear',
+                      'compare_cost_us',
                       'copy',
+                      'cost_mode',
                       'count',
                       'extend',
                       'index',
                       'insert',
+                      'lock_exclusive_acquired',
+                      'lock_exclusive_contended',
+                      'lock_exclusive_wait_ns',
+                      'lock_hold_histogram',
+                      'lock_shared_acquired',
+                      'lock_shared_contended',
+                      'lock_shared_wait_ns',
+                      'lock_spin_acquired',
+                      'lock_timeouts',
                       'max',
                       'pop',
                       'remove',
                       'reverse',
-                      'sort']
+                      'rwlock',
+                      'sort',
+                      'trace_lock_hold']
 
 
 @pytest.mark.skipif(not (sys.version_info.minor > 10), reason='Python 3.11+')
@@ -134,17 +154,31 @@ def test_cppsublist_cppsublist_dir_post_310():
                       '__str__',
                       '__subclasshook__',
                       'append',
+                      'append_cost_us',
                       'clear',
+                      'compare_cost_us',
                       'copy',
+                      'cost_mode',
                       'count',
                       'extend',
                       'index',
                       'insert',
+                      'lock_exclusive_acquired',
+                      'lock_exclusive_contended',
+                      'lock_exclusive_wait_ns',
+                      'lock_hold_histogram',
+                      'lock_shared_acquired',
+                      'lock_shared_contended',
+                      'lock_shared_wait_ns',
+                      'lock_spin_acquired',
+                      'lock_timeouts',
                       'max',
                       'pop',
                       'remove',
                       'reverse',
-                      'sort']
+                      'rwlock',
+                      'sort',
+                      'trace_lock_hold']
 
 
 @pytest.mark.skipif(not (sys.version_info.minor <= 10), reason='Python 3.9, 3.10')
@@ -188,17 +222,29 @@ def test_cppsublist_csublist_dir_pre_311():
                       '__str__',
                       '__subclasshook__',
                       'append',
+                      'append_cost_us',
                       'clear',
+                      'compare_cost_us',
                       'copy',
+                      'cost_mode',
                       'count',
                       'extend',
                       'index',
                       'insert',
+                      'lock_exclusive_acquired',
+                      'lock_exclusive_contended',
+                      'lock_exclusive_wait_ns',
+                      'lock_hold_histogram',
+                      'lock_shared_acquired',
+                      'lock_shared_contended',
+                      'lock_shared_wait_ns',
                       'max',
                       'pop',
                       'remove',
                       'reverse',
-                      'sort']
+                      'rwlock',
+                      'sort',
+                      'trace_lock_hold']
 
 
 @pytest.mark.skipif(not (sys.version_info.minor > 10), reason='Python 3.11+')
@@ -243,17 +289,29 @@ def test_cppsublist_csublist_dir_post_310():
                       '__str__',
                       '__subclasshook__',
                       'append',
+                      'append_cost_us',
                       'clear',
+                      'compare_cost_us',
                       'copy',
+                      'cost_mode',
                       'count',
                       'extend',
                       'index',
                       'insert',
+                      'lock_exclusive_acquired',
+                      'lock_exclusive_contended',
+                      'lock_exclusive_wait_ns',
+                      'lock_hold_histogram',
+                      'lock_shared_acquired',
+                      'lock_shared_contended',
+                      'lock_shared_wait_ns',
                       'max',
                       'pop',
                       'remove',
                       'reverse',
-                      'sort']
+                      'rwlock',
+                      'sort',
+                      'trace_lock_hold']
 
 
 def test_cppsublist_cppsublist_append():
@@ -382,6 +440,8 @@ def test_threaded_c():
     print()
     print('test_threaded_c() START', flush=True)
     obj = csublist.cSubList(range(128))
+    obj.append_cost_us = 250_000
+    obj.compare_cost_us = 2_000
     threads = []
     for i in range(4):
         threads.append(
@@ -406,3 +466,476 @@ def test_threaded_c():
         if t is not main_thread:
             t.join()
     print('Worker threads DONE', flush=True)
+
+
+SUBLIST_TYPES = (csublist.cSubList, cppsublist.cppSubList)
+
+
+@pytest.mark.parametrize('cls', SUBLIST_TYPES)
+def test_sublist_rwlock_default(cls):
+    obj = cls([1, 2, 3])
+    assert not obj.rwlock
+    assert obj == [1, 2, 3]
+
+
+@pytest.mark.parametrize('cls', SUBLIST_TYPES)
+def test_sublist_rwlock(cls):
+    obj = cls([1, 2, 3], rwlock=True)
+    assert obj.rwlock
+    assert obj == [1, 2, 3]
+
+
+@pytest.mark.parametrize('cls', SUBLIST_TYPES)
+def test_sublist_rwlock_can_not_change(cls):
+    obj = cls([1, 2, 3], rwlock=True)
+    with pytest.raises(ValueError) as err:
+        obj.__init__([1, 2, 3], rwlock=False)
+    assert err.value.args[0] == 'The lock mode can not be changed.'
+
+
+@pytest.mark.parametrize('cls', SUBLIST_TYPES)
+def test_sublist_lock_counters_exclusive(cls):
+    """With a single lock only max() and append() take it, the other methods are those of list."""
+    obj = cls([1, 2, 3])
+    assert len(obj) == 3
+    assert obj[0] == 1
+    assert obj[1:] == [2, 3]
+    assert 2 in obj
+    assert obj.max() == 3
+    assert obj.lock_exclusive_acquired == 1
+    assert obj.lock_shared_acquired == 0
+
+
+@pytest.mark.parametrize('cls', SUBLIST_TYPES)
+def test_sublist_lock_counters_rwlock(cls):
+    obj = cls([1, 2, 3], rwlock=True)
+    assert len(obj) == 3
+    assert obj[0] == 1
+    assert obj[1:] == [2, 3]
+    assert 2 in obj
+    assert obj.max() == 3
+    assert obj.lock_shared_acquired == 5
+    assert obj.lock_exclusive_acquired == 0
+    obj.append(4)
+    assert obj.lock_exclusive_acquired == 1
+
+
+def _max_in_threads(obj, thread_count):
+    threads = [threading.Thread(target=obj.max) for _i in range(thread_count)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+
+
+@pytest.mark.parametrize('cls', SUBLIST_TYPES)
+def test_sublist_concurrent_readers_exclusive(cls):
+    """max() holds the lock for about 30ms so the other readers wait."""
+    obj = cls(range(16))
+    obj.compare_cost_us = 2_000
+    _max_in_threads(obj, 4)
+    assert obj.lock_exclusive_acquired == 4
+    assert obj.lock_exclusive_contended > 0
+    assert obj.lock_exclusive_wait_ns > 0
+
+
+@pytest.mark.parametrize('cls', SUBLIST_TYPES)
+def test_sublist_concurrent_readers_rwlock(cls):
+    """With a reader/writer lock the readers never wait for each other."""
+    obj = cls(range(16), rwlock=True)
+    obj.compare_cost_us = 2_000
+    _max_in_threads(obj, 4)
+    assert obj.lock_shared_acquired == 4
+    assert obj.lock_shared_contended == 0
+
+
+class _ReentrantRead:
+    """Calls back into the sub-list from __eq__(), __gt__() and __index__() whilst another thread waits to write.
+    If the read lock were held across the call back the nested read would deadlock."""
+
+    def __init__(self, obj):
+        self.obj = obj
+        self.lengths = []
+        self.writer = None
+
+    def _read(self):
+        if not self.lengths:
+            self.writer = threading.Thread(target=self.obj.append, args=(4,), daemon=True)
+            self.writer.start()
+            # Give the writer time to block on the lock if it is held.
+            self.writer.join(0.1)
+        self.lengths.append(len(self.obj))
+        return self.lengths[-1]
+
+    def __eq__(self, other):
+        self._read()
+        return False
+
+    def __gt__(self, other):
+        self._read()
+        return False
+
+    def __index__(self):
+        self._read()
+        return 0
+
+    __hash__ = None
+
+
+def _run_with_timeout(function, timeout=10.0):
+    result = []
+    thread = threading.Thread(target=lambda: result.append(function()), daemon=True)
+    thread.start()
+    thread.join(timeout)
+    assert not thread.is_alive(), 'Deadlocked.'
+    return result[0]
+
+
+@pytest.mark.parametrize('cls', SUBLIST_TYPES)
+@pytest.mark.parametrize('rwlock', (False, True))
+def test_sublist_reentrant_contains(cls, rwlock):
+    obj = cls([1, 2, 3], rwlock=rwlock)
+    key = _ReentrantRead(obj)
+    assert not _run_with_timeout(lambda: key in obj)
+    assert key.lengths[0] == 4
+    assert obj == [1, 2, 3, 4]
+
+
+@pytest.mark.parametrize('cls', SUBLIST_TYPES)
+@pytest.mark.parametrize('rwlock', (False, True))
+def test_sublist_reentrant_getitem(cls, rwlock):
+    obj = cls([1, 2, 3], rwlock=rwlock)
+    key = _ReentrantRead(obj)
+    assert _run_with_timeout(lambda: obj[key]) == 1
+    assert _run_with_timeout(lambda: obj[key:1]) == [1]
+    assert key.lengths[0] == 4
+
+
+@pytest.mark.parametrize('cls', SUBLIST_TYPES)
+@pytest.mark.parametrize('rwlock', (False, True))
+def test_sublist_reentrant_max(cls, rwlock):
+    obj = cls(rwlock=rwlock)
+    first = _ReentrantRead(obj)
+    second = _ReentrantRead(obj)
+    obj.extend([first, second])
+    # This calls second.__gt__(first).
+    assert _run_with_timeout(obj.max) is first
+    # With a single lock the writer waits for max() to finish.
+    second.writer.join(10.0)
+    assert len(obj) == 3
+
+
+@pytest.mark.parametrize('cls', SUBLIST_TYPES)
+def test_sublist_rwlock_getitem(cls):
+    """__getitem__ with a reader/writer lock has the semantics of list."""
+    values = list(range(10))
+    obj = cls(values, rwlock=True)
+    for key in (0, 9, -1, -10, True, slice(None), slice(2, 8, 3), slice(None, None, -2), slice(-3, None),
+                slice(100, -100, -1), slice(-100, 100)):
+        assert obj[key] == values[key]
+    for key in (10, -11):
+        with pytest.raises(IndexError) as err:
+            obj[key]
+        assert err.value.args[0] == 'list index out of range'
+    for key in ('a', 1.0):
+        with pytest.raises(TypeError):
+            obj[key]
+    with pytest.raises(ValueError):
+        obj[::0]
+
+
+@pytest.fixture
+def parallel_max_config():
+    """Restore the cppsublist parallel max() configuration after the test."""
+    threads = cppsublist.set_parallel_max_threads(0)
+    threshold = cppsublist.parallel_max_threshold()
+    yield
+    cppsublist.set_parallel_max_threads(threads)
+    cppsublist.set_parallel_max_threshold(threshold)
+
+
+def test_cppsublist_parallel_max_threads(parallel_max_config):
+    assert cppsublist.parallel_max_threads() >= 1
+    cppsublist.set_parallel_max_threads(3)
+    assert cppsublist.parallel_max_threads() == 3
+    assert cppsublist.set_parallel_max_threads(1) == 3
+    assert cppsublist.parallel_max_threads() == 1
+
+
+def test_cppsublist_parallel_max_threads_raises(parallel_max_config):
+    with pytest.raises(ValueError) as err:
+        cppsublist.set_parallel_max_threads(-1)
+    assert err.value.args[0] == 'The number of threads must be >= 0 not -1.'
+
+
+def test_cppsublist_parallel_max_threshold(parallel_max_config):
+    assert cppsublist.parallel_max_threshold() == 4096
+    assert cppsublist.set_parallel_max_threshold(2) == 4096
+    assert cppsublist.parallel_max_threshold() == 2
+    with pytest.raises(ValueError) as err:
+        cppsublist.set_parallel_max_threshold(0)
+    assert err.value.args[0] == 'The threshold must be >= 1 not 0.'
+
+
+@pytest.mark.parametrize('thread_count', (1, 2, 4))
+@pytest.mark.parametrize(
+    'values',
+    (
+            list(range(100_000)),
+            list(range(100_000, 0, -1)),
+            [(i * 7919) % 100_003 - 50_000 for i in range(100_000)],
+            [-2 ** 63] * 50_000 + [2 ** 63 - 1],
+            [float(i % 1000) / 7 for i in range(100_000)],
+            [-1.0] * 70_000 + [float('inf')] + [-float('inf')] * 10,
+    ),
+    ids=('ascending', 'descending', 'scattered', 'long_long_limits', 'float', 'float_inf'),
+)
+@pytest.mark.parametrize('rwlock', (False, True))
+def test_cppsublist_parallel_max(parallel_max_config, values, thread_count, rwlock):
+    cppsublist.set_parallel_max_threads(thread_count)
+    obj = cppsublist.cppSubList(values, rwlock=rwlock)
+    result = obj.max()
+    assert result == max(values)
+    assert type(result) == type(max(values))
+    # The native path takes the lock once.
+    if rwlock:
+        assert obj.lock_shared_acquired == 1
+    else:
+        assert obj.lock_exclusive_acquired == 1
+
+
+def test_cppsublist_parallel_max_first_of_equal(parallel_max_config):
+    """As max() the first of equal values is returned, 0.0 == -0.0 so the sign shows which one."""
+    cppsublist.set_parallel_max_threshold(2)
+    obj = cppsublist.cppSubList([-1.0] * 20_000 + [-0.0] + [-1.0] * 20_000 + [0.0])
+    result = obj.max()
+    assert str(result) == '-0.0'
+
+
+@pytest.mark.parametrize(
+    'values, expected',
+    (
+            ([1, 2.5, 2], 2.5),
+            ([1.5, 3, 2.0], 3),
+            ([1, 2 ** 64, 3], 2 ** 64),
+            ([True, 2, 1], 2),
+    ),
+    ids=('int_float', 'float_int', 'big_int', 'bool'),
+)
+def test_cppsublist_parallel_max_falls_back(parallel_max_config, values, expected):
+    """Mixed types and values that do not fit a C type use the generic path."""
+    cppsublist.set_parallel_max_threshold(2)
+    obj = cppsublist.cppSubList(values)
+    result = obj.max()
+    assert result == expected
+    assert type(result) == type(expected)
+
+
+def test_cppsublist_parallel_max_nan_falls_back(parallel_max_config):
+    """max() with a NaN depends on the order of the comparisons so uses the generic path."""
+    cppsublist.set_parallel_max_threshold(2)
+    obj = cppsublist.cppSubList([1.0, float('nan'), 3.0])
+    assert obj.max() == 3.0
+    obj = cppsublist.cppSubList([float('nan'), 1.0, 3.0])
+    assert str(obj.max()) == 'nan'
+
+
+def test_cppsublist_parallel_max_releases_gil(parallel_max_config):
+    """Several threads can find the maximum at the same time."""
+    obj = cppsublist.cppSubList(range(1_000_000), rwlock=True)
+    results = []
+    threads = [threading.Thread(target=lambda: results.append(obj.max())) for _i in range(4)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    assert results == [999_999] * 4
+
+
+@pytest.fixture
+def lock_max_spins_config():
+    """Restore the cppsublist lock spin limit after the test."""
+    max_spins = cppsublist.lock_max_spins()
+    yield
+    cppsublist.set_lock_max_spins(max_spins)
+
+
+def test_cppsublist_lock_max_spins(lock_max_spins_config):
+    assert cppsublist.lock_max_spins() == 100
+    assert cppsublist.set_lock_max_spins(0) == 100
+    assert cppsublist.lock_max_spins() == 0
+
+
+def test_cppsublist_lock_max_spins_raises(lock_max_spins_config):
+    with pytest.raises(ValueError) as err:
+        cppsublist.set_lock_max_spins(-1)
+    assert err.value.args[0] == 'The maximum number of spins must be >= 0 not -1.'
+
+
+def test_cppsublist_lock_counters_initial():
+    obj = cppsublist.cppSubList([1, 2, 3])
+    assert obj.lock_exclusive_wait_ns == 0
+    assert obj.lock_shared_wait_ns == 0
+    assert obj.lock_spin_acquired == 0
+    assert obj.lock_timeouts == 0
+
+
+def _append_in_thread(obj):
+    """Start a thread that holds the exclusive lock for 250ms in append() and wait until it has the lock."""
+    obj.append_cost_us = 250_000
+    thread = threading.Thread(target=obj.append, args=(4,))
+    thread.start()
+    time.sleep(0.05)
+    return thread
+
+
+@pytest.mark.parametrize('rwlock', (False, True))
+def test_cppsublist_max_timeout_raises(rwlock):
+    obj = cppsublist.cppSubList([1, 2, 3], rwlock=rwlock)
+    thread = _append_in_thread(obj)
+    with pytest.raises(TimeoutError) as err:
+        obj.max(timeout=0.01)
+    assert err.value.args[0] == 'Unable to acquire the lock within the timeout.'
+    with pytest.raises(TimeoutError):
+        obj.max(timeout=0)
+    thread.join()
+    assert obj.lock_timeouts == 2
+    wait_ns = obj.lock_shared_wait_ns if rwlock else obj.lock_exclusive_wait_ns
+    assert wait_ns >= 5_000_000
+    # The lock is free again.
+    assert obj.max(timeout=0) == 4
+
+
+@pytest.mark.parametrize('rwlock', (False, True))
+def test_cppsublist_max_timeout_waits(rwlock):
+    obj = cppsublist.cppSubList([1, 2, 3], rwlock=rwlock)
+    thread = _append_in_thread(obj)
+    assert obj.max(timeout=5.0) == 4
+    thread.join()
+    assert obj.lock_timeouts == 0
+    if rwlock:
+        assert obj.lock_shared_contended == 1
+        assert obj.lock_shared_wait_ns >= 100_000_000
+    else:
+        assert obj.lock_exclusive_contended == 1
+        assert obj.lock_exclusive_wait_ns >= 100_000_000
+
+
+@pytest.mark.parametrize(
+    'timeout, error, message',
+    (
+            (-1, ValueError, "'timeout' must be a non-negative number"),
+            (float('nan'), ValueError, "'timeout' must be a non-negative number"),
+            ('1', TypeError, 'must be real number, not str'),
+    ),
+)
+def test_cppsublist_max_timeout_bad(timeout, error, message):
+    obj = cppsublist.cppSubList([1, 2, 3])
+    with pytest.raises(error) as err:
+        obj.max(timeout=timeout)
+    assert err.value.args[0] == message
+
+
+def test_cppsublist_max_timeout_none():
+    obj = cppsublist.cppSubList([1, 2, 3])
+    assert obj.max(timeout=None) == 3
+    assert obj.max(None) == 3
+
+
+def test_cppsublist_lock_no_spin(lock_max_spins_config):
+    """With spinning disabled every contended acquisition releases the GIL and blocks."""
+    cppsublist.set_lock_max_spins(0)
+    obj = cppsublist.cppSubList(range(16))
+    obj.compare_cost_us = 2_000
+    _max_in_threads(obj, 4)
+    assert obj.lock_exclusive_contended > 0
+    assert obj.lock_spin_acquired == 0
+
+
+@pytest.mark.parametrize('cls', SUBLIST_TYPES)
+def test_sublist_cost_model_default(cls):
+    obj = cls()
+    assert obj.append_cost_us == 0
+    assert obj.compare_cost_us == 0
+    assert obj.cost_mode == 'sleep'
+
+
+@pytest.mark.parametrize('cls', SUBLIST_TYPES)
+@pytest.mark.parametrize('cost_mode', ('sleep', 'busy', 'busy_gil'))
+def test_sublist_cost_model(cls, cost_mode):
+    obj = cls(range(4))
+    obj.cost_mode = cost_mode
+    obj.append_cost_us = 20_000
+    obj.compare_cost_us = 10_000
+    assert obj.cost_mode == cost_mode
+    start = time.monotonic()
+    obj.append(4)
+    assert time.monotonic() - start >= 0.019
+    start = time.monotonic()
+    assert obj.max() == 4
+    # Four comparisons.
+    assert time.monotonic() - start >= 0.039
+
+
+@pytest.mark.parametrize('cls', SUBLIST_TYPES)
+@pytest.mark.parametrize(
+    'name, value, error, message',
+    (
+            ('append_cost_us', -1, ValueError, 'The cost must be >= 0 microseconds not -1.'),
+            ('compare_cost_us', -1, ValueError, 'The cost must be >= 0 microseconds not -1.'),
+            ('append_cost_us', 'a', TypeError, "'str' object cannot be interpreted as an integer"),
+            ('cost_mode', 'fast', ValueError, "The cost mode must be 'sleep', 'busy' or 'busy_gil' not 'fast'."),
+            ('cost_mode', 1, TypeError, 'The cost mode must be a str not "int".'),
+    ),
+)
+def test_sublist_cost_model_raises(cls, name, value, error, message):
+    obj = cls()
+    with pytest.raises(error) as err:
+        setattr(obj, name, value)
+    assert err.value.args[0] == message
+
+
+@pytest.mark.parametrize('cls', SUBLIST_TYPES)
+def test_sublist_lock_hold_histogram_off(cls):
+    obj = cls(range(4))
+    assert not obj.trace_lock_hold
+    obj.append(4)
+    assert obj.max() == 4
+    assert obj.lock_hold_histogram() == {}
+
+
+@pytest.mark.parametrize('cls', SUBLIST_TYPES)
+@pytest.mark.parametrize('rwlock', (False, True))
+def test_sublist_lock_hold_histogram(cls, rwlock):
+    obj = cls(range(4), rwlock=rwlock)
+    obj.trace_lock_hold = True
+    assert len(obj) == 4
+    obj.append_cost_us = 3_000
+    obj.append(4)
+    histogram = obj.lock_hold_histogram()
+    # len() only takes the lock in reader/writer mode.
+    assert sum(histogram.values()) == (2 if rwlock else 1)
+    # The append() holds the lock for 3ms or more, the bucket upper bounds are powers of two microseconds.
+    assert max(histogram) >= 4096
+    assert all(key & (key - 1) == 0 for key in histogram)
+    assert obj.lock_hold_histogram(clear=True) == histogram
+    assert obj.lock_hold_histogram() == {}
+
+
+@pytest.mark.parametrize('cls', SUBLIST_TYPES)
+@pytest.mark.parametrize('thread_count', (1, 2, 4))
+def test_sublist_lock_hold_histogram_threads(cls, thread_count):
+    """Every acquisition from every thread is recorded, in reader/writer mode __getitem__ takes the shared lock."""
+    obj = cls(range(16), rwlock=True)
+    obj.trace_lock_hold = True
+
+    def read():
+        for i in range(100):
+            assert obj[i % 16] == i % 16
+
+    threads = [threading.Thread(target=read) for _i in range(thread_count)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    assert sum(obj.lock_hold_histogram().values()) == 100 * thread_count
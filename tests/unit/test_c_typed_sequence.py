@@ -0,0 +1,318 @@
+import array
+import sys
+
+import pytest
+
+from cPyExtPatt.cpp import cTypedSequence
+
+# (type, typecode, itemsize, minimum, maximum) where minimum and maximum are None for floating point.
+TYPED_SEQUENCES = (
+    (cTypedSequence.SequenceInt8, 'b', 1, -2 ** 7, 2 ** 7 - 1),
+    (cTypedSequence.SequenceUInt8, 'B', 1, 0, 2 ** 8 - 1),
+    (cTypedSequence.SequenceInt16, 'h', 2, -2 ** 15, 2 ** 15 - 1),
+    (cTypedSequence.SequenceUInt16, 'H', 2, 0, 2 ** 16 - 1),
+    (cTypedSequence.SequenceInt32, 'i', 4, -2 ** 31, 2 ** 31 - 1),
+    (cTypedSequence.SequenceUInt32, 'I', 4, 0, 2 ** 32 - 1),
+    (cTypedSequence.SequenceInt64, 'q', 8, -2 ** 63, 2 ** 63 - 1),
+    (cTypedSequence.SequenceUInt64, 'Q', 8, 0, 2 ** 64 - 1),
+    (cTypedSequence.SequenceFloat32, 'f', 4, None, None),
+    (cTypedSequence.SequenceFloat64, 'd', 8, None, None),
+)
+
+INTEGER_SEQUENCES = tuple(t for t in TYPED_SEQUENCES if t[3] is not None)
+
+
+def test_module_dir():
+    assert dir(cTypedSequence) == [
+        'SequenceFloat32', 'SequenceFloat64',
+        'SequenceInt16', 'SequenceInt32', 'SequenceInt64', 'SequenceInt8',
+        'SequenceUInt16', 'SequenceUInt32', 'SequenceUInt64', 'SequenceUInt8',
+        '__doc__', '__file__', '__loader__', '__name__', '__package__', '__spec__',
+    ]
+
+
+@pytest.mark.parametrize('typ, typecode, itemsize, minimum, maximum', TYPED_SEQUENCES)
+def test_typed_sequence_attributes(typ, typecode, itemsize, minimum, maximum):
+    obj = typ([])
+    assert obj.typecode == typecode
+    assert obj.itemsize == itemsize
+    assert str(obj) == f'<{typ.__name__} sequence size: 0>'
+    assert type(obj).__module__ == 'cTypedSequence'
+
+
+@pytest.mark.parametrize('typ, typecode, itemsize, minimum, maximum', TYPED_SEQUENCES)
+@pytest.mark.parametrize('initial', ([], [1, 2, 3], (7, 0, 5), range(10)))
+def test_typed_sequence_init_sequence(typ, typecode, itemsize, minimum, maximum, initial):
+    obj = typ(initial)
+    assert len(obj) == len(initial)
+    assert list(obj) == list(initial)
+
+
+@pytest.mark.parametrize('typ, typecode, itemsize, minimum, maximum', INTEGER_SEQUENCES)
+def test_typed_sequence_init_limits(typ, typecode, itemsize, minimum, maximum):
+    obj = typ([minimum, 0, maximum])
+    assert list(obj) == [minimum, 0, maximum]
+
+
+@pytest.mark.parametrize('typ, typecode, itemsize, minimum, maximum', INTEGER_SEQUENCES)
+@pytest.mark.parametrize('delta', (-1, 1))
+def test_typed_sequence_init_out_of_range(typ, typecode, itemsize, minimum, maximum, delta):
+    value = minimum - 1 if delta < 0 else maximum + 1
+    with pytest.raises(OverflowError):
+        typ([0, value])
+
+
+@pytest.mark.parametrize('typ, typecode, itemsize, minimum, maximum', INTEGER_SEQUENCES)
+def test_typed_sequence_init_integer_rejects_float(typ, typecode, itemsize, minimum, maximum):
+    with pytest.raises(TypeError) as err:
+        typ([1, 2.0])
+    assert err.value.args[0] == 'Argument [1] must be an int, not type float'
+
+
+def test_typed_sequence_init_float_accepts_int():
+    obj = cTypedSequence.SequenceFloat64([1, 2.5, -3])
+    assert list(obj) == [1.0, 2.5, -3.0]
+
+
+def test_typed_sequence_init_float_rejects_str():
+    with pytest.raises(TypeError) as err:
+        cTypedSequence.SequenceFloat64([1.0, '2'])
+    assert err.value.args[0] == 'Argument [1] must be a float or int, not type str'
+
+
+def test_typed_sequence_init_not_a_sequence():
+    with pytest.raises(TypeError) as err:
+        cTypedSequence.SequenceInt32(1)
+    assert err.value.args[0] == 'Argument must be a sequence or support the buffer protocol, not type int'
+
+
+@pytest.mark.parametrize('typ, typecode, itemsize, minimum, maximum', INTEGER_SEQUENCES)
+@pytest.mark.parametrize('array_typecode', ('b', 'B', 'h', 'H', 'i', 'I', 'l', 'L', 'q', 'Q'))
+def test_typed_sequence_init_array(typ, typecode, itemsize, minimum, maximum, array_typecode):
+    values = [0, 1, 2, 127]
+    obj = typ(array.array(array_typecode, values))
+    assert list(obj) == values
+
+
+@pytest.mark.parametrize('typ, typecode, itemsize, minimum, maximum', INTEGER_SEQUENCES)
+def test_typed_sequence_init_array_same_type(typ, typecode, itemsize, minimum, maximum):
+    values = [minimum, 0, maximum]
+    obj = typ(array.array(typecode, values))
+    assert list(obj) == values
+
+
+def test_typed_sequence_init_array_out_of_range():
+    with pytest.raises(OverflowError) as err:
+        cTypedSequence.SequenceUInt8(array.array('h', [1, 256]))
+    assert err.value.args[0] == "Argument [1] with buffer format 'h' is out of range for SequenceUInt8"
+
+
+def test_typed_sequence_init_array_negative_unsigned():
+    with pytest.raises(OverflowError):
+        cTypedSequence.SequenceUInt32(array.array('i', [1, -1]))
+
+
+@pytest.mark.parametrize('array_typecode', ('f', 'd', 'i', 'q'))
+def test_typed_sequence_init_float_from_array(array_typecode):
+    values = [0, 1.0, -2.5, 1024]
+    if array_typecode in 'iq':
+        values = [0, 1, -2, 1024]
+    obj = cTypedSequence.SequenceFloat64(array.array(array_typecode, values))
+    assert list(obj) == values
+
+
+def test_typed_sequence_init_float32_narrows():
+    obj = cTypedSequence.SequenceFloat32(array.array('d', [0.1]))
+    assert list(obj) == array.array('f', [0.1]).tolist()
+
+
+def test_typed_sequence_init_integer_from_float_array():
+    """A floating point buffer falls back to the sequence path which rejects floats."""
+    with pytest.raises(TypeError):
+        cTypedSequence.SequenceInt64(array.array('d', [1.0]))
+
+
+def test_typed_sequence_init_bytes():
+    obj = cTypedSequence.SequenceUInt8(b'\x00\x01\xff')
+    assert list(obj) == [0, 1, 255]
+
+
+def test_typed_sequence_init_strided_buffer():
+    obj = cTypedSequence.SequenceInt16(memoryview(array.array('q', range(10)))[::3])
+    assert list(obj) == [0, 3, 6, 9]
+
+
+def test_typed_sequence_init_from_typed_sequence():
+    source = cTypedSequence.SequenceInt8([-1, 0, 1])
+    obj = cTypedSequence.SequenceFloat64(source)
+    assert list(obj) == [-1.0, 0.0, 1.0]
+
+
+@pytest.mark.parametrize('typ, typecode, itemsize, minimum, maximum', TYPED_SEQUENCES)
+def test_typed_sequence_getitem(typ, typecode, itemsize, minimum, maximum):
+    obj = typ([1, 2, 3])
+    assert obj[0] == 1
+    assert obj[-1] == 3
+    with pytest.raises(IndexError) as err:
+        obj[3]
+    assert err.value.args[0] == 'Index 3 is out of range for length 3'
+    with pytest.raises(IndexError) as err:
+        obj[-4]
+    assert err.value.args[0] == 'Index -4 is out of range for length 3'
+
+
+@pytest.mark.parametrize('typ, typecode, itemsize, minimum, maximum', TYPED_SEQUENCES)
+def test_typed_sequence_getitem_type(typ, typecode, itemsize, minimum, maximum):
+    obj = typ([1])
+    assert type(obj[0]) == (int if minimum is not None else float)
+
+
+@pytest.mark.parametrize('typ, typecode, itemsize, minimum, maximum', TYPED_SEQUENCES)
+def test_typed_sequence_setitem(typ, typecode, itemsize, minimum, maximum):
+    obj = typ([1, 2, 3])
+    obj[1] = 7
+    obj[-1] = 8
+    assert list(obj) == [1, 7, 8]
+
+
+@pytest.mark.parametrize('typ, typecode, itemsize, minimum, maximum', INTEGER_SEQUENCES)
+def test_typed_sequence_setitem_out_of_range(typ, typecode, itemsize, minimum, maximum):
+    obj = typ([1, 2, 3])
+    with pytest.raises(OverflowError):
+        obj[0] = maximum + 1
+    assert list(obj) == [1, 2, 3]
+
+
+def test_typed_sequence_setitem_wrong_type():
+    obj = cTypedSequence.SequenceInt32([1, 2, 3])
+    with pytest.raises(TypeError) as err:
+        obj[0] = 'a'
+    assert err.value.args[0] == 'SequenceInt32 value must be an int, not type str'
+
+
+@pytest.mark.parametrize('typ, typecode, itemsize, minimum, maximum', TYPED_SEQUENCES)
+def test_typed_sequence_delitem(typ, typecode, itemsize, minimum, maximum):
+    obj = typ([1, 2, 3])
+    del obj[1]
+    assert list(obj) == [1, 3]
+    del obj[-1]
+    assert list(obj) == [1]
+
+
+def test_typed_sequence_delitem_with_export():
+    obj = cTypedSequence.SequenceInt32([1, 2, 3])
+    view = memoryview(obj)
+    with pytest.raises(BufferError) as err:
+        del obj[1]
+    assert err.value.args[0] == 'Existing exports of data (1): object cannot be re-sized'
+    view.release()
+    del obj[1]
+    assert list(obj) == [1, 3]
+
+
+@pytest.mark.parametrize('typ, typecode, itemsize, minimum, maximum', TYPED_SEQUENCES)
+def test_typed_sequence_contains(typ, typecode, itemsize, minimum, maximum):
+    obj = typ([1, 2, 3])
+    assert 2 in obj
+    assert 4 not in obj
+    assert 'a' not in obj
+    assert 2 ** 80 not in obj
+
+
+def test_typed_sequence_contains_float32_not_narrowed():
+    obj = cTypedSequence.SequenceFloat32([0.1])
+    assert obj[0] != 0.1
+    assert 0.1 not in obj
+    assert obj[0] in obj
+
+
+@pytest.mark.parametrize('typ, typecode, itemsize, minimum, maximum', TYPED_SEQUENCES)
+def test_typed_sequence_concat(typ, typecode, itemsize, minimum, maximum):
+    obj = typ([1, 2]) + typ([3])
+    assert type(obj) == typ
+    assert list(obj) == [1, 2, 3]
+
+
+def test_typed_sequence_concat_different_types():
+    with pytest.raises(TypeError) as err:
+        cTypedSequence.SequenceInt8([1]) + cTypedSequence.SequenceInt16([2])
+    assert err.value.args[0] == (
+        'can only concatenate SequenceInt8 (not "cTypedSequence.SequenceInt16") to SequenceInt8'
+    )
+
+
+@pytest.mark.parametrize('typ, typecode, itemsize, minimum, maximum', TYPED_SEQUENCES)
+@pytest.mark.parametrize('count', (-1, 0, 1, 3))
+def test_typed_sequence_repeat(typ, typecode, itemsize, minimum, maximum, count):
+    obj = typ([1, 2]) * count
+    assert type(obj) == typ
+    assert list(obj) == [1, 2] * count
+
+
+@pytest.mark.parametrize('typ, typecode, itemsize, minimum, maximum', TYPED_SEQUENCES)
+def test_typed_sequence_iter(typ, typecode, itemsize, minimum, maximum):
+    obj = typ([1, 2, 3])
+    iterator = iter(obj)
+    assert type(iterator).__name__ == f'{typ.__name__}Iterator'
+    assert next(iterator) == 1
+    assert list(iterator) == [2, 3]
+    with pytest.raises(StopIteration):
+        next(iterator)
+
+
+def test_typed_sequence_iter_delete_during_iteration():
+    obj = cTypedSequence.SequenceInt32([1, 2, 3])
+    iterator = iter(obj)
+    assert next(iterator) == 1
+    del obj[2]
+    assert list(iterator) == [2]
+
+
+@pytest.mark.parametrize('typ, typecode, itemsize, minimum, maximum', TYPED_SEQUENCES)
+def test_typed_sequence_memoryview(typ, typecode, itemsize, minimum, maximum):
+    obj = typ([1, 2, 3])
+    view = memoryview(obj)
+    assert view.format == typecode
+    assert view.itemsize == itemsize
+    assert view.shape == (3,)
+    assert view.nbytes == 3 * itemsize
+    assert not view.readonly
+    assert view.tolist() == [1, 2, 3]
+    view[0] = 5
+    assert obj[0] == 5
+
+
+@pytest.mark.parametrize('typ, typecode, itemsize, minimum, maximum', TYPED_SEQUENCES)
+def test_typed_sequence_memoryview_empty(typ, typecode, itemsize, minimum, maximum):
+    view = memoryview(typ([]))
+    assert view.shape == (0,)
+    assert view.tolist() == []
+
+
+@pytest.mark.parametrize('typ, typecode, itemsize, minimum, maximum', TYPED_SEQUENCES)
+def test_typed_sequence_array_round_trip(typ, typecode, itemsize, minimum, maximum):
+    values = [1, 2, 3]
+    obj = typ(values)
+    assert array.array(typecode, bytes(obj)).tolist() == values
+
+
+def test_typed_sequence_init_with_export():
+    obj = cTypedSequence.SequenceInt32([1, 2, 3])
+    view = memoryview(obj)
+    with pytest.raises(BufferError):
+        obj.__init__([4])
+    view.release()
+    obj.__init__([4])
+    assert list(obj) == [4]
+
+
+@pytest.mark.parametrize('typ, typecode, itemsize, minimum, maximum', TYPED_SEQUENCES)
+def test_typed_sequence_sizeof(typ, typecode, itemsize, minimum, maximum):
+    size = 1_000
+    empty = sys.getsizeof(typ([]))
+    assert sys.getsizeof(typ([1] * size)) - empty == size * itemsize
+
+
+def test_typed_sequence_sizeof_smaller_than_list():
+    size = 1_000
+    assert sys.getsizeof(cTypedSequence.SequenceInt8([1] * size)) < sys.getsizeof([1] * size) // 4